@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_APP_CORE_H
+#define CLAWDESK_APP_CORE_H
+
+// HTTP 服务器、MCP 传输和会话存储用到的全局状态与宿主回调。
+// 不引入平台头文件：Windows 托盘程序（main.cpp）和 POSIX 无界面宿主（headless_main.cpp）各自提供定义
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class ConfigManager;
+class PolicyGuard;
+class HttpRequest;
+class HttpResponse;
+
+namespace clawdesk {
+    class AuditLogger;
+}
+
+// ── 全局变量 (extern) ───────────────────────────────────
+extern std::atomic<bool>      g_running;
+extern ConfigManager*         g_configManager;
+extern clawdesk::AuditLogger* g_auditLogger;
+extern PolicyGuard*           g_policyGuard;
+extern uint64_t               g_startTickCount;  // 启动时的 MonotonicMillis()，用于计算运行时长
+
+// ── 宿主回调 ────────────────────────────────────────────
+void AppendExceptionLogA(const std::string& line);
+void AppendHttpServerLogA(const std::string& line);
+
+// 活动记录：托盘程序转发到 Dashboard 窗口，无界面宿主忽略
+enum class ActivityKind { Request, Processing, Success, Error };
+void LogActivity(ActivityKind kind, const std::string& source, const std::string& message);
+
+// ── 请求授权 ────────────────────────────────────────────
+bool         IsAuthorizedRequest(const HttpRequest& request);
+HttpResponse MakeUnauthorizedResponse();
+std::string  RedactAuthorizationHeader(const std::string& request);
+
+#endif // CLAWDESK_APP_CORE_H
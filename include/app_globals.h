@@ -29,6 +29,7 @@
 #include <vector>
 #include <thread>
 #include <nlohmann/json.hpp>
+#include "app_core.h"
 
 // 前向声明（避免 include 重量级头文件）
 class ConfigManager;
@@ -43,6 +44,8 @@ class ScreenshotService;
 class FileService;
 class ClipboardService;
 class WindowService;
+class HttpRequest;
+class HttpResponse;
 class AppService;
 class CommandService;
 class BrowserService;
@@ -83,19 +86,15 @@ namespace clawdesk {
 // ── 全局变量 (extern) ───────────────────────────────────
 extern NOTIFYICONDATA nid;
 extern HWND g_hwnd;
-extern std::atomic<bool> g_running;
 extern HINSTANCE g_hInstance;
 extern DWORD g_mainThreadId;
 
-extern ConfigManager*              g_configManager;
 extern clawdesk::DashboardWindow*  g_dashboard;
-extern clawdesk::AuditLogger*      g_auditLogger;
 extern LicenseManager*             g_licenseManager;
 extern clawdesk::UpdateChecker*    g_updateChecker;
 extern std::thread*                g_updateCheckThread;
 extern std::atomic<bool>           g_checkingUpdate;
 extern clawdesk::UpdateCheckResult* g_updateCheckResult;
-extern PolicyGuard*                g_policyGuard;
 
 extern std::thread*                g_updateTimerThread;
 extern std::atomic<bool>           g_updateTimerRunning;
@@ -119,28 +118,20 @@ extern ULONG_PTR                   g_gdiplusToken;
 
 // HTTP 服务器
 extern HANDLE g_serverThread;
-extern SOCKET g_serverSocket;
-extern DWORD  g_startTickCount;  // GetTickCount() at startup, for uptime calculation
 
 // ── 共享工具函数 ────────────────────────────────────────
 std::wstring GetLogDirW();
 void         EnsureLogDir();
 void         AppendCrashLog(const std::wstring& line);
-void         AppendExceptionLogA(const std::string& line);
-void         AppendHttpServerLogA(const std::string& line);
 
 std::string  GetLocalIPAddress();
 bool         AddFirewallRule();
 bool         CheckFirewallRule();
 
-std::string  UrlDecode(const std::string& str);
 std::string  GetHeaderValue(const std::string& request, const std::string& headerNameLower);
-std::string  BuildUrlFromRequest(const std::string& request, const std::string& path);
+std::string  BuildUrlFromRequest(const HttpRequest& request, const std::string& path);
 std::wstring ToWide(const std::string& value);
 
-bool         IsAuthorizedRequest(const std::string& request);
-std::string  MakeUnauthorizedResponse();
-
 std::string  GetProcessList();
 std::string  ExecuteCommand(const std::string& command);
 std::string  CaptureScreenshot(const std::string& format = "png");
@@ -157,7 +148,6 @@ void CloseDashboardWindow();
 void SignalDaemonExit();
 std::wstring Localize(const char* key, const wchar_t* fallback);
 std::string GetWindowList();
-std::string RedactAuthorizationHeader(const std::string& request);
 bool SendHotkey(const std::string& hotkey);
 bool IsModifierKey(WORD vk);
 std::string BuildHelpJson();
@@ -166,7 +156,7 @@ void RegisterMcpTools();
 
 // HTTP 服务器
 DWORD WINAPI HttpServerThread(LPVOID lpParam);
-std::string  HandleHttpRequest(const std::string& request);
+HttpResponse HandleHttpRequest(const HttpRequest& request);
 
 // MCP 协议
 std::string HandleMCPInitialize(const std::string& body);
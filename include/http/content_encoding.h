@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_HTTP_CONTENT_ENCODING_H
+#define CLAWDESK_HTTP_CONTENT_ENCODING_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "http/deflate.h"
+#include "http/http_request.h"
+#include "http/http_response.h"
+
+enum class ContentCoding { Identity, Gzip, Deflate };
+
+struct CompressionOptions {
+    bool   enabled = true;
+    size_t minBytes = 1024;   // 小于此大小的 body 不压缩（压缩头尾和 CPU 开销不划算）
+    int    level = 6;         // 1（最快）~ 9（最小）
+};
+
+// 按 Accept-Encoding（含 q 值、"*"）选择编码：gzip 优先，其次 deflate；都不接受返回 Identity
+ContentCoding NegotiateContentCoding(std::string_view acceptEncoding);
+
+// Content-Encoding 的取值；Identity 返回 nullptr
+const char* ContentCodingName(ContentCoding coding);
+
+// 编码后的表示使用的 ETag：强 ETag "<tag>" 变为 "<tag>-gzip"，同一资源的各个编码各有一个强校验值。
+// 弱 ETag（W/）和 Identity 原样返回
+std::string EncodedETag(std::string_view etag, ContentCoding coding);
+
+// JSON、文本、JavaScript、XML、SSE 等值得压缩的类型；图片等已压缩格式返回 false
+bool IsCompressibleType(std::string_view contentType);
+
+// 流式（chunked）响应：请求接受且类型可压缩时写入 Content-Encoding / Vary，返回 body 应使用的编码。
+// 长度事先未知，不检查阈值
+ContentCoding ApplyStreamCoding(const HttpRequest& request, HttpResponse& response,
+                                const CompressionOptions& options);
+
+/**
+ * 按请求协商压缩内存中的响应 body，返回是否已压缩。
+ *
+ * 不处理：流式响应、文件区间（sendfile 发送）、已带 Content-Encoding、1xx/204/304、
+ * 不可压缩的类型、小于阈值的 body。可压缩的响应都带 Vary: Accept-Encoding；
+ * 压缩后的响应按 EncodedETag 改写 ETag。
+ * 共享 body（static 常量响应等，body 缓冲区被多个响应引用）的压缩结果会缓存，
+ * 同一缓冲区只压缩一次。
+ */
+bool CompressResponse(const HttpRequest& request, HttpResponse& response, const CompressionOptions& options);
+
+/**
+ * StreamCompressor - 分段写出的压缩流
+ *
+ * 每段数据压缩后立即 sync flush，返回的字节可以直接作为一个 chunk / SSE 数据发送，
+ * 客户端无需等待后续数据就能解出这一段。
+ */
+class StreamCompressor {
+public:
+    StreamCompressor(ContentCoding coding, int level);
+
+    std::string compress(std::string_view data);
+    // 流结束：压缩尾（含校验和）
+    std::string finish();
+
+private:
+    DeflateEncoder encoder_;
+};
+
+#endif // CLAWDESK_HTTP_CONTENT_ENCODING_H
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_HTTP_DEFLATE_H
+#define CLAWDESK_HTTP_DEFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * DeflateEncoder - DEFLATE（RFC 1951）压缩器，用于 HTTP Content-Encoding
+ *
+ * LZ77（32 KB 窗口、哈希链，level 4 起惰性匹配）+ 每块按频率建动态 Huffman 码，
+ * 动态、固定、stored 三种块按编码后大小取最小。可以整体压缩，也可以分多次写入：
+ * flush 时输出 sync flush（空 stored 块），对端能立即解出已写入的全部数据，
+ * 用于 SSE 事件和 chunked 响应块。
+ *
+ * 不是线程安全的：一个流只能在一个线程里写。
+ */
+class DeflateEncoder {
+public:
+    enum class Format {
+        Raw,    // 裸 DEFLATE
+        Zlib,   // RFC 1950（HTTP "deflate"）：2 字节头 + Adler-32
+        Gzip    // RFC 1952（HTTP "gzip"）：10 字节头 + CRC-32 + 长度
+    };
+
+    // level 1（最快）~ 9（最小），超出范围按边界处理
+    DeflateEncoder(Format format, int level);
+
+    // 压缩 data，输出追加到 out；flush 为 true 时本次写入的数据全部输出并字节对齐
+    void write(std::string_view data, std::string& out, bool flush = false);
+
+    // 结束流：输出剩余数据、最后一个块和校验尾。之后不能再写入
+    void finish(std::string& out);
+
+    uint64_t totalIn() const { return totalIn_; }
+
+private:
+    struct Symbol {
+        uint16_t litLen;  // 字面字节（dist 为 0）或匹配长度 3..258
+        uint16_t dist;    // 匹配距离 1..32768，0 表示字面字节
+    };
+
+    void writeHeader(std::string& out);
+    void compress(bool all, bool final, std::string& out);
+    void insertHash(size_t pos);
+    size_t longestMatch(size_t pos, size_t end, size_t& dist) const;
+    void emitBlock(const std::vector<Symbol>& symbols, size_t rawBegin, size_t rawEnd, bool final, std::string& out);
+    void slideWindow();
+
+    void putBits(uint32_t value, int count, std::string& out);
+    void alignToByte(std::string& out);
+
+    Format format_;
+    int maxChain_;
+    size_t niceLength_;
+    bool lazy_;
+
+    std::string window_;           // 已压缩的历史（最多保留 32 KB 以供匹配）+ 待压缩数据
+    size_t pos_ = 0;               // 待压缩数据在 window_ 中的起点
+    std::vector<int32_t> head_;    // 3 字节哈希 -> 最近出现的位置
+    std::vector<int32_t> prev_;    // 位置 -> 同哈希的上一个位置
+    size_t hashed_ = 0;            // [0, hashed_) 已插入哈希链
+
+    uint64_t bitBuffer_ = 0;
+    int bitCount_ = 0;
+    bool headerWritten_ = false;
+    bool finished_ = false;
+    uint32_t checksum_;
+    uint64_t totalIn_ = 0;
+};
+
+// 一次性压缩
+std::string DeflateCompress(std::string_view data, DeflateEncoder::Format format, int level);
+
+uint32_t Crc32(uint32_t crc, const void* data, size_t size);
+uint32_t Adler32(uint32_t adler, const void* data, size_t size);
+
+#endif // CLAWDESK_HTTP_DEFLATE_H
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_HTTP_REQUEST_H
+#define CLAWDESK_HTTP_REQUEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct HttpHeaderField {
+    std::string_view name;    // 保持原始大小写
+    std::string_view value;   // 已去掉首尾空白
+};
+
+/**
+ * HttpBodyReader - 流式请求体的读端，由连接层实现
+ *
+ * 只有声明为流式读取的路由才会拿到它（此时 HttpRequest::body 为空）；
+ * 在 worker 线程中按需拉取，客户端发来多少读多少，内存占用与 body 大小无关。
+ * 请求带 Expect: 100-continue 时，第一次 read() 才会让连接回复 100 Continue，
+ * 因此处理函数在读 body 之前拒绝请求（鉴权、参数错误）时客户端不必上传 body。
+ */
+class HttpBodyReader {
+public:
+    virtual ~HttpBodyReader() = default;
+    // 读取最多 size 字节，必要时阻塞等待客户端数据；body 已读完返回 0。
+    // 客户端断开或超时抛出 std::runtime_error
+    virtual size_t read(char* buf, size_t size) = 0;
+    // Content-Length
+    virtual uint64_t length() const = 0;
+    // 已读取的字节数
+    virtual uint64_t consumed() const = 0;
+};
+
+/**
+ * HttpRequest - 解析后的 HTTP 请求
+ *
+ * 对象持有原始请求字节，method/path/header/body 都是指向这块内存的 string_view，
+ * 因此不可拷贝也不可移动；跨线程传递时使用 std::shared_ptr<HttpRequest>。
+ */
+class HttpRequest {
+public:
+    std::string_view method;          // "GET"
+    std::string_view target;          // 原始 request-target，如 "/list?path=C%3A"
+    std::string_view path;            // 不含 query string，未解码，如 "/list"
+    std::string_view version;         // "HTTP/1.1"
+    std::string_view body;
+    std::vector<HttpHeaderField> headers;
+    std::map<std::string, std::string> query;  // 已 URL 解码；重复参数保留第一个
+    bool secure = false;                       // 来自 HTTPS 监听器（TLS 连接）
+
+    HttpRequest() = default;
+    HttpRequest(const HttpRequest&) = delete;
+    HttpRequest& operator=(const HttpRequest&) = delete;
+
+    // 按名称查找 header（不区分大小写），不存在返回空 view
+    std::string_view header(std::string_view name) const;
+    bool hasHeader(std::string_view name) const;
+
+    // 已解码的 query 参数，不存在返回空串
+    std::string queryParam(const std::string& key) const;
+
+    // 完整原始请求（header + body；body 单独接收时只有 header）
+    std::string_view raw() const { return data_; }
+
+    // 原始请求中 header 部分（含请求行，不含 body）
+    std::string_view head() const { return std::string_view(data_).substr(0, headLength_); }
+
+    // 连接层先取 header、再单独接收 body 时使用（见 HttpRequestParser::takeHead）
+    void attachBody(std::string body);
+    void attachBodyReader(std::shared_ptr<HttpBodyReader> reader) { bodyReader_ = std::move(reader); }
+
+    // 流式路由的请求体读端；body 已完整缓存在 body 中时为 nullptr
+    HttpBodyReader* bodyReader() const { return bodyReader_.get(); }
+
+private:
+    friend class HttpRequestParser;
+    std::string data_;
+    size_t headLength_ = 0;
+    std::string bodyData_;            // attachBody() 接收的 body（data_ 中只有 header）
+    std::shared_ptr<HttpBodyReader> bodyReader_;
+};
+
+/**
+ * HttpRequestParser - 增量式单遍 HTTP/1.x 请求解析器
+ *
+ * 连接每收到一块数据就调用一次 parse()，解析器从上次停下的位置继续扫描，
+ * 每个字节只看一遍；完整后用 take() 把请求字节移交给 HttpRequest，
+ * 缓冲区中剩余的字节（pipelining 的下一个请求）保留在原处。
+ *
+ * 需要按路由决定 body 上限或流式读取 body 时，改用 parseHead() + takeHead()：
+ * header 结束即返回，body 由调用方自行接收。
+ */
+class HttpRequestParser {
+public:
+    enum class Status { NeedMore, Complete, Error };
+
+    HttpRequestParser(size_t maxHeaderBytes, size_t maxBodyBytes);
+
+    // 继续解析 buf（连接的累计输入，须从本请求第一个字节开始）
+    Status parse(const std::string& buf);
+
+    // 只解析到 header 结束（不等待 body，也不检查 body 上限）
+    Status parseHead(const std::string& buf);
+
+    // Error 时建议返回给客户端的状态码（400/413/431/501）
+    int errorStatus() const { return errorStatus_; }
+
+    // 已收到完整 header 后的 Content-Length；之前为 0
+    size_t contentLength() const { return contentLength_; }
+
+    // Complete 后调用：取走 buf 开头的一个请求并重置解析器
+    std::unique_ptr<HttpRequest> take(std::string& buf);
+
+    // parseHead() 返回 Complete 后调用：只取走 header（body 为空），buf 中留下 body 及之后的字节。
+    // Content-Length 须在调用前用 contentLength() 读取
+    std::unique_ptr<HttpRequest> takeHead(std::string& buf);
+
+    void reset();
+
+private:
+    enum class State { RequestLine, Headers, Body, Complete, Error };
+
+    struct Span {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+    struct HeaderSpan {
+        Span name;
+        Span value;
+    };
+
+    Status fail(int status);
+    Status scanHead(const std::string& buf);
+    std::unique_ptr<HttpRequest> build(std::string& buf, size_t total);
+    bool parseRequestLine(const char* data, size_t begin, size_t end);
+    bool parseHeaderLine(const char* data, size_t begin, size_t end);
+
+    size_t maxHeaderBytes_;
+    size_t maxBodyBytes_;
+
+    State  state_ = State::RequestLine;
+    size_t scanPos_ = 0;     // 下一个待扫描的字节
+    size_t lineStart_ = 0;   // 当前行起点
+    size_t bodyStart_ = 0;
+    size_t contentLength_ = 0;
+    bool   hasContentLength_ = false;
+    int    errorStatus_ = 0;
+
+    Span method_;
+    Span target_;
+    Span version_;
+    std::vector<HeaderSpan> headers_;
+};
+
+// 解析一个完整的请求字符串（测试和非连接场景使用）；不完整或出错时返回 nullptr
+std::unique_ptr<HttpRequest> ParseHttpRequest(std::string raw);
+
+// URL 解码：%XX 与 '+'（表示空格）
+std::string DecodeUrlComponent(std::string_view in);
+
+// ASCII 大小写不敏感比较
+bool EqualsIgnoreCase(std::string_view a, std::string_view b);
+
+#endif // CLAWDESK_HTTP_REQUEST_H
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_HTTP_RESPONSE_H
+#define CLAWDESK_HTTP_RESPONSE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "net/file_handle.h"
+
+// 响应的一段数据：共享的内存块，或文件中的一个区间（由连接层用 sendfile/TransmitFile 发送）
+struct HttpBodyPart {
+    std::shared_ptr<const std::string> data;
+    std::shared_ptr<FileHandle> file;
+    uint64_t    fileOffset = 0;
+    uint64_t    fileLength = 0;
+
+    bool isFile() const { return file != nullptr; }
+    uint64_t size() const { return file ? fileLength : data->size(); }
+};
+
+// 流式 body 的写端，由连接层实现
+class HttpBodySink {
+public:
+    virtual ~HttpBodySink() = default;
+    // 追加一段 body（可能阻塞等待客户端读取）；客户端已断开时返回 false，producer 应尽快返回
+    virtual bool write(std::string_view data) = 0;
+};
+
+// 在 worker 线程中运行，边生成边把 body 写入 sink
+using HttpBodyProducer = std::function<void(HttpBodySink&)>;
+
+// 异步 body 的写端，由连接层实现：任意线程调用，只排队不阻塞（没有背压，适合事件、进度这类小块数据）
+class HttpAsyncBodySink {
+public:
+    virtual ~HttpAsyncBodySink() = default;
+    // 追加一段 body；客户端已断开或已 finish 时返回 false
+    virtual bool write(std::string data) = 0;
+    // 结束 body（只有第一次调用有效）。ok 为 false 时直接断开，客户端据此得知响应不完整；
+    // 写端析构时仍未结束按 finish(false) 处理
+    virtual void finish(bool ok = true) = 0;
+    // 客户端已断开（连接关闭）
+    virtual bool cancelled() const = 0;
+};
+
+// 在 worker 线程中调用一次，应立即返回；之后由其他线程（工具线程池、定时器等）通过 sink 写出 body，
+// 期间不占用 worker
+using HttpAsyncBodyStarter = std::function<void(std::shared_ptr<HttpAsyncBodySink>)>;
+
+/**
+ * HttpResponse - 结构化的 HTTP 响应
+ *
+ * body 由若干段组成（内存块 / 文件区间），写出时由连接层用 gather I/O 直接发送，
+ * 不再把 header 和 body 拼成一个大字符串。Content-Length 按 body 自动生成
+ * （1xx/204/304 不带 body，也不写 Content-Length）。
+ *
+ * 拷贝代价很小：body 段是共享指针，freeze() 之后的状态行和 header 也是共享的，
+ * 因此固定响应可以做成 static 常量，每次返回一份拷贝。
+ */
+class HttpResponse {
+public:
+    using Buffer = std::shared_ptr<const std::string>;
+
+    explicit HttpResponse(int status = 200);
+
+    int status() const { return status_; }
+    void setStatus(int status);
+
+    // 追加 header（不检查重名）；不要手动设置 Content-Length
+    void addHeader(std::string name, std::string value);
+    // 替换同名 header（不区分大小写），不存在则追加
+    void setHeader(const std::string& name, std::string value);
+    // 查找 header，不存在返回空 view
+    std::string_view header(std::string_view name) const;
+
+    void setBody(std::string body);
+    void appendBody(std::string data);
+    void appendBody(Buffer data);
+    void appendFile(std::shared_ptr<FileHandle> file, uint64_t offset, uint64_t length);
+
+    // 流式 body：替换已有 body，响应以 Transfer-Encoding: chunked 写出，
+    // 不再需要预先知道长度，也不必把完整 body 放在内存里。setBody() 取消流式。
+    void setStreamBody(HttpBodyProducer producer);
+    // 异步流式 body：同样以 chunked 写出，但 body 由 starter 交出的 sink 在之后陆续写入
+    void setAsyncBody(HttpAsyncBodyStarter starter);
+    bool isStreaming() const { return producer_ || asyncStarter_; }
+    const HttpBodyProducer& producer() const { return producer_; }
+    const HttpAsyncBodyStarter& asyncStarter() const { return asyncStarter_; }
+
+    uint64_t contentLength() const { return contentLength_; }
+    const std::vector<HttpBodyPart>& body() const { return body_; }
+
+    // 把状态行和当前 header 预先序列化（固定响应用）。之后 addHeader 追加的
+    // header 单独写出；修改状态码、已冻结的 header 或 body 会自动解除冻结。
+    HttpResponse& freeze();
+
+    // 序列化为待写出的段：第一段（或前两段）是响应头，其后是 body（流式响应只有响应头）
+    std::vector<HttpBodyPart> serialize() const;
+
+    // 完整响应文本（只含内存 body，测试和日志用）
+    std::string toString() const;
+
+    static const char* ReasonPhrase(int status);
+
+private:
+    using Header = std::pair<std::string, std::string>;
+
+    struct Frozen {
+        std::string head;             // 状态行 + header + Content-Length/Transfer-Encoding，不含结尾空行
+        std::vector<Header> headers;
+    };
+
+    void thaw();
+    std::string renderHead(bool includeFrozen) const;
+
+    int status_;
+    std::shared_ptr<const Frozen> frozen_;
+    std::vector<Header> headers_;     // 冻结之后追加的 header（未冻结时为全部）
+    std::vector<HttpBodyPart> body_;
+    uint64_t contentLength_ = 0;
+    HttpBodyProducer producer_;
+    HttpAsyncBodyStarter asyncStarter_;
+};
+
+// Content-Type: application/json + CORS 的常用响应
+HttpResponse MakeJsonResponse(int status, std::string body);
+
+// 200 + JSON 的流式响应，body 由 producer 分段写出
+HttpResponse MakeJsonStreamResponse(HttpBodyProducer producer);
+
+// 预序列化的 202 Accepted（空 body），MCP 的通知/回执共用
+const HttpResponse& AcceptedResponse();
+
+#endif // CLAWDESK_HTTP_RESPONSE_H
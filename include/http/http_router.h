@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_HTTP_ROUTER_H
+#define CLAWDESK_HTTP_ROUTER_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "http/http_request.h"
+#include "http/http_response.h"
+
+// 路由对请求体的约定：大小上限，以及 handler 是否通过 HttpBodyReader 边收边读
+struct HttpBodyPolicy {
+    uint64_t maxBytes;
+    bool     streaming;
+};
+
+enum class RouteAuth {
+    Public,   // 不需要 Auth Token（/health）
+    Token     // 需要 Auth Token
+};
+
+using HttpRouteHandler = std::function<HttpResponse(const HttpRequest&)>;
+
+struct HttpRoute {
+    std::string method;        // "GET" 等；空表示任意方法
+    std::string path;          // 精确路径；前缀路由为以 '/' 结尾的前缀
+    bool prefix = false;
+    RouteAuth auth = RouteAuth::Token;
+    uint64_t maxBodyBytes = 0; // 0 表示使用路由表的默认上限
+    bool streamBody = false;
+    bool (*streamBodyIf)(const HttpRequest& head) = nullptr;  // 非空时按请求 header 决定是否流式读取
+    HttpRouteHandler handler;
+
+    HttpRoute& setPublic() { auth = RouteAuth::Public; return *this; }
+    HttpRoute& setBody(uint64_t maxBytes, bool streaming) { maxBodyBytes = maxBytes; streamBody = streaming; return *this; }
+    HttpRoute& setStreamBodyIf(bool (*predicate)(const HttpRequest&)) { streamBodyIf = predicate; return *this; }
+};
+
+struct HttpRouteMatch {
+    const HttpRoute* route = nullptr;  // 命中的路由
+    std::string_view allow;            // 未命中但路径存在（方法不对）时的 Allow 值，如 "GET, PUT"；否则为空
+};
+
+/**
+ * HttpRouter - 路由表
+ *
+ * 精确路径与前缀路径各放一张哈希表：精确匹配一次查找，前缀匹配按路径中的 '/'
+ * 从长到短逐段查找，代价与路径长度成正比，与路由数量无关。同一路径下按方法区分，
+ * 指定方法的路由优先于任意方法的路由；前缀路由只在没有精确命中时才考虑。
+ *
+ * 路由表在启动时建好，之后只读，可以被多个 worker 线程并发查询。
+ */
+class HttpRouter {
+public:
+    explicit HttpRouter(uint64_t defaultBodyLimit) : defaultBodyLimit_(defaultBodyLimit) {}
+    HttpRouter(const HttpRouter&) = delete;
+    HttpRouter& operator=(const HttpRouter&) = delete;
+
+    // 注册精确路径。method 为空表示任意方法；同一路径与方法重复注册抛 std::logic_error
+    HttpRoute& add(std::string method, std::string path, HttpRouteHandler handler);
+
+    // 注册前缀路径（须以 '/' 结尾），如 "/screenshot/file/"
+    HttpRoute& addPrefix(std::string method, std::string prefix, HttpRouteHandler handler);
+
+    HttpRouteMatch match(std::string_view method, std::string_view path) const;
+
+    // 按请求 header 查找路由的请求体约定；没有命中的路由时使用默认上限、不流式
+    HttpBodyPolicy bodyPolicy(const HttpRequest& head) const;
+
+    size_t size() const { return routes_.size(); }
+
+private:
+    struct PathEntry {
+        std::string path;
+        std::vector<const HttpRoute*> routes;
+        const HttpRoute* anyMethod = nullptr;
+        std::string allow;
+    };
+    using PathTable = std::unordered_map<std::string_view, std::unique_ptr<PathEntry>>;
+
+    HttpRoute& insert(PathTable& table, std::string method, std::string path, bool prefix, HttpRouteHandler handler);
+    static const HttpRoute* select(const PathEntry& entry, std::string_view method);
+
+    uint64_t defaultBodyLimit_;
+    std::deque<HttpRoute> routes_;   // deque：插入不移动已有元素，PathEntry 中的指针保持有效
+    PathTable exact_;
+    PathTable prefix_;
+};
+
+#endif // CLAWDESK_HTTP_ROUTER_H
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_HTTP_STATIC_FILE_H
+#define CLAWDESK_HTTP_STATIC_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "http/http_request.h"
+#include "http/http_response.h"
+
+// 按扩展名判断 MIME 类型（不区分大小写），未知返回 application/octet-stream
+const char* GuessMimeType(std::string_view fileName);
+
+// RFC 7231 IMF-fixdate，如 "Sun, 06 Nov 1994 08:49:37 GMT"
+std::string FormatHttpDate(int64_t unixSeconds);
+
+// 解析 IMF-fixdate；格式不符返回 false（按 RFC 应忽略该 header）
+bool ParseHttpDate(std::string_view text, int64_t& unixSeconds);
+
+// 解析单个 "bytes=first-last" / "bytes=first-" / "bytes=-suffix" 区间。
+// 返回 1 表示可满足（写入 [offset, offset + length)），0 表示不可满足（416），
+// -1 表示格式不支持或多区间（忽略 Range，返回完整内容）
+int ParseByteRange(std::string_view header, uint64_t fileSize, uint64_t& offset, uint64_t& length);
+
+// If-None-Match 列表是否包含 etag（弱比较：忽略 W/ 前缀；"*" 匹配任意）
+bool ETagListMatches(std::string_view list, std::string_view etag);
+
+/**
+ * 发送磁盘上的文件（截图、剪贴板图片/文件）
+ *
+ * - 内容作为文件区间交给连接层，由 sendfile / TransmitFile 发送，不读入内存
+ * - ETag（大小 + 修改时间）与 Last-Modified；If-None-Match / If-Modified-Since 命中返回 304
+ * - Range / If-Range：单区间返回 206，不可满足返回 416，多区间按完整内容返回
+ *
+ * contentType 为空时按文件名推断。文件不存在返回 404。
+ */
+HttpResponse ServeFile(const HttpRequest& request, const std::string& path, const char* contentType = nullptr);
+
+#endif // CLAWDESK_HTTP_STATIC_FILE_H
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_HTTP_CONNECTION_H
+#define CLAWDESK_HTTP_CONNECTION_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "http/content_encoding.h"
+#include "net/reactor.h"
+#include "support/rate_limiter.h"
+#include "support/worker_pool.h"
+
+class HttpConnection;
+class TlsContext;
+
+/**
+ * HttpConnectionManager - reactor 上的 HTTP 连接管理
+ *
+ * 拥有监听 socket 和所有已接受的连接（普通请求、keep-alive 空闲连接、SSE 流）。
+ * 连接的读写全部由 reactor 线程非阻塞完成，只有请求处理本身交给 WorkerPool，
+ * 因此空闲连接和 SSE 流不占用任何线程。
+ *
+ * 开启 accept 分片时每个 reactor 线程各有一个实例，共享 WorkerPool 和按 IP 的限流器。
+ *
+ * 除构造外，所有方法都只能在 reactor 线程调用。
+ */
+class HttpConnectionManager {
+public:
+    HttpConnectionManager(Reactor& reactor, WorkerPool& pool, RateLimiter& rateLimiter);
+    ~HttpConnectionManager();
+
+    HttpConnectionManager(const HttpConnectionManager&) = delete;
+    HttpConnectionManager& operator=(const HttpConnectionManager&) = delete;
+
+    // 注册监听 socket，可多次调用（所有权交给 reactor，停止时由 reactor 关闭；失败时由调用方关闭）。
+    // tls 非空时该监听器接受的连接走 HTTPS
+    bool addListener(socket_t listener, std::shared_ptr<TlsContext> tls = nullptr);
+
+    // 关闭所有连接（服务器退出时）
+    void closeAll();
+
+    // 排空（服务器退出时）：关闭监听 socket 不再接受新连接；空闲连接立即关闭，SSE 流写完
+    // 已排队的事件后关闭，进行中的请求写完响应后关闭。全部连接结束或 timeoutMs 到期
+    // （剩余连接强制关闭）后在 reactor 线程调用一次 onDrained。重复调用无效
+    void drain(int timeoutMs, std::function<void()> onDrained);
+
+    bool draining() const { return draining_; }
+
+    size_t connectionCount() const { return connections_.size(); }
+
+private:
+    friend class HttpConnection;
+    class Listener;
+
+    void onAccept(socket_t sock, TlsContext* tls);
+    void remove(HttpConnection* conn);
+    void checkDrained();
+
+    Reactor& reactor_;
+    WorkerPool& pool_;
+    std::vector<std::unique_ptr<Listener>> listeners_;
+    std::unordered_map<HttpConnection*, std::shared_ptr<HttpConnection>> connections_;
+
+    RateLimiter& rateLimiter_;
+    int keepAliveTimeoutMs_;
+    int keepAliveMaxRequests_;
+    int queueTimeoutMs_;      // 请求在 worker 队列中的最长等待
+    int headerTimeoutMs_;     // 收齐请求头的总时限
+    int bodyTimeoutMs_;       // 请求体接收的最长停顿
+    int minBodyRate_;         // 请求体最低平均速率（字节/秒），0 表示不检查
+    CompressionOptions compression_;
+
+    bool draining_ = false;
+    std::function<void()> onDrained_;
+    Reactor::TimerId drainTimer_ = 0;
+};
+
+#endif // CLAWDESK_HTTP_CONNECTION_H
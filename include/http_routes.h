@@ -19,9 +19,24 @@
 #ifndef CLAWDESK_HTTP_ROUTES_H
 #define CLAWDESK_HTTP_ROUTES_H
 
+#include <cstdint>
 #include <string>
+#include "http/http_request.h"
+#include "http/http_response.h"
+#include "http/http_router.h"
 
-// HTTP 请求路由分发
-std::string HandleHttpRequest(const std::string& request);
+// 按请求 header 查找路由的请求体约定（连接层在 header 收齐、接收 body 之前调用）
+HttpBodyPolicy GetRequestBodyPolicy(const HttpRequest& head);
+
+// 是否走快速通道（/health、OPTIONS、MCP ping 和 notifications/cancelled）：不排在普通请求之后，也不受排队时限约束
+bool IsFastLaneRequest(const HttpRequest& request);
+
+// HTTP 请求路由分发：按路由表查找处理函数，检查授权后调用
+HttpResponse HandleHttpRequest(const HttpRequest& request);
+
+#ifdef _WIN32
+// 桌面功能路由（状态、文件、剪贴板、截图、窗口、进程、命令执行），定义在 http_desktop_routes.cpp
+void RegisterDesktopRoutes(HttpRouter& router);
+#endif
 
 #endif // CLAWDESK_HTTP_ROUTES_H
@@ -19,23 +19,39 @@
 #ifndef CLAWDESK_HTTP_SERVER_H
 #define CLAWDESK_HTTP_SERVER_H
 
+#include <functional>
+#include <string>
+#include "net/tls_context.h"
+#include "support/worker_pool.h"
+
+#ifdef _WIN32
 #include <winsock2.h>
 #include <windows.h>
-#include <string>
+#endif
 
-// HTTP 服务器线程
-DWORD WINAPI HttpServerThread(LPVOID lpParam);
+// 在调用线程上运行 HTTP 服务器，直到 StopHttpServer() 触发的排空结束。
+// 监听就绪或启动失败时调用一次 onStarted(true / false)；返回进程风格的退出码
+int RunHttpServer(const std::function<void(bool started)>& onStarted);
 
-// 完整接收 HTTP 请求（处理分片）
-std::string RecvFullHttpRequest(SOCKET sock);
+// 线程安全：置 g_running = false 并立即唤醒服务器开始排空——停止 accept，进行中的请求
+// 在 server.drain_timeout_ms 内写完响应，SSE 流写完已排队的事件后关闭。
+// 可在 RunHttpServer 启动前后任意时刻调用（启动前调用时服务器就绪后立即排空）
+void StopHttpServer();
 
-// 可靠发送：循环处理 partial send，失败返回 false
-bool SendAll(SOCKET sock, const char* buf, int len);
-bool SendAll(SOCKET sock, const std::string& data);
+// 请求处理线程池指标（服务器未运行时返回 false）
+bool GetHttpWorkerPoolStats(WorkerPool::Stats& out);
+
+// HTTPS 握手指标（未启用 HTTPS 或服务器未运行时返回 false）
+bool GetHttpTlsStats(TlsContext::Stats& out);
+
+#ifdef _WIN32
+// HTTP 服务器线程（托盘程序）：运行 RunHttpServer，通过 g_httpServerStartedEvent 通知启动结果
+DWORD WINAPI HttpServerThread(LPVOID lpParam);
 
 // 网络辅助
 std::string GetLocalIPAddress();
 bool AddFirewallRule();
 bool CheckFirewallRule();
+#endif
 
 #endif // CLAWDESK_HTTP_SERVER_H
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_MCP_BATCH_EXECUTOR_H
+#define CLAWDESK_MCP_BATCH_EXECUTOR_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "support/worker_pool.h"
+
+/**
+ * JSON-RPC batch 的并发执行
+ *
+ * batch 中的各条消息交给专用的有界线程池并发处理。调用线程（HTTP worker）也参与执行：
+ * 调用方和池线程从同一个计数器领取任务，池满、池未设置或池线程迟迟未开始时剩余任务
+ * 都由调用线程自己完成，因此不会因池被占满而死锁；一个 batch 最多同时占用
+ * 1 + 池线程数 个线程。
+ */
+
+// 单个 batch 的消息数上限（超过时整个 batch 以 -32600 拒绝）
+static const size_t kMaxJsonRpcBatchSize = 64;
+
+// 设置 batch 线程池（RunHttpServer 启动时设置，退出前置空）；为空时 batch 在调用线程中顺序执行
+void SetMcpBatchPool(WorkerPool* pool);
+
+// 并发执行 tasks，全部完成后返回。task 不得抛出异常
+void RunMcpBatchTasks(std::vector<std::function<void()>> tasks);
+
+// 处理 JSON-RPC 2.0 batch：对每个元素调用 handle（返回响应对象；通知和客户端发来的
+// response 无需回复，返回 null）。各元素并发执行、互不影响，handle 抛出的异常转为该元素的
+// -32603 错误。返回按原顺序排列的响应数组，全部无需回复时为空数组
+nlohmann::json RunJsonRpcBatch(const nlohmann::json& batch,
+                               const std::function<nlohmann::json(const nlohmann::json&)>& handle);
+
+#endif // CLAWDESK_MCP_BATCH_EXECUTOR_H
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_MCP_DISPATCHER_H
+#define CLAWDESK_MCP_DISPATCHER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+/**
+ * MCP 方法分发（与传输无关）
+ *
+ * Streamable HTTP（POST /mcp）、SSE（POST /messages）和 /mcp/ 下的 REST 接口只负责 session、
+ * 响应头和响应的投递方式；JSON-RPC 消息校验、ping / tools/list / tools/call 都在这里处理。
+ * tools/call 只查找一次工具，之后的策略检查、审计、执行和结果封装都使用同一个 ToolHandle。
+ * 异步工具和带 progressToken 的调用经 StartMcpToolCall 执行，响应与进度通知通过传输提供的
+ * McpResponseChannel 投递，不占用 HTTP worker。
+ *
+ * 带 session 的 tools/call 执行期间按 (sessionId, 请求 id) 登记，客户端发送
+ * notifications/cancelled 时经 CancelMcpRequest 取消其 CancellationToken。
+ */
+
+// JSON-RPC 2.0 错误码
+static const int kJsonRpcParseError     = -32700;
+static const int kJsonRpcInvalidRequest = -32600;
+static const int kJsonRpcMethodNotFound = -32601;
+static const int kJsonRpcInvalidParams  = -32602;
+static const int kJsonRpcInternalError  = -32603;
+static const int kJsonRpcServerError    = -32000;
+
+// 服务器回复的 MCP 协议版本
+static const char* const kMcpProtocolVersion = "2024-11-05";
+
+nlohmann::json MakeJsonRpcResult(const nlohmann::json& id, const nlohmann::json& result);
+nlohmann::json MakeJsonRpcError(const nlohmann::json& id, int code, const std::string& message);
+
+// 一条已校验的 JSON-RPC 消息
+struct JsonRpcMessage {
+    enum Kind {
+        Invalid,        // error 为应回复的错误响应
+        Request,        // 有 method 和 id
+        Notification,   // 有 method 无 id
+        Response        // 客户端发来的 response，忽略
+    };
+    Kind kind = Invalid;
+    std::string method;
+    nlohmann::json id;
+    nlohmann::json params;
+    nlohmann::json error;
+};
+
+// 校验 jsonrpc 字段并判定消息类型
+JsonRpcMessage ParseJsonRpcMessage(const nlohmann::json& msg);
+
+// body 是否为应走 worker 池快速通道的单条消息：ping，以及 notifications/cancelled
+// （取消不能排在它要取消的、占满 worker 的 tools/call 后面）
+bool IsMcpFastLaneMessage(std::string_view body);
+
+// initialize 的 result（session 的创建由各传输负责）
+nlohmann::json MakeMcpInitializeResult();
+
+// tools/list 的 result：{"tools": [...]}（解析注册表缓存的字节，batch 等需要 json 对象时使用）
+nlohmann::json MakeMcpToolsListResult();
+
+// tools/list 的 JSON-RPC 响应，不做 JSON 构造和序列化：prefix + *result + "}" 与
+// MakeJsonRpcResult(id, MakeMcpToolsListResult()).dump() 相同，result 是注册表共享的预序列化字节
+struct McpToolsListResponse {
+    std::string prefix;
+    std::shared_ptr<const std::string> result;
+    std::string etag;
+
+    static const char* suffix() { return "}"; }
+    std::string join() const { return prefix + *result + suffix(); }
+};
+
+McpToolsListResponse MakeMcpToolsListResponse(const nlohmann::json& id, const char* source);
+
+// tools/call 的执行结果：成功时 result 为工具返回值，失败时 errorCode / errorMessage 为 JSON-RPC 错误
+struct McpToolCallResult {
+    int errorCode = 0;
+    std::string errorMessage;
+    nlohmann::json result;
+
+    bool ok() const { return errorCode == 0; }
+};
+
+// tools/call：校验 params、查找工具、策略检查、审计、执行，阻塞到完成（只有 asyncHandler 的工具
+// 也等待其完成）。source 为日志 / Activity 标签；sessionId 和 requestId 都不为空时调用可被
+// notifications/cancelled 取消
+McpToolCallResult CallMcpTool(const nlohmann::json& params, const char* source,
+                              const std::string& sessionId = "", const nlohmann::json& requestId = nullptr);
+
+// tools/call 响应的投递通道（由传输实现，任意线程调用）
+class McpResponseChannel {
+public:
+    virtual ~McpResponseChannel() = default;
+    // 发送通知（notifications/progress）；客户端已断开时返回 false
+    virtual bool notify(const nlohmann::json& notification) = 0;
+    // 发送最终响应，只调用一次
+    virtual void respond(const nlohmann::json& response) = 0;
+    // 客户端已断开
+    virtual bool closed() const = 0;
+};
+
+// 是否应以 StartMcpToolCall 异步执行：工具提供了 asyncHandler，或客户端带了 _meta.progressToken
+bool IsAsyncMcpToolCall(const nlohmann::json& params);
+
+// 异步执行 tools/call：校验、策略检查和审计在调用线程中完成，之后由工具的 asyncHandler（没有时
+// 由工具线程池）执行；进度通知和最终响应通过 channel 发出。调用线程立即返回。
+// channel 关闭或 session 内收到对应的 notifications/cancelled 时取消
+void StartMcpToolCall(const JsonRpcMessage& request, const char* source,
+                      std::shared_ptr<McpResponseChannel> channel, const std::string& sessionId = "");
+
+// notifications/cancelled：取消 session 内 id 为 params.requestId 的执行中调用。
+// 调用已结束或 id 未知时忽略，返回 false
+bool CancelMcpRequest(const nlohmann::json& params, const std::string& sessionId, const char* source);
+
+// 分发 initialize 以外的 Request（ping、tools/list、tools/call、未知方法），返回 JSON-RPC 响应
+nlohmann::json DispatchMcpRequest(const JsonRpcMessage& request, const char* source,
+                                  const std::string& sessionId = "");
+
+#endif // CLAWDESK_MCP_DISPATCHER_H
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_MCP_EVENT_LOG_H
+#define CLAWDESK_MCP_EVENT_LOG_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "mcp_sse.h"
+
+/**
+ * Streamable HTTP session 的事件日志（可续传）
+ *
+ * session 发给客户端的每个 SSE 事件都带一个 ID："<流号>-<序号>"。流号 0 是 GET /mcp 的
+ * 事件流，POST /mcp 以 SSE 回复的每个请求各占一个流号；序号在 session 内单调递增。
+ * 最近的事件保留在有界的重放缓冲中：连接断开后客户端带 Last-Event-ID 重新 GET /mcp，
+ * 接管该 ID 所属的流，先收到之后缓冲的事件，再继续收到该流的新事件，工具不必重新执行。
+ */
+
+// 每个 session 的重放缓冲上限（超过时丢弃最早的事件）
+static const size_t kMcpReplayMaxEvents = 256;
+static const size_t kMcpReplayMaxBytes  = 256 * 1024;
+
+class McpEventLog {
+public:
+    McpEventLog(size_t maxEvents = kMcpReplayMaxEvents, size_t maxBytes = kMcpReplayMaxBytes);
+
+    // 为 POST 的 SSE 响应分配流号
+    uint64_t openStream();
+
+    // 记录一个 message 事件，返回带 ID 的 SSE 帧。primaryOpen 为 true 时由调用方写到流自己的
+    // 连接；为 false（该流的连接已断开）时写到接管该流的 GET 连接，没有时只留在重放缓冲中
+    std::string publish(uint64_t stream, const std::string& data, bool primaryOpen = false);
+
+    // GET 连接接管事件流。lastEventId 为空时接管流 0，已有的流 0 连接被关闭；否则接管该 ID 所属的流，
+    // 先重放缓冲中其后的事件。lastEventId 格式错误时返回 false
+    bool attach(std::shared_ptr<SseStreamWriter> writer, const std::string& lastEventId);
+
+    // 有 GET 连接接管着某个流（断开的连接在下次写失败前仍计入）
+    bool hasListeners() const;
+
+    // session 结束：关闭所有 GET 连接，之后 closed() 为 true
+    void close();
+    bool closed() const;
+
+    // 解析 "<流号>-<序号>"
+    static bool ParseEventId(const std::string& id, uint64_t& stream, uint64_t& seq);
+
+private:
+    struct Event {
+        uint64_t stream;
+        uint64_t seq;
+        std::string frame;
+    };
+
+    void write(uint64_t stream, const std::string& frame);
+
+    const size_t maxEvents_;
+    const size_t maxBytes_;
+    mutable std::mutex mutex_;
+    uint64_t nextSeq_ = 1;
+    uint64_t nextStream_ = 1;
+    uint64_t evictedSeq_ = 0;  // 已被丢弃的最大序号
+    std::deque<Event> events_;
+    size_t bytes_ = 0;
+    std::map<uint64_t, std::shared_ptr<SseStreamWriter>> writers_;  // 流号 → 接管它的 GET 连接
+    bool closed_ = false;
+};
+
+#endif // CLAWDESK_MCP_EVENT_LOG_H
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_MCP_SESSION_STORE_H
+#define CLAWDESK_MCP_SESSION_STORE_H
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "mcp/event_log.h"
+
+/**
+ * Streamable HTTP session 存储
+ *
+ * 每个 POST /mcp 都要按 MCP-Session-Id 查找 session：按 ID 的哈希分片，查找只取分片的读锁，
+ * 最近使用时间用原子变量更新，不同 session 的请求之间没有锁竞争。查找返回持有 session 的
+ * 句柄，session 被移除后句柄仍然有效。
+ *
+ * 内存有上限：
+ * - 空闲超过 idleTimeoutMs（有 GET 事件流的除外）或创建超过 ttlMs 的 session 视为过期，
+ *   查找时移除，创建 session 时顺带清理所在分片；
+ * - 总数上限按分片均分，分片满时淘汰其中最久未使用的 session。
+ * 被移除的 session 关闭其事件日志（GET 事件流随之结束），客户端之后的请求收到 404，需要重新 initialize。
+ */
+
+// 默认上限（RunHttpServer 按配置调用 configure）
+static const size_t   kMcpMaxSessions          = 1024;
+static const uint64_t kMcpSessionIdleTimeoutMs = 30ULL * 60 * 1000;
+static const uint64_t kMcpSessionTtlMs         = 24ULL * 60 * 60 * 1000;
+
+struct McpSession {
+    std::string sessionId;
+    std::string protocolVersion;
+    std::time_t createdAt = 0;
+    uint64_t    createdMs = 0;                 // MonotonicMillis
+    std::atomic<uint64_t> lastUsedMs{0};       // 最近一次查找（MonotonicMillis）
+    std::atomic_bool initialized{false};       // notifications/initialized 已收到
+    std::shared_ptr<McpEventLog> events;       // 发给客户端的 SSE 事件（GET 流、POST 的 SSE 响应），可续传
+};
+
+typedef std::shared_ptr<McpSession> McpSessionHandle;
+
+// 全局 session 存储（线程安全）
+class McpSessionStore {
+public:
+    struct Limits {
+        size_t   maxSessions   = kMcpMaxSessions;
+        uint64_t idleTimeoutMs = kMcpSessionIdleTimeoutMs;
+        uint64_t ttlMs         = kMcpSessionTtlMs;  // 0 表示不限
+    };
+
+    struct Stats {
+        size_t   sessions = 0;
+        uint64_t created = 0;
+        uint64_t expired = 0;   // 空闲或超过存活时间而移除
+        uint64_t evicted = 0;   // 分片满时按 LRU 淘汰
+    };
+
+    static McpSessionStore& getInstance();
+
+    // 设置上限；已有的 session 按新上限在之后的查找 / 创建中处理
+    void configure(const Limits& limits);
+
+    // 创建新 session，返回 sessionId
+    std::string createSession(const std::string& protocolVersion);
+
+    // 查找 session 并刷新其最近使用时间；不存在或已过期返回 nullptr
+    McpSessionHandle findSession(const std::string& sessionId);
+
+    // session 的事件日志，不存在返回 nullptr（同样刷新最近使用时间）
+    std::shared_ptr<McpEventLog> eventLog(const std::string& sessionId);
+
+    // 标记 session 为 initialized
+    bool markInitialized(const std::string& sessionId);
+
+    // 移除 session（关闭其 GET 事件流）
+    void removeSession(const std::string& sessionId);
+
+    // 移除所有 session（测试和退出时使用）
+    void clear();
+
+    Stats stats() const;
+
+private:
+    McpSessionStore() = default;
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, McpSessionHandle> sessions;
+    };
+    static const size_t kShards = 16;
+
+    Shard& shard(const std::string& sessionId);
+    bool isExpired(const McpSession& session, uint64_t now) const;
+    // 移除 shard 中已过期的 session（调用方持有写锁），事件日志放入 closing 由调用方在锁外关闭
+    void sweepLocked(Shard& shard, uint64_t now, std::vector<std::shared_ptr<McpEventLog>>& closing);
+
+    Shard shards_[kShards];
+    std::atomic<size_t>   maxPerShard_{(kMcpMaxSessions + kShards - 1) / kShards};
+    std::atomic<uint64_t> idleTimeoutMs_{kMcpSessionIdleTimeoutMs};
+    std::atomic<uint64_t> ttlMs_{kMcpSessionTtlMs};
+    std::atomic<size_t>   size_{0};
+    std::atomic<uint64_t> created_{0};
+    std::atomic<uint64_t> expired_{0};
+    std::atomic<uint64_t> evicted_{0};
+};
+
+#endif // CLAWDESK_MCP_SESSION_STORE_H
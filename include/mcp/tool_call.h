@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_MCP_TOOL_CALL_H
+#define CLAWDESK_MCP_TOOL_CALL_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "support/cancellation.h"
+#include "support/worker_pool.h"
+
+/**
+ * 异步工具调用
+ *
+ * 异步工具的 handler 收到参数和一个 ToolCallContext 后立即返回，之后在任意线程中通过
+ * context 上报进度（客户端带 progressToken 时转为 notifications/progress）、检查调用是否
+ * 已取消，并在完成时调用 complete / fail。context 的最后一个引用释放时仍未完成视为内部错误。
+ *
+ * 客户端断开或发送 notifications/cancelled 时调用被取消：cancellation() 返回的令牌可以传给
+ * FileService / CommandService / BrowserService，让搜索、子进程和 CDP 请求尽快停止。
+ *
+ * 同步 handler 执行期间（CallMcpTool 直接执行，或经 RunOnToolPool 在工具线程池中执行）可以用
+ * ReportToolProgress / IsToolCallCancelled / CurrentCancellationToken 访问当前调用的 context。
+ */
+
+class ToolCallContext {
+public:
+    virtual ~ToolCallContext() = default;
+    // 上报进度（total <= 0 表示总量未知）；客户端未提供 progressToken 或调用已完成时忽略。
+    // progress 应单调递增
+    virtual void reportProgress(double progress, double total = 0, const std::string& message = "") = 0;
+    // 本次调用的取消令牌：客户端已断开或请求已取消时取消
+    virtual CancellationToken cancellation() const = 0;
+    // 已取消：工具应尽快结束
+    bool cancelled() const { return cancellation().cancelled(); }
+    // 完成调用（只有第一次 complete / fail 生效）
+    virtual void complete(nlohmann::json result) = 0;
+    virtual void fail(const std::string& message) = 0;
+};
+
+typedef std::function<void(const nlohmann::json& args, std::shared_ptr<ToolCallContext> context)> AsyncToolHandler;
+
+// 设置工具线程池（RunHttpServer 启动时设置，退出前置空）
+void SetMcpToolPool(WorkerPool* pool);
+
+// 把同步 handler 包装为异步 handler：提交到工具线程池执行；池未设置或已满时在调用线程中执行
+AsyncToolHandler RunOnToolPool(std::function<nlohmann::json(const nlohmann::json&)> handler);
+
+// 在调用线程中执行同步 handler（设置 ToolCallScope），结果 / 异常交给 context
+void RunSyncToolHandler(const std::function<nlohmann::json(const nlohmann::json&)>& handler,
+                        const nlohmann::json& args, const std::shared_ptr<ToolCallContext>& context);
+
+// 当前线程正在执行的调用（同步 handler 执行期间有效）
+class ToolCallScope {
+public:
+    explicit ToolCallScope(ToolCallContext* context);
+    ~ToolCallScope();
+
+    ToolCallScope(const ToolCallScope&) = delete;
+    ToolCallScope& operator=(const ToolCallScope&) = delete;
+
+private:
+    ToolCallContext* previous_;
+};
+
+// 同步 handler 中上报进度 / 检查取消 / 取得取消令牌；不在工具调用中时为空操作 / 返回 false /
+// 返回不会取消的令牌
+void ReportToolProgress(double progress, double total = 0, const std::string& message = "");
+bool IsToolCallCancelled();
+CancellationToken CurrentCancellationToken();
+
+#endif // CLAWDESK_MCP_TOOL_CALL_H
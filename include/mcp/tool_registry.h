@@ -19,12 +19,15 @@
 #ifndef CLAWDESK_TOOL_REGISTRY_H
 #define CLAWDESK_TOOL_REGISTRY_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <functional>
 #include <nlohmann/json.hpp>
+#include "mcp/tool_call.h"
 #include "support/audit_logger.h"
 
 struct ToolDefinition {
@@ -40,6 +43,20 @@ struct ToolMetadata {
     bool requiresConfirmation;
     nlohmann::json inputSchema;
     std::function<nlohmann::json(const nlohmann::json&)> handler;
+    // 可选：异步执行（进度上报、取消、稍后完成）。设置后带进度或流式响应的调用优先使用它
+    AsyncToolHandler asyncHandler = nullptr;
+};
+
+// 已注册工具的只读句柄：重新注册同名工具只替换表项，已取得的句柄在调用期间保持有效
+typedef std::shared_ptr<const ToolMetadata> ToolHandle;
+
+// 预序列化的 tools/list result（{"tools":[...]}）。注册表变化后首次读取时重建，之后所有
+// 请求共享同一份字节；etag 为内容哈希（带引号），进程重启后内容不变则不变
+struct ToolsListSnapshot {
+    uint64_t generation = 0;
+    size_t toolCount = 0;
+    std::shared_ptr<const std::string> json;
+    std::string etag;
 };
 
 class ToolRegistry {
@@ -47,13 +64,22 @@ public:
     static ToolRegistry& getInstance();
 
     void registerTool(const std::string& name, const ToolMetadata& metadata);
+    // 查找工具，不存在时返回空句柄（只加一次锁，不拷贝元数据）
+    ToolHandle findTool(const std::string& name) const;
     ToolMetadata getTool(const std::string& name) const;
     std::vector<ToolDefinition> getAllTools() const;
     bool hasTool(const std::string& name) const;
 
+    // 每次 registerTool 加一
+    uint64_t generation() const;
+    // 当前版本的 tools/list（未变化时只增加一次引用计数）
+    std::shared_ptr<const ToolsListSnapshot> getToolsList() const;
+
 private:
     ToolRegistry() = default;
-    std::map<std::string, ToolMetadata> tools_;
+    std::map<std::string, ToolHandle> tools_;
+    uint64_t generation_ = 0;
+    mutable std::shared_ptr<const ToolsListSnapshot> toolsList_;  // 按需重建的缓存
     mutable std::mutex registryMutex_;
 };
 
@@ -19,36 +19,64 @@
 #ifndef CLAWDESK_MCP_SSE_H
 #define CLAWDESK_MCP_SSE_H
 
-#include <winsock2.h>
-#include <windows.h>
+#include <cstdint>
 #include <string>
 #include <map>
 #include <mutex>
 #include <memory>
 #include <atomic>
+#include "http/http_request.h"
+#include "http/http_response.h"
+
+// ── SSE 流写端 ────────────────────────────────────────────
+// 由 HTTP 服务器的连接对象实现：write 只把数据排入连接的发送队列，
+// 实际写出由 reactor 线程以非阻塞方式完成，调用方不会被慢客户端阻塞。
+class SseStreamWriter {
+public:
+    virtual ~SseStreamWriter() = default;
+    // 排队发送原始字节；连接已关闭时返回 false
+    virtual bool write(const std::string& data) = 0;
+    // 发送响应头；此后的 write 按 contentEncoding() 编码
+    virtual bool writeHead(const std::string& head) { return write(head); }
+    // 事件流的 Content-Encoding（如 "gzip"），不压缩时为 nullptr
+    virtual const char* contentEncoding() const { return nullptr; }
+    // 关闭底层连接（异步）
+    virtual void close() = 0;
+};
 
 // ── SSE Session ────────────────────────────────────────────
 struct SseSession {
     std::string sessionId;
-    SOCKET      socket;
-    std::mutex  writeMutex;      // 保护 socket 写操作
+    std::shared_ptr<SseStreamWriter> writer;
     std::atomic_bool alive;      // SSE 连接是否存活（跨线程读写）
     // MCP 协议状态
     std::string protocolVersion;
-    bool        initialized;     // notifications/initialized 已收到
-    DWORD       createdAt;       // GetTickCount() 创建时间
+    std::atomic_bool initialized;  // notifications/initialized 已收到（batch 元素可能并发写）
+    uint64_t    createdAt;       // MonotonicMillis() 创建时间
 
-    SseSession() : socket(INVALID_SOCKET), alive(false), initialized(false), createdAt(0) {}
+    SseSession() : alive(false), initialized(false), createdAt(0) {}
 };
 
+// 默认上限（RunHttpServer 按配置调用 configure）
+static const size_t   kSseMaxSessions   = 256;
+static const uint64_t kSseSessionTtlMs  = 3600000;  // 1 小时
+
 // SSE Session 全局存储（线程安全）
+//
+// 事件流连接由 HTTP 服务器的 reactor 线程驱动（非阻塞写、定时心跳），不占用线程，
+// 同时打开的 session 数只受 configure 的上限约束。每个事件流在 sessionTtlMs 到期时由
+// reactor 定时器断开。
 class SseSessionStore {
 public:
     static SseSessionStore& getInstance();
 
-    // 创建 session，返回 shared_ptr；超过上限或 TTL 淘汰时返回 nullptr
-    // socket 生命周期由 store 统一管理（send/TTL/shutdown 均会 close）
-    std::shared_ptr<SseSession> createSession(SOCKET socket);
+    // 设置 session 上限和最长存活时间（对之后创建的 session 生效）
+    void configure(size_t maxSessions, uint64_t ttlMs);
+    uint64_t sessionTtlMs() const { return ttlMs_.load(); }
+
+    // 创建 session，返回 shared_ptr；超过上限时返回 nullptr
+    // TTL 淘汰与 shutdown 会通过 writer 关闭底层连接
+    std::shared_ptr<SseSession> createSession(std::shared_ptr<SseStreamWriter> writer);
 
     // 查找 session
     std::shared_ptr<SseSession> findSession(const std::string& sessionId);
@@ -56,7 +84,7 @@ public:
     // 移除 session
     void removeSession(const std::string& sessionId);
 
-    // 关闭所有 session（退出时调用，关闭 socket 让线程尽快退出）
+    // 关闭所有 session（退出时调用）
     void shutdownAllSessions();
 
     // 当前活跃 session 数量
@@ -71,21 +99,28 @@ private:
     SseSessionStore() = default;
     mutable std::mutex mutex_;
     std::map<std::string, std::shared_ptr<SseSession>> sessions_;
+    std::atomic<size_t>   maxSessions_{kSseMaxSessions};
+    std::atomic<uint64_t> ttlMs_{kSseSessionTtlMs};
 };
 
-// ── SSE 连接线程参数 ──────────────────────────────────────
-struct SseThreadParams {
-    SOCKET      socket;
-    std::string request;  // 原始 HTTP 请求（用于授权检查）
-};
+// 事件流的响应头（200、text/event-stream，按 writer 的编码带 Content-Encoding）
+std::string MakeSseResponseHead(const SseStreamWriter& writer);
+
+// 处理 GET /sse：校验授权、创建 session，并通过 writer 写出响应头和 endpoint 事件。
+// 成功返回 true 并填写 sessionId（之后连接进入事件流模式；写出失败时 writer 已关闭连接）；
+// 失败返回 false，error 为应发给客户端的 HTTP 错误响应。
+bool OpenSseStream(const HttpRequest& request,
+                   std::shared_ptr<SseStreamWriter> writer,
+                   std::string& sessionId,
+                   HttpResponse& error);
 
-// SSE 连接线程入口
-DWORD WINAPI SseConnectionThread(LPVOID lpParam);
+// SSE 连接断开后清理 session（由 HTTP 服务器在连接关闭时调用）
+void CloseSseStream(const std::string& sessionId);
 
-// 处理 POST /messages 请求，返回完整 HTTP 响应
-std::string HandleSseMessage(const std::string& request);
+// 处理 POST /messages 请求
+HttpResponse HandleSseMessage(const HttpRequest& request);
 
 // 检查是否为 SSE 请求（GET /sse）
-bool IsSseRequest(const std::string& request);
+bool IsSseRequest(const HttpRequest& request);
 
 #endif // CLAWDESK_MCP_SSE_H
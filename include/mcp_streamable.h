@@ -19,44 +19,25 @@
 #ifndef CLAWDESK_MCP_STREAMABLE_H
 #define CLAWDESK_MCP_STREAMABLE_H
 
+#include <memory>
 #include <string>
-#include <map>
-#include <mutex>
-#include <ctime>
-
-// ── MCP Session ────────────────────────────────────────────
-struct McpSession {
-    std::string sessionId;
-    std::string protocolVersion;
-    bool        initialized = false;   // notifications/initialized 已收到
-    std::time_t createdAt   = 0;
-};
-
-// 全局 session 存储（线程安全）
-class McpSessionStore {
-public:
-    static McpSessionStore& getInstance();
-
-    // 创建新 session，返回 sessionId
-    std::string createSession(const std::string& protocolVersion);
-
-    // 查找 session，不存在返回 nullptr
-    const McpSession* findSession(const std::string& sessionId) const;
-
-    // 标记 session 为 initialized
-    bool markInitialized(const std::string& sessionId);
-
-    // 移除 session
-    void removeSession(const std::string& sessionId);
-
-private:
-    McpSessionStore() = default;
-    mutable std::mutex mutex_;
-    std::map<std::string, McpSession> sessions_;
-};
+#include "http/http_request.h"
+#include "http/http_response.h"
+#include "mcp/session_store.h"
 
 // ── Streamable HTTP handler ────────────────────────────────
-// 处理 POST /mcp 请求，返回完整 HTTP 响应字符串
-std::string HandleMcpStreamableHttp(const std::string& request);
+// 处理 POST /mcp、DELETE /mcp（结束 session）；其余方法返回 405
+HttpResponse HandleMcpStreamableHttp(const HttpRequest& request);
+
+// 是否为打开事件流的 GET /mcp（Accept 含 text/event-stream）
+bool IsMcpEventStreamRequest(const HttpRequest& request);
+
+// 处理 GET /mcp：校验 Origin 和 session，写出 SSE 响应头后把 writer 交给 session 的事件日志
+// （带 Last-Event-ID 时先重放断开期间的事件）。成功返回 true 并填写 sessionId；失败返回 false，
+// error 为应发给客户端的 HTTP 错误响应。之后连接上只有事件流，断开时无需通知
+bool OpenMcpEventStream(const HttpRequest& request,
+                        std::shared_ptr<SseStreamWriter> writer,
+                        std::string& sessionId,
+                        HttpResponse& error);
 
 #endif // CLAWDESK_MCP_STREAMABLE_H
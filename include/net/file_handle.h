@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_NET_FILE_HANDLE_H
+#define CLAWDESK_NET_FILE_HANDLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Windows 上是 HANDLE；这里不包含 <windows.h>，避免抢在 <winsock2.h> 之前被引入
+#ifdef _WIN32
+using file_t = void*;
+#else
+using file_t = int;
+#endif
+
+/**
+ * FileHandle - 只读打开的普通文件
+ *
+ * 供 IoBackend::startSendFile（sendfile / TransmitFile）使用：打开时记录大小和
+ * 修改时间，之后生成的 ETag 与实际发送的内容来自同一个打开的文件。
+ * 通过 shared_ptr 持有，写出完成前由连接保持引用。
+ */
+class FileHandle {
+public:
+    // 打开失败或不是普通文件时返回 nullptr
+    static std::shared_ptr<FileHandle> open(const std::string& path);
+
+    ~FileHandle();
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+    file_t native() const { return file_; }
+    const std::string& path() const { return path_; }
+    uint64_t size() const { return size_; }
+    int64_t modifiedTime() const { return modifiedTime_; }  // Unix 时间（秒）
+
+    // 从 offset 处同步读取最多 size 字节（不移动文件指针）。返回读到的字节数，出错返回 -1。
+    // 内核直接发送不可用时（如 TLS 连接需要先加密）使用
+    long long readAt(uint64_t offset, void* buf, size_t size) const;
+
+private:
+    FileHandle(file_t file, std::string path, uint64_t size, int64_t modifiedTime)
+        : file_(file), path_(std::move(path)), size_(size), modifiedTime_(modifiedTime) {}
+
+    file_t file_;
+    std::string path_;
+    uint64_t size_;
+    int64_t modifiedTime_;
+};
+
+#endif // CLAWDESK_NET_FILE_HANDLE_H
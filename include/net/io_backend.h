@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_NET_IO_BACKEND_H
+#define CLAWDESK_NET_IO_BACKEND_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "net/file_handle.h"
+#include "net/socket_compat.h"
+
+/**
+ * I/O 后端抽象
+ *
+ * 对上层统一为"发起操作 → 等待完成"的模型：
+ *   - Windows: IOCP 原生完成端口（AcceptEx / WSARecv / WSASend / TransmitFile）
+ *   - Linux:   epoll 就绪通知，由后端在就绪时执行非阻塞读写并产出完成结果
+ *
+ * 除 wakeup() 外，所有方法只能在调用 wait() 的同一线程（reactor 线程）中使用。
+ */
+
+enum class IoOp {
+    Accept,   // 监听 socket 接受了新连接
+    Recv,     // 一次读完成
+    Send,     // 一次写全部完成
+    Wakeup    // wakeup() 触发
+};
+
+// 一个 socket 在后端中的注册，由后端创建与回收。
+// 上层只读这些字段；closed 之后不会再产生任何结果。
+struct IoChannel {
+    socket_t socket = kInvalidSocket;
+    void*    context = nullptr;   // 上层对象（通常是 IoHandler*）
+    bool     closed = false;
+
+    virtual ~IoChannel() = default;
+};
+
+// 待写出的缓冲区：共享只读，后端持有引用直到写完，调用方无需拷贝
+using IoBuffer = std::shared_ptr<const std::string>;
+
+// gather 写的进度（供后端实现使用）
+struct IoSendCursor {
+    std::vector<IoBuffer> buffers;
+    size_t index = 0;      // 当前缓冲区
+    size_t offset = 0;     // 当前缓冲区内已写出的字节
+    size_t written = 0;    // 累计写出
+
+    void reset(std::vector<IoBuffer> bufs) {
+        buffers = std::move(bufs);
+        index = 0;
+        offset = 0;
+        written = 0;
+        skipEmpty();
+    }
+
+    bool done() const { return index >= buffers.size(); }
+
+    void advance(size_t n) {
+        written += n;
+        while (n > 0 && index < buffers.size()) {
+            size_t left = buffers[index]->size() - offset;
+            if (n < left) {
+                offset += n;
+                return;
+            }
+            n -= left;
+            ++index;
+            offset = 0;
+        }
+        skipEmpty();
+    }
+
+    void clear() {
+        buffers.clear();
+        index = offset = written = 0;
+    }
+
+private:
+    void skipEmpty() {
+        while (index < buffers.size() && (!buffers[index] || buffers[index]->size() == offset)) {
+            ++index;
+            offset = 0;
+        }
+    }
+};
+
+struct IoResult {
+    IoOp        op = IoOp::Wakeup;
+    IoChannel*  channel = nullptr;      // Wakeup 时为 nullptr
+    int         error = 0;              // 0 表示成功，否则为平台错误码
+    const char* data = nullptr;         // Recv: 数据（后端所有，下一次 startRecv/close 前有效）
+    size_t      bytes = 0;              // Recv: 0 表示对端关闭；Send: 已写出字节数
+    socket_t    accepted = kInvalidSocket;  // Accept: 新连接（所有权交给上层）
+};
+
+class IoBackend {
+public:
+    virtual ~IoBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    // 注册监听 socket；之后持续产生 Accept 结果
+    virtual IoChannel* addListener(socket_t listener, void* context) = 0;
+
+    // 注册已连接 socket（后端负责设置非阻塞/关联完成端口）
+    virtual IoChannel* addSocket(socket_t sock, void* context) = 0;
+
+    // 发起一次读。每个 channel 同时最多一个未完成的读
+    virtual bool startRecv(IoChannel* channel) = 0;
+
+    // 发起一次 gather 写（writev / 多 WSABUF 的 WSASend），按顺序写出全部缓冲区；
+    // 完成时要么全部写出，要么 error != 0。每个 channel 同时最多一个未完成的写
+    virtual bool startSend(IoChannel* channel, std::vector<IoBuffer> buffers) = 0;
+
+    // 单块数据的便捷版本
+    bool startSend(IoChannel* channel, std::string data) {
+        std::vector<IoBuffer> buffers;
+        buffers.push_back(std::make_shared<const std::string>(std::move(data)));
+        return startSend(channel, std::move(buffers));
+    }
+
+    // 先写出 head（可以为空，通常是响应头），再把文件 [offset, offset + length) 交给内核发送
+    // （Linux: sendfile，Windows: TransmitFile），文件内容不经过用户态缓冲区。
+    // file 由调用方保证在完成前有效；完成语义与 startSend 相同，bytes 含 head
+    virtual bool startSendFile(IoChannel* channel, std::vector<IoBuffer> head,
+                               file_t file, uint64_t offset, uint64_t length) = 0;
+
+    // 关闭 socket 并注销。调用后该 channel 不再产生结果，内存由后端在安全时回收
+    virtual void close(IoChannel* channel) = 0;
+
+    // 等待完成结果，返回写入 out 的数量；timeoutMs < 0 表示无限等待
+    virtual int wait(IoResult* out, int maxResults, int timeoutMs) = 0;
+
+    // 线程安全：唤醒 wait()，产生一个 Wakeup 结果
+    virtual void wakeup() = 0;
+};
+
+// 按平台创建后端（Windows: IOCP，Linux: epoll）；失败返回 nullptr
+std::unique_ptr<IoBackend> CreateIoBackend();
+
+#ifdef _WIN32
+std::unique_ptr<IoBackend> CreateIocpBackend();
+#elif defined(__linux__)
+std::unique_ptr<IoBackend> CreateEpollBackend();
+#endif
+
+#endif // CLAWDESK_NET_IO_BACKEND_H
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_NET_LISTEN_SOCKET_H
+#define CLAWDESK_NET_LISTEN_SOCKET_H
+
+#include <string>
+#include <vector>
+#include "net/socket_compat.h"
+
+// 一个监听地址
+struct ListenEndpoint {
+    std::string host;        // 规范化后的文本地址，如 "0.0.0.0"、"127.0.0.1"、"::"、"::1"
+    int family = AF_INET;    // AF_INET / AF_INET6
+    bool dualStack = false;  // IPv6 任意地址同时接受 IPv4 连接（IPV6_V6ONLY=0）
+
+    // 日志用：IPv6 带方括号，如 "[::1]:35182"
+    std::string describe(int port) const;
+};
+
+/**
+ * 解析 server.listen_address：逗号分隔的 IPv4 / IPv6 字面地址，IPv6 可带方括号。
+ *   "0.0.0.0"                 所有 IPv4 接口
+ *   "::" 或 "*"               双栈：所有 IPv6 和 IPv4 接口
+ *   "127.0.0.1,::1"           仅本机（IPv4 + IPv6 回环）
+ *   "127.0.0.1,192.168.1.10"  回环和指定网卡分别监听
+ * 重复地址去重；有双栈任意地址时 "0.0.0.0" 已被覆盖，不再单独监听。
+ * 无法解析的条目放入 invalid；没有任何有效地址时返回 "0.0.0.0"。
+ */
+std::vector<ListenEndpoint> ParseListenAddresses(const std::string& spec, std::vector<std::string>* invalid = nullptr);
+
+struct ListenOptions {
+    // SO_REUSEPORT：多个 socket 绑定同一地址端口，由内核把新连接分摊到各 socket。
+    // 仅在 SupportsReusePort() 为 true 的平台生效
+    bool reusePort = false;
+    int backlog = SOMAXCONN;
+};
+
+// 当前平台是否支持按连接负载均衡的 SO_REUSEPORT（Linux 3.9+）。
+// Windows 没有对应语义：监听 socket 始终使用 SO_EXCLUSIVEADDRUSE 独占端口
+bool SupportsReusePort();
+
+// 创建、绑定并开始监听；失败返回 kInvalidSocket，error 为平台错误码
+socket_t OpenListenSocket(const ListenEndpoint& endpoint, int port, const ListenOptions& options, int& error);
+
+// 已绑定 socket 的本地端口；失败返回 -1
+int GetLocalPort(socket_t s);
+
+#endif // CLAWDESK_NET_LISTEN_SOCKET_H
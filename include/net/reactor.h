@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_NET_REACTOR_H
+#define CLAWDESK_NET_REACTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "net/io_backend.h"
+#include "net/timer_queue.h"
+
+// 注册到 reactor 的对象（监听器、连接）实现此接口接收完成结果
+class IoHandler {
+public:
+    virtual ~IoHandler() = default;
+    virtual void onIoComplete(const IoResult& result) = 0;
+};
+
+/**
+ * Reactor - 单线程事件循环
+ *
+ * 一个线程驱动一个 IoBackend：所有 socket 的读写完成、跨线程投递的任务
+ * 定时器和周期 tick 都在 run() 所在线程里串行执行，因此连接状态无需加锁。
+ * 其他线程（worker）通过 post() 把结果交回 reactor 线程。
+ */
+class Reactor {
+public:
+    explicit Reactor(std::unique_ptr<IoBackend> backend);
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    IoBackend& backend() { return *backend_; }
+
+    // 线程安全：把任务投递到 reactor 线程执行（run() 结束后投递的任务被丢弃）
+    void post(std::function<void()> task);
+
+    using TimerId = TimerQueue::TimerId;
+
+    // 仅 reactor 线程：delayMs 毫秒后在 reactor 线程回调一次，返回可取消的 id
+    TimerId addTimer(int delayMs, std::function<void()> callback);
+    // 仅 reactor 线程：取消尚未触发的定时器（id 为 0 或已触发时无操作）
+    void cancelTimer(TimerId id);
+
+    // 周期回调，在 reactor 线程执行；须在 run() 之前设置
+    void setTick(int intervalMs, std::function<void()> tick);
+
+    // 运行事件循环，直到 stop()
+    void run();
+
+    // 线程安全：请求 run() 返回
+    void stop();
+
+    bool inReactorThread() const { return std::this_thread::get_id() == threadId_; }
+
+private:
+    void runPosted();
+
+    std::unique_ptr<IoBackend> backend_;
+    std::mutex postMutex_;
+    std::vector<std::function<void()>> posted_;
+    std::atomic<bool> wakePending_{false};
+    std::atomic<bool> stopping_{false};
+    std::thread::id threadId_;
+    TimerQueue timers_;
+
+    int tickIntervalMs_ = 0;
+    std::function<void()> tick_;
+};
+
+#endif // CLAWDESK_NET_REACTOR_H
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_NET_SOCKET_COMPAT_H
+#define CLAWDESK_NET_SOCKET_COMPAT_H
+
+// Winsock 与 BSD socket 之间的最小差异层，供 net/ 下的平台无关代码使用
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <csignal>
+#include <unistd.h>
+#endif
+
+#include <string>
+
+#ifdef _WIN32
+using socket_t = SOCKET;
+static const socket_t kInvalidSocket = INVALID_SOCKET;
+#else
+using socket_t = int;
+static const socket_t kInvalidSocket = -1;
+#endif
+
+inline void CloseSocket(socket_t s) {
+#ifdef _WIN32
+    closesocket(s);
+#else
+    ::close(s);
+#endif
+}
+
+inline int LastSocketError() {
+#ifdef _WIN32
+    return WSAGetLastError();
+#else
+    return errno;
+#endif
+}
+
+// 非阻塞操作暂时无法完成（稍后重试）
+inline bool IsWouldBlock(int err) {
+#ifdef _WIN32
+    return err == WSAEWOULDBLOCK;
+#else
+    return err == EAGAIN || err == EWOULDBLOCK;
+#endif
+}
+
+inline bool SetNonBlocking(socket_t s) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(s, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// 进程内 socket 运行时的作用域：Windows 上初始化 / 释放 Winsock（WSAStartup 按引用计数，可嵌套）；
+// POSIX 上忽略 SIGPIPE，向已关闭的连接写入只返回 EPIPE 而不终止进程
+class SocketRuntime {
+public:
+    SocketRuntime() {
+#ifdef _WIN32
+        WSADATA wsaData;
+        ok_ = WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+#else
+        std::signal(SIGPIPE, SIG_IGN);
+        ok_ = true;
+#endif
+    }
+    ~SocketRuntime() {
+#ifdef _WIN32
+        if (ok_) WSACleanup();
+#endif
+    }
+    SocketRuntime(const SocketRuntime&) = delete;
+    SocketRuntime& operator=(const SocketRuntime&) = delete;
+
+    bool ok() const { return ok_; }
+
+private:
+    bool ok_ = false;
+};
+
+// 对端地址（IPv4/IPv6 文本形式），失败返回空串。
+// 双栈监听收到的 IPv4 连接（::ffff:a.b.c.d）按 IPv4 返回，限流和日志不区分来源 socket
+inline std::string GetPeerAddress(socket_t s) {
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (getpeername(s, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        return std::string();
+    }
+    char buf[INET6_ADDRSTRLEN] = {};
+    if (addr.ss_family == AF_INET) {
+        inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in*>(&addr)->sin_addr, buf, sizeof(buf));
+    } else if (addr.ss_family == AF_INET6) {
+        const in6_addr& v6 = reinterpret_cast<sockaddr_in6*>(&addr)->sin6_addr;
+        if (IN6_IS_ADDR_V4MAPPED(&v6)) {
+            inet_ntop(AF_INET, reinterpret_cast<const unsigned char*>(&v6) + 12, buf, sizeof(buf));
+        } else {
+            inet_ntop(AF_INET6, &v6, buf, sizeof(buf));
+        }
+    }
+    return buf;
+}
+
+#endif // CLAWDESK_NET_SOCKET_COMPAT_H
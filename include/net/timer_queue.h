@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_NET_TIMER_QUEUE_H
+#define CLAWDESK_NET_TIMER_QUEUE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * TimerQueue - reactor 线程的定时器集合
+ *
+ * 最小堆按到期时间排序，回调放在按 id 索引的表里；取消只删表项，堆中的
+ * 旧条目到达堆顶时丢弃（失效条目过多时整体重建）。连接的各类截止时间
+ * （读 header、读 body、空闲、写出）都挂在这里，不再依赖阻塞 socket 超时，
+ * 也不用每个 tick 扫描全部连接。
+ *
+ * 非线程安全：只在 reactor 线程使用（见 Reactor::addTimer）。
+ */
+class TimerQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;  // 0 表示无效
+
+    // 添加定时器，到期后回调一次
+    TimerId schedule(Clock::time_point when, std::function<void()> callback);
+
+    // 取消尚未触发的定时器；已触发或不存在时返回 false
+    bool cancel(TimerId id);
+
+    // 依次执行所有已到期的定时器（回调中可以添加、取消定时器），返回执行个数
+    size_t runExpired(Clock::time_point now);
+
+    // 距最近一个定时器到期的毫秒数（向上取整）；没有定时器时返回 -1
+    int msUntilNext(Clock::time_point now);
+
+    size_t size() const { return callbacks_.size(); }
+    bool empty() const { return callbacks_.empty(); }
+
+private:
+    struct Entry {
+        Clock::time_point when;
+        TimerId id;
+    };
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.when != b.when ? a.when > b.when : a.id > b.id;
+        }
+    };
+
+    void dropCancelledTop();
+    void compact();
+
+    std::vector<Entry> heap_;
+    std::unordered_map<TimerId, std::function<void()>> callbacks_;
+    TimerId nextId_ = 1;
+};
+
+#endif // CLAWDESK_NET_TIMER_QUEUE_H
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_NET_TLS_CONTEXT_H
+#define CLAWDESK_NET_TLS_CONTEXT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// OpenSSL 类型前置声明，调用方不需要包含 OpenSSL 头文件
+typedef struct ssl_ctx_st SSL_CTX;
+typedef struct ssl_st SSL;
+typedef struct bio_st BIO;
+
+class TlsSession;
+
+struct TlsOptions {
+    std::string certFile;            // PEM 证书（可带中间证书链）
+    std::string keyFile;             // PEM 私钥
+    int sessionTimeoutSeconds = 3600;  // 会话缓存与 session ticket 的有效期
+    long sessionCacheSize = 20480;   // 服务端会话缓存条目上限（TLS 1.2 session id 复用）
+};
+
+/**
+ * TlsContext - 服务端 TLS 配置（证书、会话缓存、session ticket 密钥）
+ *
+ * 所有 accept 分片共享一个实例：会话缓存和 ticket 密钥在分片之间通用，
+ * 客户端重连落到任何一个 reactor 线程都能恢复会话，只需一次简化握手。
+ * 同时汇总握手次数与耗时，供 /health 展示。线程安全。
+ *
+ * 未启用 OpenSSL 构建（CLAWDESK_OPENSSL_ENABLED 未定义）时 create() 总是失败。
+ */
+class TlsContext : public std::enable_shared_from_this<TlsContext> {
+public:
+    struct Stats {
+        uint64_t fullHandshakes = 0;      // 完整握手
+        uint64_t resumedHandshakes = 0;   // 会话恢复（session id 或 ticket）
+        uint64_t failedHandshakes = 0;
+        uint64_t fullHandshakeUs = 0;     // 完整握手累计耗时（首个 ClientHello 到握手完成）
+        uint64_t resumedHandshakeUs = 0;  // 恢复握手累计耗时
+        uint64_t maxHandshakeUs = 0;
+        uint64_t requests = 0;            // TLS 连接上处理的请求数（与握手次数之比即 keep-alive 复用程度）
+    };
+
+    // 加载证书和私钥；失败返回 nullptr，error 为原因
+    static std::shared_ptr<TlsContext> create(const TlsOptions& options, std::string& error);
+
+    // 当前构建是否支持 TLS
+    static bool available();
+
+    ~TlsContext();
+    TlsContext(const TlsContext&) = delete;
+    TlsContext& operator=(const TlsContext&) = delete;
+
+    // 为新接受的连接创建会话；失败返回 nullptr
+    std::unique_ptr<TlsSession> newSession();
+
+    Stats stats() const;
+
+private:
+    friend class TlsSession;
+
+    explicit TlsContext(SSL_CTX* ctx) : ctx_(ctx) {}
+
+    void recordHandshake(bool resumed, uint64_t micros);
+    void recordFailure() { failed_.fetch_add(1, std::memory_order_relaxed); }
+    void recordRequest() { requests_.fetch_add(1, std::memory_order_relaxed); }
+
+    SSL_CTX* ctx_;
+    std::atomic<uint64_t> full_{0};
+    std::atomic<uint64_t> resumed_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> fullUs_{0};
+    std::atomic<uint64_t> resumedUs_{0};
+    std::atomic<uint64_t> maxUs_{0};
+    std::atomic<uint64_t> requests_{0};
+};
+
+/**
+ * TlsSession - 一个连接上的 TLS 状态（内存 BIO，不直接读写 socket）
+ *
+ * 连接照常通过 IoBackend 收发字节：收到的密文交给 decrypt() 得到明文，
+ * 待发送的明文用 encrypt() 加密，再用 takeOutput() 取出密文写出。
+ * 握手记录、session ticket、告警也都经由 takeOutput() 发送。
+ * 只能在所属连接的 reactor 线程中使用。
+ */
+class TlsSession {
+public:
+    ~TlsSession();
+    TlsSession(const TlsSession&) = delete;
+    TlsSession& operator=(const TlsSession&) = delete;
+
+    // 输入收到的密文，解出的明文追加到 plain。
+    // 返回 false 表示握手失败、协议错误或对端发来 close_notify，应断开连接
+    bool decrypt(const char* data, size_t size, std::string& plain);
+
+    // 加密一段明文（握手完成后才能调用）；失败返回 false
+    bool encrypt(const char* data, size_t size);
+
+    // 取出待发送的密文
+    std::string takeOutput();
+    bool hasOutput() const;
+
+    bool handshakeDone() const { return handshakeDone_; }
+    bool resumed() const { return resumed_; }
+
+    // 连接上开始处理一个请求（计入 Stats::requests）
+    void countRequest() { context_->recordRequest(); }
+
+private:
+    friend class TlsContext;
+
+    TlsSession(std::shared_ptr<TlsContext> context, SSL* ssl, BIO* in, BIO* out)
+        : context_(std::move(context)), ssl_(ssl), in_(in), out_(out) {}
+
+    bool finishHandshake();
+
+    std::shared_ptr<TlsContext> context_;
+    SSL* ssl_;
+    BIO* in_;    // 收到的密文（SSL 从这里读）
+    BIO* out_;   // 待发送的密文（SSL 写到这里）
+    bool handshakeDone_ = false;
+    bool resumed_ = false;
+    bool failed_ = false;
+    int64_t handshakeStartUs_ = 0;
+};
+
+#endif // CLAWDESK_NET_TLS_CONTEXT_H
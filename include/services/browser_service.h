@@ -25,9 +25,14 @@
 #include <mutex>
 #include <cstdint>
 #include <nlohmann/json.hpp>
+#include "support/cancellation.h"
 
 // Minimal CDP (Chrome DevTools Protocol) controller for Edge/Chrome using
 // remote-debugging HTTP discovery + WinHTTP WebSocket.
+//
+// Methods that wait on the browser take an optional CancellationToken: once it is
+// cancelled, pending CDP requests are aborted and polling loops stop early, and the
+// method fails with error "Cancelled".
 class BrowserService {
 public:
     struct LaunchResult {
@@ -73,17 +78,22 @@ public:
     LaunchResult launch(const std::string& app,
                         bool headless,
                         const std::string& user_data_dir,
-                        const std::vector<std::string>& additional_args);
+                        const std::vector<std::string>& additional_args,
+                        const CancellationToken& cancel = CancellationToken());
 
     bool close(const std::string& session_id);
 
-    NewTabResult newTab(const std::string& session_id);
-    bool navigate(const std::string& session_id, const std::string& target_id, const std::string& url, std::string* outError);
+    NewTabResult newTab(const std::string& session_id,
+                        const CancellationToken& cancel = CancellationToken());
+    bool navigate(const std::string& session_id, const std::string& target_id, const std::string& url, std::string* outError,
+                  const CancellationToken& cancel = CancellationToken());
 
-    EvalResult eval(const std::string& session_id, const std::string& target_id, const std::string& expression, bool awaitPromise);
+    EvalResult eval(const std::string& session_id, const std::string& target_id, const std::string& expression, bool awaitPromise,
+                    const CancellationToken& cancel = CancellationToken());
 
     ScreenshotResult screenshotPngToFile(const std::string& session_id,
-                                         const std::string& target_id);
+                                         const std::string& target_id,
+                                         const CancellationToken& cancel = CancellationToken());
 
     // Returns a URL like:
     //   http://127.0.0.1:<port>/devtools/inspector.html?ws=127.0.0.1:<port>/devtools/page/<id>
@@ -96,7 +106,8 @@ public:
     OpenUrlResult openUrl(const std::string& url,
                           const std::string& app = "",
                           bool headless = false,
-                          const std::string& session_id = "");
+                          const std::string& session_id = "",
+                          const CancellationToken& cancel = CancellationToken());
 
 private:
     struct Session {
@@ -21,6 +21,7 @@
 
 #include <string>
 #include <vector>
+#include "support/cancellation.h"
 
 class ConfigManager;
 class PolicyGuard;
@@ -30,15 +31,18 @@ struct CommandResult {
     std::string stderrText;
     int exitCode;
     bool timedOut;
+    bool cancelled;
 };
 
 class CommandService {
 public:
     CommandService(ConfigManager* configManager, PolicyGuard* policyGuard);
 
+    // 超时或 cancel 取消时结束整个进程树（cmd.exe 及其启动的子进程），返回已读到的输出
     CommandResult executeCommand(const std::string& command,
                                  const std::vector<std::string>& args,
-                                 int timeoutMs = 30000);
+                                 int timeoutMs = 30000,
+                                 const CancellationToken& cancel = CancellationToken());
 
 private:
     bool validateCommand(const std::string& command);
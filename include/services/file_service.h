@@ -22,7 +22,9 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <memory>
 #include <windows.h>
+#include "support/cancellation.h"
 
 class ConfigManager;
 class PolicyGuard;
@@ -32,6 +34,7 @@ struct FindFilesParams {
     std::vector<std::string> exts;
     int days;
     int max;
+    CancellationToken cancel;  // 取消后停止遍历，返回已找到的结果
 };
 
 struct FileInfo {
@@ -53,6 +56,45 @@ struct SearchMatch {
     std::string text;
 };
 
+/**
+ * TextFileWriter - 流式写入文本文件
+ *
+ * 内容逐块写入同目录下的临时文件（边写边转换行尾，内存占用与文件大小无关），
+ * commit() 时再替换为目标文件；未 commit 就析构（上传中断、出错）会删除临时文件，
+ * 目标文件保持原样。由 FileService::openTextFileWriter() 创建。
+ */
+class TextFileWriter {
+public:
+    ~TextFileWriter();
+    TextFileWriter(const TextFileWriter&) = delete;
+    TextFileWriter& operator=(const TextFileWriter&) = delete;
+
+    void write(const char* data, size_t size);
+    void write(const std::string& data) { write(data.data(), data.size()); }
+
+    // 写入完成：关闭临时文件并改名为目标路径
+    void commit();
+
+    // 实际写入磁盘的字节数（行尾转换之后）
+    uint64_t bytesWritten() const { return bytesWritten_; }
+
+private:
+    friend class FileService;
+    enum class LineEndings { Keep, Lf, Crlf };
+
+    TextFileWriter(std::string path, std::string tempPath, HANDLE file, LineEndings mode, bool overwrite);
+    void writeRaw(const char* data, size_t size);
+
+    std::string path_;
+    std::string tempPath_;
+    HANDLE file_;
+    LineEndings mode_;
+    bool overwrite_;
+    bool lastWasCr_ = false;    // 上一块以 CR 结尾（CRLF 可能跨块）
+    uint64_t bytesWritten_ = 0;
+    std::string scratch_;
+};
+
 class FileService {
 public:
     FileService(ConfigManager* configManager, PolicyGuard* policyGuard);
@@ -64,6 +106,12 @@ public:
                        const std::string& content,
                        bool overwrite,
                        const std::string& lineEndings);
+    // "auto" 对 .bat/.cmd 改为 crlf（cmd.exe 对 LF 行尾的批处理解析不可靠），其余原样返回
+    static std::string resolveLineEndings(const std::string& path, const std::string& lineEndings);
+    // 流式写入：检查与 writeTextFile 相同（路径白名单、overwrite），目录按需创建
+    std::unique_ptr<TextFileWriter> openTextFileWriter(const std::string& path,
+                                                       bool overwrite,
+                                                       const std::string& lineEndings);
     std::vector<SearchMatch> searchTextInFile(const std::string& path, const std::string& query);
     std::vector<DirectoryEntry> listDirectory(const std::string& path);
 
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_CANCELLATION_H
+#define CLAWDESK_CANCELLATION_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+/**
+ * 协作式取消
+ *
+ * CancellationToken 是可复制的句柄，副本共享同一个取消状态。发起方调用 cancel()，执行方在
+ * 循环中检查 cancelled()、用 waitFor() 代替 Sleep，或用 onCancel() 注册回调中断阻塞调用。
+ * 默认构造的令牌永远不会取消，不分配内存，可作为“不可取消”的参数默认值。
+ *
+ * Create 的 probe 用于把外部状态（例如客户端已断开）并入取消：cancelled() / waitFor() 检查时
+ * probe 返回 true 即视为取消，并触发已注册的回调。
+ */
+
+struct CancellationState;
+class CancellationRegistration;
+
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    static CancellationToken Create(std::function<bool()> probe = nullptr);
+
+    // 请求取消（幂等）；在调用线程中依次执行已注册的回调
+    void cancel() const;
+    bool cancelled() const;
+    // 等待 ms 毫秒，期间被取消时提前返回 true
+    bool waitFor(int ms) const;
+
+    // 取消时执行 callback（已取消时立即执行）。回调持有取消状态的锁执行，不能再访问本令牌；
+    // 返回的注册对象析构时注销，回调正在执行时等待其结束
+    CancellationRegistration onCancel(std::function<void()> callback) const;
+
+private:
+    std::shared_ptr<CancellationState> state_;
+};
+
+class CancellationRegistration {
+public:
+    CancellationRegistration() = default;
+    ~CancellationRegistration();
+
+    CancellationRegistration(CancellationRegistration&& other) noexcept;
+    CancellationRegistration& operator=(CancellationRegistration&& other) noexcept;
+    CancellationRegistration(const CancellationRegistration&) = delete;
+    CancellationRegistration& operator=(const CancellationRegistration&) = delete;
+
+    // 提前注销；返回后回调不会再执行
+    void reset();
+
+private:
+    friend class CancellationToken;
+    std::shared_ptr<CancellationState> state_;
+    uint64_t id_ = 0;
+};
+
+#endif // CLAWDESK_CANCELLATION_H
@@ -40,7 +40,7 @@ struct ServerConfig {
     std::string auth_token;
     int server_port;                                    // 默认 35182，0 表示随机端口
     bool auto_port;                                     // 默认 true
-    std::string listen_address;                         // 监听地址："0.0.0.0" 或 "127.0.0.1"
+    std::string listen_address;                         // 监听地址，逗号分隔的 IPv4/IPv6 地址，如 "0.0.0.0"、"127.0.0.1,::1"、"::"
     std::vector<std::string> allowed_dirs;
     std::map<std::string, std::string> allowed_apps;
     std::vector<std::string> allowed_commands;
@@ -64,6 +64,34 @@ struct ServerConfig {
     std::string last_update_check;                      // 上次检查时间（ISO 8601）
     std::string skipped_version;                        // 跳过的版本号
     int command_timeout_seconds;                         // 命令执行超时（秒），默认 30
+
+    // HTTP 服务器并发
+    int http_worker_threads;                            // 请求处理线程数，0 表示按 CPU 核数自动选择
+    int http_queue_capacity;                            // accept 与 worker 之间的等待队列容量
+    int http_keep_alive_timeout_seconds;                // 空闲长连接保留时间（秒），0 表示禁用 keep-alive
+    int http_keep_alive_max_requests;                   // 单个连接最多处理的请求数
+    int http_rate_limit_per_minute;                     // 每个客户端 IP 每分钟最多请求数（keep-alive 上的请求各计一次）
+    int http_queue_timeout_ms;                          // 请求排队超过此时间不再执行，直接回 503
+    int http_fast_lane_workers;                         // 为 /health、OPTIONS、ping 保留的处理线程数
+    int http_header_timeout_ms;                         // 收齐请求头的时限（从连接建立或请求首字节算起）
+    int http_body_timeout_ms;                           // 接收请求体时最长允许多久没有数据
+    int http_min_body_rate;                             // 请求体最低上传速率（字节/秒），0 表示不检查
+    int http_accept_shards;                             // accept 分片数：每片一个 reactor 线程和 SO_REUSEPORT 监听 socket
+    bool http_compression;                              // 按 Accept-Encoding 用 gzip/deflate 压缩响应
+    int http_compression_min_bytes;                     // 小于此大小的响应不压缩
+    int http_compression_level;                         // 压缩级别 1（最快）~ 9（最小）
+    int http_tls_port;                                  // HTTPS 监听端口，0 表示不启用
+    std::string http_tls_cert_file;                     // PEM 证书链（相对路径按配置文件目录解析）
+    std::string http_tls_key_file;                      // PEM 私钥
+    int http_tls_session_timeout_seconds;               // TLS 会话恢复（会话缓存 / session ticket）有效期
+    int http_drain_timeout_ms;                          // 退出时等待进行中的请求完成的时限，到期后强制断开
+    int http_batch_workers;                             // JSON-RPC batch 并发执行线程数，0 表示在请求线程中顺序执行
+    int http_tool_workers;                              // 异步 tools/call 执行线程数，0 表示在请求线程中执行
+    int mcp_max_sessions;                               // Streamable HTTP session 上限，满时淘汰最久未使用的
+    int mcp_session_idle_timeout_seconds;               // session 空闲超过此时长后失效（有 GET 事件流时除外）
+    int mcp_session_ttl_seconds;                        // session 创建后的最长存活时间，0 表示不限
+    int sse_max_sessions;                               // 同时打开的 GET /sse 事件流上限
+    int sse_session_ttl_seconds;                        // GET /sse 事件流的最长存活时间，到期断开
 };
 
 /**
@@ -156,6 +184,12 @@ public:
      */
     std::string getListenAddress() const;
 
+    /**
+     * 监听地址是否全部是回环地址（127.x.x.x / ::1）
+     * @return true 表示仅本机可访问，不需要防火墙规则
+     */
+    bool isListenLoopbackOnly() const;
+
     std::string getLanguage() const;
     bool isAutoStartupEnabled() const;
     std::string getApiKey() const;
@@ -167,6 +201,155 @@ public:
     bool isDaemonEnabled() const;
     int getCommandTimeoutSeconds() const;
 
+    /**
+     * 获取 HTTP 请求处理线程数
+     * @return 线程数（已将 0/非法值解析为按 CPU 核数的默认值）
+     */
+    int getHttpWorkerThreads() const;
+
+    /**
+     * 获取 HTTP 等待队列容量
+     * @return 队列容量（至少 1）
+     */
+    int getHttpQueueCapacity() const;
+
+    /**
+     * 获取 keep-alive 空闲超时
+     * @return 秒数；0 表示每个请求后关闭连接
+     */
+    int getHttpKeepAliveTimeoutSeconds() const;
+
+    /**
+     * 获取单个 keep-alive 连接的最大请求数
+     * @return 请求数（至少 1）
+     */
+    int getHttpKeepAliveMaxRequests() const;
+
+    /**
+     * 获取每个客户端 IP 每分钟的请求数上限
+     * @return 请求数（1–1000000）
+     */
+    int getHttpRateLimitPerMinute() const;
+
+    /**
+     * 获取请求排队时限
+     * @return 毫秒（至少 100）
+     */
+    int getHttpQueueTimeoutMs() const;
+
+    /**
+     * 获取快速通道保留线程数
+     * @return 线程数（0–4）
+     */
+    int getHttpFastLaneWorkers() const;
+
+    /**
+     * 获取请求头接收时限
+     * @return 毫秒（至少 1000）
+     */
+    int getHttpHeaderTimeoutMs() const;
+
+    /**
+     * 获取请求体停顿时限
+     * @return 毫秒（至少 1000）
+     */
+    int getHttpBodyTimeoutMs() const;
+
+    /**
+     * 获取请求体最低上传速率
+     * @return 字节/秒（0 表示不检查）
+     */
+    int getHttpMinBodyRate() const;
+
+    /**
+     * 获取 accept 分片数（不支持 SO_REUSEPORT 的平台上由服务器回退为 1）
+     * @return 分片数（1–16）
+     */
+    int getHttpAcceptShards() const;
+
+    /**
+     * 获取退出时连接排空时限
+     * @return 毫秒（0–60000，0 表示立即断开）
+     */
+    int getHttpDrainTimeoutMs() const;
+
+    /**
+     * 获取 JSON-RPC batch 并发执行线程数
+     * @return 线程数（0–32，0 表示 batch 在处理请求的 worker 中顺序执行）
+     */
+    int getHttpBatchWorkers() const;
+
+    /**
+     * 获取异步 tools/call 执行线程数
+     * @return 线程数（0–64，0 表示工具在处理请求的 worker 中执行）
+     */
+    int getHttpToolWorkers() const;
+
+    /**
+     * 获取 Streamable HTTP session 数上限
+     * @return 上限（16–100000）
+     */
+    int getMcpMaxSessions() const;
+
+    /**
+     * 获取 session 空闲超时
+     * @return 秒数（60–604800）
+     */
+    int getMcpSessionIdleTimeoutSeconds() const;
+
+    /**
+     * 获取 session 最长存活时间
+     * @return 秒数（0 表示不限，最多 30 天）
+     */
+    int getMcpSessionTtlSeconds() const;
+
+    /**
+     * 获取同时打开的 SSE（GET /sse）session 上限
+     * @return 上限（1–10000）
+     */
+    int getSseMaxSessions() const;
+
+    /**
+     * 获取 SSE session 最长存活时间
+     * @return 秒数（60–86400）
+     */
+    int getSseSessionTtlSeconds() const;
+
+    /**
+     * 是否压缩 HTTP 响应（客户端 Accept-Encoding 接受 gzip/deflate 时）
+     */
+    bool isHttpCompressionEnabled() const;
+
+    /**
+     * 获取响应压缩阈值
+     * @return 字节（至少 0）
+     */
+    int getHttpCompressionMinBytes() const;
+
+    /**
+     * 获取响应压缩级别
+     * @return 1–9
+     */
+    int getHttpCompressionLevel() const;
+
+    /**
+     * 获取 HTTPS 监听端口（与 HTTP 使用相同的 listen_address）
+     * @return 端口，0 表示不启用
+     */
+    int getHttpTlsPort() const;
+
+    /**
+     * 获取 TLS 证书 / 私钥路径（已按配置文件目录解析相对路径）
+     */
+    std::string getHttpTlsCertFile() const;
+    std::string getHttpTlsKeyFile() const;
+
+    /**
+     * 获取 TLS 会话恢复有效期
+     * @return 秒（60–86400）
+     */
+    int getHttpTlsSessionTimeoutSeconds() const;
+
     // ===== 配置项修改器 =====
 
     /**
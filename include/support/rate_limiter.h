@@ -19,7 +19,7 @@
 #ifndef CLAWDESK_RATE_LIMITER_H
 #define CLAWDESK_RATE_LIMITER_H
 
-#include <windows.h>
+#include <cstdint>
 #include <string>
 #include <map>
 #include <deque>
@@ -29,7 +29,7 @@
 // 默认：每个 IP 在 windowMs 毫秒内最多 maxRequests 次请求
 class RateLimiter {
 public:
-    RateLimiter(int maxRequests = 60, DWORD windowMs = 60000);
+    RateLimiter(int maxRequests = 60, uint64_t windowMs = 60000);
 
     // 检查该 IP 是否允许请求，同时记录本次请求
     // 返回 true 表示放行，false 表示限流
@@ -40,9 +40,9 @@ public:
 
 private:
     int maxRequests_;
-    DWORD windowMs_;
+    uint64_t windowMs_;
     mutable std::mutex mutex_;
-    std::map<std::string, std::deque<DWORD>> requests_;  // IP -> 请求时间戳列表
+    std::map<std::string, std::deque<uint64_t>> requests_;  // IP -> 请求时间戳列表（MonotonicMillis）
 };
 
 #endif // CLAWDESK_RATE_LIMITER_H
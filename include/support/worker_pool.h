@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_WORKER_POOL_H
+#define CLAWDESK_WORKER_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "support/mpmc_queue.h"
+
+/**
+ * WorkerPool - 固定大小的工作线程池
+ *
+ * 提交方（accept 线程）与工作线程之间通过有界无锁队列交接任务；
+ * 队列满时 submit() 立即返回 false，由调用方决定如何拒绝（例如回 503），
+ * 不会阻塞提交方。空闲线程在条件变量上休眠，有任务时才被唤醒。
+ *
+ * 准入控制：
+ * - 同时执行的任务数不超过线程数，排队的任务不超过队列容量；
+ * - 带时限提交的任务在出队时已超时则不再执行，改为调用 onExpired；
+ *   按队列深度和平均执行时间预估明显赶不上时限的任务在提交时直接拒绝；
+ * - 快速通道：独立的小队列，所有线程优先处理，另有保留线程只处理它，
+ *   普通任务占满线程池时轻量请求（健康检查、预检、ping）仍能及时执行。
+ */
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    struct Stats {
+        size_t   workers = 0;
+        size_t   busyWorkers = 0;
+        size_t   queueCapacity = 0;
+        size_t   queueDepth = 0;
+        size_t   peakQueueDepth = 0;
+        size_t   fastLaneWorkers = 0;
+        size_t   fastLaneDepth = 0;
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        uint64_t rejected = 0;          // 队列满、已停止或预估超时（含 shed）
+        uint64_t shed = 0;              // 提交时预估等待超过时限而拒绝
+        uint64_t expired = 0;           // 出队时已超过时限、未执行
+        uint64_t fastLaneSubmitted = 0;
+        uint64_t totalQueueWaitUs = 0;  // 所有已出队任务的排队时间之和
+        uint64_t maxQueueWaitUs = 0;
+        uint64_t avgServiceUs = 0;      // 普通任务执行时间的滑动平均
+    };
+
+    /**
+     * @param workers          工作线程数（至少 1）
+     * @param capacity         等待队列容量（向上取整到 2 的幂）
+     * @param name             线程池名称（仅用于日志）
+     * @param fastLaneWorkers  只处理快速通道的保留线程数
+     */
+    WorkerPool(size_t workers, size_t capacity, const std::string& name = "worker", size_t fastLaneWorkers = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // 提交任务；队列满或已停止时返回 false
+    bool submit(Task task);
+
+    // 带排队时限提交：出队时已等待超过 maxWait 则不执行 task，改为在 worker 线程调用
+    // onExpired（应很轻量，例如投递一个 503）。预估等待已超过时限时直接返回 false
+    bool submit(Task task, std::chrono::milliseconds maxWait, Task onExpired);
+
+    // 提交到快速通道；快速通道队列满或已停止时返回 false
+    bool submitFast(Task task);
+
+    // 停止接收新任务，等待正在执行的任务结束后回收线程。
+    // 尚未开始的排队任务直接丢弃（析构 Task，由其捕获的资源负责清理）。
+    void shutdown();
+
+    Stats stats() const;
+    const std::string& name() const { return name_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Item {
+        Task task;
+        Task onExpired;
+        Clock::time_point enqueuedAt;
+        Clock::time_point deadline = Clock::time_point::max();
+    };
+
+    bool enqueue(Item item);
+    void wake(bool fast);
+    void workerLoop(bool fastOnly);
+    void run(Item& item, bool fast);
+    void recordWait(uint64_t waitUs);
+    void recordService(uint64_t serviceUs);
+
+    std::string name_;
+    BoundedMpmcQueue<Item> queue_;
+    BoundedMpmcQueue<Item> fastQueue_;
+    std::vector<std::thread> threads_;
+    size_t workerCount_ = 0;
+    size_t fastLaneCount_ = 0;
+
+    std::mutex parkMutex_;
+    std::condition_variable parkCv_;
+    std::condition_variable fastParkCv_;  // 只处理快速通道的线程
+    std::atomic<int> parked_{0};
+    std::atomic<int> fastParked_{0};
+    std::atomic<bool> stopping_{false};
+
+    std::atomic<size_t>   busy_{0};
+    std::atomic<size_t>   peakDepth_{0};
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> shed_{0};
+    std::atomic<uint64_t> expired_{0};
+    std::atomic<uint64_t> fastSubmitted_{0};
+    std::atomic<uint64_t> totalWaitUs_{0};
+    std::atomic<uint64_t> maxWaitUs_{0};
+    std::atomic<uint64_t> avgServiceUs_{0};
+};
+
+#endif // CLAWDESK_WORKER_POOL_H
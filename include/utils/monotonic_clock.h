@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#ifndef CLAWDESK_UTILS_MONOTONIC_CLOCK_H
+#define CLAWDESK_UTILS_MONOTONIC_CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+
+// 单调时钟毫秒数（不受系统时间调整影响），用于超时、TTL 和运行时长。
+// 取代 GetTickCount：64 位不会在 49.7 天后回绕，POSIX 上同样可用
+inline uint64_t MonotonicMillis() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+#endif // CLAWDESK_UTILS_MONOTONIC_CLOCK_H
@@ -0,0 +1,710 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * wba_loadgen - HTTP / MCP 负载生成器
+ *
+ * 每个并发连接一个线程，闭环发送：上一个响应收完才发下一个请求。请求按混合比例
+ * （/health、initialize、tools/list、tools/call）或 JSONL 脚本轮流生成；MCP 请求使用
+ * 每个连接启动时建立的 session（握手不计入统计）。
+ *
+ * 结果以 JSON 输出到 stdout（或 --output 文件），摘要打印到 stderr：
+ *   吞吐、延迟 min/mean/p50/p90/p99/p99.9/max（毫秒）、错误分类、按请求类型的分项统计。
+ *
+ * 脚本每行一个 JSON 对象，空行和 # 开头的行忽略：
+ *   {"jsonrpc":"2.0","id":1,"method":"tools/call","params":{...}}   POST /mcp（带 session）
+ *   {"method":"GET","path":"/health"}                                  任意 HTTP 请求
+ *   {"method":"POST","path":"/mcp/tools/call","body":{...},"kind":"rest_call"}
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "net/socket_compat.h"
+
+using Clock = std::chrono::steady_clock;
+
+// ── 参数 ──────────────────────────────────────────────────
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 35182;
+    int connections = 8;
+    double durationSec = 10;
+    double warmupSec = 1;
+    uint64_t maxRequests = 0;       // 0 表示只按时长
+    bool keepAlive = true;
+    int timeoutMs = 5000;
+    std::string mix = "health=1";
+    std::string scriptFile;
+    std::string tool = "echo";
+    std::string toolArgs = "{\"text\":\"hello\"}";
+    std::string output;             // 空表示 stdout
+};
+
+static void PrintUsage() {
+    fprintf(stderr,
+        "usage: wba_loadgen [options]\n"
+        "  --host ADDR          target address (default 127.0.0.1)\n"
+        "  --port N             target port (default 35182)\n"
+        "  -c, --connections N  concurrent connections (default 8)\n"
+        "  -d, --duration SEC   measured duration (default 10)\n"
+        "  --warmup SEC         unmeasured warm-up (default 1)\n"
+        "  -n, --requests N     stop after N measured requests\n"
+        "  --no-keep-alive      one request per TCP connection\n"
+        "  --timeout MS         per-request socket timeout (default 5000)\n"
+        "  --mix SPEC           weights, e.g. health=4,initialize=1,tools_list=2,tools_call=3\n"
+        "  --script FILE        replay requests from a JSONL file instead of --mix\n"
+        "  --tool NAME          tool for tools_call (default echo)\n"
+        "  --tool-args JSON     arguments for tools_call (default {\"text\":\"hello\"})\n"
+        "  -o, --output FILE    write the JSON report to FILE instead of stdout\n");
+}
+
+static bool ParseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char*& out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        const char* v = nullptr;
+        if (arg == "--host" && value(v)) {
+            opt.host = v;
+        } else if (arg == "--port" && value(v)) {
+            opt.port = atoi(v);
+        } else if ((arg == "-c" || arg == "--connections") && value(v)) {
+            opt.connections = atoi(v);
+        } else if ((arg == "-d" || arg == "--duration") && value(v)) {
+            opt.durationSec = atof(v);
+        } else if (arg == "--warmup" && value(v)) {
+            opt.warmupSec = atof(v);
+        } else if ((arg == "-n" || arg == "--requests") && value(v)) {
+            opt.maxRequests = strtoull(v, nullptr, 10);
+        } else if (arg == "--no-keep-alive") {
+            opt.keepAlive = false;
+        } else if (arg == "--timeout" && value(v)) {
+            opt.timeoutMs = atoi(v);
+        } else if (arg == "--mix" && value(v)) {
+            opt.mix = v;
+        } else if (arg == "--script" && value(v)) {
+            opt.scriptFile = v;
+        } else if (arg == "--tool" && value(v)) {
+            opt.tool = v;
+        } else if (arg == "--tool-args" && value(v)) {
+            opt.toolArgs = v;
+        } else if ((arg == "-o" || arg == "--output") && value(v)) {
+            opt.output = v;
+        } else {
+            return false;
+        }
+    }
+    if (opt.host == "localhost") opt.host = "127.0.0.1";
+    return opt.port > 0 && opt.port < 65536 && opt.connections > 0 && opt.connections <= 4096 &&
+           opt.durationSec > 0 && opt.warmupSec >= 0 && opt.timeoutMs > 0;
+}
+
+// ── 请求模板 ──────────────────────────────────────────────
+
+struct RequestTemplate {
+    std::string kind;       // 统计分组名，如 "health"、"tools/call"
+    std::string method;
+    std::string path;
+    std::string body;
+    bool mcpSession = false;  // 带 MCP-Session-Id
+    bool jsonRpc = false;     // 响应按 JSON-RPC 检查 error / isError
+};
+
+static nlohmann::json RpcRequest(const std::string& method, nlohmann::json params = nullptr) {
+    nlohmann::json msg = {{"jsonrpc", "2.0"}, {"id", 1}, {"method", method}};
+    if (!params.is_null()) msg["params"] = std::move(params);
+    return msg;
+}
+
+static nlohmann::json InitializeParams() {
+    return {{"protocolVersion", "2025-03-26"},
+            {"capabilities", nlohmann::json::object()},
+            {"clientInfo", {{"name", "wba_loadgen"}, {"version", CLAWDESK_VERSION}}}};
+}
+
+static RequestTemplate McpTemplate(const std::string& kind, const nlohmann::json& msg, bool session) {
+    RequestTemplate t;
+    t.kind = kind;
+    t.method = "POST";
+    t.path = "/mcp";
+    t.body = msg.dump();
+    t.mcpSession = session;
+    t.jsonRpc = msg.contains("id");
+    return t;
+}
+
+static bool BuiltinTemplate(const std::string& name, const Options& opt, RequestTemplate& out, std::string& error) {
+    if (name == "health") {
+        out = RequestTemplate();
+        out.kind = "health";
+        out.method = "GET";
+        out.path = "/health";
+    } else if (name == "initialize") {
+        out = McpTemplate("initialize", RpcRequest("initialize", InitializeParams()), false);
+    } else if (name == "tools_list") {
+        out = McpTemplate("tools/list", RpcRequest("tools/list"), true);
+    } else if (name == "tools_call") {
+        nlohmann::json args = nlohmann::json::parse(opt.toolArgs, nullptr, false);
+        if (!args.is_object()) {
+            error = "--tool-args must be a JSON object";
+            return false;
+        }
+        out = McpTemplate("tools/call", RpcRequest("tools/call", {{"name", opt.tool}, {"arguments", args}}), true);
+    } else {
+        error = "unknown request kind '" + name + "' (health, initialize, tools_list, tools_call)";
+        return false;
+    }
+    return true;
+}
+
+// 按权重展开为一个轮转序列，各类请求尽量均匀交错（如 2:1 → A B A）
+static bool BuildMix(const Options& opt, std::vector<RequestTemplate>& out, std::string& error) {
+    struct Entry { RequestTemplate t; int weight; double credit; };
+    std::vector<Entry> entries;
+    size_t pos = 0;
+    while (pos < opt.mix.size()) {
+        size_t comma = opt.mix.find(',', pos);
+        if (comma == std::string::npos) comma = opt.mix.size();
+        std::string item = opt.mix.substr(pos, comma - pos);
+        pos = comma + 1;
+        if (item.empty()) continue;
+        size_t eq = item.find('=');
+        int weight = eq == std::string::npos ? 1 : atoi(item.c_str() + eq + 1);
+        Entry e{RequestTemplate(), weight, 0};
+        if (weight <= 0 || weight > 1000) {
+            error = "invalid weight in '" + item + "'";
+            return false;
+        }
+        if (!BuiltinTemplate(item.substr(0, eq), opt, e.t, error)) return false;
+        entries.push_back(std::move(e));
+    }
+    if (entries.empty()) {
+        error = "empty --mix";
+        return false;
+    }
+    int total = 0;
+    for (const Entry& e : entries) total += e.weight;
+    for (int i = 0; i < total; ++i) {
+        Entry* best = nullptr;
+        for (Entry& e : entries) {
+            e.credit += e.weight;
+            if (!best || e.credit > best->credit) best = &e;
+        }
+        best->credit -= total;
+        out.push_back(best->t);
+    }
+    return true;
+}
+
+static bool LoadScript(const std::string& file, std::vector<RequestTemplate>& out, std::string& error) {
+    std::ifstream in(file);
+    if (!in) {
+        error = "cannot open " + file;
+        return false;
+    }
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        nlohmann::json j = nlohmann::json::parse(line, nullptr, false);
+        std::string where = file + ":" + std::to_string(lineNo);
+        if (!j.is_object()) {
+            error = where + ": not a JSON object";
+            return false;
+        }
+        if (j.contains("jsonrpc")) {
+            std::string method = j.value("method", "");
+            out.push_back(McpTemplate(method.empty() ? "jsonrpc" : method, j, method != "initialize"));
+            continue;
+        }
+        if (!j.contains("path") || !j["path"].is_string()) {
+            error = where + ": expected a JSON-RPC message or an object with \"path\"";
+            return false;
+        }
+        RequestTemplate t;
+        t.path = j["path"].get<std::string>();
+        t.method = j.value("method", "GET");
+        t.kind = j.value("kind", t.method + " " + t.path);
+        if (j.contains("body")) {
+            t.body = j["body"].is_string() ? j["body"].get<std::string>() : j["body"].dump();
+        }
+        t.mcpSession = j.value("session", t.path == "/mcp");
+        t.jsonRpc = t.path == "/mcp";
+        out.push_back(std::move(t));
+    }
+    if (out.empty()) {
+        error = file + ": no requests";
+        return false;
+    }
+    return true;
+}
+
+// ── HTTP 客户端 ───────────────────────────────────────────
+
+struct HttpResult {
+    int status = 0;
+    std::string sessionId;   // MCP-Session-Id 响应头
+    std::string body;
+    bool close = false;      // 服务器要求关闭连接
+};
+
+// 错误分类（报告中的 key）
+enum class IoError { None, Connect, Send, Timeout, Recv, BadResponse };
+
+static const char* IoErrorName(IoError e) {
+    switch (e) {
+    case IoError::Connect:     return "connect";
+    case IoError::Send:        return "send";
+    case IoError::Timeout:     return "timeout";
+    case IoError::Recv:        return "recv";
+    case IoError::BadResponse: return "bad_response";
+    default:                   return "none";
+    }
+}
+
+static bool IsTimeoutError(int err) {
+#ifdef _WIN32
+    return err == WSAETIMEDOUT || err == WSAEWOULDBLOCK;
+#else
+    return err == EAGAIN || err == EWOULDBLOCK || err == ETIMEDOUT;
+#endif
+}
+
+class HttpClient {
+public:
+    HttpClient(const Options& opt) : opt_(opt) {}
+    ~HttpClient() { disconnect(); }
+
+    void disconnect() {
+        if (sock_ != kInvalidSocket) {
+            CloseSocket(sock_);
+            sock_ = kInvalidSocket;
+        }
+        buffer_.clear();
+    }
+
+    uint64_t connects() const { return connects_; }
+
+    IoError execute(const RequestTemplate& t, const std::string& sessionId, HttpResult& result) {
+        if (sock_ == kInvalidSocket && !connect()) return IoError::Connect;
+
+        std::string req = t.method + " " + t.path + " HTTP/1.1\r\nHost: " + opt_.host + ":" +
+                          std::to_string(opt_.port) + "\r\n";
+        if (!opt_.keepAlive) req += "Connection: close\r\n";
+        if (t.path == "/mcp") req += "Accept: application/json, text/event-stream\r\n";
+        if (t.mcpSession && !sessionId.empty()) req += "MCP-Session-Id: " + sessionId + "\r\n";
+        if (!t.body.empty() || t.method == "POST" || t.method == "PUT") {
+            req += "Content-Type: application/json\r\nContent-Length: " + std::to_string(t.body.size()) + "\r\n";
+        }
+        req += "\r\n";
+        req += t.body;
+
+        IoError err = sendAll(req);
+        if (err == IoError::None) err = readResponse(result);
+        if (err != IoError::None || result.close || !opt_.keepAlive) disconnect();
+        return err;
+    }
+
+private:
+    bool connect() {
+        sock_ = kInvalidSocket;
+        sockaddr_storage addr{};
+        socklen_t len = 0;
+        int family = AF_INET;
+        auto* sin = reinterpret_cast<sockaddr_in*>(&addr);
+        auto* sin6 = reinterpret_cast<sockaddr_in6*>(&addr);
+        std::string host = opt_.host;
+        if (host.size() > 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+        if (inet_pton(AF_INET, host.c_str(), &sin->sin_addr) == 1) {
+            sin->sin_family = AF_INET;
+            sin->sin_port = htons(static_cast<unsigned short>(opt_.port));
+            len = sizeof(sockaddr_in);
+        } else if (inet_pton(AF_INET6, host.c_str(), &sin6->sin6_addr) == 1) {
+            family = AF_INET6;
+            sin6->sin6_family = AF_INET6;
+            sin6->sin6_port = htons(static_cast<unsigned short>(opt_.port));
+            len = sizeof(sockaddr_in6);
+        } else {
+            return false;
+        }
+
+        socket_t s = socket(family, SOCK_STREAM, IPPROTO_TCP);
+        if (s == kInvalidSocket) return false;
+        int on = 1;
+        setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on));
+#ifdef _WIN32
+        DWORD timeout = static_cast<DWORD>(opt_.timeoutMs);
+#else
+        timeval timeout{opt_.timeoutMs / 1000, (opt_.timeoutMs % 1000) * 1000};
+#endif
+        setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        if (::connect(s, reinterpret_cast<sockaddr*>(&addr), len) != 0) {
+            CloseSocket(s);
+            return false;
+        }
+        sock_ = s;
+        ++connects_;
+        return true;
+    }
+
+    IoError sendAll(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+#ifdef _WIN32
+            int n = ::send(sock_, data.data() + sent, static_cast<int>(data.size() - sent), 0);
+#else
+            ssize_t n = ::send(sock_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#endif
+            if (n <= 0) return IsTimeoutError(LastSocketError()) ? IoError::Timeout : IoError::Send;
+            sent += static_cast<size_t>(n);
+        }
+        return IoError::None;
+    }
+
+    // 读入更多数据；对端关闭返回 Recv
+    IoError fill() {
+        char chunk[16 * 1024];
+#ifdef _WIN32
+        int n = ::recv(sock_, chunk, static_cast<int>(sizeof(chunk)), 0);
+#else
+        ssize_t n = ::recv(sock_, chunk, sizeof(chunk), 0);
+#endif
+        if (n > 0) {
+            buffer_.append(chunk, static_cast<size_t>(n));
+            return IoError::None;
+        }
+        if (n < 0 && IsTimeoutError(LastSocketError())) return IoError::Timeout;
+        return IoError::Recv;
+    }
+
+    static std::string Lower(std::string s) {
+        for (char& c : s) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        return s;
+    }
+
+    IoError readResponse(HttpResult& result) {
+        result = HttpResult();
+        size_t headerEnd;
+        while ((headerEnd = buffer_.find("\r\n\r\n")) == std::string::npos) {
+            if (buffer_.size() > 64 * 1024) return IoError::BadResponse;
+            IoError err = fill();
+            if (err != IoError::None) return err;
+        }
+
+        // 状态行与需要的 header
+        std::string head = buffer_.substr(0, headerEnd + 2);
+        buffer_.erase(0, headerEnd + 4);
+        if (head.compare(0, 5, "HTTP/") != 0 || head.size() < 12) return IoError::BadResponse;
+        result.status = atoi(head.c_str() + 9);
+        long long contentLength = -1;
+        bool chunked = false;
+        size_t pos = head.find("\r\n") + 2;
+        while (pos < head.size()) {
+            size_t eol = head.find("\r\n", pos);
+            std::string line = head.substr(pos, eol - pos);
+            pos = eol + 2;
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string name = Lower(line.substr(0, colon));
+            std::string value = line.substr(line.find_first_not_of(' ', colon + 1) == std::string::npos
+                                                ? line.size() : line.find_first_not_of(' ', colon + 1));
+            if (name == "content-length") {
+                contentLength = atoll(value.c_str());
+            } else if (name == "transfer-encoding") {
+                chunked = Lower(value).find("chunked") != std::string::npos;
+            } else if (name == "connection") {
+                result.close = Lower(value) == "close";
+            } else if (name == "mcp-session-id") {
+                result.sessionId = value;
+            }
+        }
+
+        if (chunked) return readChunked(result.body);
+        if (contentLength >= 0) {
+            while (buffer_.size() < static_cast<size_t>(contentLength)) {
+                IoError err = fill();
+                if (err != IoError::None) return err;
+            }
+            result.body = buffer_.substr(0, static_cast<size_t>(contentLength));
+            buffer_.erase(0, static_cast<size_t>(contentLength));
+            return IoError::None;
+        }
+        // 无长度：读到连接关闭
+        IoError err;
+        while ((err = fill()) == IoError::None) {}
+        if (err == IoError::Timeout) return err;
+        result.body.swap(buffer_);
+        result.close = true;
+        return IoError::None;
+    }
+
+    IoError readChunked(std::string& body) {
+        for (;;) {
+            size_t eol;
+            while ((eol = buffer_.find("\r\n")) == std::string::npos) {
+                IoError err = fill();
+                if (err != IoError::None) return err;
+            }
+            size_t size = strtoul(buffer_.c_str(), nullptr, 16);
+            buffer_.erase(0, eol + 2);
+            while (buffer_.size() < size + 2) {
+                IoError err = fill();
+                if (err != IoError::None) return err;
+            }
+            body.append(buffer_, 0, size);
+            buffer_.erase(0, size + 2);
+            if (size == 0) return IoError::None;  // 不支持 trailer
+        }
+    }
+
+    const Options& opt_;
+    socket_t sock_ = kInvalidSocket;
+    std::string buffer_;
+    uint64_t connects_ = 0;
+};
+
+// ── 统计 ──────────────────────────────────────────────────
+
+struct KindStats {
+    std::vector<uint32_t> latencyUs;   // 成功请求的延迟
+    uint64_t errors = 0;
+};
+
+struct WorkerStats {
+    std::map<std::string, KindStats> kinds;
+    std::map<std::string, uint64_t> errors;
+    uint64_t connects = 0;
+};
+
+// 响应错误分类；成功返回空串
+static std::string ClassifyResponse(const RequestTemplate& t, const HttpResult& r) {
+    if (r.status >= 400 || r.status < 200) return "http_" + std::to_string(r.status);
+    if (!t.jsonRpc || r.status == 202) return std::string();
+    nlohmann::json msg = nlohmann::json::parse(r.body, nullptr, false);
+    if (!msg.is_object()) return "bad_json";
+    if (msg.contains("error")) {
+        return "rpc_" + std::to_string(msg["error"].value("code", 0));
+    }
+    const nlohmann::json& result = msg.contains("result") ? msg["result"] : nlohmann::json();
+    if (result.is_object() && result.value("isError", false)) return "tool_error";
+    return std::string();
+}
+
+// MCP session 握手：initialize + notifications/initialized（不计入统计）
+static bool OpenSession(HttpClient& client, std::string& sessionId) {
+    HttpResult r;
+    RequestTemplate init = McpTemplate("initialize", RpcRequest("initialize", InitializeParams()), false);
+    if (client.execute(init, "", r) != IoError::None || r.status != 200 || r.sessionId.empty()) return false;
+    sessionId = r.sessionId;
+    nlohmann::json note = {{"jsonrpc", "2.0"}, {"method", "notifications/initialized"}};
+    return client.execute(McpTemplate("initialized", note, true), sessionId, r) == IoError::None;
+}
+
+struct RunState {
+    Clock::time_point measureStart;
+    Clock::time_point end;
+    std::atomic<uint64_t> measured{0};
+    std::atomic<bool> stop{false};
+    std::atomic<int> sessionFailures{0};
+};
+
+static void RunWorker(int index, const Options& opt, const std::vector<RequestTemplate>& schedule,
+                      RunState& state, WorkerStats& stats) {
+    HttpClient client(opt);
+    std::string sessionId;
+    bool needSession = std::any_of(schedule.begin(), schedule.end(),
+                                   [](const RequestTemplate& t) { return t.mcpSession; });
+    if (needSession && !OpenSession(client, sessionId)) {
+        state.sessionFailures.fetch_add(1);
+    }
+
+    // 各连接从不同位置开始，避免同一时刻都发同一类请求
+    size_t next = static_cast<size_t>(index) % schedule.size();
+    HttpResult result;
+    while (!state.stop.load(std::memory_order_relaxed)) {
+        const RequestTemplate& t = schedule[next];
+        next = (next + 1) % schedule.size();
+
+        Clock::time_point begin = Clock::now();
+        if (begin >= state.end) break;
+        IoError err = client.execute(t, sessionId, result);
+        Clock::time_point done = Clock::now();
+        if (done < state.measureStart || done > state.end) continue;  // 预热期或超出测量窗口
+
+        if (opt.maxRequests) {
+            uint64_t n = state.measured.fetch_add(1) + 1;
+            if (n > opt.maxRequests) break;
+            if (n == opt.maxRequests) state.stop.store(true);
+        }
+
+        KindStats& kind = stats.kinds[t.kind];
+        std::string error = err != IoError::None ? IoErrorName(err) : ClassifyResponse(t, result);
+        if (!error.empty()) {
+            ++kind.errors;
+            ++stats.errors[error];
+            if (err == IoError::Connect) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(done - begin).count();
+        kind.latencyUs.push_back(static_cast<uint32_t>(std::min<long long>(us, UINT32_MAX)));
+    }
+    stats.connects = client.connects();
+}
+
+// 最近秩分位数（毫秒）；latency 已排序
+static double Percentile(const std::vector<uint32_t>& latency, double p) {
+    if (latency.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * latency.size()));
+    return latency[std::min(latency.size(), std::max<size_t>(rank, 1)) - 1] / 1000.0;
+}
+
+static nlohmann::json LatencyJson(std::vector<uint32_t>& latency) {
+    std::sort(latency.begin(), latency.end());
+    double sum = 0;
+    for (uint32_t v : latency) sum += v;
+    nlohmann::json j;
+    j["min"] = latency.empty() ? 0.0 : latency.front() / 1000.0;
+    j["mean"] = latency.empty() ? 0.0 : sum / latency.size() / 1000.0;
+    j["p50"] = Percentile(latency, 50);
+    j["p90"] = Percentile(latency, 90);
+    j["p99"] = Percentile(latency, 99);
+    j["p99_9"] = Percentile(latency, 99.9);
+    j["max"] = latency.empty() ? 0.0 : latency.back() / 1000.0;
+    return j;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!ParseOptions(argc, argv, opt)) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::vector<RequestTemplate> schedule;
+    std::string error;
+    bool ok = opt.scriptFile.empty() ? BuildMix(opt, schedule, error) : LoadScript(opt.scriptFile, schedule, error);
+    if (!ok) {
+        fprintf(stderr, "wba_loadgen: %s\n", error.c_str());
+        return 2;
+    }
+
+    SocketRuntime socketRuntime;
+    if (!socketRuntime.ok()) {
+        fprintf(stderr, "wba_loadgen: socket runtime initialization failed\n");
+        return 1;
+    }
+
+    RunState state;
+    Clock::time_point start = Clock::now();
+    state.measureStart = start + std::chrono::milliseconds(static_cast<int64_t>(opt.warmupSec * 1000));
+    state.end = state.measureStart + std::chrono::milliseconds(static_cast<int64_t>(opt.durationSec * 1000));
+
+    std::vector<WorkerStats> workerStats(static_cast<size_t>(opt.connections));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < opt.connections; ++i) {
+        threads.emplace_back(RunWorker, i, std::cref(opt), std::cref(schedule), std::ref(state),
+                             std::ref(workerStats[static_cast<size_t>(i)]));
+    }
+    for (std::thread& t : threads) t.join();
+
+    // 按 -n 提前结束时以最后完成时间为准
+    Clock::time_point finished = std::min(Clock::now(), state.end);
+    double elapsed = std::chrono::duration<double>(finished - state.measureStart).count();
+    if (elapsed <= 0) elapsed = opt.durationSec;
+
+    // 汇总
+    std::map<std::string, KindStats> kinds;
+    std::map<std::string, uint64_t> errors;
+    uint64_t connects = 0;
+    for (WorkerStats& w : workerStats) {
+        for (auto& pair : w.kinds) {
+            KindStats& k = kinds[pair.first];
+            k.latencyUs.insert(k.latencyUs.end(), pair.second.latencyUs.begin(), pair.second.latencyUs.end());
+            k.errors += pair.second.errors;
+        }
+        for (auto& pair : w.errors) errors[pair.first] += pair.second;
+        connects += w.connects;
+    }
+    std::vector<uint32_t> all;
+    uint64_t errorCount = 0;
+    nlohmann::json byKind = nlohmann::json::object();
+    for (auto& pair : kinds) {
+        KindStats& k = pair.second;
+        all.insert(all.end(), k.latencyUs.begin(), k.latencyUs.end());
+        errorCount += k.errors;
+        uint64_t requests = k.latencyUs.size() + k.errors;
+        nlohmann::json kj;
+        kj["requests"] = requests;
+        kj["errors"] = k.errors;
+        kj["throughput_rps"] = requests / elapsed;
+        kj["latency_ms"] = LatencyJson(k.latencyUs);
+        byKind[pair.first] = kj;
+    }
+    uint64_t total = all.size() + errorCount;
+
+    nlohmann::json report;
+    report["target"] = opt.host + ":" + std::to_string(opt.port);
+    report["connections"] = opt.connections;
+    report["keep_alive"] = opt.keepAlive;
+    report["workload"] = opt.scriptFile.empty() ? opt.mix : opt.scriptFile;
+    report["duration_s"] = elapsed;
+    report["requests"] = total;
+    report["succeeded"] = all.size();
+    report["failed"] = errorCount;
+    report["throughput_rps"] = total / elapsed;
+    report["latency_ms"] = LatencyJson(all);
+    report["errors"] = errors;
+    report["by_kind"] = byKind;
+    report["tcp_connects"] = connects;
+    report["session_failures"] = state.sessionFailures.load();
+
+    std::string json = report.dump(2);
+    if (opt.output.empty()) {
+        printf("%s\n", json.c_str());
+    } else {
+        std::ofstream out(opt.output);
+        out << json << "\n";
+        if (!out) {
+            fprintf(stderr, "wba_loadgen: cannot write %s\n", opt.output.c_str());
+            return 1;
+        }
+    }
+
+    const nlohmann::json& lat = report["latency_ms"];
+    fprintf(stderr, "%llu requests in %.2fs, %.0f req/s, %llu errors | p50 %.3fms p90 %.3fms p99 %.3fms p99.9 %.3fms max %.3fms\n",
+            static_cast<unsigned long long>(total), elapsed, total / elapsed,
+            static_cast<unsigned long long>(errorCount), lat["p50"].get<double>(), lat["p90"].get<double>(),
+            lat["p99"].get<double>(), lat["p99_9"].get<double>(), lat["max"].get<double>());
+    return errorCount == 0 && state.sessionFailures.load() == 0 ? 0 : 1;
+}
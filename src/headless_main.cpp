@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * 无界面服务器宿主（POSIX）
+ *
+ * 运行与托盘程序相同的 HTTP 服务器、MCP 传输和会话存储，不含桌面功能路由和工具，
+ * 只注册 echo 和 sleep（异步、带进度）两个压测工具。用于在 Linux 构建机上做吞吐 / 延迟压测和 sanitizer 测试。
+ *
+ * 用法：clawdesk_server [--config config.json] [--audit-log audit.log] [--quiet]
+ * SIGINT / SIGTERM 排空进行中的请求后退出（server.drain_timeout_ms）。
+ */
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include <nlohmann/json.hpp>
+#include "app_core.h"
+#include "http_server.h"
+#include "mcp_handlers.h"
+#include "mcp_sse.h"
+#include "mcp/tool_registry.h"
+#include "policy/policy_guard.h"
+#include "support/audit_logger.h"
+#include "support/config_manager.h"
+#include "support/license_manager.h"
+#include "utils/monotonic_clock.h"
+
+// ── 全局变量（app_core.h）────────────────────────────────
+std::atomic<bool>      g_running(true);
+ConfigManager*         g_configManager = nullptr;
+clawdesk::AuditLogger* g_auditLogger = nullptr;
+PolicyGuard*           g_policyGuard = nullptr;
+uint64_t               g_startTickCount = 0;
+
+static bool g_quiet = false;
+static std::mutex g_logMutex;
+
+void AppendHttpServerLogA(const std::string& line) {
+    if (g_quiet) return;
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    fprintf(stderr, "%s\n", line.c_str());
+}
+
+void AppendExceptionLogA(const std::string& line) {
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    fprintf(stderr, "[exception] %s\n", line.c_str());
+}
+
+void LogActivity(ActivityKind, const std::string&, const std::string&) {}
+
+// 信号线程：SIGINT / SIGTERM 在所有线程中屏蔽，由这里 sigwait 同步接收后停止服务器
+// （StopHttpServer 要加锁，不能在异步信号处理函数里调用）。服务器自行退出时主线程向本线程
+// 发送 SIGTERM 让它结束
+static void WaitForStopSignal(sigset_t signals) {
+    int sig = 0;
+    sigwait(&signals, &sig);
+    StopHttpServer();
+}
+
+// sleep：分 steps 步共休眠 ms 毫秒，每步上报一次进度，客户端断开或取消请求后立即返回
+static nlohmann::json SleepTool(const nlohmann::json& args) {
+    int totalMs = std::max(0, std::min(args.value("ms", 1000), 60000));
+    int steps = std::max(1, std::min(args.value("steps", 10), 1000));
+    CancellationToken cancel = CurrentCancellationToken();
+    for (int i = 0; i < steps; ++i) {
+        if (cancel.waitFor(totalMs / steps)) {
+            return MakeTextContent("cancelled", true);
+        }
+        ReportToolProgress(i + 1, steps);
+    }
+    return MakeTextContent("slept " + std::to_string(totalMs) + " ms", false);
+}
+
+// 压测用工具：echo 原样返回 text 参数；sleep 模拟长时间运行、上报进度的工具
+static void RegisterBenchmarkTools() {
+    ToolRegistry::getInstance().registerTool("echo", {
+        "echo",
+        "Return the given text unchanged",
+        clawdesk::RiskLevel::Low,
+        false,
+        {
+            {"type", "object"},
+            {"properties", {
+                {"text", {{"type", "string"}, {"description", "Text to echo back"}}}
+            }},
+            {"required", {"text"}}
+        },
+        [](const nlohmann::json& args) {
+            if (!args.contains("text") || !args["text"].is_string()) {
+                return MakeTextContent("Error: text is required", true);
+            }
+            return MakeTextContent(args["text"].get<std::string>(), false);
+        }
+    });
+    ToolRegistry::getInstance().registerTool("sleep", {
+        "sleep",
+        "Sleep for the given time, reporting progress after each step",
+        clawdesk::RiskLevel::Low,
+        false,
+        {
+            {"type", "object"},
+            {"properties", {
+                {"ms", {{"type", "integer"}, {"description", "Total time to sleep in milliseconds (max 60000)"}}},
+                {"steps", {{"type", "integer"}, {"description", "Number of progress steps"}}}
+            }}
+        },
+        SleepTool,
+        RunOnToolPool(SleepTool)
+    });
+}
+
+static void PrintUsage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--config config.json] [--audit-log audit.log] [--quiet]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    std::string configPath = "config.json";
+    std::string auditLogPath;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            configPath = argv[++i];
+        } else if (strcmp(argv[i], "--audit-log") == 0 && i + 1 < argc) {
+            auditLogPath = argv[++i];
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            g_quiet = true;
+        } else {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    g_startTickCount = MonotonicMillis();
+
+    ConfigManager config(configPath);
+    try {
+        config.load();
+    } catch (const std::exception& e) {
+        fprintf(stderr, "Failed to load %s: %s\n", configPath.c_str(), e.what());
+        return 1;
+    }
+    g_configManager = &config;
+
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);  // 之后创建的线程继承
+    std::thread signalThread(WaitForStopSignal, stopSignals);
+
+    // 审计日志默认关闭，避免压测时每次 tools/call 都写文件
+    std::unique_ptr<clawdesk::AuditLogger> auditLogger;
+    if (!auditLogPath.empty()) {
+        auditLogger.reset(new clawdesk::AuditLogger(auditLogPath));
+        g_auditLogger = auditLogger.get();
+    }
+    LicenseManager licenseManager(&config, "usage.json");
+    PolicyGuard policyGuard(&config, &licenseManager);
+    g_policyGuard = &policyGuard;
+
+    RegisterBenchmarkTools();
+
+    int exitCode = RunHttpServer([](bool started) {
+        if (started) {
+            fprintf(stderr, "clawdesk_server " CLAWDESK_VERSION " listening on port %d\n",
+                    g_configManager->getServerPort());
+        }
+    });
+
+    pthread_kill(signalThread.native_handle(), SIGTERM);
+    signalThread.join();
+
+    SseSessionStore::getInstance().shutdownAllSessions();
+    g_policyGuard = nullptr;
+    g_auditLogger = nullptr;
+    g_configManager = nullptr;
+    return exitCode;
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "http/content_encoding.h"
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+static std::string_view TrimView(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// "gzip;q=0.8" -> q 值；没有 q 参数为 1，格式错误按 0（不接受）处理
+static double ParseQValue(std::string_view params) {
+    while (!params.empty()) {
+        size_t semi = params.find(';');
+        std::string_view param = TrimView(params.substr(0, semi));
+        params = semi == std::string_view::npos ? std::string_view() : params.substr(semi + 1);
+        if (param.size() >= 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+            std::string value(TrimView(param.substr(2)));
+            char* end = nullptr;
+            double q = std::strtod(value.c_str(), &end);
+            if (value.empty() || *end != '\0' || q < 0) return 0;
+            return q > 1 ? 1 : q;
+        }
+    }
+    return 1;
+}
+
+ContentCoding NegotiateContentCoding(std::string_view acceptEncoding) {
+    double gzip = -1;
+    double deflate = -1;
+    double any = -1;
+    while (!acceptEncoding.empty()) {
+        size_t comma = acceptEncoding.find(',');
+        std::string_view item = acceptEncoding.substr(0, comma);
+        acceptEncoding = comma == std::string_view::npos ? std::string_view() : acceptEncoding.substr(comma + 1);
+
+        size_t semi = item.find(';');
+        std::string_view name = TrimView(item.substr(0, semi));
+        double q = semi == std::string_view::npos ? 1 : ParseQValue(item.substr(semi + 1));
+        if (EqualsIgnoreCase(name, "gzip") || EqualsIgnoreCase(name, "x-gzip")) {
+            gzip = q;
+        } else if (EqualsIgnoreCase(name, "deflate")) {
+            deflate = q;
+        } else if (name == "*") {
+            any = q;
+        }
+    }
+    // 未列出的编码按 "*" 的 q 值
+    if (gzip < 0) gzip = any;
+    if (deflate < 0) deflate = any;
+    if (gzip > 0 && gzip >= deflate) return ContentCoding::Gzip;
+    if (deflate > 0) return ContentCoding::Deflate;
+    return ContentCoding::Identity;
+}
+
+const char* ContentCodingName(ContentCoding coding) {
+    switch (coding) {
+    case ContentCoding::Gzip:    return "gzip";
+    case ContentCoding::Deflate: return "deflate";
+    default:                     return nullptr;
+    }
+}
+
+bool IsCompressibleType(std::string_view contentType) {
+    std::string_view type = TrimView(contentType.substr(0, contentType.find(';')));
+    if (type.size() >= 5 && EqualsIgnoreCase(type.substr(0, 5), "text/")) {
+        return true;
+    }
+    static const char* const kTypes[] = {
+        "application/json", "application/javascript", "application/xml",
+        "application/x-ndjson", "image/svg+xml",
+    };
+    for (const char* t : kTypes) {
+        if (EqualsIgnoreCase(type, t)) return true;
+    }
+    return type.size() > 5 && (EqualsIgnoreCase(type.substr(type.size() - 5), "+json") ||
+                               EqualsIgnoreCase(type.substr(type.size() - 4), "+xml"));
+}
+
+static DeflateEncoder::Format EncoderFormat(ContentCoding coding) {
+    // HTTP 的 "deflate" 指 zlib 格式（RFC 9110 8.4.1.2），不是裸 DEFLATE
+    return coding == ContentCoding::Gzip ? DeflateEncoder::Format::Gzip : DeflateEncoder::Format::Zlib;
+}
+
+static bool IsBodyless(int status) {
+    return (status >= 100 && status < 200) || status == 204 || status == 304;
+}
+
+static void AddVary(HttpResponse& response) {
+    std::string_view vary = response.header("vary");
+    if (vary.empty()) {
+        response.addHeader("Vary", "Accept-Encoding");
+    } else if (vary.find("Accept-Encoding") == std::string_view::npos) {
+        response.setHeader("Vary", std::string(vary) + ", Accept-Encoding");
+    }
+}
+
+std::string EncodedETag(std::string_view etag, ContentCoding coding) {
+    if (coding == ContentCoding::Identity || etag.size() < 2 || etag.back() != '"' || etag.substr(0, 2) == "W/") {
+        return std::string(etag);
+    }
+    std::string out(etag.substr(0, etag.size() - 1));
+    out += '-';
+    out += ContentCodingName(coding);
+    out += '"';
+    return out;
+}
+
+// 响应改为编码后的表示：写入 Content-Encoding，ETag 换成该编码的校验值
+static void SetContentEncoding(HttpResponse& response, ContentCoding coding) {
+    response.setHeader("Content-Encoding", ContentCodingName(coding));
+    std::string_view etag = response.header("etag");
+    if (!etag.empty()) {
+        response.setHeader("ETag", EncodedETag(etag, coding));
+    }
+}
+
+ContentCoding ApplyStreamCoding(const HttpRequest& request, HttpResponse& response,
+                                const CompressionOptions& options) {
+    if (!options.enabled || !response.isStreaming() || IsBodyless(response.status()) ||
+        !response.header("content-encoding").empty() || !IsCompressibleType(response.header("content-type"))) {
+        return ContentCoding::Identity;
+    }
+    AddVary(response);
+    ContentCoding coding = NegotiateContentCoding(request.header("accept-encoding"));
+    if (coding != ContentCoding::Identity) {
+        SetContentEncoding(response, coding);
+    }
+    return coding;
+}
+
+// ── 共享 body 的压缩缓存 ──────────────────────────────────
+
+namespace {
+
+class CompressedBodyCache {
+public:
+    HttpResponse::Buffer find(const HttpResponse::Buffer& source, ContentCoding coding, int level) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(Key{source.get(), coding});
+        if (it == entries_.end()) return nullptr;
+        // 原缓冲区已释放、地址被复用时条目失效
+        if (it->second.source.lock() != source || it->second.level != level) {
+            entries_.erase(it);
+            return nullptr;
+        }
+        return it->second.compressed;
+    }
+
+    void store(const HttpResponse::Buffer& source, ContentCoding coding, int level, HttpResponse::Buffer compressed) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.size() >= kMaxEntries) {
+            for (auto it = entries_.begin(); it != entries_.end();) {
+                it = it->second.source.expired() ? entries_.erase(it) : std::next(it);
+            }
+            if (entries_.size() >= kMaxEntries) entries_.clear();
+        }
+        entries_[Key{source.get(), coding}] = Entry{source, level, std::move(compressed)};
+    }
+
+private:
+    static const size_t kMaxEntries = 64;
+
+    struct Key {
+        const std::string* source;
+        ContentCoding coding;
+        bool operator==(const Key& other) const { return source == other.source && coding == other.coding; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            return std::hash<const void*>()(k.source) ^ static_cast<size_t>(k.coding);
+        }
+    };
+    struct Entry {
+        std::weak_ptr<const std::string> source;
+        int level = 0;
+        HttpResponse::Buffer compressed;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<Key, Entry, KeyHash> entries_;
+};
+
+CompressedBodyCache& BodyCache() {
+    static CompressedBodyCache cache;
+    return cache;
+}
+
+}  // namespace
+
+bool CompressResponse(const HttpRequest& request, HttpResponse& response, const CompressionOptions& options) {
+    if (!options.enabled || response.isStreaming() || IsBodyless(response.status()) ||
+        response.contentLength() < options.minBytes || !response.header("content-encoding").empty() ||
+        !IsCompressibleType(response.header("content-type"))) {
+        return false;
+    }
+    const std::vector<HttpBodyPart>& parts = response.body();
+    for (const HttpBodyPart& part : parts) {
+        if (part.isFile()) return false;
+    }
+
+    AddVary(response);
+    ContentCoding coding = NegotiateContentCoding(request.header("accept-encoding"));
+    if (coding == ContentCoding::Identity) {
+        return false;
+    }
+
+    // 单个缓冲区且被其他对象共享（static 响应、缓存的结果）：查缓存
+    HttpResponse::Buffer shared;
+    if (parts.size() == 1 && parts[0].data.use_count() > 1) {
+        shared = parts[0].data;
+        if (HttpResponse::Buffer cached = BodyCache().find(shared, coding, options.level)) {
+            response.setBody(std::string());
+            response.appendBody(std::move(cached));
+            SetContentEncoding(response, coding);
+            return true;
+        }
+    }
+
+    DeflateEncoder encoder(EncoderFormat(coding), options.level);
+    std::string compressed;
+    compressed.reserve(static_cast<size_t>(response.contentLength() / 4) + 64);
+    for (const HttpBodyPart& part : parts) {
+        encoder.write(*part.data, compressed);
+    }
+    encoder.finish(compressed);
+    if (compressed.size() >= response.contentLength()) {
+        return false;  // 压缩后没有变小（已压缩或随机数据）
+    }
+
+    auto buffer = std::make_shared<const std::string>(std::move(compressed));
+    if (shared) {
+        BodyCache().store(shared, coding, options.level, buffer);
+    }
+    response.setBody(std::string());
+    response.appendBody(std::move(buffer));
+    SetContentEncoding(response, coding);
+    return true;
+}
+
+// ── StreamCompressor ──────────────────────────────────────
+
+StreamCompressor::StreamCompressor(ContentCoding coding, int level) : encoder_(EncoderFormat(coding), level) {}
+
+std::string StreamCompressor::compress(std::string_view data) {
+    std::string out;
+    out.reserve(data.size() / 2 + 32);
+    encoder_.write(data, out, true);
+    return out;
+}
+
+std::string StreamCompressor::finish() {
+    std::string out;
+    encoder_.finish(out);
+    return out;
+}
@@ -0,0 +1,594 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "http/deflate.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+namespace {
+
+const size_t kWindowSize = 32768;
+const size_t kMinMatch = 3;
+const size_t kMaxMatch = 258;
+const size_t kBlockInput = 64 * 1024;   // 每个块最多处理的输入字节
+const int kHashBits = 15;
+const uint32_t kHashMask = (1u << kHashBits) - 1;
+
+const int kLitLenCodes = 286;
+const int kDistCodes = 30;
+const int kCodeLenCodes = 19;
+const int kEndOfBlock = 256;
+
+const uint16_t kLengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t kDistBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                6145, 8193, 12289, 16385, 24577};
+const uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+const uint8_t kCodeLenOrder[kCodeLenCodes] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+struct LevelParams {
+    int maxChain;
+    size_t niceLength;
+    bool lazy;
+};
+
+const LevelParams kLevels[10] = {
+    {4, 8, false},      // 0 按 1 处理
+    {4, 8, false},
+    {8, 16, false},
+    {16, 32, false},
+    {16, 16, true},
+    {32, 32, true},
+    {128, 128, true},
+    {256, 128, true},
+    {1024, 258, true},
+    {4096, 258, true},
+};
+
+// 长度 3..258 -> 长度码 0..28；距离 1..32768 -> 距离码 0..29（距离 > 256 时按 dist >> 7 查表）
+struct CodeTables {
+    uint8_t length[kMaxMatch + 1];
+    uint8_t dist[512];
+
+    CodeTables() {
+        for (size_t len = kMinMatch; len <= kMaxMatch; ++len) {
+            length[len] = static_cast<uint8_t>(std::upper_bound(kLengthBase, kLengthBase + 29, len) - kLengthBase - 1);
+        }
+        for (size_t d = 1; d <= 256; ++d) {
+            dist[d - 1] = static_cast<uint8_t>(std::upper_bound(kDistBase, kDistBase + 30, d) - kDistBase - 1);
+        }
+        for (size_t i = 2; i < 256; ++i) {
+            size_t d = (i << 7) + 1;
+            dist[256 + i] = static_cast<uint8_t>(std::upper_bound(kDistBase, kDistBase + 30, d) - kDistBase - 1);
+        }
+    }
+};
+
+const CodeTables& Codes() {
+    static const CodeTables tables;
+    return tables;
+}
+
+int LengthCode(size_t length) {
+    return Codes().length[length];
+}
+
+int DistCode(size_t dist) {
+    return dist <= 256 ? Codes().dist[dist - 1] : Codes().dist[256 + ((dist - 1) >> 7)];
+}
+
+// 按频率计算长度不超过 limit 的 Huffman 码长。超限时把频率减半重建，
+// 频率越来越平均，树深最终会降到 ceil(log2(n)) 以内
+void BuildCodeLengths(const uint32_t* freq, int n, int limit, uint8_t* lengths) {
+    std::vector<uint32_t> weights(freq, freq + n);
+
+    // 至少两个符号，保证生成完整的前缀码（解码器拒绝不完整的码表）
+    int used = static_cast<int>(std::count_if(weights.begin(), weights.end(), [](uint32_t w) { return w > 0; }));
+    for (int i = 0; used < 2 && i < n; ++i) {
+        if (weights[i] == 0) {
+            weights[i] = 1;
+            used++;
+        }
+    }
+
+    struct Node {
+        uint64_t weight;
+        int left;
+        int right;
+    };
+    for (;;) {
+        std::vector<Node> nodes;
+        nodes.reserve(2 * n);
+        using Entry = std::pair<uint64_t, int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+        for (int i = 0; i < n; ++i) {
+            nodes.push_back({weights[i], -1, -1});
+            if (weights[i] > 0) heap.push({weights[i], i});
+        }
+        while (heap.size() > 1) {
+            Entry a = heap.top();
+            heap.pop();
+            Entry b = heap.top();
+            heap.pop();
+            nodes.push_back({a.first + b.first, a.second, b.second});
+            heap.push({a.first + b.first, static_cast<int>(nodes.size()) - 1});
+        }
+
+        std::fill(lengths, lengths + n, 0);
+        int maxDepth = 0;
+        std::vector<std::pair<int, int>> stack{{heap.top().second, 0}};
+        while (!stack.empty()) {
+            auto [index, depth] = stack.back();
+            stack.pop_back();
+            if (index < n) {
+                lengths[index] = static_cast<uint8_t>(depth);
+                maxDepth = std::max(maxDepth, depth);
+            } else {
+                stack.push_back({nodes[index].left, depth + 1});
+                stack.push_back({nodes[index].right, depth + 1});
+            }
+        }
+        if (maxDepth <= limit) return;
+        for (uint32_t& w : weights) {
+            if (w > 0) w = (w + 1) / 2;
+        }
+    }
+}
+
+// 由码长生成规范 Huffman 码（RFC 1951 3.2.2），并按位反转以便低位先出
+void BuildCodes(const uint8_t* lengths, int n, uint16_t* codes) {
+    uint16_t count[16] = {};
+    for (int i = 0; i < n; ++i) count[lengths[i]]++;
+    count[0] = 0;
+    uint16_t next[16] = {};
+    uint16_t code = 0;
+    for (int bits = 1; bits < 16; ++bits) {
+        code = static_cast<uint16_t>((code + count[bits - 1]) << 1);
+        next[bits] = code;
+    }
+    for (int i = 0; i < n; ++i) {
+        int len = lengths[i];
+        if (len == 0) {
+            codes[i] = 0;
+            continue;
+        }
+        uint16_t c = next[len]++;
+        uint16_t reversed = 0;
+        for (int b = 0; b < len; ++b) {
+            reversed = static_cast<uint16_t>((reversed << 1) | ((c >> b) & 1));
+        }
+        codes[i] = reversed;
+    }
+}
+
+struct FixedTables {
+    uint8_t litLen[288];
+    uint8_t dist[30];
+    uint16_t litCode[288];
+    uint16_t distCode[30];
+
+    FixedTables() {
+        for (int i = 0; i < 288; ++i) {
+            litLen[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+        }
+        std::fill(dist, dist + 30, 5);
+        BuildCodes(litLen, 288, litCode);
+        BuildCodes(dist, 30, distCode);
+    }
+};
+
+const FixedTables& Fixed() {
+    static const FixedTables tables;
+    return tables;
+}
+
+// 码长序列的游程编码（16 重复前一个、17/18 重复 0）
+struct CodeLenSymbol {
+    uint8_t symbol;
+    uint8_t extra;
+};
+
+std::vector<CodeLenSymbol> EncodeCodeLengths(const uint8_t* lengths, int n) {
+    std::vector<CodeLenSymbol> out;
+    int i = 0;
+    while (i < n) {
+        uint8_t len = lengths[i];
+        int run = 1;
+        while (i + run < n && lengths[i + run] == len) run++;
+        int left = run;
+        if (len == 0) {
+            while (left >= 11) {
+                int k = std::min(left, 138);
+                out.push_back({18, static_cast<uint8_t>(k - 11)});
+                left -= k;
+            }
+            if (left >= 3) {
+                out.push_back({17, static_cast<uint8_t>(left - 3)});
+                left = 0;
+            }
+        } else {
+            out.push_back({len, 0});
+            left--;
+            while (left >= 3) {
+                int k = std::min(left, 6);
+                out.push_back({16, static_cast<uint8_t>(k - 3)});
+                left -= k;
+            }
+        }
+        for (; left > 0; --left) out.push_back({len, 0});
+        i += run;
+    }
+    return out;
+}
+
+const uint8_t kCodeLenExtraBits[3] = {2, 3, 7};  // 16, 17, 18
+
+// 公共前缀长度（不超过 limit），每次比较 8 字节
+size_t MatchLength(const uint8_t* a, const uint8_t* b, size_t limit) {
+    size_t len = 0;
+    while (len + 8 <= limit) {
+        uint64_t x, y;
+        std::memcpy(&x, a + len, 8);
+        std::memcpy(&y, b + len, 8);
+        if (x != y) break;
+        len += 8;
+    }
+    while (len < limit && a[len] == b[len]) len++;
+    return len;
+}
+
+}  // namespace
+
+// ── 校验和 ────────────────────────────────────────────────
+
+uint32_t Crc32(uint32_t crc, const void* data, size_t size) {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t Adler32(uint32_t adler, const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    while (size > 0) {
+        size_t n = std::min<size_t>(size, 5552);  // 5552 字节内累加不会溢出 32 位
+        size -= n;
+        for (; n > 0; --n) {
+            a += *p++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+// ── DeflateEncoder ────────────────────────────────────────
+
+DeflateEncoder::DeflateEncoder(Format format, int level)
+    : format_(format), head_(1u << kHashBits, -1) {
+    const LevelParams& params = kLevels[std::min(std::max(level, 1), 9)];
+    maxChain_ = params.maxChain;
+    niceLength_ = params.niceLength;
+    lazy_ = params.lazy;
+    checksum_ = format == Format::Zlib ? 1 : 0;
+}
+
+void DeflateEncoder::putBits(uint32_t value, int count, std::string& out) {
+    bitBuffer_ |= static_cast<uint64_t>(value) << bitCount_;
+    bitCount_ += count;
+    while (bitCount_ >= 8) {
+        out.push_back(static_cast<char>(bitBuffer_ & 0xFF));
+        bitBuffer_ >>= 8;
+        bitCount_ -= 8;
+    }
+}
+
+void DeflateEncoder::alignToByte(std::string& out) {
+    if (bitCount_ > 0) putBits(0, 8 - bitCount_, out);
+}
+
+void DeflateEncoder::writeHeader(std::string& out) {
+    if (headerWritten_) return;
+    headerWritten_ = true;
+    if (format_ == Format::Zlib) {
+        out += "\x78\x9C";  // 32 KB 窗口，默认压缩级别
+    } else if (format_ == Format::Gzip) {
+        static const char kGzipHeader[10] = {'\x1F', '\x8B', 8, 0, 0, 0, 0, 0, 0, '\xFF'};
+        out.append(kGzipHeader, sizeof(kGzipHeader));
+    }
+}
+
+void DeflateEncoder::write(std::string_view data, std::string& out, bool flush) {
+    if (finished_) return;
+    writeHeader(out);
+    if (!data.empty()) {
+        totalIn_ += data.size();
+        if (format_ == Format::Zlib) {
+            checksum_ = Adler32(checksum_, data.data(), data.size());
+        } else if (format_ == Format::Gzip) {
+            checksum_ = Crc32(checksum_, data.data(), data.size());
+        }
+        window_.append(data.data(), data.size());
+    }
+    compress(flush, false, out);
+    if (flush) {
+        // sync flush：空 stored 块，之后字节对齐
+        putBits(0, 3, out);
+        alignToByte(out);
+        out.append("\x00\x00\xFF\xFF", 4);
+    }
+}
+
+void DeflateEncoder::finish(std::string& out) {
+    if (finished_) return;
+    writeHeader(out);
+    if (pos_ < window_.size()) {
+        compress(true, true, out);
+    } else {
+        // 只有结束符的固定 Huffman 块（结束符的固定码是 7 个 0 位）
+        putBits(1, 1, out);
+        putBits(1, 2, out);
+        putBits(0, 7, out);
+    }
+    alignToByte(out);
+    finished_ = true;
+
+    if (format_ == Format::Zlib) {
+        for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<char>((checksum_ >> shift) & 0xFF));
+    } else if (format_ == Format::Gzip) {
+        uint32_t size = static_cast<uint32_t>(totalIn_);
+        for (int shift = 0; shift < 32; shift += 8) out.push_back(static_cast<char>((checksum_ >> shift) & 0xFF));
+        for (int shift = 0; shift < 32; shift += 8) out.push_back(static_cast<char>((size >> shift) & 0xFF));
+    }
+}
+
+void DeflateEncoder::insertHash(size_t pos) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(window_.data()) + pos;
+    uint32_t h = ((static_cast<uint32_t>(p[0]) << 10) ^ (static_cast<uint32_t>(p[1]) << 5) ^ p[2]) & kHashMask;
+    if (prev_.size() <= pos) prev_.resize(window_.size(), -1);
+    prev_[pos] = head_[h];
+    head_[h] = static_cast<int32_t>(pos);
+}
+
+size_t DeflateEncoder::longestMatch(size_t pos, size_t end, size_t& dist) const {
+    if (pos + kMinMatch > end) return 0;
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(window_.data());
+    const uint8_t* cur = base + pos;
+    size_t limit = std::min(kMaxMatch, end - pos);
+    uint32_t h = ((static_cast<uint32_t>(cur[0]) << 10) ^ (static_cast<uint32_t>(cur[1]) << 5) ^ cur[2]) & kHashMask;
+
+    size_t best = 0;
+    int chain = maxChain_;
+    for (int32_t candidate = head_[h]; candidate >= 0 && chain-- > 0; candidate = prev_[candidate]) {
+        size_t c = static_cast<size_t>(candidate);
+        if (pos - c > kWindowSize) break;
+        const uint8_t* m = base + c;
+        if (m[best] != cur[best] || m[0] != cur[0]) continue;
+        size_t len = MatchLength(m, cur, limit);
+        if (len > best) {
+            best = len;
+            dist = pos - c;
+            if (len >= niceLength_ || len == limit) break;
+        }
+    }
+    return best >= kMinMatch ? best : 0;
+}
+
+// 压缩 [pos_, end)。all 为 false 时只处理完整的块，剩余数据留到下次
+void DeflateEncoder::compress(bool all, bool final, std::string& out) {
+    size_t end = window_.size();
+    std::vector<Symbol> symbols;
+    while (pos_ < end && (all || end - pos_ >= kBlockInput)) {
+        size_t blockBegin = pos_;
+        size_t blockEnd = std::min(end, pos_ + kBlockInput);
+        symbols.clear();
+
+        auto catchUp = [this, end](size_t limit) {
+            while (hashed_ < limit && hashed_ + kMinMatch <= end) insertHash(hashed_++);
+        };
+
+        size_t i = pos_;
+        while (i < blockEnd) {
+            catchUp(i);
+            size_t dist = 0;
+            size_t len = longestMatch(i, end, dist);
+            if (lazy_ && len > 0 && len < niceLength_ && i + 1 < end) {
+                catchUp(i + 1);
+                size_t nextDist = 0;
+                if (longestMatch(i + 1, end, nextDist) > len) {
+                    symbols.push_back({static_cast<uint8_t>(window_[i]), 0});
+                    i++;
+                    continue;
+                }
+            }
+            if (len > 0) {
+                symbols.push_back({static_cast<uint16_t>(len), static_cast<uint16_t>(dist)});
+                i += len;
+            } else {
+                symbols.push_back({static_cast<uint8_t>(window_[i]), 0});
+                i++;
+            }
+        }
+        pos_ = i;
+        emitBlock(symbols, blockBegin, pos_, final && pos_ >= end, out);
+    }
+    slideWindow();
+}
+
+void DeflateEncoder::emitBlock(const std::vector<Symbol>& symbols, size_t rawBegin, size_t rawEnd, bool final,
+                               std::string& out) {
+    uint32_t litFreq[kLitLenCodes] = {};
+    uint32_t distFreq[kDistCodes] = {};
+    litFreq[kEndOfBlock] = 1;
+    for (const Symbol& s : symbols) {
+        if (s.dist == 0) {
+            litFreq[s.litLen]++;
+        } else {
+            litFreq[257 + LengthCode(s.litLen)]++;
+            distFreq[DistCode(s.dist)]++;
+        }
+    }
+
+    // 动态 Huffman 码表
+    uint8_t litLen[kLitLenCodes];
+    uint8_t distLen[kDistCodes];
+    BuildCodeLengths(litFreq, kLitLenCodes, 15, litLen);
+    BuildCodeLengths(distFreq, kDistCodes, 15, distLen);
+    int hlit = kLitLenCodes;
+    while (hlit > 257 && litLen[hlit - 1] == 0) hlit--;
+    int hdist = kDistCodes;
+    while (hdist > 1 && distLen[hdist - 1] == 0) hdist--;
+
+    std::vector<uint8_t> allLengths(litLen, litLen + hlit);
+    allLengths.insert(allLengths.end(), distLen, distLen + hdist);
+    std::vector<CodeLenSymbol> clSymbols = EncodeCodeLengths(allLengths.data(), static_cast<int>(allLengths.size()));
+    uint32_t clFreq[kCodeLenCodes] = {};
+    for (const CodeLenSymbol& s : clSymbols) clFreq[s.symbol]++;
+    uint8_t clLen[kCodeLenCodes];
+    BuildCodeLengths(clFreq, kCodeLenCodes, 7, clLen);
+    int hclen = kCodeLenCodes;
+    while (hclen > 4 && clLen[kCodeLenOrder[hclen - 1]] == 0) hclen--;
+
+    // 三种块的位数
+    const FixedTables& fixed = Fixed();
+    uint64_t dataDynamic = 0;
+    uint64_t dataFixed = 0;
+    for (int i = 0; i < kLitLenCodes; ++i) {
+        uint32_t extra = i >= 257 ? kLengthExtra[i - 257] : 0;
+        dataDynamic += static_cast<uint64_t>(litFreq[i]) * (litLen[i] + extra);
+        dataFixed += static_cast<uint64_t>(litFreq[i]) * (fixed.litLen[i] + extra);
+    }
+    for (int i = 0; i < kDistCodes; ++i) {
+        dataDynamic += static_cast<uint64_t>(distFreq[i]) * (distLen[i] + kDistExtra[i]);
+        dataFixed += static_cast<uint64_t>(distFreq[i]) * (5 + kDistExtra[i]);
+    }
+    uint64_t headerDynamic = 5 + 5 + 4 + 3 * static_cast<uint64_t>(hclen);
+    for (const CodeLenSymbol& s : clSymbols) {
+        headerDynamic += clLen[s.symbol] + (s.symbol >= 16 ? kCodeLenExtraBits[s.symbol - 16] : 0);
+    }
+    uint64_t dynamicBits = 3 + headerDynamic + dataDynamic;
+    uint64_t fixedBits = 3 + dataFixed;
+    size_t rawSize = rawEnd - rawBegin;
+    uint64_t storedBits = (rawSize / 65535 + 1) * (3 + 7 + 32) + 8 * static_cast<uint64_t>(rawSize);
+
+    if (storedBits <= dynamicBits && storedBits <= fixedBits) {
+        size_t offset = rawBegin;
+        do {
+            size_t n = std::min<size_t>(rawEnd - offset, 65535);
+            bool last = offset + n >= rawEnd;
+            putBits(final && last ? 1 : 0, 1, out);
+            putBits(0, 2, out);
+            alignToByte(out);
+            putBits(static_cast<uint32_t>(n), 16, out);
+            putBits(static_cast<uint32_t>(~n & 0xFFFF), 16, out);
+            out.append(window_, offset, n);
+            offset += n;
+        } while (offset < rawEnd);
+        return;
+    }
+
+    uint16_t litCode[kLitLenCodes];
+    uint16_t distCode[kDistCodes];
+    const uint8_t* litLens = litLen;
+    const uint8_t* distLens = distLen;
+    const uint16_t* litCodes = litCode;
+    const uint16_t* distCodes = distCode;
+
+    putBits(final ? 1 : 0, 1, out);
+    if (fixedBits <= dynamicBits) {
+        putBits(1, 2, out);
+        litLens = fixed.litLen;
+        distLens = fixed.dist;
+        litCodes = fixed.litCode;
+        distCodes = fixed.distCode;
+    } else {
+        putBits(2, 2, out);
+        BuildCodes(litLen, kLitLenCodes, litCode);
+        BuildCodes(distLen, kDistCodes, distCode);
+        uint16_t clCode[kCodeLenCodes];
+        BuildCodes(clLen, kCodeLenCodes, clCode);
+
+        putBits(static_cast<uint32_t>(hlit - 257), 5, out);
+        putBits(static_cast<uint32_t>(hdist - 1), 5, out);
+        putBits(static_cast<uint32_t>(hclen - 4), 4, out);
+        for (int i = 0; i < hclen; ++i) putBits(clLen[kCodeLenOrder[i]], 3, out);
+        for (const CodeLenSymbol& s : clSymbols) {
+            putBits(clCode[s.symbol], clLen[s.symbol], out);
+            if (s.symbol >= 16) putBits(s.extra, kCodeLenExtraBits[s.symbol - 16], out);
+        }
+    }
+
+    for (const Symbol& s : symbols) {
+        if (s.dist == 0) {
+            putBits(litCodes[s.litLen], litLens[s.litLen], out);
+            continue;
+        }
+        int lc = LengthCode(s.litLen);
+        putBits(litCodes[257 + lc], litLens[257 + lc], out);
+        if (kLengthExtra[lc]) putBits(s.litLen - kLengthBase[lc], kLengthExtra[lc], out);
+        int dc = DistCode(s.dist);
+        putBits(distCodes[dc], distLens[dc], out);
+        if (kDistExtra[dc]) putBits(s.dist - kDistBase[dc], kDistExtra[dc], out);
+    }
+    putBits(litCodes[kEndOfBlock], litLens[kEndOfBlock], out);
+}
+
+// 已压缩的数据只保留最后 32 KB 作为匹配窗口，哈希链中的位置随之平移
+void DeflateEncoder::slideWindow() {
+    if (pos_ <= 2 * kWindowSize) return;
+    size_t shift = pos_ - kWindowSize;
+    window_.erase(0, shift);
+    auto rebase = [shift](int32_t& p) {
+        p = p >= static_cast<int32_t>(shift) ? p - static_cast<int32_t>(shift) : -1;
+    };
+    for (int32_t& p : head_) rebase(p);
+    if (prev_.size() > shift) {
+        prev_.erase(prev_.begin(), prev_.begin() + static_cast<std::ptrdiff_t>(shift));
+        for (int32_t& p : prev_) rebase(p);
+    } else {
+        prev_.clear();
+    }
+    pos_ -= shift;
+    hashed_ = hashed_ > shift ? hashed_ - shift : 0;
+}
+
+std::string DeflateCompress(std::string_view data, DeflateEncoder::Format format, int level) {
+    DeflateEncoder encoder(format, level);
+    std::string out;
+    out.reserve(data.size() / 4 + 64);
+    encoder.write(data, out);
+    encoder.finish(out);
+    return out;
+}
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "http/http_request.h"
+#include <cstring>
+
+static const size_t kMaxHeaderCount = 100;
+
+static inline char AsciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+static inline bool IsTokenChar(char c) {
+    // RFC 7230 tchar
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) return true;
+    return std::strchr("!#$%&'*+-.^_`|~", c) != nullptr && c != '\0';
+}
+
+static inline int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (AsciiLower(a[i]) != AsciiLower(b[i])) return false;
+    }
+    return true;
+}
+
+std::string DecodeUrlComponent(std::string_view in) {
+    std::string out;
+    out.reserve(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        char c = in[i];
+        if (c == '%' && i + 2 < in.size()) {
+            int hi = HexValue(in[i + 1]);
+            int lo = HexValue(in[i + 2]);
+            if (hi >= 0 && lo >= 0) {
+                out += static_cast<char>((hi << 4) | lo);
+                i += 2;
+                continue;
+            }
+        }
+        out += (c == '+') ? ' ' : c;
+    }
+    return out;
+}
+
+// ── HttpRequest ───────────────────────────────────────────
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (const auto& h : headers) {
+        if (EqualsIgnoreCase(h.name, name)) return h.value;
+    }
+    return std::string_view();
+}
+
+void HttpRequest::attachBody(std::string body) {
+    bodyData_ = std::move(body);
+    this->body = bodyData_;
+}
+
+bool HttpRequest::hasHeader(std::string_view name) const {
+    for (const auto& h : headers) {
+        if (EqualsIgnoreCase(h.name, name)) return true;
+    }
+    return false;
+}
+
+std::string HttpRequest::queryParam(const std::string& key) const {
+    auto it = query.find(key);
+    return it == query.end() ? std::string() : it->second;
+}
+
+static void ParseQueryString(std::string_view qs, std::map<std::string, std::string>& out) {
+    while (!qs.empty()) {
+        size_t amp = qs.find('&');
+        std::string_view pair = qs.substr(0, amp);
+        qs = amp == std::string_view::npos ? std::string_view() : qs.substr(amp + 1);
+        if (pair.empty()) continue;
+        size_t eq = pair.find('=');
+        std::string key = DecodeUrlComponent(pair.substr(0, eq));
+        std::string value = eq == std::string_view::npos ? std::string() : DecodeUrlComponent(pair.substr(eq + 1));
+        out.emplace(std::move(key), std::move(value));
+    }
+}
+
+// ── HttpRequestParser ─────────────────────────────────────
+
+HttpRequestParser::HttpRequestParser(size_t maxHeaderBytes, size_t maxBodyBytes)
+    : maxHeaderBytes_(maxHeaderBytes), maxBodyBytes_(maxBodyBytes) {}
+
+void HttpRequestParser::reset() {
+    state_ = State::RequestLine;
+    scanPos_ = 0;
+    lineStart_ = 0;
+    bodyStart_ = 0;
+    contentLength_ = 0;
+    hasContentLength_ = false;
+    errorStatus_ = 0;
+    method_ = Span();
+    target_ = Span();
+    version_ = Span();
+    headers_.clear();
+}
+
+HttpRequestParser::Status HttpRequestParser::fail(int status) {
+    state_ = State::Error;
+    errorStatus_ = status;
+    return Status::Error;
+}
+
+// "METHOD SP request-target SP HTTP/x.y"
+bool HttpRequestParser::parseRequestLine(const char* data, size_t begin, size_t end) {
+    size_t sp1 = begin;
+    while (sp1 < end && data[sp1] != ' ') {
+        if (!IsTokenChar(data[sp1])) return false;
+        ++sp1;
+    }
+    if (sp1 == begin || sp1 >= end) return false;
+
+    size_t targetBegin = sp1 + 1;
+    size_t sp2 = targetBegin;
+    while (sp2 < end && data[sp2] != ' ') {
+        unsigned char c = static_cast<unsigned char>(data[sp2]);
+        if (c <= 0x20 || c == 0x7F) return false;
+        ++sp2;
+    }
+    if (sp2 == targetBegin || sp2 >= end) return false;
+
+    size_t versionBegin = sp2 + 1;
+    size_t versionLen = end - versionBegin;
+    if (versionLen != 8 || std::memcmp(data + versionBegin, "HTTP/1.", 7) != 0 ||
+        (data[versionBegin + 7] != '0' && data[versionBegin + 7] != '1')) {
+        return false;
+    }
+
+    method_ = {begin, sp1 - begin};
+    target_ = {targetBegin, sp2 - targetBegin};
+    version_ = {versionBegin, versionLen};
+    return true;
+}
+
+// "name: OWS value OWS"；同时识别 Content-Length / Transfer-Encoding
+bool HttpRequestParser::parseHeaderLine(const char* data, size_t begin, size_t end) {
+    size_t colon = begin;
+    while (colon < end && data[colon] != ':') {
+        if (!IsTokenChar(data[colon])) return false;  // 包括 name 与冒号之间的空白
+        ++colon;
+    }
+    if (colon == begin || colon >= end) return false;
+
+    size_t vb = colon + 1;
+    size_t ve = end;
+    while (vb < ve && (data[vb] == ' ' || data[vb] == '\t')) ++vb;
+    while (ve > vb && (data[ve - 1] == ' ' || data[ve - 1] == '\t')) --ve;
+
+    std::string_view name(data + begin, colon - begin);
+    std::string_view value(data + vb, ve - vb);
+
+    if (EqualsIgnoreCase(name, "content-length")) {
+        if (value.empty()) return false;
+        size_t length = 0;
+        for (char c : value) {
+            if (c < '0' || c > '9') return false;
+            if (length > (static_cast<size_t>(-1) - 9) / 10) return false;
+            length = length * 10 + static_cast<size_t>(c - '0');
+        }
+        if (hasContentLength_ && length != contentLength_) return false;
+        hasContentLength_ = true;
+        contentLength_ = length;
+    } else if (EqualsIgnoreCase(name, "transfer-encoding")) {
+        // 不支持分块请求体；标记后在 header 结束时返回 501
+        errorStatus_ = 501;
+    }
+
+    headers_.push_back({{begin, colon - begin}, {vb, ve - vb}});
+    return true;
+}
+
+// 扫描请求行和 header；header 结束（进入 Body 状态）时返回 Complete
+HttpRequestParser::Status HttpRequestParser::scanHead(const std::string& buf) {
+    const char* data = buf.data();
+    const size_t size = buf.size();
+
+    while (state_ == State::RequestLine || state_ == State::Headers) {
+        const void* nl = scanPos_ < size ? std::memchr(data + scanPos_, '\n', size - scanPos_) : nullptr;
+        if (!nl) {
+            scanPos_ = size;
+            if (size > maxHeaderBytes_) return fail(431);
+            return Status::NeedMore;
+        }
+        size_t lineEnd = static_cast<const char*>(nl) - data;
+        scanPos_ = lineEnd + 1;
+        if (scanPos_ > maxHeaderBytes_) return fail(431);
+
+        size_t contentEnd = (lineEnd > lineStart_ && data[lineEnd - 1] == '\r') ? lineEnd - 1 : lineEnd;
+
+        if (state_ == State::RequestLine) {
+            // RFC 7230 3.5: 请求行之前的空行应忽略
+            if (contentEnd == lineStart_) {
+                lineStart_ = scanPos_;
+                continue;
+            }
+            if (!parseRequestLine(data, lineStart_, contentEnd)) return fail(400);
+            state_ = State::Headers;
+        } else if (contentEnd == lineStart_) {
+            // 空行：header 结束
+            if (errorStatus_ == 501) return fail(501);
+            bodyStart_ = scanPos_;
+            state_ = State::Body;
+        } else {
+            if (data[lineStart_] == ' ' || data[lineStart_] == '\t') return fail(400);  // obs-fold
+            if (headers_.size() >= kMaxHeaderCount) return fail(431);
+            if (!parseHeaderLine(data, lineStart_, contentEnd)) return fail(400);
+        }
+        lineStart_ = scanPos_;
+    }
+    return state_ == State::Error ? Status::Error : Status::Complete;
+}
+
+HttpRequestParser::Status HttpRequestParser::parseHead(const std::string& buf) {
+    return scanHead(buf);
+}
+
+HttpRequestParser::Status HttpRequestParser::parse(const std::string& buf) {
+    Status status = scanHead(buf);
+    if (status != Status::Complete) return status;
+
+    if (state_ == State::Body) {
+        if (contentLength_ > maxBodyBytes_) return fail(413);
+        if (buf.size() - bodyStart_ < contentLength_) return Status::NeedMore;
+        state_ = State::Complete;
+    }
+    return Status::Complete;
+}
+
+std::unique_ptr<HttpRequest> HttpRequestParser::take(std::string& buf) {
+    if (state_ != State::Complete) return nullptr;
+    return build(buf, bodyStart_ + contentLength_);
+}
+
+std::unique_ptr<HttpRequest> HttpRequestParser::takeHead(std::string& buf) {
+    if (state_ != State::Body && state_ != State::Complete) return nullptr;
+    contentLength_ = 0;  // body 由调用方接收
+    return build(buf, bodyStart_);
+}
+
+// 把 buf 开头 total 字节移交给新请求，建立各字段的 view 并重置解析器
+std::unique_ptr<HttpRequest> HttpRequestParser::build(std::string& buf, size_t total) {
+    std::unique_ptr<HttpRequest> req(new HttpRequest());
+    if (buf.size() == total) {
+        req->data_ = std::move(buf);
+        buf.clear();
+    } else {
+        // pipelining：只拷贝本请求，剩余字节留在 buf 开头
+        req->data_.assign(buf, 0, total);
+        buf.erase(0, total);
+    }
+
+    std::string_view d(req->data_);
+    req->method = d.substr(method_.offset, method_.length);
+    req->target = d.substr(target_.offset, target_.length);
+    req->version = d.substr(version_.offset, version_.length);
+    req->body = d.substr(bodyStart_, contentLength_);
+    req->headLength_ = bodyStart_;
+
+    size_t q = req->target.find('?');
+    req->path = req->target.substr(0, q);
+    if (q != std::string_view::npos) {
+        std::string_view qs = req->target.substr(q + 1);
+        size_t hash = qs.find('#');
+        ParseQueryString(qs.substr(0, hash), req->query);
+    }
+
+    req->headers.reserve(headers_.size());
+    for (const auto& h : headers_) {
+        req->headers.push_back({d.substr(h.name.offset, h.name.length), d.substr(h.value.offset, h.value.length)});
+    }
+
+    reset();
+    return req;
+}
+
+std::unique_ptr<HttpRequest> ParseHttpRequest(std::string raw) {
+    HttpRequestParser parser(raw.size(), raw.size());
+    if (parser.parse(raw) != HttpRequestParser::Status::Complete) {
+        return nullptr;
+    }
+    return parser.take(raw);
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "http/http_response.h"
+#include "http/http_request.h"
+
+HttpResponse::HttpResponse(int status) : status_(status) {}
+
+const char* HttpResponse::ReasonPhrase(int status) {
+    switch (status) {
+    case 100: return "Continue";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 415: return "Unsupported Media Type";
+    case 416: return "Range Not Satisfiable";
+    case 417: return "Expectation Failed";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default:  return "Unknown";
+    }
+}
+
+void HttpResponse::thaw() {
+    if (!frozen_) return;
+    std::vector<Header> all = frozen_->headers;
+    all.insert(all.end(), headers_.begin(), headers_.end());
+    headers_ = std::move(all);
+    frozen_.reset();
+}
+
+void HttpResponse::setStatus(int status) {
+    if (status == status_) return;
+    thaw();
+    status_ = status;
+}
+
+void HttpResponse::addHeader(std::string name, std::string value) {
+    headers_.emplace_back(std::move(name), std::move(value));
+}
+
+void HttpResponse::setHeader(const std::string& name, std::string value) {
+    if (frozen_) {
+        for (const auto& h : frozen_->headers) {
+            if (EqualsIgnoreCase(h.first, name)) {
+                thaw();
+                break;
+            }
+        }
+    }
+    for (auto& h : headers_) {
+        if (EqualsIgnoreCase(h.first, name)) {
+            h.second = std::move(value);
+            return;
+        }
+    }
+    headers_.emplace_back(name, std::move(value));
+}
+
+std::string_view HttpResponse::header(std::string_view name) const {
+    if (frozen_) {
+        for (const auto& h : frozen_->headers) {
+            if (EqualsIgnoreCase(h.first, name)) return h.second;
+        }
+    }
+    for (const auto& h : headers_) {
+        if (EqualsIgnoreCase(h.first, name)) return h.second;
+    }
+    return std::string_view();
+}
+
+void HttpResponse::setBody(std::string body) {
+    thaw();
+    body_.clear();
+    contentLength_ = 0;
+    producer_ = nullptr;
+    asyncStarter_ = nullptr;
+    if (!body.empty()) {
+        appendBody(std::move(body));
+    }
+}
+
+void HttpResponse::appendBody(std::string data) {
+    appendBody(std::make_shared<const std::string>(std::move(data)));
+}
+
+void HttpResponse::appendBody(Buffer data) {
+    if (!data || data->empty()) return;
+    thaw();
+    contentLength_ += data->size();
+    HttpBodyPart part;
+    part.data = std::move(data);
+    body_.push_back(std::move(part));
+}
+
+void HttpResponse::appendFile(std::shared_ptr<FileHandle> file, uint64_t offset, uint64_t length) {
+    if (!file || length == 0) return;
+    thaw();
+    contentLength_ += length;
+    HttpBodyPart part;
+    part.file = std::move(file);
+    part.fileOffset = offset;
+    part.fileLength = length;
+    body_.push_back(std::move(part));
+}
+
+void HttpResponse::setStreamBody(HttpBodyProducer producer) {
+    thaw();
+    body_.clear();
+    contentLength_ = 0;
+    producer_ = std::move(producer);
+    asyncStarter_ = nullptr;
+}
+
+void HttpResponse::setAsyncBody(HttpAsyncBodyStarter starter) {
+    thaw();
+    body_.clear();
+    contentLength_ = 0;
+    producer_ = nullptr;
+    asyncStarter_ = std::move(starter);
+}
+
+std::string HttpResponse::renderHead(bool includeFrozen) const {
+    std::string head;
+    if (includeFrozen) {
+        head.reserve(128 + headers_.size() * 48);
+        head += "HTTP/1.1 ";
+        head += std::to_string(status_);
+        head += ' ';
+        head += ReasonPhrase(status_);
+        head += "\r\n";
+    }
+    for (const auto& h : headers_) {
+        head += h.first;
+        head += ": ";
+        head += h.second;
+        head += "\r\n";
+    }
+    bool bodyless = (status_ >= 100 && status_ < 200) || status_ == 204 || status_ == 304;
+    if (includeFrozen && !bodyless) {
+        if (isStreaming()) {
+            head += "Transfer-Encoding: chunked\r\n";
+        } else {
+            head += "Content-Length: ";
+            head += std::to_string(contentLength_);
+            head += "\r\n";
+        }
+    }
+    return head;
+}
+
+HttpResponse& HttpResponse::freeze() {
+    thaw();
+    auto frozen = std::make_shared<Frozen>();
+    frozen->head = renderHead(true);
+    frozen->headers = std::move(headers_);
+    headers_.clear();
+    frozen_ = std::move(frozen);
+    return *this;
+}
+
+std::vector<HttpBodyPart> HttpResponse::serialize() const {
+    std::vector<HttpBodyPart> parts;
+    parts.reserve(body_.size() + 2);
+
+    HttpBodyPart head;
+    if (frozen_) {
+        // 共享冻结的响应头（aliasing 构造，不拷贝）
+        head.data = Buffer(frozen_, &frozen_->head);
+        parts.push_back(std::move(head));
+        static const Buffer kBlankLine = std::make_shared<const std::string>("\r\n");
+        HttpBodyPart tail;
+        tail.data = headers_.empty() ? kBlankLine : std::make_shared<const std::string>(renderHead(false) + "\r\n");
+        parts.push_back(std::move(tail));
+    } else {
+        head.data = std::make_shared<const std::string>(renderHead(true) + "\r\n");
+        parts.push_back(std::move(head));
+    }
+    parts.insert(parts.end(), body_.begin(), body_.end());
+    return parts;
+}
+
+std::string HttpResponse::toString() const {
+    std::string out;
+    for (const auto& part : serialize()) {
+        if (!part.isFile()) out += *part.data;
+    }
+    return out;
+}
+
+HttpResponse MakeJsonResponse(int status, std::string body) {
+    HttpResponse response(status);
+    response.addHeader("Content-Type", "application/json");
+    response.addHeader("Access-Control-Allow-Origin", "*");
+    response.setBody(std::move(body));
+    return response;
+}
+
+HttpResponse MakeJsonStreamResponse(HttpBodyProducer producer) {
+    HttpResponse response(200);
+    response.addHeader("Content-Type", "application/json");
+    response.addHeader("Access-Control-Allow-Origin", "*");
+    response.setStreamBody(std::move(producer));
+    return response;
+}
+
+const HttpResponse& AcceptedResponse() {
+    static const HttpResponse accepted = [] {
+        HttpResponse r(202);
+        r.addHeader("Access-Control-Allow-Origin", "*");
+        r.freeze();
+        return r;
+    }();
+    return accepted;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "http/http_router.h"
+#include <stdexcept>
+
+HttpRoute& HttpRouter::add(std::string method, std::string path, HttpRouteHandler handler) {
+    return insert(exact_, std::move(method), std::move(path), false, std::move(handler));
+}
+
+HttpRoute& HttpRouter::addPrefix(std::string method, std::string prefix, HttpRouteHandler handler) {
+    if (prefix.empty() || prefix.back() != '/') {
+        throw std::logic_error("route prefix must end with '/': " + prefix);
+    }
+    return insert(prefix_, std::move(method), std::move(prefix), true, std::move(handler));
+}
+
+HttpRoute& HttpRouter::insert(PathTable& table, std::string method, std::string path, bool prefix,
+                              HttpRouteHandler handler) {
+    auto it = table.find(path);
+    if (it == table.end()) {
+        auto entry = std::make_unique<PathEntry>();
+        entry->path = path;
+        std::string_view key = entry->path;  // 键指向 entry 自己持有的字符串
+        it = table.emplace(key, std::move(entry)).first;
+    }
+    PathEntry& entry = *it->second;
+
+    bool duplicate = method.empty() && entry.anyMethod;
+    for (const HttpRoute* existing : entry.routes) {
+        duplicate = duplicate || existing->method == method;
+    }
+    if (duplicate) {
+        throw std::logic_error("duplicate route: " + (method.empty() ? std::string("*") : method) + " " + path);
+    }
+
+    routes_.emplace_back();
+    HttpRoute& route = routes_.back();
+    route.method = std::move(method);
+    route.path = std::move(path);
+    route.prefix = prefix;
+    route.handler = std::move(handler);
+
+    if (route.method.empty()) {
+        entry.anyMethod = &route;
+    } else {
+        entry.routes.push_back(&route);
+        if (!entry.allow.empty()) entry.allow += ", ";
+        entry.allow += route.method;
+    }
+    return route;
+}
+
+const HttpRoute* HttpRouter::select(const PathEntry& entry, std::string_view method) {
+    for (const HttpRoute* route : entry.routes) {
+        if (route->method == method) return route;
+    }
+    return entry.anyMethod;
+}
+
+HttpRouteMatch HttpRouter::match(std::string_view method, std::string_view path) const {
+    HttpRouteMatch result;
+    const PathEntry* known = nullptr;  // 路径存在但方法不匹配时用于 Allow
+
+    auto exact = exact_.find(path);
+    if (exact != exact_.end()) {
+        if ((result.route = select(*exact->second, method))) return result;
+        known = exact->second.get();
+    }
+
+    // 从最长的 '/' 边界前缀开始，每段一次哈希查找
+    if (!prefix_.empty()) {
+        size_t end = path.size();
+        while (end > 0) {
+            size_t slash = path.rfind('/', end - 1);
+            if (slash == std::string_view::npos) break;
+            auto it = prefix_.find(path.substr(0, slash + 1));
+            if (it != prefix_.end()) {
+                if ((result.route = select(*it->second, method))) return result;
+                if (!known) known = it->second.get();
+            }
+            end = slash;
+        }
+    }
+
+    if (known) result.allow = known->allow;
+    return result;
+}
+
+HttpBodyPolicy HttpRouter::bodyPolicy(const HttpRequest& head) const {
+    const HttpRoute* route = match(head.method, head.path).route;
+    if (!route) {
+        return {defaultBodyLimit_, false};
+    }
+    HttpBodyPolicy policy;
+    policy.maxBytes = route->maxBodyBytes ? route->maxBodyBytes : defaultBodyLimit_;
+    policy.streaming = route->streamBodyIf ? route->streamBodyIf(head) : route->streamBody;
+    return policy;
+}
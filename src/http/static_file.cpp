@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "http/static_file.h"
+#include <cstdio>
+
+// ── MIME ──────────────────────────────────────────────────
+
+struct MimeEntry {
+    const char* extension;
+    const char* type;
+};
+
+static const MimeEntry kMimeTypes[] = {
+    {"png", "image/png"},
+    {"jpg", "image/jpeg"},
+    {"jpeg", "image/jpeg"},
+    {"gif", "image/gif"},
+    {"bmp", "image/bmp"},
+    {"webp", "image/webp"},
+    {"ico", "image/x-icon"},
+    {"svg", "image/svg+xml"},
+    {"tif", "image/tiff"},
+    {"tiff", "image/tiff"},
+    {"txt", "text/plain; charset=utf-8"},
+    {"log", "text/plain; charset=utf-8"},
+    {"md", "text/markdown; charset=utf-8"},
+    {"csv", "text/csv; charset=utf-8"},
+    {"htm", "text/html; charset=utf-8"},
+    {"html", "text/html; charset=utf-8"},
+    {"css", "text/css; charset=utf-8"},
+    {"js", "text/javascript; charset=utf-8"},
+    {"json", "application/json"},
+    {"xml", "application/xml"},
+    {"pdf", "application/pdf"},
+    {"zip", "application/zip"},
+    {"gz", "application/gzip"},
+    {"7z", "application/x-7z-compressed"},
+    {"doc", "application/msword"},
+    {"docx", "application/vnd.openxmlformats-officedocument.wordprocessingml.document"},
+    {"xls", "application/vnd.ms-excel"},
+    {"xlsx", "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"},
+    {"ppt", "application/vnd.ms-powerpoint"},
+    {"pptx", "application/vnd.openxmlformats-officedocument.presentationml.presentation"},
+    {"mp3", "audio/mpeg"},
+    {"wav", "audio/wav"},
+    {"mp4", "video/mp4"},
+    {"webm", "video/webm"},
+};
+
+const char* GuessMimeType(std::string_view fileName) {
+    size_t dot = fileName.find_last_of('.');
+    if (dot != std::string_view::npos) {
+        std::string_view ext = fileName.substr(dot + 1);
+        for (const MimeEntry& entry : kMimeTypes) {
+            if (EqualsIgnoreCase(ext, entry.extension)) {
+                return entry.type;
+            }
+        }
+    }
+    return "application/octet-stream";
+}
+
+// ── HTTP 日期 ─────────────────────────────────────────────
+
+static const char* const kWeekdays[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static const char* const kMonths[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                      "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+// 公历日期与 1970-01-01 起天数的互相换算（与平台 timegm/gmtime 无关）
+static int64_t DaysFromCivil(int64_t y, int m, int d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void CivilFromDays(int64_t z, int64_t& y, int& m, int& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    y = yoe + era * 400 + (m <= 2);
+}
+
+static int64_t FloorDiv(int64_t a, int64_t b) {
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+std::string FormatHttpDate(int64_t unixSeconds) {
+    int64_t days = FloorDiv(unixSeconds, 86400);
+    int64_t secs = unixSeconds - days * 86400;
+    int64_t year;
+    int month, day;
+    CivilFromDays(days, year, month, day);
+    int weekday = static_cast<int>(((days % 7) + 11) % 7);  // 1970-01-01 是星期四
+
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%s, %02d %s %04lld %02d:%02d:%02d GMT",
+             kWeekdays[weekday], day, kMonths[month - 1], static_cast<long long>(year),
+             static_cast<int>(secs / 3600), static_cast<int>(secs / 60 % 60), static_cast<int>(secs % 60));
+    return buf;
+}
+
+static bool ParseDigits(std::string_view text, size_t pos, size_t count, int& out) {
+    out = 0;
+    for (size_t i = pos; i < pos + count; ++i) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        out = out * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+bool ParseHttpDate(std::string_view text, int64_t& unixSeconds) {
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    if (text.size() != 29 || text.substr(3, 2) != ", " || text[7] != ' ' || text[11] != ' ' ||
+        text[16] != ' ' || text[19] != ':' || text[22] != ':' || text.substr(25) != " GMT") {
+        return false;
+    }
+    int day, year, hour, minute, second;
+    if (!ParseDigits(text, 5, 2, day) || !ParseDigits(text, 12, 4, year) || !ParseDigits(text, 17, 2, hour) ||
+        !ParseDigits(text, 20, 2, minute) || !ParseDigits(text, 23, 2, second)) {
+        return false;
+    }
+    int month = 0;
+    for (int i = 0; i < 12; ++i) {
+        if (text.substr(8, 3) == kMonths[i]) {
+            month = i + 1;
+            break;
+        }
+    }
+    if (month == 0 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+    unixSeconds = DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+// ── Range ─────────────────────────────────────────────────
+
+static std::string_view Trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+static bool ParseUint64(std::string_view s, uint64_t& out) {
+    if (s.empty()) return false;
+    out = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        if (out > (UINT64_MAX - 9) / 10) return false;
+        out = out * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return true;
+}
+
+int ParseByteRange(std::string_view header, uint64_t fileSize, uint64_t& offset, uint64_t& length) {
+    header = Trim(header);
+    if (header.size() < 6 || !EqualsIgnoreCase(header.substr(0, 6), "bytes=")) return -1;
+    std::string_view spec = Trim(header.substr(6));
+    if (spec.find(',') != std::string_view::npos) return -1;  // 多区间（multipart/byteranges）不支持
+    size_t dash = spec.find('-');
+    if (dash == std::string_view::npos) return -1;
+    std::string_view first = Trim(spec.substr(0, dash));
+    std::string_view last = Trim(spec.substr(dash + 1));
+
+    if (first.empty()) {
+        // 后缀区间：最后 N 个字节
+        uint64_t suffix;
+        if (!ParseUint64(last, suffix)) return -1;
+        if (suffix == 0 || fileSize == 0) return 0;
+        if (suffix > fileSize) suffix = fileSize;
+        offset = fileSize - suffix;
+        length = suffix;
+        return 1;
+    }
+
+    uint64_t begin;
+    if (!ParseUint64(first, begin)) return -1;
+    uint64_t end = UINT64_MAX;
+    if (!last.empty()) {
+        if (!ParseUint64(last, end) || end < begin) return -1;
+    }
+    if (begin >= fileSize) return 0;
+    if (end >= fileSize) end = fileSize - 1;
+    offset = begin;
+    length = end - begin + 1;
+    return 1;
+}
+
+// ── 条件请求 ──────────────────────────────────────────────
+
+static std::string MakeETag(const FileHandle& file) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "\"%llx-%llx\"", static_cast<unsigned long long>(file.size()),
+             static_cast<unsigned long long>(file.modifiedTime()));
+    return buf;
+}
+
+bool ETagListMatches(std::string_view list, std::string_view etag) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view item = Trim(list.substr(0, comma));
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+        if (item == "*") return true;
+        if (item.size() > 2 && item.substr(0, 2) == "W/") item.remove_prefix(2);
+        if (item == etag) return true;
+    }
+    return false;
+}
+
+static bool IsNotModified(const HttpRequest& request, const std::string& etag, int64_t modifiedTime) {
+    std::string_view ifNoneMatch = request.header("if-none-match");
+    if (!ifNoneMatch.empty()) {
+        return ETagListMatches(ifNoneMatch, etag);  // 有 If-None-Match 时忽略 If-Modified-Since
+    }
+    int64_t since;
+    std::string_view ifModifiedSince = request.header("if-modified-since");
+    return !ifModifiedSince.empty() && ParseHttpDate(ifModifiedSince, since) && modifiedTime <= since;
+}
+
+// If-Range 只在强校验器完全一致时才允许返回部分内容
+static bool IfRangeMatches(const HttpRequest& request, const std::string& etag, const std::string& lastModified) {
+    std::string_view ifRange = Trim(request.header("if-range"));
+    if (ifRange.empty()) return true;
+    if (ifRange.front() == '"' || ifRange.substr(0, 2) == "W/") {
+        return ifRange == etag;
+    }
+    return ifRange == lastModified;
+}
+
+// ── ServeFile ─────────────────────────────────────────────
+
+HttpResponse ServeFile(const HttpRequest& request, const std::string& path, const char* contentType) {
+    std::shared_ptr<FileHandle> file = FileHandle::open(path);
+    if (!file) {
+        return MakeJsonResponse(404, "{\"error\":\"not found\"}");
+    }
+
+    std::string etag = MakeETag(*file);
+    std::string lastModified = FormatHttpDate(file->modifiedTime());
+
+    HttpResponse response(200);
+    response.addHeader("Access-Control-Allow-Origin", "*");
+    response.addHeader("ETag", etag);
+    response.addHeader("Last-Modified", lastModified);
+
+    if ((request.method == "GET" || request.method == "HEAD") && IsNotModified(request, etag, file->modifiedTime())) {
+        response.setStatus(304);
+        return response;
+    }
+
+    response.addHeader("Content-Type", contentType ? contentType : GuessMimeType(path));
+    response.addHeader("X-Content-Type-Options", "nosniff");
+    response.addHeader("Accept-Ranges", "bytes");
+
+    uint64_t offset = 0;
+    uint64_t length = file->size();
+    std::string_view range = request.header("range");
+    if (!range.empty() && request.method == "GET" && IfRangeMatches(request, etag, lastModified)) {
+        int result = ParseByteRange(range, file->size(), offset, length);
+        if (result == 0) {
+            HttpResponse unsatisfiable(416);
+            unsatisfiable.addHeader("Access-Control-Allow-Origin", "*");
+            unsatisfiable.addHeader("Content-Range", "bytes */" + std::to_string(file->size()));
+            return unsatisfiable;
+        }
+        if (result == 1) {
+            response.setStatus(206);
+            response.addHeader("Content-Range", "bytes " + std::to_string(offset) + "-" +
+                                                    std::to_string(offset + length - 1) + "/" +
+                                                    std::to_string(file->size()));
+        } else {
+            offset = 0;
+            length = file->size();
+        }
+    }
+
+    response.appendFile(std::move(file), offset, length);
+    return response;
+}
@@ -0,0 +1,1394 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "http_connection.h"
+#include "http/http_request.h"
+#include "http/http_response.h"
+#include "http_routes.h"
+#include "mcp_sse.h"
+#include "mcp_streamable.h"
+#include "net/tls_context.h"
+#include "app_core.h"
+#include "support/config_manager.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+
+static const size_t kMaxHttpHeaderSize  = 16 * 1024;       // 16 KB header 上限（body 上限按路由，见 GetRequestBodyPolicy）
+static const int    kWriteTimeoutMs     = 10000;           // 响应写出超时（基础值）
+static const size_t kMinSendBytesPerSec = 64 * 1024;       // 大响应按此速率放宽写超时
+static const int    kSseWriteTimeoutMs  = 5000;            // SSE 帧写出超时
+static const int    kSsePingIntervalMs  = 15000;           // SSE 心跳间隔
+static const size_t kMaxSseBacklog      = 1024 * 1024;     // SSE 未写出数据上限，超过视为慢客户端
+static const int    kBodyCheckMs        = 5000;            // 请求体停顿 / 速率检查周期（首个周期为宽限期）
+
+static const size_t kMaxSendBatch       = 256 * 1024;      // 一次 gather 写合并的内存块上限
+static const size_t kMaxSendBuffers     = 64;
+static const size_t kStreamChunkSize    = 16 * 1024;       // 流式响应攒到此大小再成块写出
+static const size_t kMaxStreamBacklog   = 256 * 1024;      // 流式响应未写出数据上限，超过时 producer 等待
+static const size_t kMaxBodyBacklog     = 256 * 1024;      // 流式请求体未被 handler 读走的上限，超过时暂停接收
+
+// 固定响应预先序列化，发送时只增加引用计数
+static const HttpResponse& ServerBusyResponse() {
+    static const HttpResponse response = [] {
+        HttpResponse r = MakeJsonResponse(503, "{\"error\":\"Server busy\"}");
+        r.addHeader("Retry-After", "1");
+        r.freeze();
+        return r;
+    }();
+    return response;
+}
+
+static const HttpResponse& TooManyRequestsResponse() {
+    static const HttpResponse response = [] {
+        HttpResponse r = MakeJsonResponse(429, "{\"error\":\"Too many requests\"}");
+        r.addHeader("Retry-After", "60");
+        r.freeze();
+        return r;
+    }();
+    return response;
+}
+
+static HttpResponse MakeParseErrorResponse(int status) {
+    return MakeJsonResponse(status, std::string("{\"error\":\"") + HttpResponse::ReasonPhrase(status) + "\"}");
+}
+
+// ── keep-alive ────────────────────────────────────────────
+
+// 客户端是否希望保持连接：HTTP/1.1 默认保持，HTTP/1.0 需显式 keep-alive。
+// （带 Transfer-Encoding 的请求在解析阶段已被拒绝）
+static bool ClientWantsKeepAlive(const HttpRequest& request) {
+    std::string connection(request.header("connection"));
+    std::transform(connection.begin(), connection.end(), connection.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (connection.find("close") != std::string::npos) {
+        return false;
+    }
+    if (connection.find("keep-alive") != std::string::npos) {
+        return true;
+    }
+    return request.version == "HTTP/1.1";
+}
+
+// 在响应头中写入 Connection（以及 Keep-Alive）头，返回最终是否保持连接
+static bool ApplyConnectionHeader(HttpResponse& response, bool keepAlive, int timeoutSec, int remaining) {
+    if (keepAlive) {
+        response.setHeader("Connection", "keep-alive");
+        response.setHeader("Keep-Alive", "timeout=" + std::to_string(timeoutSec) + ", max=" + std::to_string(remaining));
+    } else {
+        response.setHeader("Connection", "close");
+    }
+    return keepAlive;
+}
+
+// 在 worker 线程中执行路由处理，异常转为 500
+static HttpResponse DispatchRequest(const HttpRequest& request) {
+    try {
+        return HandleHttpRequest(request);
+    } catch (const std::exception& e) {
+        std::string safe = RedactAuthorizationHeader(std::string(request.raw().substr(0, 1024)));
+        AppendExceptionLogA(std::string("[HttpServerThread] std::exception: ") + e.what());
+        AppendExceptionLogA(std::string("[HttpServerThread] request(first 1024): ") + safe.substr(0, 1024));
+    } catch (...) {
+        std::string safe = RedactAuthorizationHeader(std::string(request.raw().substr(0, 1024)));
+        AppendExceptionLogA("[HttpServerThread] unknown exception");
+        AppendExceptionLogA(std::string("[HttpServerThread] request(first 1024): ") + safe.substr(0, 1024));
+    }
+    return MakeJsonResponse(500, "{\"error\":\"internal_error\"}");
+}
+
+// HTTP/1.0 客户端不支持 chunked：异步 body 只能在 worker 中等它结束
+static void CollectAsyncBody(HttpResponse& response) {
+    struct Collected {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::string body;
+        bool done = false;
+        bool ok = false;
+    };
+    class CollectSink : public HttpAsyncBodySink {
+    public:
+        explicit CollectSink(std::shared_ptr<Collected> state) : state_(std::move(state)) {}
+        ~CollectSink() override { finish(false); }
+
+        bool write(std::string data) override {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            if (state_->done) return false;
+            state_->body += data;
+            return true;
+        }
+        void finish(bool ok) override {
+            {
+                std::lock_guard<std::mutex> lock(state_->mutex);
+                if (state_->done) return;
+                state_->done = true;
+                state_->ok = ok;
+            }
+            state_->cv.notify_all();
+        }
+        bool cancelled() const override { return false; }
+
+    private:
+        std::shared_ptr<Collected> state_;
+    };
+
+    auto state = std::make_shared<Collected>();
+    try {
+        response.asyncStarter()(std::make_shared<CollectSink>(state));
+    } catch (const std::exception& e) {
+        AppendExceptionLogA(std::string("[HttpServerThread] async body: ") + e.what());
+    }
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&state]() { return state->done; });
+    if (state->ok) {
+        response.setBody(std::move(state->body));
+    } else {
+        response = MakeJsonResponse(500, "{\"error\":\"internal_error\"}");
+    }
+}
+
+// HTTP/1.0 客户端不支持 chunked：在 worker 中跑完 producer，改为普通的定长响应
+static void CollectStreamBody(HttpResponse& response) {
+    class BufferSink : public HttpBodySink {
+    public:
+        bool write(std::string_view data) override {
+            body.append(data.data(), data.size());
+            return true;
+        }
+        std::string body;
+    };
+
+    if (response.asyncStarter()) {
+        CollectAsyncBody(response);
+        return;
+    }
+    HttpBodyProducer producer = response.producer();
+    BufferSink sink;
+    try {
+        producer(sink);
+        response.setBody(std::move(sink.body));
+    } catch (const std::exception& e) {
+        AppendExceptionLogA(std::string("[HttpServerThread] stream producer: ") + e.what());
+        response = MakeJsonResponse(500, "{\"error\":\"internal_error\"}");
+    }
+}
+
+// chunked 编码的一块（payload 不能为空，空块表示结束）
+static std::string ChunkFrame(const std::string& payload) {
+    char size[24];
+    int n = snprintf(size, sizeof(size), "%zx\r\n", payload.size());
+    std::string frame;
+    frame.reserve(payload.size() + n + 2);
+    frame.append(size, n);
+    frame += payload;
+    frame += "\r\n";
+    return frame;
+}
+
+// ── 流式响应背压 ──────────────────────────────────────────
+//
+// producer 在 worker 线程中写入，reactor 每写出一批就释放相应字节；
+// 积压超过 kMaxStreamBacklog 时 producer 阻塞，连接关闭时唤醒并让 write() 返回 false。
+
+class StreamBackpressure {
+public:
+    bool acquire(size_t n) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return cancelled_ || pending_ < kMaxStreamBacklog; });
+        if (cancelled_) return false;
+        pending_ += n;
+        return true;
+    }
+
+    void release(size_t n) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = pending_ > n ? pending_ - n : 0;  // 同一批里可能含响应头，按 0 截断
+        }
+        cv_.notify_all();
+    }
+
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cancelled_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    bool cancelled() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cancelled_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t pending_ = 0;
+    bool cancelled_ = false;
+};
+
+// ── HttpConnection ────────────────────────────────────────
+//
+// 状态机（全部在 reactor 线程中推进）：
+//
+//   Reading ──完整请求──▶ Processing ──worker 完成──▶ Writing ──写完──▶ Reading（keep-alive）
+//                              │                         └──────────────▶ Closed
+//                              └──GET /sse、/mcp 成功──▶ Streaming ──断开/超时──▶ Closed
+//                                                    └──排空/会话关闭──▶ Writing（写完即关闭）
+//
+// 流式（chunked）响应在 Writing 状态下持续写出，直到 worker 中的 producer 结束并写出末尾的空块。
+//
+// header 收齐后按路由约定（GetRequestBodyPolicy）处理 body：超出上限直接 413；
+// 普通路由在 Reading 状态下收齐 body 再分发；流式路由立即分发，Processing 状态下
+// 继续接收 body 并交给 handler 的 HttpBodyReader。Expect: 100-continue 在需要 body 时才回复。
+//
+// TLS 连接（tls_ 非空）在收发两端加解密：收到的密文解出明文后再进入上述流程，
+// 待写出的段加密后再交给后端；文件区间无法交给内核直接发送，改为分批读入内存加密。
+// 握手计入 Header 时限。
+//
+// 截止时间由 reactor 定时器驱动，读、写各一个槽：
+//   读：Header（收齐请求头的总时限，逐字节慢发也会到期）、Body（周期检查停顿和平均速率）、
+//       Idle（keep-alive 空闲）
+//   写：Write（单批写出时限，按批大小放宽）、Ping（SSE 心跳）
+
+class HttpConnection : public IoHandler, public std::enable_shared_from_this<HttpConnection> {
+public:
+    enum class State { Reading, Processing, Writing, Streaming, Closed };
+
+    HttpConnection(HttpConnectionManager& manager, std::string peer, std::unique_ptr<TlsSession> tls)
+        : manager_(manager), reactor_(manager.reactor_), peer_(std::move(peer)), tls_(std::move(tls)),
+          parser_(kMaxHttpHeaderSize, 0) {}  // 只用 parseHead()，body 由连接按路由接收
+
+    // 注册到 reactor；失败时 socket 已关闭
+    bool attach(socket_t sock) {
+        channel_ = reactor_.backend().addSocket(sock, this);
+        if (!channel_) {
+            CloseSocket(sock);
+            return false;
+        }
+        return true;
+    }
+
+    void startReading() {
+        armRead(Deadline::Header, manager_.headerTimeoutMs_);
+        armRecv();
+    }
+
+    void onIoComplete(const IoResult& r) override {
+        if (r.op == IoOp::Recv) {
+            onRecv(r);
+        } else if (r.op == IoOp::Send) {
+            onSent(r);
+        }
+    }
+
+    // 发送一个完整响应；closeAfter 为 true 时写完即关闭
+    void sendResponse(HttpResponse response, bool closeAfter) {
+        if (state_ == State::Closed) return;
+        cancelTimer(readTimer_);
+        if (bodyIn_) {
+            // handler 没等 body 收完就给出了响应：剩余 body 不再接收，写完即断开
+            bodyIn_->cancel();
+            bodyIn_.reset();
+            if (!closeAfter) response.setHeader("Connection", "close");
+            closeAfter = true;
+        }
+        state_ = State::Writing;
+        closeAfterWrite_ = closeAfter;
+        if (closeAfter && response.header("connection").empty()) {
+            response.setHeader("Connection", "close");
+        }
+        for (HttpBodyPart& part : response.serialize()) {
+            outBytes_ += part.isFile() ? 0 : part.data->size();
+            outQueue_.push_back(std::move(part));
+        }
+        flush();
+    }
+
+    // 开始流式响应：先写出响应头，body 块由 worker 中的 ChunkedSink 陆续投递
+    void beginStream(HttpResponse response, std::shared_ptr<StreamBackpressure> stream, bool closeAfter) {
+        if (state_ == State::Closed) {
+            stream->cancel();
+            return;
+        }
+        stream_ = std::move(stream);
+        sendResponse(std::move(response), closeAfter);
+    }
+
+    // producer 结束：正常结束时写出末尾的空块；出错时直接断开，客户端据此得知响应不完整
+    void endStream(bool ok) {
+        if (state_ == State::Closed) return;
+        stream_.reset();
+        asyncStream_ = false;
+        if (!ok) {
+            close();
+            return;
+        }
+        queueWrite("0\r\n\r\n");
+    }
+
+    // 追加待写出的数据（SSE 帧、chunked 响应块、100 Continue）
+    void queueWrite(std::string data) {
+        if (state_ == State::Closed) return;
+        if ((state_ == State::Streaming || asyncStream_) && outBytes_ + data.size() > kMaxSseBacklog) {
+            AppendHttpServerLogA(asyncStream_ ? "[HttpServerThread] Client too slow, closing " + peer_
+                                              : "[SSE] Client too slow, closing " + streamSessionId_);
+            close();
+            return;
+        }
+        outBytes_ += data.size();
+        HttpBodyPart part;
+        part.data = std::make_shared<const std::string>(std::move(data));
+        outQueue_.push_back(std::move(part));
+        flush();
+    }
+
+    // SSE 响应头已排队：之后的事件按协商的编码压缩
+    void startSseEncoding(ContentCoding coding) {
+        if (coding != ContentCoding::Identity) {
+            sseCompressor_.reset(new StreamCompressor(coding, manager_.compression_.level));
+        }
+    }
+
+    // SSE 事件与心跳（每段单独 sync flush，客户端立即可解）
+    void queueSse(const std::string& data) {
+        queueWrite(sseCompressor_ ? sseCompressor_->compress(data) : data);
+    }
+
+    // 有序结束 SSE 流：写完已排队的事件（以及压缩流的结尾）后关闭连接
+    void finishStreaming() {
+        if (state_ != State::Streaming) return;
+        if (!sending_) cancelTimer(writeTimer_);  // 心跳；写出中时是写超时，保留
+        state_ = State::Writing;
+        closeAfterWrite_ = true;
+        if (sseCompressor_) {
+            std::string tail = sseCompressor_->finish();
+            sseCompressor_.reset();
+            if (!tail.empty()) queueWrite(std::move(tail));
+        }
+        if (!sending_ && outQueue_.empty()) {
+            close();
+        }
+    }
+
+    // 服务器排空：空闲连接立即关闭，SSE 流有序结束；进行中的请求照常完成，
+    // 写完响应后由 onSent 关闭
+    void drain() {
+        if (state_ == State::Streaming) {
+            finishStreaming();
+        } else if (state_ == State::Reading && inbuf_.empty() && !pending_ && !bodyIn_) {
+            close();
+        }
+    }
+
+    // GET /sse 或 GET /mcp 已在 worker 中完成握手，连接转为事件流。sseSession 为 true 时
+    // （GET /sse）连接关闭即结束该 SSE session；GET /mcp 的 session 不随事件流断开而结束
+    void enterStreaming(const std::string& sessionId, bool sseSession) {
+        if (state_ == State::Closed) {
+            if (sseSession) CloseSseStream(sessionId);
+            return;
+        }
+        state_ = State::Streaming;
+        streamSessionId_ = sessionId;
+        sseSession_ = sseSession;
+        if (manager_.draining_) {
+            // 握手在 worker 中进行时服务器开始排空：写完响应头和首个事件后关闭
+            finishStreaming();
+            return;
+        }
+        armTimer(writeTimer_, Deadline::Ping, kSsePingIntervalMs);
+        if (sseSession) {
+            // GET /sse 到期断开；读定时器在事件流中不再使用
+            uint64_t ttlMs = SseSessionStore::getInstance().sessionTtlMs();
+            armTimer(readTimer_, Deadline::Expire, static_cast<int>(std::min<uint64_t>(ttlMs, 0x7FFFFFFF)));
+        }
+        armRecv();  // 只用于感知客户端断开
+    }
+
+    void close() {
+        if (state_ == State::Closed) return;
+        state_ = State::Closed;
+        closed_.store(true);
+        cancelTimer(readTimer_);
+        cancelTimer(writeTimer_);
+        reactor_.backend().close(channel_);
+        outQueue_.clear();
+        if (bodyIn_) {
+            bodyIn_->cancel();
+            bodyIn_.reset();
+        }
+        if (stream_) {
+            stream_->cancel();
+            stream_.reset();
+        }
+        if (sseSession_) {
+            CloseSseStream(streamSessionId_);
+        }
+        // 可能正处在自己的回调里，延迟到当前调用栈返回后再析构
+        std::shared_ptr<HttpConnection> self = shared_from_this();
+        manager_.remove(this);
+        reactor_.post([self]() {});
+    }
+
+    bool isClosed() const { return closed_.load(); }
+
+private:
+    enum class Deadline { Header, Body, Idle, Write, Ping, Expire };
+
+    void armTimer(TimerQueue::TimerId& slot, Deadline kind, int delayMs) {
+        reactor_.cancelTimer(slot);
+        std::weak_ptr<HttpConnection> weak = shared_from_this();
+        slot = reactor_.addTimer(delayMs, [weak, kind]() {
+            if (std::shared_ptr<HttpConnection> conn = weak.lock()) conn->onDeadline(kind);
+        });
+    }
+
+    void cancelTimer(TimerQueue::TimerId& slot) {
+        reactor_.cancelTimer(slot);
+        slot = 0;
+    }
+
+    void armRead(Deadline kind, int delayMs) {
+        readDeadline_ = kind;
+        armTimer(readTimer_, kind, delayMs);
+    }
+
+    // 开始接收 body：停顿和速率从这里开始计
+    void startBodyDeadline() {
+        bodyBytes_ = 0;
+        bodyElapsedMs_ = 0;
+        bodyIdleMs_ = 0;
+        bodyLastBytes_ = 0;
+        armRead(Deadline::Body, kBodyCheckMs);
+    }
+
+    void onDeadline(Deadline kind) {
+        if (state_ == State::Closed) return;
+        switch (kind) {
+        case Deadline::Header:
+            readTimer_ = 0;
+            AppendHttpServerLogA("[HttpServerThread] request header timeout, closing " + peer_);
+            close();
+            break;
+        case Deadline::Idle:
+            readTimer_ = 0;
+            close();
+            break;
+        case Deadline::Body:
+            readTimer_ = 0;
+            checkBodyProgress();
+            break;
+        case Deadline::Write:
+            writeTimer_ = 0;
+            AppendHttpServerLogA("[HttpServerThread] write timeout, closing " + peer_);
+            close();
+            break;
+        case Deadline::Ping:
+            writeTimer_ = 0;
+            if (state_ == State::Streaming && !sending_) {
+                // SSE comment（以 ":" 开头）不会被客户端当作事件，用于检测断连
+                queueSse(": ping\n\n");
+            }
+            break;
+        case Deadline::Expire:
+            readTimer_ = 0;
+            AppendHttpServerLogA("[SSE] Session TTL expired, closing: " + streamSessionId_);
+            close();
+            break;
+        }
+    }
+
+    // 每 kBodyCheckMs 检查一次请求体接收进度：连续无数据超过 body_timeout，或宽限期后
+    // 平均速率低于 min_body_rate 时断开。handler 读得慢导致的暂停接收不计入。
+    void checkBodyProgress() {
+        if (!pending_ && !bodyIn_) return;
+        if (!recvPending_) {
+            bodyLastBytes_ = bodyBytes_;
+            armRead(Deadline::Body, kBodyCheckMs);
+            return;
+        }
+        bool progressed = bodyBytes_ > bodyLastBytes_;
+        bodyLastBytes_ = bodyBytes_;
+        bodyIdleMs_ = progressed ? 0 : bodyIdleMs_ + kBodyCheckMs;
+        bodyElapsedMs_ += kBodyCheckMs;
+        if (bodyIdleMs_ >= manager_.bodyTimeoutMs_) {
+            AppendHttpServerLogA("[HttpServerThread] request body stalled, closing " + peer_);
+            close();
+            return;
+        }
+        uint64_t minRate = static_cast<uint64_t>(manager_.minBodyRate_);
+        if (bodyElapsedMs_ > kBodyCheckMs && bodyBytes_ * 1000 < minRate * bodyElapsedMs_) {
+            AppendHttpServerLogA("[HttpServerThread] request body below " + std::to_string(minRate) +
+                                 " B/s, closing " + peer_);
+            close();
+            return;
+        }
+        armRead(Deadline::Body, kBodyCheckMs);
+    }
+
+    void armRecv() {
+        if (recvPending_ || state_ == State::Closed) return;
+        recvPending_ = true;
+        if (!reactor_.backend().startRecv(channel_)) {
+            close();
+        }
+    }
+
+    void onRecv(const IoResult& r) {
+        recvPending_ = false;
+        if (r.error || r.bytes == 0) {
+            close();
+            return;
+        }
+        const char* data = r.data;
+        size_t size = r.bytes;
+        std::string plain;
+        if (tls_) {
+            bool ok = tls_->decrypt(r.data, r.bytes, plain);
+            if (!ok) {
+                if (!tls_->handshakeDone()) {
+                    AppendHttpServerLogA("[HttpServerThread] TLS handshake failed, closing " + peer_);
+                }
+                close();
+                return;
+            }
+            flush();  // 握手记录、session ticket
+            if (plain.empty()) {
+                armRecv();
+                return;
+            }
+            data = plain.data();
+            size = plain.size();
+        }
+        if (state_ == State::Streaming) {
+            armRecv();  // 客户端不应在 SSE 连接上发数据，忽略
+            return;
+        }
+        if (pending_ || bodyIn_) {
+            bodyBytes_ += size;
+        } else if (state_ == State::Reading && readDeadline_ == Deadline::Idle) {
+            // keep-alive 连接上的下一个请求开始到达
+            armRead(Deadline::Header, manager_.headerTimeoutMs_);
+        }
+        inbuf_.append(data, size);
+        if (bodyIn_) {
+            feedBody();
+        } else if (state_ == State::Reading) {
+            tryDispatch();
+        }
+    }
+
+    void tryDispatch() {
+        if (!pending_ && !readHead()) return;
+        if (inbuf_.size() < bodyRemaining_) {
+            if (readDeadline_ != Deadline::Body) startBodyDeadline();
+            armRecv();
+            return;
+        }
+
+        // 同一连接上客户端可能已经发出下一个请求（pipelining），多出的字节留在 inbuf_ 给下一轮
+        std::shared_ptr<HttpRequest> request = std::move(pending_);
+        pending_.reset();
+        if (bodyRemaining_ > 0) {
+            if (inbuf_.size() == bodyRemaining_) {
+                request->attachBody(std::move(inbuf_));
+                inbuf_.clear();
+            } else {
+                request->attachBody(inbuf_.substr(0, static_cast<size_t>(bodyRemaining_)));
+                inbuf_.erase(0, static_cast<size_t>(bodyRemaining_));
+            }
+            bodyRemaining_ = 0;
+        }
+        dispatch(std::move(request));
+    }
+
+    // 解析 header，收齐后按路由约定决定如何接收 body。
+    // 返回 true 表示 header 已取出、body 由 tryDispatch 继续缓存（pending_）
+    bool readHead() {
+        HttpRequestParser::Status status = parser_.parseHead(inbuf_);
+        if (status == HttpRequestParser::Status::Error) {
+            int code = parser_.errorStatus();
+            AppendHttpServerLogA("[HttpServerThread] malformed request (" + std::to_string(code) + "), dropping " + peer_);
+            inbuf_.clear();
+            sendResponse(MakeParseErrorResponse(code), true);
+            return false;
+        }
+        if (status == HttpRequestParser::Status::NeedMore) {
+            armRecv();
+            return false;
+        }
+
+        uint64_t length = parser_.contentLength();
+        std::shared_ptr<HttpRequest> request(parser_.takeHead(inbuf_));
+        request->secure = tls_ != nullptr;
+
+        // 限流按请求计：连接的第一个请求已在接受连接时计入，keep-alive 上的后续请求各计一次
+        if (served_ > 0 && !manager_.rateLimiter_.allow(peer_)) {
+            AppendHttpServerLogA("[HttpServerThread] rate limit exceeded, rejecting " + peer_);
+            inbuf_.clear();
+            sendResponse(TooManyRequestsResponse(), true);
+            return false;
+        }
+        HttpBodyPolicy policy = GetRequestBodyPolicy(*request);
+
+        // RFC 7231 5.1.1：HTTP/1.0 的 Expect 忽略；不认识的期望回复 417
+        bool expectContinue = false;
+        std::string_view expect = request->header("expect");
+        if (!expect.empty() && request->version == "HTTP/1.1") {
+            if (!EqualsIgnoreCase(expect, "100-continue")) {
+                inbuf_.clear();
+                sendResponse(MakeParseErrorResponse(417), true);
+                return false;
+            }
+            expectContinue = length > inbuf_.size();
+        }
+
+        // 超出路由上限：不接收 body 直接拒绝（带 100-continue 的客户端此时还没开始上传）
+        if (length > policy.maxBytes) {
+            AppendHttpServerLogA("[HttpServerThread] request body too large (" + std::to_string(length) + " bytes) for " +
+                                 std::string(request->path) + ", dropping " + peer_);
+            inbuf_.clear();
+            sendResponse(MakeParseErrorResponse(413), true);
+            return false;
+        }
+
+        if (policy.streaming && length > 0) {
+            // 立即分发，body 边收边交给 handler；100 Continue 等 handler 第一次 read() 时再发
+            bodyIn_ = std::make_shared<BodyStream>(shared_from_this(), length, expectContinue);
+            bodyRemaining_ = length;
+            request->attachBodyReader(bodyIn_);
+            dispatch(std::move(request));
+            feedBody();
+            return false;
+        }
+
+        if (expectContinue) {
+            queueWrite("HTTP/1.1 100 Continue\r\n\r\n");
+        }
+        pending_ = std::move(request);
+        bodyRemaining_ = length;
+        return true;
+    }
+
+    // 把已收到的 body 字节交给流式 handler；积压未满时继续接收
+    void feedBody() {
+        if (!bodyIn_) return;
+        size_t n = static_cast<size_t>(std::min<uint64_t>(inbuf_.size(), bodyRemaining_));
+        bool more = true;
+        if (n > 0) {
+            more = bodyIn_->push(inbuf_.data(), n);
+            inbuf_.erase(0, n);
+            bodyRemaining_ -= n;
+        }
+        if (bodyRemaining_ == 0) {
+            bodyIn_.reset();  // 已全部收到；多出的字节属于下一个请求，响应写完后由 tryDispatch 处理
+            cancelTimer(readTimer_);
+            return;
+        }
+        if (more) {
+            armRecv();
+        }
+    }
+
+    // handler 读走了积压的 body，恢复接收
+    void resumeBody() {
+        if (!bodyIn_ || state_ == State::Closed) return;
+        feedBody();
+    }
+
+    // handler 开始读取 body：回复 Expect: 100-continue
+    void sendContinue() {
+        if (!bodyIn_ || state_ != State::Processing) return;
+        queueWrite("HTTP/1.1 100 Continue\r\n\r\n");
+    }
+
+    void dispatch(std::shared_ptr<HttpRequest> request) {
+        state_ = State::Processing;
+        served_++;
+        if (tls_) tls_->countRequest();
+        if (bodyIn_) {
+            startBodyDeadline();
+        } else {
+            cancelTimer(readTimer_);
+        }
+        std::shared_ptr<HttpConnection> self = shared_from_this();
+
+        bool queued;
+        CompressionOptions compression = manager_.compression_;
+        bool sse = IsSseRequest(*request);
+        if (sse || IsMcpEventStreamRequest(*request)) {
+            ContentCoding coding = compression.enabled ? NegotiateContentCoding(request->header("accept-encoding"))
+                                                       : ContentCoding::Identity;
+            queued = submit(*request, [self, request, coding, sse]() {
+                auto writer = std::make_shared<Writer>(self, coding);
+                std::string sessionId;
+                HttpResponse error;
+                bool opened = sse ? OpenSseStream(*request, writer, sessionId, error)
+                                  : OpenMcpEventStream(*request, writer, sessionId, error);
+                self->reactor_.post([self, opened, error, sessionId, sse]() {
+                    if (opened) {
+                        self->enterStreaming(sessionId, sse);
+                    } else {
+                        self->sendResponse(error, true);
+                    }
+                });
+            });
+        } else {
+            int remaining = manager_.keepAliveMaxRequests_ - served_;
+            int timeoutSec = manager_.keepAliveTimeoutMs_ / 1000;
+            queued = submit(*request, [self, request, remaining, timeoutSec, compression]() {
+                HttpResponse response = DispatchRequest(*request);
+                if (response.isStreaming() && request->version != "HTTP/1.1") {
+                    CollectStreamBody(response);
+                }
+                ContentCoding coding = ApplyStreamCoding(*request, response, compression);
+                CompressResponse(*request, response, compression);
+                // 流式请求体没读完（handler 提前拒绝）时剩余字节无法跳过，只能断开
+                HttpBodyReader* body = request->bodyReader();
+                bool bodyDone = !body || body->consumed() == body->length();
+                bool keepAlive = bodyDone && timeoutSec > 0 && remaining > 0 && g_running && ClientWantsKeepAlive(*request);
+                keepAlive = ApplyConnectionHeader(response, keepAlive, timeoutSec, remaining);
+                if (response.isStreaming()) {
+                    self->runStream(std::move(response), keepAlive, coding, compression.level);
+                    return;
+                }
+                self->reactor_.post([self, response, keepAlive]() mutable {
+                    self->sendResponse(std::move(response), !keepAlive);
+                });
+            });
+        }
+
+        if (!queued) {
+            AppendHttpServerLogA("[HttpServerThread] worker queue full or overloaded, rejecting " + peer_);
+            sendResponse(ServerBusyResponse(), true);
+        }
+    }
+
+    // 准入控制：轻量请求走快速通道；其余请求带排队时限，排队超时不再执行、直接回 503
+    bool submit(const HttpRequest& request, WorkerPool::Task task) {
+        if (IsFastLaneRequest(request)) {
+            return manager_.pool_.submitFast(std::move(task));
+        }
+        std::shared_ptr<HttpConnection> self = shared_from_this();
+        return manager_.pool_.submit(std::move(task), std::chrono::milliseconds(manager_.queueTimeoutMs_), [self]() {
+            self->reactor_.post([self]() {
+                AppendHttpServerLogA("[HttpServerThread] queue deadline exceeded, rejecting " + self->peer_);
+                self->sendResponse(ServerBusyResponse(), true);
+            });
+        });
+    }
+
+    // 在 worker 线程中运行流式响应的 producer（reactor 按投递顺序处理，响应头一定先于 body 块）
+    void runStream(HttpResponse response, bool keepAlive, ContentCoding coding, int level) {
+        if (response.asyncStarter()) {
+            runAsyncStream(std::move(response), keepAlive, coding, level);
+            return;
+        }
+        std::shared_ptr<HttpConnection> self = shared_from_this();
+        auto stream = std::make_shared<StreamBackpressure>();
+        HttpBodyProducer producer = response.producer();
+        reactor_.post([self, response, stream, keepAlive]() mutable {
+            self->beginStream(std::move(response), stream, !keepAlive);
+        });
+
+        std::unique_ptr<StreamCompressor> compressor;
+        if (coding != ContentCoding::Identity) {
+            compressor.reset(new StreamCompressor(coding, level));
+        }
+        ChunkedSink sink(self, stream, std::move(compressor));
+        bool ok = true;
+        try {
+            producer(sink);
+            ok = sink.finish();
+        } catch (const std::exception& e) {
+            AppendExceptionLogA(std::string("[HttpServerThread] stream producer: ") + e.what());
+            ok = false;
+        } catch (...) {
+            AppendExceptionLogA("[HttpServerThread] stream producer: unknown exception");
+            ok = false;
+        }
+        reactor_.post([self, ok]() { self->endStream(ok); });
+    }
+
+    // 异步流式响应：写出响应头后把 sink 交给 starter，worker 随即返回；之后的 chunk 由持有 sink 的
+    // 线程投递。等待期间监听读事件，客户端断开时 sink 立即变为 cancelled
+    void runAsyncStream(HttpResponse response, bool keepAlive, ContentCoding coding, int level) {
+        std::shared_ptr<HttpConnection> self = shared_from_this();
+        auto stream = std::make_shared<StreamBackpressure>();
+        HttpAsyncBodyStarter starter = response.asyncStarter();
+        reactor_.post([self, response, stream, keepAlive]() mutable {
+            self->beginStream(std::move(response), stream, !keepAlive);
+            if (self->stream_ == stream) {
+                self->asyncStream_ = true;
+                self->armRecv();
+            }
+        });
+
+        std::unique_ptr<StreamCompressor> compressor;
+        if (coding != ContentCoding::Identity) {
+            compressor.reset(new StreamCompressor(coding, level));
+        }
+        auto sink = std::make_shared<AsyncChunkedSink>(self, stream, std::move(compressor));
+        try {
+            starter(std::move(sink));
+        } catch (const std::exception& e) {
+            AppendExceptionLogA(std::string("[HttpServerThread] async body: ") + e.what());
+        } catch (...) {
+            AppendExceptionLogA("[HttpServerThread] async body: unknown exception");
+        }
+    }
+
+    // 把排队的段合并成一次写：内存块用 gather 写直接引用；遇到文件区间时，
+    // 前面攒下的内存块（通常是响应头）作为 head 与文件一起交给 sendfile/TransmitFile。
+    // TLS 连接把整批加密成一块密文（连同握手等待发送的记录）
+    void flush() {
+        if (sending_ || state_ == State::Closed) return;
+        if (outQueue_.empty() && !(tls_ && tls_->hasOutput())) return;
+
+        std::vector<IoBuffer> buffers;
+        uint64_t batchBytes = 0;
+        size_t memoryBytes = 0;
+        while (!outQueue_.empty() && buffers.size() < kMaxSendBuffers && batchBytes < kMaxSendBatch) {
+            HttpBodyPart& part = outQueue_.front();
+            if (part.isFile() && tls_) {
+                if (!readFileChunk(part, buffers, batchBytes)) {
+                    close();
+                    return;
+                }
+                continue;
+            }
+            if (part.isFile()) {
+                sendingFile_ = std::move(part);
+                outQueue_.pop_front();
+                break;
+            }
+            batchBytes += part.data->size();
+            memoryBytes += part.data->size();
+            outBytes_ -= part.data->size();
+            buffers.push_back(std::move(part.data));
+            outQueue_.pop_front();
+        }
+        if (tls_) {
+            for (const IoBuffer& buffer : buffers) {
+                if (!tls_->encrypt(buffer->data(), buffer->size())) {
+                    close();
+                    return;
+                }
+            }
+            buffers.clear();
+            buffers.push_back(std::make_shared<const std::string>(tls_->takeOutput()));
+        }
+
+        sending_ = true;
+        sentBatchBytes_ = memoryBytes;
+        batchBytes += sendingFile_.fileLength;
+        long long base = state_ == State::Streaming ? kSseWriteTimeoutMs : kWriteTimeoutMs;
+        long long timeoutMs = base + static_cast<long long>(batchBytes / kMinSendBytesPerSec) * 1000;
+        armTimer(writeTimer_, Deadline::Write, static_cast<int>(std::min<long long>(timeoutMs, 0x7FFFFFFF)));
+
+        bool started;
+        if (sendingFile_.file) {
+            started = reactor_.backend().startSendFile(channel_, std::move(buffers), sendingFile_.file->native(),
+                                                       sendingFile_.fileOffset, sendingFile_.fileLength);
+        } else {
+            started = reactor_.backend().startSend(channel_, std::move(buffers));
+        }
+        if (!started) {
+            close();
+        }
+    }
+
+    // TLS 连接上的文件区间：读出不超过本批剩余额度的一段作为内存块，整个区间读完后出队。
+    // 读取在 reactor 线程同步进行，每批至多 kMaxSendBatch
+    bool readFileChunk(HttpBodyPart& part, std::vector<IoBuffer>& buffers, uint64_t& batchBytes) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(part.fileLength, kMaxSendBatch - batchBytes));
+        if (want > 0) {
+            std::string chunk(want, '\0');
+            long long n = part.file->readAt(part.fileOffset, &chunk[0], want);
+            if (n <= 0) {
+                AppendHttpServerLogA("[HttpServerThread] read file " + part.file->path() + " failed, closing " + peer_);
+                return false;
+            }
+            chunk.resize(static_cast<size_t>(n));
+            part.fileOffset += static_cast<uint64_t>(n);
+            part.fileLength -= static_cast<uint64_t>(n);
+            batchBytes += static_cast<uint64_t>(n);
+            buffers.push_back(std::make_shared<const std::string>(std::move(chunk)));
+        }
+        if (part.fileLength == 0) {
+            outQueue_.pop_front();
+        }
+        return true;
+    }
+
+    void onSent(const IoResult& r) {
+        sending_ = false;
+        cancelTimer(writeTimer_);
+        if (sendingFile_.file) {
+            if (r.error) {
+                AppendHttpServerLogA("[HttpServerThread] send file " + sendingFile_.file->path() + " failed err=" +
+                                     std::to_string(r.error) + ", closing " + peer_);
+            }
+            sendingFile_ = HttpBodyPart();
+        }
+        if (r.error) {
+            if (state_ == State::Streaming) {
+                LogActivity(ActivityKind::Error, "SSE", "Client disconnected: " + streamSessionId_);
+            }
+            close();
+            return;
+        }
+        if (stream_) {
+            stream_->release(sentBatchBytes_);
+        }
+        if (!outQueue_.empty() || (tls_ && tls_->hasOutput())) {
+            flush();
+            return;
+        }
+        if (state_ == State::Streaming) {
+            armTimer(writeTimer_, Deadline::Ping, kSsePingIntervalMs);
+        } else if (state_ == State::Writing && !stream_) {
+            if (closeAfterWrite_ || (manager_.draining_ && inbuf_.empty())) {
+                close();
+                return;
+            }
+            state_ = State::Reading;
+            if (inbuf_.empty()) {
+                armRead(Deadline::Idle, manager_.keepAliveTimeoutMs_);
+            } else {
+                armRead(Deadline::Header, manager_.headerTimeoutMs_);
+            }
+            tryDispatch();
+        }
+    }
+
+    // SSE 写端：任意线程调用，数据投递到 reactor 线程排队写出（压缩也在 reactor 线程按投递顺序进行）
+    class Writer : public SseStreamWriter {
+    public:
+        Writer(const std::shared_ptr<HttpConnection>& conn, ContentCoding coding)
+            : conn_(conn), reactor_(conn->reactor_), coding_(coding) {}
+
+        bool writeHead(const std::string& head) override {
+            std::shared_ptr<HttpConnection> conn = conn_.lock();
+            if (!conn || conn->isClosed()) return false;
+            ContentCoding coding = coding_;
+            reactor_.post([conn, head, coding]() {
+                conn->queueWrite(head);
+                conn->startSseEncoding(coding);
+            });
+            return true;
+        }
+
+        bool write(const std::string& data) override {
+            std::shared_ptr<HttpConnection> conn = conn_.lock();
+            if (!conn || conn->isClosed()) return false;
+            reactor_.post([conn, data]() { conn->queueSse(data); });
+            return true;
+        }
+
+        const char* contentEncoding() const override { return ContentCodingName(coding_); }
+
+        // 事件流已建立时先写完排队的事件再关闭
+        void close() override {
+            std::shared_ptr<HttpConnection> conn = conn_.lock();
+            if (!conn || conn->isClosed()) return;
+            reactor_.post([conn]() {
+                if (conn->state_ == State::Streaming) {
+                    conn->finishStreaming();
+                } else {
+                    conn->close();
+                }
+            });
+        }
+
+    private:
+        std::weak_ptr<HttpConnection> conn_;
+        Reactor& reactor_;
+        ContentCoding coding_;
+    };
+
+    // 流式响应写端（worker 线程）：攒够 kStreamChunkSize 后编码成一个 chunk 投递给 reactor。
+    // 协商了压缩时每块先压缩并 sync flush，客户端收到一块就能解出一块
+    class ChunkedSink : public HttpBodySink {
+    public:
+        ChunkedSink(const std::shared_ptr<HttpConnection>& conn, std::shared_ptr<StreamBackpressure> stream,
+                    std::unique_ptr<StreamCompressor> compressor)
+            : conn_(conn), stream_(std::move(stream)), compressor_(std::move(compressor)) {}
+
+        bool write(std::string_view data) override {
+            if (stream_->cancelled()) return false;
+            buffer_.append(data.data(), data.size());
+            return buffer_.size() < kStreamChunkSize || emit();
+        }
+
+        // 写出剩余数据（以及压缩流的结尾）
+        bool finish() {
+            if (!emit()) return false;
+            if (compressor_ && !sendChunk(compressor_->finish())) return false;
+            return !stream_->cancelled();
+        }
+
+    private:
+        bool emit() {
+            if (buffer_.empty()) return true;
+            std::string payload = compressor_ ? compressor_->compress(buffer_) : std::move(buffer_);
+            buffer_.clear();
+            return sendChunk(payload);
+        }
+
+        bool sendChunk(const std::string& payload) {
+            if (payload.empty()) return true;  // 空块表示结束，不能提前发出
+            std::string frame = ChunkFrame(payload);
+            if (!stream_->acquire(frame.size())) return false;
+            std::shared_ptr<HttpConnection> conn = conn_;
+            conn->reactor_.post([conn, frame]() mutable { conn->queueWrite(std::move(frame)); });
+            return true;
+        }
+
+        std::shared_ptr<HttpConnection> conn_;
+        std::shared_ptr<StreamBackpressure> stream_;
+        std::unique_ptr<StreamCompressor> compressor_;
+        std::string buffer_;
+    };
+
+    // 异步流式响应写端（任意线程）：每次 write 立即编码成一个 chunk 投递给 reactor，不攒块、不等待；
+    // 积压由 queueWrite 按 kMaxSseBacklog 限制
+    class AsyncChunkedSink : public HttpAsyncBodySink {
+    public:
+        AsyncChunkedSink(const std::shared_ptr<HttpConnection>& conn, std::shared_ptr<StreamBackpressure> stream,
+                         std::unique_ptr<StreamCompressor> compressor)
+            : conn_(conn), stream_(std::move(stream)), compressor_(std::move(compressor)) {}
+
+        ~AsyncChunkedSink() override { finish(false); }
+
+        bool write(std::string data) override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (finished_ || stream_->cancelled()) return false;
+            if (data.empty()) return true;
+            post(compressor_ ? compressor_->compress(data) : std::move(data));
+            return true;
+        }
+
+        void finish(bool ok) override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (finished_) return;
+            finished_ = true;
+            if (ok && compressor_) {
+                std::string tail = compressor_->finish();
+                if (!tail.empty()) post(std::move(tail));
+            }
+            std::shared_ptr<HttpConnection> conn = conn_;
+            conn->reactor_.post([conn, ok]() { conn->endStream(ok); });
+        }
+
+        bool cancelled() const override { return stream_->cancelled(); }
+
+    private:
+        void post(const std::string& payload) {
+            std::shared_ptr<HttpConnection> conn = conn_;
+            std::string frame = ChunkFrame(payload);
+            conn->reactor_.post([conn, frame]() mutable { conn->queueWrite(std::move(frame)); });
+        }
+
+        std::shared_ptr<HttpConnection> conn_;
+        std::shared_ptr<StreamBackpressure> stream_;
+        std::unique_ptr<StreamCompressor> compressor_;
+        std::mutex mutex_;
+        bool finished_ = false;
+    };
+
+    // 流式请求体（handler 在 worker 线程读取）：reactor push 收到的字节，
+    // 积压达到 kMaxBodyBacklog 时 reactor 暂停接收，handler 读走一半后再恢复
+    class BodyStream : public HttpBodyReader {
+    public:
+        BodyStream(const std::shared_ptr<HttpConnection>& conn, uint64_t length, bool expectContinue)
+            : conn_(conn), reactor_(conn->reactor_), length_(length), expectContinue_(expectContinue) {}
+
+        size_t read(char* buf, size_t size) override {
+            bool sendContinue = false;
+            bool resume = false;
+            size_t n = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (consumed_ == length_ || size == 0) return 0;
+                if (expectContinue_) {
+                    expectContinue_ = false;
+                    sendContinue = true;
+                }
+            }
+            if (sendContinue) post(&HttpConnection::sendContinue);
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return cancelled_ || readPos_ < buffer_.size(); });
+                if (cancelled_) {
+                    throw std::runtime_error("Request body aborted");
+                }
+                n = std::min(size, buffer_.size() - readPos_);
+                std::memcpy(buf, buffer_.data() + readPos_, n);
+                readPos_ += n;
+                consumed_ += n;
+                if (readPos_ == buffer_.size()) {
+                    buffer_.clear();
+                    readPos_ = 0;
+                } else if (readPos_ >= kMaxBodyBacklog / 2) {
+                    buffer_.erase(0, readPos_);
+                    readPos_ = 0;
+                }
+                if (paused_ && buffer_.size() - readPos_ <= kMaxBodyBacklog / 2) {
+                    paused_ = false;
+                    resume = true;
+                }
+            }
+            if (resume) post(&HttpConnection::resumeBody);
+            return n;
+        }
+
+        uint64_t length() const override { return length_; }
+
+        uint64_t consumed() const override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return consumed_;
+        }
+
+        // reactor 线程：追加 body 字节，返回 false 表示积压已满、应暂停接收
+        bool push(const char* data, size_t size) {
+            bool more;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                buffer_.append(data, size);
+                more = buffer_.size() - readPos_ < kMaxBodyBacklog;
+                paused_ = !more;
+            }
+            cv_.notify_all();
+            return more;
+        }
+
+        // 连接关闭或响应已发出：唤醒并让 read() 抛出
+        void cancel() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                cancelled_ = true;
+            }
+            cv_.notify_all();
+        }
+
+    private:
+        void post(void (HttpConnection::*fn)()) {
+            std::weak_ptr<HttpConnection> weak = conn_;
+            reactor_.post([weak, fn]() {
+                if (std::shared_ptr<HttpConnection> conn = weak.lock()) ((*conn).*fn)();
+            });
+        }
+
+        std::weak_ptr<HttpConnection> conn_;
+        Reactor& reactor_;
+        const uint64_t length_;
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::string buffer_;
+        size_t readPos_ = 0;
+        uint64_t consumed_ = 0;
+        bool expectContinue_;
+        bool paused_ = false;
+        bool cancelled_ = false;
+    };
+
+    HttpConnectionManager& manager_;
+    Reactor& reactor_;
+    IoChannel* channel_ = nullptr;
+    std::string peer_;
+    std::unique_ptr<TlsSession> tls_;       // HTTPS 监听器接受的连接
+
+    State state_ = State::Reading;
+    std::atomic<bool> closed_{false};   // 供其他线程（SSE 写端）查询
+    std::string inbuf_;
+    HttpRequestParser parser_;
+    std::shared_ptr<HttpRequest> pending_;  // header 已收齐、正在缓存 body 的请求
+    uint64_t bodyRemaining_ = 0;            // 本请求尚未收到的 body 字节
+    std::shared_ptr<BodyStream> bodyIn_;    // 流式请求体接收中
+    std::deque<HttpBodyPart> outQueue_;
+    size_t outBytes_ = 0;                   // 排队中的内存字节（不含文件区间）
+    HttpBodyPart sendingFile_;              // 正在由内核发送的文件区间（完成前保持文件打开）
+    std::shared_ptr<StreamBackpressure> stream_;  // 流式响应进行中
+    bool asyncStream_ = false;                    // 流式响应的 body 由异步写端投递
+    size_t sentBatchBytes_ = 0;
+    bool recvPending_ = false;
+    bool sending_ = false;
+    bool closeAfterWrite_ = false;
+    int served_ = 0;
+    std::string streamSessionId_;  // 事件流所属的 session
+    bool sseSession_ = false;      // 事件流是 GET /sse（连接即 session）
+    std::unique_ptr<StreamCompressor> sseCompressor_;  // SSE 事件流压缩（reactor 线程）
+
+    TimerQueue::TimerId readTimer_ = 0;
+    TimerQueue::TimerId writeTimer_ = 0;
+    Deadline readDeadline_ = Deadline::Header;
+    uint64_t bodyBytes_ = 0;                // 本请求已收到的 body 字节（含暂停期间）
+    uint64_t bodyLastBytes_ = 0;            // 上次检查时的 bodyBytes_
+    uint64_t bodyElapsedMs_ = 0;            // 计入速率的接收时长（不含暂停接收的周期）
+    int bodyIdleMs_ = 0;                    // 连续无数据的时长
+};
+
+// ── 监听器 ────────────────────────────────────────────────
+
+class HttpConnectionManager::Listener : public IoHandler {
+public:
+    Listener(HttpConnectionManager& manager, std::shared_ptr<TlsContext> tls)
+        : manager_(manager), tls_(std::move(tls)) {}
+
+    IoChannel* channel = nullptr;
+
+    void onIoComplete(const IoResult& r) override {
+        if (r.op != IoOp::Accept) return;
+        if (r.error) {
+            AppendHttpServerLogA("[HttpServerThread] accept failed err=" + std::to_string(r.error));
+            return;
+        }
+        manager_.onAccept(r.accepted, tls_.get());
+    }
+
+private:
+    HttpConnectionManager& manager_;
+    std::shared_ptr<TlsContext> tls_;
+};
+
+// ── HttpConnectionManager ─────────────────────────────────
+
+HttpConnectionManager::HttpConnectionManager(Reactor& reactor, WorkerPool& pool, RateLimiter& rateLimiter)
+    : reactor_(reactor), pool_(pool), rateLimiter_(rateLimiter) {
+    int keepAliveSec = g_configManager ? g_configManager->getHttpKeepAliveTimeoutSeconds() : 15;
+    keepAliveTimeoutMs_ = keepAliveSec * 1000;
+    keepAliveMaxRequests_ = g_configManager ? g_configManager->getHttpKeepAliveMaxRequests() : 100;
+    queueTimeoutMs_ = g_configManager ? g_configManager->getHttpQueueTimeoutMs() : 5000;
+    headerTimeoutMs_ = g_configManager ? g_configManager->getHttpHeaderTimeoutMs() : 10000;
+    bodyTimeoutMs_ = g_configManager ? g_configManager->getHttpBodyTimeoutMs() : 30000;
+    minBodyRate_ = g_configManager ? g_configManager->getHttpMinBodyRate() : 1024;
+    if (g_configManager) {
+        compression_.enabled = g_configManager->isHttpCompressionEnabled();
+        compression_.minBytes = static_cast<size_t>(g_configManager->getHttpCompressionMinBytes());
+        compression_.level = g_configManager->getHttpCompressionLevel();
+    }
+}
+
+HttpConnectionManager::~HttpConnectionManager() {
+    closeAll();
+}
+
+bool HttpConnectionManager::addListener(socket_t listener, std::shared_ptr<TlsContext> tls) {
+    std::unique_ptr<Listener> handler(new Listener(*this, std::move(tls)));
+    handler->channel = reactor_.backend().addListener(listener, handler.get());
+    if (!handler->channel) {
+        return false;
+    }
+    listeners_.push_back(std::move(handler));
+    return true;
+}
+
+void HttpConnectionManager::onAccept(socket_t sock, TlsContext* tls) {
+    std::string clientIp = GetPeerAddress(sock);
+    std::unique_ptr<TlsSession> session;
+    if (tls && !(session = tls->newSession())) {
+        AppendHttpServerLogA("[HttpServerThread] failed to create TLS session, dropping " + clientIp);
+        CloseSocket(sock);
+        return;
+    }
+    bool secure = session != nullptr;
+    auto conn = std::make_shared<HttpConnection>(*this, clientIp, std::move(session));
+    if (!conn->attach(sock)) {
+        return;
+    }
+    connections_[conn.get()] = conn;
+
+    // Rate limiting: 按客户端 IP 计数，新连接计一次（即它的第一个请求，之后的请求在 readHead 中计入；
+    // TLS 连接握手前无法回 429，直接断开）
+    if (!rateLimiter_.allow(clientIp)) {
+        if (secure) {
+            conn->close();
+        } else {
+            conn->sendResponse(TooManyRequestsResponse(), true);
+        }
+        return;
+    }
+    conn->startReading();
+}
+
+void HttpConnectionManager::remove(HttpConnection* conn) {
+    connections_.erase(conn);
+    checkDrained();
+}
+
+void HttpConnectionManager::closeAll() {
+    std::vector<std::shared_ptr<HttpConnection>> snapshot;
+    for (auto& pair : connections_) {
+        snapshot.push_back(pair.second);
+    }
+    for (auto& conn : snapshot) {
+        conn->close();
+    }
+    connections_.clear();
+}
+
+void HttpConnectionManager::drain(int timeoutMs, std::function<void()> onDrained) {
+    if (draining_) return;
+    draining_ = true;
+    onDrained_ = std::move(onDrained);
+    for (auto& listener : listeners_) {
+        reactor_.backend().close(listener->channel);
+    }
+
+    std::vector<std::shared_ptr<HttpConnection>> snapshot;
+    for (auto& pair : connections_) {
+        snapshot.push_back(pair.second);
+    }
+    for (auto& conn : snapshot) {
+        conn->drain();
+    }
+
+    if (!connections_.empty()) {
+        AppendHttpServerLogA("[HttpServerThread] draining " + std::to_string(connections_.size()) +
+                             " connection(s), timeout " + std::to_string(timeoutMs) + " ms");
+        if (timeoutMs <= 0) {
+            closeAll();
+        } else {
+            drainTimer_ = reactor_.addTimer(timeoutMs, [this]() {
+                drainTimer_ = 0;
+                AppendHttpServerLogA("[HttpServerThread] drain timeout, closing " +
+                                     std::to_string(connections_.size()) + " connection(s)");
+                closeAll();
+            });
+        }
+    }
+    checkDrained();
+}
+
+// 排空中最后一个连接关闭：通知调用方（可能在连接自己的回调里，延迟到调用栈返回后）
+void HttpConnectionManager::checkDrained() {
+    if (!draining_ || !onDrained_ || !connections_.empty()) return;
+    reactor_.cancelTimer(drainTimer_);
+    drainTimer_ = 0;
+    std::function<void()> done = std::move(onDrained_);
+    onDrained_ = nullptr;
+    reactor_.post(std::move(done));
+}
@@ -0,0 +1,883 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "http_routes.h"
+#include "app_globals.h"
+#include "http_server.h"
+#include "http/static_file.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <windows.h>
+#include <gdiplus.h>
+#include <nlohmann/json.hpp>
+#include "support/config_manager.h"
+#include "support/audit_logger.h"
+#include "policy/policy_guard.h"
+#include "services/file_service.h"
+#include "services/clipboard_service.h"
+#include "services/window_service.h"
+#include "services/screenshot_service.h"
+
+using namespace Gdiplus;
+
+// ── 流式响应辅助 ──────────────────────────────────────────
+
+// 按行读取文件（每行保留结尾的 '\n'），每次读入一块，内存占用只与最长的一行有关
+class LineReader {
+public:
+    explicit LineReader(FILE* file) : file_(file), buffer_(64 * 1024) {}
+
+    bool next(std::string& line) {
+        line.clear();
+        for (;;) {
+            if (pos_ < length_) {
+                const char* start = buffer_.data() + pos_;
+                const void* nl = memchr(start, '\n', length_ - pos_);
+                size_t n = nl ? static_cast<size_t>(static_cast<const char*>(nl) - start) + 1 : length_ - pos_;
+                line.append(start, n);
+                pos_ += n;
+                if (nl) return true;
+            }
+            length_ = fread(buffer_.data(), 1, buffer_.size(), file_);
+            pos_ = 0;
+            if (length_ == 0) return !line.empty();
+        }
+    }
+
+private:
+    FILE* file_;
+    std::vector<char> buffer_;
+    size_t pos_ = 0;
+    size_t length_ = 0;
+};
+
+// 序列化时把非法 UTF-8 替换为 U+FFFD：响应头已经发出，中途不能再抛异常
+static std::string DumpJsonLenient(const nlohmann::json& value) {
+    return value.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+// 写出 JSON 字符串的内容部分（已转义，不含两侧引号）
+static bool WriteJsonStringContent(HttpBodySink& sink, const std::string& text) {
+    std::string quoted = DumpJsonLenient(text);
+    return sink.write(std::string_view(quoted).substr(1, quoted.size() - 2));
+}
+
+// ── 请求体 ────────────────────────────────────────────────
+
+static const uint64_t kClipboardBodyLimit = 32 * 1024 * 1024;         // 32 MB，剪贴板文本
+static const uint64_t kUploadBodyLimit    = 2ULL * 1024 * 1024 * 1024; // 2 GB，PUT /file 流式写盘
+static const size_t   kBodyReadChunk      = 64 * 1024;
+
+static bool IsPlainTextBody(const HttpRequest& request) {
+    std::string_view type = request.header("content-type");
+    return type.size() >= 10 && EqualsIgnoreCase(type.substr(0, 10), "text/plain");
+}
+
+// 把已填好的 CF_TEXT 内存交给剪贴板；成功后内存归剪贴板所有，失败时释放
+static HttpResponse SetClipboardTextMemory(HGLOBAL hMem, size_t length) {
+    if (!OpenClipboard(NULL)) {
+        GlobalFree(hMem);
+        return MakeJsonResponse(500, "{\"error\":\"Failed to open clipboard\"}");
+    }
+    EmptyClipboard();
+    if (!SetClipboardData(CF_TEXT, hMem)) {
+        CloseClipboard();
+        GlobalFree(hMem);
+        return MakeJsonResponse(500, "{\"error\":\"Failed to set clipboard data\"}");
+    }
+    CloseClipboard();
+
+    std::string jsonResponse = "{\"success\":true,\"length\":" + std::to_string(length) + "}";
+    return MakeJsonResponse(200, std::move(jsonResponse));
+}
+
+// ── 路由处理函数 ──────────────────────────────────────────
+
+// /exit — 退出程序
+static HttpResponse HandleExit(const HttpRequest&) {
+    // 设置全局标志
+    g_running = false;
+
+    // 先在 UI 线程请求关闭 Dashboard 窗口
+    CloseDashboardWindow();
+
+    // 使用 PostMessage 异步关闭主窗口
+    if (g_hwnd) {
+        PostMessage(g_hwnd, WM_EXIT_COMMAND, 0, 0);
+    }
+    if (g_mainThreadId) {
+        PostThreadMessage(g_mainThreadId, WM_QUIT, 0, 0);
+    }
+
+    return MakeJsonResponse(200, "{\"status\":\"shutting down\"}");
+}
+
+// 状态检查 - /sts 或 /status
+static HttpResponse HandleStatus(const HttpRequest&) {
+    // 获取电脑名称
+    char computerName[MAX_COMPUTERNAME_LENGTH + 1];
+    DWORD size = sizeof(computerName);
+    if (!GetComputerNameA(computerName, &size)) {
+        strncpy(computerName, "Unknown", sizeof(computerName) - 1);
+        computerName[sizeof(computerName) - 1] = '\0';
+    }
+
+    int port = g_configManager ? g_configManager->getServerPort() : 35182;
+    std::string listenAddr = g_configManager ? g_configManager->getListenAddress() : "0.0.0.0";
+    std::string localIP = GetLocalIPAddress();
+    std::string licenseType = "opensource";
+
+    // 获取运行时间（简化版，实际应该记录启动时间）
+    DWORD uptime = GetTickCount() / 1000; // 秒
+
+    nlohmann::json out;
+    out["status"] = "running";
+    out["version"] = CLAWDESK_VERSION;
+    out["computer_name"] = std::string(computerName);
+    out["port"] = port;
+    out["listen_address"] = listenAddr;
+    out["local_ip"] = localIP;
+    out["license"] = licenseType;
+    out["uptime_seconds"] = uptime;
+    out["endpoints"] = nlohmann::json::array({
+        "/sts", "/status", "/health", "/disks", "/list", "/search", "/read", "/file",
+        "/clipboard", "/clipboard/image", "/clipboard/file",
+        "/screenshot", "/screenshot/file", "/exit"
+    });
+    std::string body = out.dump();
+
+    return MakeJsonResponse(200, std::move(body));
+}
+
+// 获取磁盘列表
+static HttpResponse HandleDisks(const HttpRequest&) {
+    // Use JSON builder to avoid fixed-size buffers (volume labels can be long).
+    nlohmann::json disks = nlohmann::json::array();
+    DWORD drives = GetLogicalDrives();
+
+    for (int i = 0; i < 26; i++) {
+        if (drives & (1 << i)) {
+            char driveLetter[4] = {(char)('A' + i), ':', '\\', '\0'};
+            UINT driveType = GetDriveTypeA(driveLetter);
+
+            std::string typeStr = "unknown";
+            switch (driveType) {
+                case DRIVE_FIXED: typeStr = "fixed"; break;
+                case DRIVE_REMOVABLE: typeStr = "removable"; break;
+                case DRIVE_REMOTE: typeStr = "network"; break;
+                case DRIVE_CDROM: typeStr = "cdrom"; break;
+                case DRIVE_RAMDISK: typeStr = "ramdisk"; break;
+            }
+
+            char volumeName[MAX_PATH] = "";
+            char fileSystem[MAX_PATH] = "";
+            DWORD serialNumber = 0;
+            ULARGE_INTEGER freeBytesAvailable{}, totalBytes{}, totalFreeBytes{};
+
+            GetVolumeInformationA(driveLetter, volumeName, MAX_PATH, &serialNumber,
+                                  NULL, NULL, fileSystem, MAX_PATH);
+            GetDiskFreeSpaceExA(driveLetter, &freeBytesAvailable, &totalBytes, &totalFreeBytes);
+
+            disks.push_back({
+                {"drive", std::string(1, static_cast<char>('A' + i)) + ":"},
+                {"type", typeStr},
+                {"label", std::string(volumeName)},
+                {"filesystem", std::string(fileSystem)},
+                {"total_bytes", totalBytes.QuadPart},
+                {"free_bytes", totalFreeBytes.QuadPart},
+                {"used_bytes", (totalBytes.QuadPart >= totalFreeBytes.QuadPart)
+                    ? (totalBytes.QuadPart - totalFreeBytes.QuadPart)
+                    : 0}
+            });
+        }
+    }
+
+    std::string jsonDisks = disks.dump();
+
+    return MakeJsonResponse(200, std::move(jsonDisks));
+}
+
+// 列出目录内容
+static HttpResponse HandleList(const HttpRequest& request) {
+    // 提取路径参数
+    std::string path = request.queryParam("path");
+
+    if (path.empty()) {
+        return MakeJsonResponse(400, "{\"error\":\"Missing required parameter: path\"}");
+    }
+
+    // PolicyGuard: 检查目录是否在白名单
+    if (g_policyGuard && !g_policyGuard->isPathAllowed(path)) {
+        return MakeJsonResponse(403, "{\"error\":\"Access denied: path not allowed\"}");
+    }
+
+    // 确保路径以 \* 结尾用于搜索
+    std::string searchPath = path;
+    if (!searchPath.empty() && searchPath.back() != '\\') searchPath += "\\";
+    searchPath += "*";
+
+    // 边枚举边写出，大目录不必等全部列完
+    return MakeJsonStreamResponse([path, searchPath](HttpBodySink& sink) {
+        if (!sink.write("[")) return;
+
+        size_t count = 0;
+        WIN32_FIND_DATA findData;
+        HANDLE hFind = FindFirstFile(searchPath.c_str(), &findData);
+
+        if (hFind != INVALID_HANDLE_VALUE) {
+            do {
+                // 跳过 . 和 ..
+                if (strcmp(findData.cFileName, ".") == 0 ||
+                    strcmp(findData.cFileName, "..") == 0) {
+                    continue;
+                }
+
+                bool isDir = (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+                ULARGE_INTEGER fileSize;
+                fileSize.LowPart = findData.nFileSizeLow;
+                fileSize.HighPart = findData.nFileSizeHigh;
+
+                // 转换文件时间
+                FILETIME ft = findData.ftLastWriteTime;
+                SYSTEMTIME st;
+                FileTimeToSystemTime(&ft, &st);
+
+                char modified[32];
+                snprintf(modified, sizeof(modified), "%04d-%02d-%02d %02d:%02d:%02d",
+                         st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond);
+
+                nlohmann::json entry;
+                entry["name"] = std::string(findData.cFileName);
+                entry["type"] = isDir ? "directory" : "file";
+                entry["size"] = fileSize.QuadPart;
+                entry["modified"] = std::string(modified);
+                std::string item = (count > 0 ? "," : "") + DumpJsonLenient(entry);
+                if (!sink.write(item)) break;
+                count++;
+
+            } while (FindNextFile(hFind, &findData));
+            FindClose(hFind);
+        }
+
+        sink.write("]");
+        LogActivity(ActivityKind::Success, "list", path + " -> " + std::to_string(count) + " items");
+    });
+}
+
+// 在文件中搜索
+static HttpResponse HandleSearch(const HttpRequest& request) {
+    // 提取路径参数
+    std::string filepath = request.queryParam("path");
+
+    // 提取搜索关键词
+    std::string query = request.queryParam("query");
+
+    if (query.empty()) {
+        return MakeJsonResponse(400, "{\"error\":\"Missing required parameter: query\"}");
+    }
+
+    // PolicyGuard: 检查文件路径是否在白名单
+    if (g_policyGuard && !g_policyGuard->isPathAllowed(filepath)) {
+        return MakeJsonResponse(403, "{\"error\":\"Access denied: path not allowed\"}");
+    }
+
+    // 提取可选参数
+    bool caseInsensitive = false;
+    int maxResults = 100;
+    int contextLines = 0;
+
+    std::string caseStr = request.queryParam("case");
+    if (!caseStr.empty()) {
+        caseInsensitive = (caseStr == "insensitive" || caseStr == "i");
+    }
+
+    std::string maxStr = request.queryParam("max");
+    if (!maxStr.empty()) {
+        maxResults = atoi(maxStr.c_str());
+        if (maxResults <= 0) maxResults = 100;
+        if (maxResults > 1000) maxResults = 1000;
+    }
+
+    std::string contextStr = request.queryParam("context");
+    if (!contextStr.empty()) {
+        contextLines = atoi(contextStr.c_str());
+        if (contextLines < 0) contextLines = 0;
+        if (contextLines > 10) contextLines = 10;
+    }
+
+    // 打开文件
+    FILE* fp = fopen(filepath.c_str(), "rb");
+    if (!fp) {
+        return MakeJsonResponse(404, "{\"error\":\"File not found or access denied\"}");
+    }
+    std::shared_ptr<FILE> file(fp, fclose);
+
+    // 获取文件大小并检查限制
+    fseek(fp, 0, SEEK_END);
+    long fileSize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    const long MAX_FILE_SIZE = 10 * 1024 * 1024;
+    if (fileSize > MAX_FILE_SIZE) {
+        return MakeJsonResponse(413, "{\"error\":\"File too large\",\"max_size\":\"10MB\"}");
+    }
+
+    // 准备搜索
+    std::string searchQuery = query;
+    if (caseInsensitive) {
+        for (char& c : searchQuery) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+
+    // 逐行搜索并立即写出匹配；统计字段放在 matches 之后
+    return MakeJsonStreamResponse([file, filepath, query, searchQuery, caseInsensitive, maxResults](HttpBodySink& sink) {
+        nlohmann::json head;
+        head["path"] = filepath;
+        head["query"] = query;
+        head["case_sensitive"] = !caseInsensitive;
+        std::string prefix = DumpJsonLenient(head);
+        prefix.pop_back();  // 去掉 '}'，继续追加字段
+        prefix += ",\"matches\":[";
+        if (!sink.write(prefix)) return;
+
+        LineReader reader(file.get());
+        std::string line;
+        std::string searchLine;
+        int totalLines = 0;
+        int matchCount = 0;
+
+        while (reader.next(line)) {
+            if (matchCount < maxResults) {
+                const std::string* haystack = &line;
+                if (caseInsensitive) {
+                    searchLine = line;
+                    for (char& c : searchLine) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+                    haystack = &searchLine;
+                }
+
+                if (haystack->find(searchQuery) != std::string::npos) {
+                    nlohmann::json match;
+                    match["line_number"] = totalLines;
+                    match["content"] = line;
+                    std::string item = (matchCount > 0 ? "," : "") + DumpJsonLenient(match);
+                    if (!sink.write(item)) return;
+                    matchCount++;
+                }
+            }
+            totalLines++;
+        }
+
+        nlohmann::json tail;
+        tail["match_count"] = matchCount;
+        tail["total_lines"] = totalLines;
+        sink.write("]," + tail.dump().substr(1));
+
+        LogActivity(ActivityKind::Success, "search", filepath + " -> " + std::to_string(matchCount) + " matches");
+    });
+}
+
+// 读取文件内容
+static HttpResponse HandleRead(const HttpRequest& request) {
+    // 提取路径参数
+    std::string filepath = request.queryParam("path");
+
+    if (filepath.empty()) {
+        return MakeJsonResponse(400, "{\"error\":\"Missing required parameter: path\"}");
+    }
+
+    // PolicyGuard: 检查文件路径是否在白名单
+    if (g_policyGuard && !g_policyGuard->isPathAllowed(filepath)) {
+        return MakeJsonResponse(403, "{\"error\":\"Access denied: path not allowed\"}");
+    }
+
+    // 提取可选参数
+    int startLine = 0;
+    int maxLines = -1;
+    int tailLines = -1;
+    bool countOnly = false;
+
+    std::string startStr = request.queryParam("start");
+    if (!startStr.empty()) startLine = atoi(startStr.c_str());
+
+    std::string linesStr = request.queryParam("lines");
+    if (!linesStr.empty()) maxLines = atoi(linesStr.c_str());
+
+    std::string tailStr = request.queryParam("tail");
+    if (!tailStr.empty()) tailLines = atoi(tailStr.c_str());
+
+    std::string countStr = request.queryParam("count");
+    if (!countStr.empty()) countOnly = (countStr == "true" || countStr == "1");
+
+    // 打开文件
+    FILE* fp = fopen(filepath.c_str(), "rb");
+    if (!fp) {
+        return MakeJsonResponse(404, "{\"error\":\"File not found or access denied\"}");
+    }
+    std::shared_ptr<FILE> file(fp, fclose);
+
+    // 获取文件大小
+    fseek(fp, 0, SEEK_END);
+    long fileSize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    // 检查文件大小限制（10MB）
+    const long MAX_FILE_SIZE = 10 * 1024 * 1024;
+    if (fileSize > MAX_FILE_SIZE) {
+        return MakeJsonResponse(413, "{\"error\":\"File too large\",\"max_size\":\"10MB\"}");
+    }
+
+    // 如果只是获取行数
+    if (countOnly) {
+        LineReader reader(fp);
+        std::string line;
+        int totalLines = 0;
+        while (reader.next(line)) totalLines++;
+
+        nlohmann::json out;
+        out["path"] = filepath;
+        out["total_lines"] = totalLines;
+        out["file_size"] = fileSize;
+        return MakeJsonResponse(200, DumpJsonLenient(out));
+    }
+
+    // 边读边写出 content；起始行、行数统计在读完后放在 content 之后。
+    // tail 模式只保留最后 tailLines 行。
+    return MakeJsonStreamResponse([file, filepath, fileSize, startLine, maxLines, tailLines](HttpBodySink& sink) {
+        nlohmann::json head;
+        head["path"] = filepath;
+        head["file_size"] = fileSize;
+        std::string prefix = DumpJsonLenient(head);
+        prefix.pop_back();  // 去掉 '}'，继续追加字段
+        prefix += ",\"content\":\"";
+        if (!sink.write(prefix)) return;
+
+        LineReader reader(file.get());
+        std::string line;
+        std::deque<std::string> lastLines;
+        int firstLine = (startLine < 0) ? 0 : startLine;
+        int totalLines = 0;
+        int returnedLines = 0;
+
+        while (reader.next(line)) {
+            if (tailLines > 0) {
+                lastLines.push_back(line);
+                if (static_cast<int>(lastLines.size()) > tailLines) lastLines.pop_front();
+            } else if (totalLines >= firstLine && (maxLines <= 0 || returnedLines < maxLines)) {
+                if (!WriteJsonStringContent(sink, line)) return;
+                returnedLines++;
+            }
+            totalLines++;
+        }
+
+        int actualStart = (firstLine < totalLines) ? firstLine : totalLines;
+        if (tailLines > 0) {
+            actualStart = totalLines - static_cast<int>(lastLines.size());
+            for (const std::string& l : lastLines) {
+                if (!WriteJsonStringContent(sink, l)) return;
+            }
+            returnedLines = static_cast<int>(lastLines.size());
+        }
+
+        nlohmann::json tail;
+        tail["start_line"] = actualStart;
+        tail["returned_lines"] = returnedLines;
+        tail["total_lines"] = totalLines;
+        sink.write("\"," + tail.dump().substr(1));
+
+        LogActivity(ActivityKind::Success, "read", filepath + " (" + std::to_string(returnedLines) + " lines)");
+    });
+}
+
+// 获取剪贴板内容
+static HttpResponse HandleGetClipboard(const HttpRequest& request) {
+    if (!OpenClipboard(NULL)) {
+
+        return MakeJsonResponse(500, "{\"error\":\"Failed to open clipboard\"}");
+    }
+
+    std::string imagePath;
+    if (SaveClipboardImageFromOpenClipboard(imagePath)) {
+        CloseClipboard();
+
+        std::string fileName = imagePath;
+        size_t slash = fileName.find_last_of("/\\");
+        if (slash != std::string::npos) {
+            fileName = fileName.substr(slash + 1);
+        }
+
+        std::string urlPath = "/clipboard/image/" + fileName;
+        std::string url = BuildUrlFromRequest(request, urlPath);
+        nlohmann::json imgJson;
+        imgJson["type"] = "image";
+        imgJson["format"] = "png";
+        imgJson["url"] = url;
+        imgJson["path"] = urlPath;
+        std::string jsonResponse = imgJson.dump();
+
+        return MakeJsonResponse(200, std::move(jsonResponse));
+    }
+
+    std::vector<std::string> filePaths;
+    std::vector<std::string> fileNames;
+    if (SaveClipboardFilesFromOpenClipboard(filePaths, fileNames)) {
+        CloseClipboard();
+
+        nlohmann::json filesJson;
+        filesJson["type"] = "files";
+        filesJson["files"] = nlohmann::json::array();
+        for (size_t i = 0; i < fileNames.size(); ++i) {
+            std::string urlPath = "/clipboard/file/" + fileNames[i];
+            std::string url = BuildUrlFromRequest(request, urlPath);
+            filesJson["files"].push_back({{"name", fileNames[i]}, {"url", url}, {"path", urlPath}});
+        }
+        std::string jsonResponse = filesJson.dump();
+
+        return MakeJsonResponse(200, std::move(jsonResponse));
+    }
+
+    HANDLE hData = GetClipboardData(CF_TEXT);
+    if (!hData) {
+        CloseClipboard();
+        return MakeJsonResponse(200, "{\"content\":\"\",\"empty\":true}");
+    }
+
+    char* pData = (char*)GlobalLock(hData);
+    if (!pData) {
+        CloseClipboard();
+        return MakeJsonResponse(500, "{\"error\":\"Failed to lock clipboard data\"}");
+    }
+
+    std::string clipboardText(pData);
+    GlobalUnlock(hData);
+    CloseClipboard();
+
+    nlohmann::json clipJson;
+    clipJson["content"] = clipboardText;
+    clipJson["length"] = clipboardText.length();
+    clipJson["empty"] = false;
+    std::string jsonResponse = clipJson.dump();
+
+    return MakeJsonResponse(200, std::move(jsonResponse));
+}
+
+// 设置剪贴板内容：text/plain 流式写入，或 JSON {"content": ...}
+static HttpResponse HandleSetClipboard(const HttpRequest& request) {
+    // text/plain：body 即剪贴板内容，边收边写入剪贴板内存，不再经过中间字符串
+    if (HttpBodyReader* body = request.bodyReader()) {
+        size_t length = static_cast<size_t>(body->length());
+        HGLOBAL hMem = GlobalAlloc(GMEM_MOVEABLE, length + 1);
+        if (!hMem) {
+            return MakeJsonResponse(500, "{\"error\":\"Failed to allocate memory\"}");
+        }
+        char* pMem = (char*)GlobalLock(hMem);
+        if (!pMem) {
+            GlobalFree(hMem);
+            return MakeJsonResponse(500, "{\"error\":\"Failed to lock clipboard memory\"}");
+        }
+        size_t received = 0;
+        try {
+            while (received < length) {
+                size_t n = body->read(pMem + received, std::min(length - received, kBodyReadChunk));
+                if (n == 0) break;
+                received += n;
+            }
+        } catch (...) {
+            GlobalUnlock(hMem);
+            GlobalFree(hMem);
+            throw;
+        }
+        pMem[received] = '\0';
+        GlobalUnlock(hMem);
+        return SetClipboardTextMemory(hMem, received);
+    }
+
+    // 提取请求体中的内容
+    if (request.body.empty()) {
+        return MakeJsonResponse(400, "{\"error\":\"Missing request body\"}");
+    }
+
+    // 使用 nlohmann::json 解析请求体
+    nlohmann::json reqJson;
+    try {
+        reqJson = nlohmann::json::parse(request.body.begin(), request.body.end());
+    } catch (const std::exception&) {
+        return MakeJsonResponse(400, "{\"error\":\"Invalid JSON format\"}");
+    }
+
+    if (!reqJson.contains("content") || !reqJson["content"].is_string()) {
+        return MakeJsonResponse(400, "{\"error\":\"Missing 'content' field in JSON\"}");
+    }
+
+    const std::string& decodedContent = reqJson["content"].get_ref<const std::string&>();
+
+    HGLOBAL hMem = GlobalAlloc(GMEM_MOVEABLE, decodedContent.length() + 1);
+    if (!hMem) {
+        return MakeJsonResponse(500, "{\"error\":\"Failed to allocate memory\"}");
+    }
+
+    char* pMem = (char*)GlobalLock(hMem);
+    if (!pMem) {
+        GlobalFree(hMem);
+        return MakeJsonResponse(500, "{\"error\":\"Failed to lock clipboard memory\"}");
+    }
+    memcpy(pMem, decodedContent.c_str(), decodedContent.length());
+    pMem[decodedContent.length()] = '\0';
+    GlobalUnlock(hMem);
+
+    return SetClipboardTextMemory(hMem, decodedContent.length());
+}
+
+// 流式上传文件：PUT /file?path=...&overwrite=true&line_endings=auto|lf|crlf，body 为文件内容。
+// 与 write_file 工具语义相同（策略、审计、行尾），但 body 直接写入磁盘，不受 JSON 请求体上限限制
+static HttpResponse HandleUploadFile(const HttpRequest& request) {
+    std::string path = request.queryParam("path");
+    if (path.empty()) {
+        return MakeJsonResponse(400, "{\"error\":\"Missing required parameter: path\"}");
+    }
+    if (!g_fileService) {
+        return MakeJsonResponse(500, "{\"error\":\"FileService not initialized\"}");
+    }
+    std::string overwriteParam = request.queryParam("overwrite");
+    bool overwrite = overwriteParam == "true" || overwriteParam == "1";
+    std::string lineEndings = request.queryParam("line_endings");
+    lineEndings = FileService::resolveLineEndings(path, lineEndings.empty() ? "auto" : lineEndings);
+
+    nlohmann::json args{{"path", path}, {"overwrite", overwrite}, {"line_endings", lineEndings}};
+    if (g_policyGuard) {
+        auto decision = g_policyGuard->evaluateToolCall("write_file", args);
+        if (!decision.allowed) {
+            nlohmann::json err{{"error", "Policy denied: " + decision.reason}};
+            return MakeJsonResponse(403, err.dump());
+        }
+    }
+    if (g_auditLogger) {
+        clawdesk::AuditLogEntry entry;
+        entry.time = g_auditLogger->getCurrentTimestamp();
+        entry.tool = "write_file";
+        entry.risk = clawdesk::RiskLevel::High;
+        args["bytes"] = request.bodyReader() ? request.bodyReader()->length() : 0;
+        entry.details = args;
+        entry.result = "executing";
+        g_auditLogger->logToolCall(entry);
+    }
+
+    // 路径、覆盖检查都在读取 body 之前完成：被拒绝时带 100-continue 的客户端不必上传
+    std::unique_ptr<TextFileWriter> writer;
+    try {
+        writer = g_fileService->openTextFileWriter(path, overwrite, lineEndings);
+    } catch (const std::exception& e) {
+        std::string msg = e.what();
+        int status = msg == "Path not allowed" ? 403 : msg == "File already exists" ? 409 : 500;
+        nlohmann::json err{{"error", msg}};
+        return MakeJsonResponse(status, err.dump());
+    }
+
+    uint64_t received = 0;
+    if (HttpBodyReader* body = request.bodyReader()) {
+        std::vector<char> buffer(kBodyReadChunk);
+        for (;;) {
+            size_t n = body->read(buffer.data(), buffer.size());
+            if (n == 0) break;
+            writer->write(buffer.data(), n);
+            received += n;
+        }
+    }
+    writer->commit();
+    if (g_policyGuard) g_policyGuard->incrementUsageCount("write_file");
+    LogActivity(ActivityKind::Success, "HTTP", "PUT /file " + path);
+
+    nlohmann::json payload{{"success", true}, {"path", path}, {"bytes", received},
+                           {"bytes_written", writer->bytesWritten()}};
+    return MakeJsonResponse(200, payload.dump());
+}
+
+// 获取窗口列表
+static HttpResponse HandleWindows(const HttpRequest&) {
+    std::string windowList = GetWindowList();
+
+    return MakeJsonResponse(200, std::move(windowList));
+}
+
+// 获取进程列表
+static HttpResponse HandleProcesses(const HttpRequest&) {
+    std::string processList = GetProcessList();
+
+    return MakeJsonResponse(200, std::move(processList));
+}
+
+// 执行命令
+static HttpResponse HandleExecute(const HttpRequest& request) {
+    // 提取请求体中的命令
+    if (request.body.empty()) {
+        return MakeJsonResponse(400, "{\"error\":\"Missing request body\"}");
+    }
+
+    std::string body(request.body);
+
+    // 使用 nlohmann::json 解析请求体
+    nlohmann::json reqJson;
+    try {
+        reqJson = nlohmann::json::parse(body);
+    } catch (const std::exception& e) {
+        return MakeJsonResponse(400, "{\"error\":\"Invalid JSON format\"}");
+    }
+
+    if (!reqJson.contains("command") || !reqJson["command"].is_string()) {
+        return MakeJsonResponse(400, "{\"error\":\"Missing 'command' field in JSON\"}");
+    }
+
+    std::string decodedCommand = reqJson["command"].get<std::string>();
+
+    // PolicyGuard: 检查命令是否在白名单
+    if (g_policyGuard && !g_policyGuard->isCommandAllowed(decodedCommand)) {
+        return MakeJsonResponse(403, "{\"error\":\"Access denied: command not allowed\"}");
+    }
+
+    // 执行命令
+    LogActivity(ActivityKind::Processing, "execute", decodedCommand);
+    std::string result = ExecuteCommand(decodedCommand);
+    LogActivity(ActivityKind::Success, "execute", decodedCommand);
+
+    return MakeJsonResponse(200, std::move(result));
+}
+
+// 截图
+static HttpResponse HandleScreenshot(const HttpRequest& request) {
+    // 提取格式参数（可选）
+    std::string format = request.queryParam("format");
+    if (format.empty()) format = "png";
+
+    // 捕获截图
+    std::string imagePath;
+    int screenWidth = 0;
+    int screenHeight = 0;
+    if (!SaveScreenshotToFile(format, imagePath, screenWidth, screenHeight)) {
+        LogActivity(ActivityKind::Error, "screenshot", "Failed to capture");
+        return MakeJsonResponse(500, "{\"error\":\"Failed to capture screenshot\"}");
+    }
+
+    std::string fileName = imagePath;
+    size_t slash = fileName.find_last_of("/\\");
+    if (slash != std::string::npos) {
+        fileName = fileName.substr(slash + 1);
+    }
+
+    std::string urlPath = "/screenshot/file/" + fileName;
+    std::string url = BuildUrlFromRequest(request, urlPath);
+
+    nlohmann::json ssJson;
+    ssJson["success"] = true;
+    ssJson["format"] = format;
+    ssJson["width"] = screenWidth;
+    ssJson["height"] = screenHeight;
+    ssJson["url"] = url;
+    ssJson["path"] = urlPath;
+    LogActivity(ActivityKind::Success, "screenshot", format + " " + std::to_string(screenWidth) + "x" + std::to_string(screenHeight));
+    std::string jsonResponse = ssJson.dump();
+
+    return MakeJsonResponse(200, std::move(jsonResponse));
+}
+
+// ── 截图、剪贴板产物文件 ──────────────────────────────────
+
+// 取前缀之后的文件名；只允许字母数字与 "-_."，不能带路径
+static bool GetArtifactFileName(const HttpRequest& request, std::string_view prefix, std::string& fileName) {
+    fileName.assign(request.path.substr(prefix.size()));
+    if (fileName.empty()) {
+        return false;
+    }
+    for (char c : fileName) {
+        if (!(isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' || c == '.')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 读取剪贴板图片文件
+static HttpResponse HandleClipboardImageFile(const HttpRequest& request) {
+    std::string fileName;
+    if (!GetArtifactFileName(request, "/clipboard/image/", fileName)) {
+        return HttpResponse(400);
+    }
+    return ServeFile(request, "clipboard_images/" + fileName);
+}
+
+// 读取截图文件
+static HttpResponse HandleScreenshotFile(const HttpRequest& request) {
+    std::string fileName;
+    if (!GetArtifactFileName(request, "/screenshot/file/", fileName)) {
+        return HttpResponse(400);
+    }
+    return ServeFile(request, "screenshots/" + fileName);
+}
+
+// 下载剪贴板文件
+static HttpResponse HandleClipboardFile(const HttpRequest& request) {
+    std::string fileName;
+    if (!GetArtifactFileName(request, "/clipboard/file/", fileName)) {
+        return HttpResponse(400);
+    }
+    HttpResponse response = ServeFile(request, "clipboard_files/" + fileName);
+    if (response.status() == 200 || response.status() == 206) {
+        response.addHeader("Content-Disposition", "attachment; filename=\"" + fileName + "\"");
+    }
+    return response;
+}
+
+// 根路径或 /help - 显示欢迎信息和 API 列表
+static HttpResponse HandleHelp(const HttpRequest&) {
+    std::string body = BuildHelpJson();
+    return MakeJsonResponse(200, std::move(body));
+}
+
+// ── 路由表 ────────────────────────────────────────────────
+
+// 方法为空的路由接受任意方法（保持旧接口行为，如 POST /status）
+void RegisterDesktopRoutes(HttpRouter& r) {
+    r.add("", "/", HandleHelp);
+    r.add("", "/help", HandleHelp);
+    r.add("", "/sts", HandleStatus);
+    r.add("", "/status", HandleStatus);
+    r.add("", "/exit", HandleExit);
+
+    r.add("", "/disks", HandleDisks);
+    r.add("", "/list", HandleList);
+    r.add("", "/search", HandleSearch);
+    r.add("", "/read", HandleRead);
+    r.add("PUT", "/file", HandleUploadFile).setBody(kUploadBodyLimit, true);
+
+    // text/plain 直接流入剪贴板内存；JSON 需要完整 body 才能解析
+    r.add("", "/clipboard", HandleGetClipboard);
+    r.add("PUT", "/clipboard", HandleSetClipboard)
+        .setBody(kClipboardBodyLimit, false)
+        .setStreamBodyIf(IsPlainTextBody);
+
+    r.add("", "/screenshot", HandleScreenshot);
+    r.addPrefix("GET", "/screenshot/file/", HandleScreenshotFile);
+    r.addPrefix("GET", "/clipboard/image/", HandleClipboardImageFile);
+    r.addPrefix("GET", "/clipboard/file/", HandleClipboardFile);
+
+    r.add("", "/windows", HandleWindows);
+    r.add("", "/processes", HandleProcesses);
+    r.add("POST", "/execute", HandleExecute);
+}
@@ -17,341 +17,375 @@
  * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
  */
 #include "http_server.h"
-#include "http_routes.h"
+#include "app_core.h"
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "support/config_manager.h"
+#include "support/worker_pool.h"
+#include "http_connection.h"
 #include "mcp_sse.h"
+#include "mcp/batch_executor.h"
+#include "mcp/session_store.h"
+#include "mcp/tool_call.h"
+#include "net/listen_socket.h"
+#include "net/reactor.h"
+#ifdef _WIN32
 #include "app_globals.h"
 #include <ws2tcpip.h>
-#include <fstream>
-#include <sstream>
-#include <string>
-#include <windows.h>
-#include "support/config_manager.h"
-#include "support/audit_logger.h"
-#include "support/rate_limiter.h"
-#include "policy/policy_guard.h"
-#include "utils/log_path.h"
-
-static const size_t kMaxHttpHeaderSize = 16 * 1024;       // 16 KB header 上限
-static const size_t kMaxHttpBodySize   = 4 * 1024 * 1024; // 4 MB body 上限
-static const int    kRecvTimeoutMs     = 30000;            // 30 秒总超时
-
-// ── SendAll: 循环处理 partial send ────────────────────────
-bool SendAll(SOCKET sock, const char* buf, int len) {
-    int totalSent = 0;
-    while (totalSent < len) {
-        int sent = send(sock, buf + totalSent, len - totalSent, 0);
-        if (sent <= 0) {
-            return false;
-        }
-        totalSent += sent;
-    }
+#endif
+
+// ── 请求处理线程池 ────────────────────────────────────────
+
+// 当前运行中的线程池（供 /health 读取指标）；服务器线程退出前置空
+static std::atomic<WorkerPool*> g_httpWorkerPool{nullptr};
+
+bool GetHttpWorkerPoolStats(WorkerPool::Stats& out) {
+    WorkerPool* pool = g_httpWorkerPool.load();
+    if (!pool) return false;
+    out = pool->stats();
     return true;
 }
 
-bool SendAll(SOCKET sock, const std::string& data) {
-    return SendAll(sock, data.c_str(), static_cast<int>(data.size()));
+// 当前 HTTPS 配置（供 /health 读取握手指标）；与线程池同时置空，worker 退出前一直有效
+static std::atomic<TlsContext*> g_httpTlsContext{nullptr};
+
+bool GetHttpTlsStats(TlsContext::Stats& out) {
+    TlsContext* tls = g_httpTlsContext.load();
+    if (!tls) return false;
+    out = tls->stats();
+    return true;
 }
 
-std::string RecvFullHttpRequest(SOCKET sock) {
-    // 设置 socket 接收超时
-    int timeout = kRecvTimeoutMs;
-    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-
-    std::string buf;
-    buf.reserve(4096);
-    char tmp[4096];
-
-    // 阶段 1：读取至少到 header 结束（\r\n\r\n）
-    size_t headerEnd = std::string::npos;
-    while (headerEnd == std::string::npos) {
-        int n = recv(sock, tmp, sizeof(tmp), 0);
-        if (n <= 0) {
-            // 连接关闭或出错
-            return buf.empty() ? std::string() : buf;
-        }
-        buf.append(tmp, n);
-        headerEnd = buf.find("\r\n\r\n");
-        if (buf.size() > kMaxHttpHeaderSize && headerEnd == std::string::npos) {
-            AppendHttpServerLogA("[RecvFullHttpRequest] header too large, dropping");
-            return std::string();
-        }
+// 按配置加载证书；失败时记录原因并返回 nullptr（HTTP 照常服务）
+static std::shared_ptr<TlsContext> CreateHttpTlsContext() {
+    TlsOptions options;
+    options.certFile = g_configManager->getHttpTlsCertFile();
+    options.keyFile = g_configManager->getHttpTlsKeyFile();
+    options.sessionTimeoutSeconds = g_configManager->getHttpTlsSessionTimeoutSeconds();
+    std::string error;
+    std::shared_ptr<TlsContext> tls = TlsContext::create(options, error);
+    if (!tls) {
+        AppendHttpServerLogA("[HttpServerThread] ERROR: HTTPS disabled: " + error);
     }
+    return tls;
+}
+
+// 一个 accept 分片：独立的 reactor 线程和连接集合，共享 worker 池和限流器
+struct HttpShard {
+    std::unique_ptr<Reactor> reactor;
+    std::unique_ptr<HttpConnectionManager> connections;
+    std::thread thread;
+};
+
+// ── 停止 ──────────────────────────────────────────────────
+//
+// StopHttpServer 向每个分片投递排空任务，post 立即唤醒 reactor（eventfd / 完成端口），
+// 不再按周期检查 g_running。分片排空结束后各自停止 reactor。
+
+static std::mutex g_httpShardsMutex;
+static std::vector<HttpShard*> g_httpShards;  // 运行中的分片；RunHttpServer 返回前清空
+static int g_httpDrainTimeoutMs = 5000;
+
+static void DrainShard(HttpShard* shard) {
+    Reactor* reactor = shard->reactor.get();
+    HttpConnectionManager* connections = shard->connections.get();
+    int timeoutMs = g_httpDrainTimeoutMs;
+    reactor->post([reactor, connections, timeoutMs]() {
+        connections->drain(timeoutMs, [reactor]() { reactor->stop(); });
+    });
+}
 
-    // 阶段 2：解析 Content-Length，继续读取 body
-    size_t bodyOffset = headerEnd + 4;
-    size_t contentLength = 0;
-
-    // 在 header 部分查找 Content-Length（大小写不敏感）
-    std::string headerPart = buf.substr(0, headerEnd);
-    std::string headerLower = headerPart;
-    std::transform(headerLower.begin(), headerLower.end(), headerLower.begin(),
-                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    size_t clPos = headerLower.find("content-length:");
-    if (clPos != std::string::npos) {
-        size_t valStart = clPos + 15; // strlen("content-length:")
-        size_t valEnd = headerLower.find("\r\n", valStart);
-        if (valEnd == std::string::npos) valEnd = headerLower.size();
-        std::string valStr = headerPart.substr(valStart, valEnd - valStart);
-        // safe trim（空串或全空格时跳过，避免 npos+1 溢出）
-        size_t first = valStr.find_first_not_of(" \t");
-        if (first != std::string::npos) {
-            size_t last = valStr.find_last_not_of(" \t");
-            valStr = valStr.substr(first, last - first + 1);
-            contentLength = static_cast<size_t>(std::strtoull(valStr.c_str(), nullptr, 10));
+void StopHttpServer() {
+    g_running = false;
+    std::lock_guard<std::mutex> lock(g_httpShardsMutex);
+    for (HttpShard* shard : g_httpShards) {
+        DrainShard(shard);
+    }
+}
+
+// 登记分片供 StopHttpServer 使用；登记前已请求退出时立即排空
+static void PublishShards(std::vector<HttpShard>& shards) {
+    std::lock_guard<std::mutex> lock(g_httpShardsMutex);
+    g_httpDrainTimeoutMs = g_configManager ? g_configManager->getHttpDrainTimeoutMs() : 5000;
+    for (HttpShard& shard : shards) {
+        g_httpShards.push_back(&shard);
+        if (!g_running) {
+            DrainShard(&shard);
         }
     }
+}
+
+static void UnpublishShards() {
+    std::lock_guard<std::mutex> lock(g_httpShardsMutex);
+    g_httpShards.clear();
+}
 
-    if (contentLength > kMaxHttpBodySize) {
-        AppendHttpServerLogA("[RecvFullHttpRequest] body too large: " + std::to_string(contentLength));
-        return std::string();
+static void CloseListeners(std::vector<socket_t>& sockets) {
+    for (socket_t s : sockets) {
+        CloseSocket(s);
     }
+    sockets.clear();
+}
 
-    // 如果没有 body 或已经收完，直接返回
-    size_t totalNeeded = bodyOffset + contentLength;
-    while (buf.size() < totalNeeded) {
-        int n = recv(sock, tmp, sizeof(tmp), 0);
-        if (n <= 0) {
-            break; // 连接关闭，返回已有数据
+// 为第一个分片打开所有监听地址。第一个地址决定实际端口（auto_port 时可能回退为系统分配），
+// 其余地址使用同一端口；个别地址绑定失败只记录警告，全部失败才返回 false
+static bool OpenPrimaryListeners(std::vector<ListenEndpoint>& endpoints, int& port, const ListenOptions& options,
+                                 std::vector<socket_t>& out) {
+    bool autoPort = g_configManager ? g_configManager->isAutoPortEnabled() : false;
+    std::vector<ListenEndpoint> bound;
+    for (const ListenEndpoint& ep : endpoints) {
+        int err = 0;
+        socket_t s = OpenListenSocket(ep, port, options, err);
+        if (s == kInvalidSocket && out.empty() && autoPort && port != 0) {
+            AppendHttpServerLogA("[HttpServerThread] listen " + ep.describe(port) + " failed err=" +
+                                 std::to_string(err) + ", auto_port enabled, retrying with port 0...");
+            s = OpenListenSocket(ep, 0, options, err);
         }
-        buf.append(tmp, n);
-        if (buf.size() > bodyOffset + kMaxHttpBodySize) {
-            AppendHttpServerLogA("[RecvFullHttpRequest] body exceeded max during recv");
-            break;
+        if (s == kInvalidSocket) {
+            AppendHttpServerLogA("[HttpServerThread] ERROR: listen " + ep.describe(port) + " failed err=" +
+                                 std::to_string(err));
+            continue;
         }
-    }
 
-    return buf;
+        // 用 getsockname 获取实际绑定的端口（port=0 时由系统分配）
+        int actualPort = GetLocalPort(s);
+        if (out.empty() && actualPort > 0 && actualPort != port) {
+            AppendHttpServerLogA("[HttpServerThread] actual port=" + std::to_string(actualPort) +
+                                 " (configured=" + std::to_string(port) + ")");
+            port = actualPort;
+            // 回写真实端口到配置，以便托盘/状态显示正确
+            if (g_configManager) {
+                g_configManager->setActualPort(actualPort);
+            }
+        }
+        AppendHttpServerLogA("[HttpServerThread] Listening OK on " + ep.describe(port));
+        out.push_back(s);
+        bound.push_back(ep);
+    }
+    endpoints.swap(bound);
+    return !out.empty();
 }
 
-// HTTP 服务器线程函数
-// 辅助函数：通知主线程 HTTP 服务器启动失败
-void SignalHttpServerStartFailed() {
-    g_httpServerStartedOK.store(false);
-    if (g_httpServerStartedEvent) {
-        SetEvent(g_httpServerStartedEvent);
+// 为后续分片打开同一组地址（均已在第一个分片上以 SO_REUSEPORT 绑定）
+static bool OpenShardListeners(const std::vector<ListenEndpoint>& endpoints, int port, const ListenOptions& options,
+                               std::vector<socket_t>& out) {
+    for (const ListenEndpoint& ep : endpoints) {
+        int err = 0;
+        socket_t s = OpenListenSocket(ep, port, options, err);
+        if (s == kInvalidSocket) {
+            AppendHttpServerLogA("[HttpServerThread] WARN: shard listen " + ep.describe(port) + " failed err=" +
+                                 std::to_string(err));
+            CloseListeners(out);
+            return false;
+        }
+        out.push_back(s);
     }
+    return true;
 }
 
-DWORD WINAPI HttpServerThread(LPVOID lpParam) {
+int RunHttpServer(const std::function<void(bool started)>& onStarted) {
     try {
     int port = g_configManager ? g_configManager->getServerPort() : 35182;
     std::string listenAddr = g_configManager ? g_configManager->getListenAddress() : "0.0.0.0";
     AppendHttpServerLogA("[HttpServerThread] Starting: listen=" + listenAddr + " port=" + std::to_string(port));
-    
-    // 初始化 Winsock
-    WSADATA wsaData;
-    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-        AppendHttpServerLogA("[HttpServerThread] ERROR: WSAStartup failed");
-        SignalHttpServerStartFailed();
-        return 1;
+
+    std::vector<std::string> invalidAddrs;
+    std::vector<ListenEndpoint> endpoints = ParseListenAddresses(listenAddr, &invalidAddrs);
+    for (const std::string& addr : invalidAddrs) {
+        AppendHttpServerLogA("[HttpServerThread] WARN: invalid listen_address entry '" + addr + "', ignored");
     }
     
-    // 创建 socket
-    g_serverSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (g_serverSocket == INVALID_SOCKET) {
-        AppendHttpServerLogA("[HttpServerThread] ERROR: socket() failed err=" + std::to_string(WSAGetLastError()));
-        WSACleanup();
-        SignalHttpServerStartFailed();
+    // 初始化 Winsock（POSIX 上忽略 SIGPIPE）；作用域结束时释放
+    SocketRuntime socketRuntime;
+    if (!socketRuntime.ok()) {
+        AppendHttpServerLogA("[HttpServerThread] ERROR: WSAStartup failed");
+        onStarted(false);
         return 1;
     }
-    
-    // Prefer exclusive binding on Windows to avoid multiple processes "sharing" the same port.
-    // Using SO_REUSEADDR for a listening socket is unsafe on Windows.
-    int opt = 1;
-    if (setsockopt(g_serverSocket, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, (char*)&opt, sizeof(opt)) != 0) {
-        AppendHttpServerLogA("[HttpServerThread] WARN: setsockopt(SO_EXCLUSIVEADDRUSE) failed err=" +
-                             std::to_string(WSAGetLastError()));
+
+    // accept 分片：每片一组 SO_REUSEPORT 监听 socket，内核按连接分摊到各 reactor 线程
+    int shardCount = g_configManager ? g_configManager->getHttpAcceptShards() : 1;
+    if (shardCount > 1 && !SupportsReusePort()) {
+        AppendHttpServerLogA("[HttpServerThread] WARN: accept_shards=" + std::to_string(shardCount) +
+                             " needs SO_REUSEPORT, not available on this platform; using 1");
+        shardCount = 1;
     }
-    
-    // 绑定地址
-    sockaddr_in serverAddr{};
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(static_cast<u_short>(port));
-    
-    if (listenAddr.empty() || listenAddr == "0.0.0.0") {
-        serverAddr.sin_addr.s_addr = INADDR_ANY;
-    } else {
-        const int ok = inet_pton(AF_INET, listenAddr.c_str(), &serverAddr.sin_addr);
-        if (ok != 1) {
-            AppendHttpServerLogA("[HttpServerThread] WARN: invalid listen_address='" + listenAddr +
-                                 "', fallback to 0.0.0.0");
-            serverAddr.sin_addr.s_addr = INADDR_ANY;
-        }
+    ListenOptions listenOptions;
+    listenOptions.reusePort = shardCount > 1;
+
+    std::vector<std::vector<socket_t>> shardListeners(1);
+    if (!OpenPrimaryListeners(endpoints, port, listenOptions, shardListeners[0])) {
+        onStarted(false);
+        return 1;
     }
-    
-    if (bind(g_serverSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
-        int bindErr = WSAGetLastError();
-        AppendHttpServerLogA("[HttpServerThread] ERROR: bind() failed listen=" + listenAddr +
-                             " port=" + std::to_string(port) +
-                             " err=" + std::to_string(bindErr));
-        
-        // auto_port: 如果配置端口绑定失败且启用了自动端口，尝试随机端口
-        bool autoPort = g_configManager ? g_configManager->isAutoPortEnabled() : false;
-        if (autoPort && port != 0) {
-            AppendHttpServerLogA("[HttpServerThread] auto_port enabled, retrying with port 0...");
-            serverAddr.sin_port = htons(0);
-            if (bind(g_serverSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
-                AppendHttpServerLogA("[HttpServerThread] ERROR: bind(port=0) also failed err=" +
-                                     std::to_string(WSAGetLastError()));
-                closesocket(g_serverSocket);
-                WSACleanup();
-                SignalHttpServerStartFailed();
-                return 1;
-            }
-            AppendHttpServerLogA("[HttpServerThread] bind(port=0) succeeded");
-        } else {
-            closesocket(g_serverSocket);
-            WSACleanup();
-            SignalHttpServerStartFailed();
-            return 1;
+    for (int i = 1; i < shardCount; ++i) {
+        std::vector<socket_t> sockets;
+        if (!OpenShardListeners(endpoints, port, listenOptions, sockets)) {
+            break;
         }
+        shardListeners.push_back(std::move(sockets));
     }
-    
-    // 用 getsockname 获取实际绑定的端口（port=0 时由系统分配）
-    {
-        sockaddr_in boundAddr{};
-        int boundLen = sizeof(boundAddr);
-        if (getsockname(g_serverSocket, (sockaddr*)&boundAddr, &boundLen) == 0) {
-            int actualPort = ntohs(boundAddr.sin_port);
-            if (actualPort != port) {
-                AppendHttpServerLogA("[HttpServerThread] actual port=" + std::to_string(actualPort) +
-                                     " (configured=" + std::to_string(port) + ")");
-                port = actualPort;
-                // 回写真实端口到配置，以便托盘/状态显示正确
-                if (g_configManager) {
-                    g_configManager->setActualPort(actualPort);
+
+    // HTTPS：同一组地址上的另一个端口，每个分片各一组监听 socket，共享一个 TlsContext
+    // （会话缓存和 ticket 密钥跨分片通用）。证书或端口有问题时只禁用 HTTPS
+    std::shared_ptr<TlsContext> tlsContext;
+    std::vector<std::vector<socket_t>> shardTlsListeners(shardListeners.size());
+    int tlsPort = g_configManager ? g_configManager->getHttpTlsPort() : 0;
+    if (tlsPort > 0) {
+        tlsContext = CreateHttpTlsContext();
+        for (size_t i = 0; tlsContext && i < shardListeners.size(); ++i) {
+            if (!OpenShardListeners(endpoints, tlsPort, listenOptions, shardTlsListeners[i])) {
+                if (i == 0) {
+                    AppendHttpServerLogA("[HttpServerThread] ERROR: HTTPS disabled: cannot listen on port " +
+                                         std::to_string(tlsPort));
+                    tlsContext.reset();
                 }
+                break;
             }
         }
+        if (tlsContext) {
+            AppendHttpServerLogA("[HttpServerThread] HTTPS listening on port " + std::to_string(tlsPort));
+        }
     }
-    
-    // 监听
-    if (listen(g_serverSocket, SOMAXCONN) == SOCKET_ERROR) {
-        AppendHttpServerLogA("[HttpServerThread] ERROR: listen() failed err=" + std::to_string(WSAGetLastError()));
-        closesocket(g_serverSocket);
-        WSACleanup();
-        SignalHttpServerStartFailed();
-        return 1;
+
+    // 请求处理线程池：reactor 线程只做非阻塞收发，请求处理在 worker 中执行
+    int workerThreads = g_configManager ? g_configManager->getHttpWorkerThreads() : 4;
+    int queueCapacity = g_configManager ? g_configManager->getHttpQueueCapacity() : 128;
+    int fastLaneWorkers = g_configManager ? g_configManager->getHttpFastLaneWorkers() : 1;
+    auto workerPool = std::make_unique<WorkerPool>(static_cast<size_t>(workerThreads),
+                                                   static_cast<size_t>(queueCapacity), "http",
+                                                   static_cast<size_t>(fastLaneWorkers));
+    g_httpWorkerPool.store(workerPool.get());
+    g_httpTlsContext.store(tlsContext.get());
+    AppendHttpServerLogA("[HttpServerThread] Worker pool: threads=" + std::to_string(workerThreads) +
+                         " queue=" + std::to_string(workerPool->stats().queueCapacity) +
+                         " fast_lane=" + std::to_string(fastLaneWorkers));
+
+    // JSON-RPC batch 线程池：batch 内的工具调用并发执行，与请求线程池分开，避免 batch 占满请求线程
+    std::unique_ptr<WorkerPool> batchPool;
+    int batchWorkers = g_configManager ? g_configManager->getHttpBatchWorkers() : 4;
+    if (batchWorkers > 0) {
+        batchPool = std::make_unique<WorkerPool>(static_cast<size_t>(batchWorkers), 256, "mcp-batch");
+        SetMcpBatchPool(batchPool.get());
     }
 
-    AppendHttpServerLogA("[HttpServerThread] Listening OK on port " + std::to_string(port));
-    
-    // 通知主线程启动成功
-    g_httpServerStartedOK.store(true);
-    if (g_httpServerStartedEvent) {
-        SetEvent(g_httpServerStartedEvent);
+    // 工具线程池：异步 tools/call 在这里执行，请求线程写出响应头后立即返回
+    std::unique_ptr<WorkerPool> toolPool;
+    int toolWorkers = g_configManager ? g_configManager->getHttpToolWorkers() : 4;
+    if (toolWorkers > 0) {
+        toolPool = std::make_unique<WorkerPool>(static_cast<size_t>(toolWorkers), 256, "mcp-tools");
+        SetMcpToolPool(toolPool.get());
     }
-    
-    // 每 IP 每分钟最多 120 次请求（/health 等轻量请求也计入）
-    static RateLimiter rateLimiter(120, 60000);
-
-    // 接受连接
-    while (g_running) {
-        // 设置超时以便能够检查 g_running
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(g_serverSocket, &readfds);
-        
-        struct timeval timeout;
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
-        
-        int result = select(0, &readfds, NULL, NULL, &timeout);
-        if (result <= 0) {
-            continue;
-        }
-        
-        sockaddr_in clientAddr{};
-        int clientAddrLen = sizeof(clientAddr);
-        SOCKET clientSocket = accept(g_serverSocket, (sockaddr*)&clientAddr, &clientAddrLen);
-        if (clientSocket == INVALID_SOCKET) {
-            continue;
-        }
 
-        // 所有连接设发送超时（10 秒），防止 SendAll 在对端不读时卡住 server loop
-        int sndTimeout = 10000;
-        setsockopt(clientSocket, SOL_SOCKET, SO_SNDTIMEO, (const char*)&sndTimeout, sizeof(sndTimeout));
-
-        // Rate limiting: 提取客户端 IP 并检查
-        char clientIpBuf[INET_ADDRSTRLEN] = {};
-        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIpBuf, sizeof(clientIpBuf));
-        std::string clientIp(clientIpBuf);
-        if (!rateLimiter.allow(clientIp)) {
-            std::string resp = "HTTP/1.1 429 Too Many Requests\r\n"
-                               "Content-Type: application/json\r\n"
-                               "Access-Control-Allow-Origin: *\r\n"
-                               "Retry-After: 60\r\n"
-                               "Content-Length: 36\r\n"
-                               "\r\n"
-                               "{\"error\":\"Too many requests\"}";
-            SendAll(clientSocket, resp);
-            closesocket(clientSocket);
-            continue;
+    // Streamable HTTP / SSE session 上限：数量、空闲超时、最长存活时间
+    if (g_configManager) {
+        McpSessionStore::Limits sessionLimits;
+        sessionLimits.maxSessions = static_cast<size_t>(g_configManager->getMcpMaxSessions());
+        sessionLimits.idleTimeoutMs = static_cast<uint64_t>(g_configManager->getMcpSessionIdleTimeoutSeconds()) * 1000;
+        sessionLimits.ttlMs = static_cast<uint64_t>(g_configManager->getMcpSessionTtlSeconds()) * 1000;
+        McpSessionStore::getInstance().configure(sessionLimits);
+        SseSessionStore::getInstance().configure(
+            static_cast<size_t>(g_configManager->getSseMaxSessions()),
+            static_cast<uint64_t>(g_configManager->getSseSessionTtlSeconds()) * 1000);
+    }
+
+    // 每 IP 每分钟的请求数上限（/health 等轻量请求也计入，keep-alive 连接上的每个请求各计一次），所有分片共享
+    RateLimiter rateLimiter(g_configManager ? g_configManager->getHttpRateLimitPerMinute() : 120, 60000);
+
+    // I/O 后端（Windows: IOCP，Linux: epoll）：监听 socket、keep-alive 连接和 SSE 流都由它驱动
+    std::vector<HttpShard> shards;
+    bool setupFailed = false;
+    for (size_t i = 0; i < shardListeners.size(); ++i) {
+        std::unique_ptr<IoBackend> backend = CreateIoBackend();
+        if (!backend) {
+            AppendHttpServerLogA("[HttpServerThread] ERROR: failed to create I/O backend");
+            setupFailed = true;
+            break;
         }
-        
-        // 完整接收 HTTP 请求（header + body）
-        std::string request = RecvFullHttpRequest(clientSocket);
-        if (request.empty()) {
-            closesocket(clientSocket);
-            continue;
+        if (i == 0) {
+            AppendHttpServerLogA(std::string("[HttpServerThread] I/O backend: ") + backend->name());
         }
-
-        // ── SSE 长连接：GET /sse 由专用线程管理 socket 生命周期 ──
-        if (IsSseRequest(request)) {
-            SseThreadParams* sseParams = new SseThreadParams();
-            sseParams->socket = clientSocket;
-            sseParams->request = std::move(request);
-            HANDLE hThread = CreateThread(NULL, 0, SseConnectionThread, sseParams, 0, NULL);
-            if (hThread) {
-                CloseHandle(hThread); // 不等待，detach
-            } else {
-                AppendHttpServerLogA("[HttpServerThread] Failed to create SSE thread");
-                delete sseParams;
-                closesocket(clientSocket);
+        HttpShard shard;
+        shard.reactor.reset(new Reactor(std::move(backend)));
+        shard.connections.reset(new HttpConnectionManager(*shard.reactor, *workerPool, rateLimiter));
+        std::vector<socket_t>& sockets = shardListeners[i];
+        while (!sockets.empty()) {
+            if (!shard.connections->addListener(sockets.front())) {
+                AppendHttpServerLogA("[HttpServerThread] ERROR: failed to register listener err=" +
+                                     std::to_string(LastSocketError()));
+                setupFailed = true;
+                break;
             }
-            continue; // socket 所有权已转移，不要 close
+            sockets.erase(sockets.begin());
         }
-
-        // ── 普通请求：请求-响应-关闭 ──
-        {
-            std::string response;
-            try {
-                response = HandleHttpRequest(request);
-            } catch (const std::exception& e) {
-                std::string safe = RedactAuthorizationHeader(request);
-                AppendExceptionLogA(std::string("[HttpServerThread] std::exception: ") + e.what());
-                AppendExceptionLogA(std::string("[HttpServerThread] request(first 1024): ") + safe.substr(0, 1024));
-                const char* errBody = "{\"error\":\"internal_error\"}";
-                response = std::string("HTTP/1.1 500 Internal Server Error\r\n")
-                    + "Content-Type: application/json\r\n"
-                    + "Access-Control-Allow-Origin: *\r\n"
-                    + "Content-Length: " + std::to_string(strlen(errBody)) + "\r\n"
-                    + "\r\n"
-                    + errBody;
-            } catch (...) {
-                std::string safe = RedactAuthorizationHeader(request);
-                AppendExceptionLogA("[HttpServerThread] unknown exception");
-                AppendExceptionLogA(std::string("[HttpServerThread] request(first 1024): ") + safe.substr(0, 1024));
-                const char* errBody = "{\"error\":\"internal_error\"}";
-                response = std::string("HTTP/1.1 500 Internal Server Error\r\n")
-                    + "Content-Type: application/json\r\n"
-                    + "Access-Control-Allow-Origin: *\r\n"
-                    + "Content-Length: " + std::to_string(strlen(errBody)) + "\r\n"
-                    + "\r\n"
-                    + errBody;
-            }
-            
-            // 发送响应（处理 partial send）
-            if (!SendAll(clientSocket, response)) {
-                AppendHttpServerLogA("[HttpServerThread] SendAll failed for HTTP response");
+        std::vector<socket_t>& tlsSockets = shardTlsListeners[i];
+        while (!setupFailed && !tlsSockets.empty()) {
+            if (!shard.connections->addListener(tlsSockets.front(), tlsContext)) {
+                AppendHttpServerLogA("[HttpServerThread] ERROR: failed to register HTTPS listener err=" +
+                                     std::to_string(LastSocketError()));
+                setupFailed = true;
+                break;
             }
+            tlsSockets.erase(tlsSockets.begin());
         }
-        
-        closesocket(clientSocket);
+        shards.push_back(std::move(shard));
+        if (setupFailed) break;
+    }
+    for (std::vector<socket_t>& sockets : shardListeners) {
+        CloseListeners(sockets);  // 未交给 reactor 的监听 socket
+    }
+    for (std::vector<socket_t>& sockets : shardTlsListeners) {
+        CloseListeners(sockets);
+    }
+    if (setupFailed) {
+        g_httpWorkerPool.store(nullptr);
+        g_httpTlsContext.store(nullptr);
+        workerPool->shutdown();
+        SetMcpBatchPool(nullptr);
+        if (batchPool) batchPool->shutdown();
+        SetMcpToolPool(nullptr);
+        if (toolPool) toolPool->shutdown();
+        shards.clear();
+        onStarted(false);
+        return 1;
+    }
+    if (shards.size() > 1) {
+        AppendHttpServerLogA("[HttpServerThread] Accept shards: " + std::to_string(shards.size()));
     }
     
-    closesocket(g_serverSocket);
-    WSACleanup();
+    PublishShards(shards);
+    onStarted(true);
+
+    for (size_t i = 1; i < shards.size(); ++i) {
+        Reactor* reactor = shards[i].reactor.get();
+        shards[i].thread = std::thread([reactor]() { reactor->run(); });
+    }
+    // 各分片排空结束（或到期）后各自停止，排空时限相同
+    shards[0].reactor->run();
+    for (HttpShard& shard : shards) {
+        if (shard.thread.joinable()) shard.thread.join();
+    }
+    UnpublishShards();
+    
+    // 停止 worker：等待正在处理的请求结束（排空到期时仍在执行的工具调用），排队中的请求直接丢弃
+    g_httpWorkerPool.store(nullptr);
+    g_httpTlsContext.store(nullptr);
+    workerPool->shutdown();
+    SetMcpBatchPool(nullptr);  // 请求线程已全部结束，不再有 batch 使用它
+    if (batchPool) batchPool->shutdown();
+    for (HttpShard& shard : shards) {
+        shard.connections->closeAll();
+    }
+    // 连接已关闭，仍在执行的工具看到 cancelled 后结束；之后不再有工具向 reactor 投递数据
+    SetMcpToolPool(nullptr);
+    if (toolPool) toolPool->shutdown();
+    shards.clear();  // 监听 socket 由各 reactor 关闭
+    workerPool.reset();
+
     AppendHttpServerLogA("[HttpServerThread] Exiting normally");
     return 0;
     
@@ -364,6 +398,18 @@ DWORD WINAPI HttpServerThread(LPVOID lpParam) {
     }
 }
 
+#ifdef _WIN32
+
+// HTTP 服务器线程函数：启动结果通过事件通知主线程
+DWORD WINAPI HttpServerThread(LPVOID lpParam) {
+    return static_cast<DWORD>(RunHttpServer([](bool started) {
+        g_httpServerStartedOK.store(started);
+        if (g_httpServerStartedEvent) {
+            SetEvent(g_httpServerStartedEvent);
+        }
+    }));
+}
+
 // 添加 Windows 防火墙规则
 bool AddFirewallRule() {
     // 获取当前可执行文件路径
@@ -472,3 +518,5 @@ std::string GetLocalIPAddress() {
     
     return ipAddress;
 }
+
+#endif // _WIN32
@@ -25,6 +25,8 @@
 #include <vector>
 #include <cctype>
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <fstream>
 #include <tlhelp32.h>
 #include <psapi.h>
@@ -57,6 +59,7 @@
 #include "services/browser_service.h"
 #include "mcp/tool_registry.h"
 #include "utils/log_path.h"
+#include "utils/monotonic_clock.h"
 #include "mcp_handlers.h"
 #include "http_routes.h"
 #include "http_server.h"
@@ -115,6 +118,8 @@ PolicyGuard* g_policyGuard = nullptr;
 // 定时检查更新相关
 std::thread* g_updateTimerThread = nullptr;
 std::atomic<bool> g_updateTimerRunning(false);
+static std::mutex g_updateTimerMutex;               // 配合 g_updateTimerWake 唤醒定时线程
+static std::condition_variable g_updateTimerWake;
 
 // HTTP 服务器启动状态
 HANDLE g_httpServerStartedEvent = NULL;
@@ -239,22 +244,6 @@ void AppendCrashLog(const std::wstring& line) {
     }
 }
 
-std::string RedactAuthorizationHeader(const std::string& request) {
-    // Avoid leaking bearer token in logs.
-    std::string out = request;
-    const std::string needle = "Authorization:";
-    size_t pos = 0;
-    while ((pos = out.find(needle, pos)) != std::string::npos) {
-        size_t lineEnd = out.find("\r\n", pos);
-        if (lineEnd == std::string::npos) {
-            lineEnd = out.size();
-        }
-        out.replace(pos, lineEnd - pos, "Authorization: <redacted>");
-        pos += needle.size();
-    }
-    return out;
-}
-
 void AppendExceptionLogA(const std::string& line) {
     EnsureLogDir();
     std::wstring path = GetLogDirW() + L"\\exceptions.log";
@@ -283,6 +272,16 @@ void AppendHttpServerLogA(const std::string& line) {
     CloseHandle(file);
 }
 
+void LogActivity(ActivityKind kind, const std::string& source, const std::string& message) {
+    if (!g_dashboard) return;
+    switch (kind) {
+    case ActivityKind::Request:    g_dashboard->logRequest(source, message); break;
+    case ActivityKind::Processing: g_dashboard->logProcessing(source, message); break;
+    case ActivityKind::Success:    g_dashboard->logSuccess(source, message); break;
+    case ActivityKind::Error:      g_dashboard->logError(source, message); break;
+    }
+}
+
 void WriteCrashLog(EXCEPTION_POINTERS* info) {
     std::wstring ts = FormatTimestampW();
     AppendCrashLog(L"==== Crash Report ====");
@@ -537,24 +536,6 @@ struct LegacyWindowInfo {
 
 std::vector<LegacyWindowInfo> g_windows;
 
-// URL 解码函数
-std::string UrlDecode(const std::string& str) {
-    std::string result;
-    for (size_t i = 0; i < str.length(); i++) {
-        if (str[i] == '%' && i + 2 < str.length()) {
-            char hex[3] = {str[i+1], str[i+2], 0};
-            int value = strtol(hex, nullptr, 16);
-            result += (char)value;
-            i += 2;
-        } else if (str[i] == '+') {
-            result += ' ';
-        } else {
-            result += str[i];
-        }
-    }
-    return result;
-}
-
 std::string GetHeaderValue(const std::string& request, const std::string& headerNameLower) {
     size_t pos = 0;
     while (true) {
@@ -586,8 +567,8 @@ std::string GetHeaderValue(const std::string& request, const std::string& header
     return "";
 }
 
-std::string BuildUrlFromRequest(const std::string& request, const std::string& path) {
-    std::string host = GetHeaderValue(request, "host");
+std::string BuildUrlFromRequest(const HttpRequest& request, const std::string& path) {
+    std::string host(request.header("host"));
     if (host.empty()) {
         return path;
     }
@@ -830,26 +811,6 @@ static std::string ToLower(const std::string& s) {
     return out;
 }
 
-// Open-source edition: auth check disabled, always allow.
-bool IsAuthorizedRequest(const std::string& /*request*/) {
-    return true;
-}
-
-std::string MakeUnauthorizedResponse() {
-    const char* body = "{\"error\":\"unauthorized\"}";
-    char header[256];
-    int contentLength = static_cast<int>(strlen(body));
-    snprintf(header, sizeof(header),
-        "HTTP/1.1 401 Unauthorized\r\n"
-        "Content-Type: application/json\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "Content-Length: %d\r\n"
-        "\r\n",
-        contentLength
-    );
-    return std::string(header) + body;
-}
-
 // 获取 CLSID 用于图像编码器
 int GetEncoderClsid(const WCHAR* format, CLSID* pClsid) {
     UINT num = 0;
@@ -1296,8 +1257,7 @@ std::string ExecuteCommand(const std::string& command) {
 // HTTP 服务器线程
 DWORD WINAPI HttpServerThread(LPVOID lpParam);
 HANDLE g_serverThread = NULL;
-SOCKET g_serverSocket = INVALID_SOCKET;
-DWORD  g_startTickCount = 0;
+uint64_t g_startTickCount = 0;
 
 // 解析 HTTP 请求行，提取 method 和 path（不含 query string）
 
@@ -1413,7 +1373,7 @@ bool SendHotkey(const std::string& hotkey) {
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
     g_mainThreadId = GetCurrentThreadId();
-    g_startTickCount = GetTickCount();
+    g_startTickCount = MonotonicMillis();
     InstallCrashHandler();
     HANDLE instanceMutex = CreateMutexW(NULL, TRUE, CLAWDESK_MAIN_MUTEX_NAME);
     if (instanceMutex && GetLastError() == ERROR_ALREADY_EXISTS) {
@@ -1524,10 +1484,10 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     std::string listenAddr = g_configManager->getListenAddress();
     logEntry.result = "Listen address: " + listenAddr;
     g_auditLogger->logToolCall(logEntry);
-    if (listenAddr == "0.0.0.0") {
+    if (!g_configManager->isListenLoopbackOnly()) {
         g_dashboard->logProcessing("firewall", "Checking firewall rules...");
         
-        // 只有在监听所有接口时才需要防火墙规则
+        // 只有在监听非回环地址时才需要防火墙规则
         if (!CheckFirewallRule()) {
             g_dashboard->logProcessing("firewall", "Firewall rule not found, requesting user permission...");
             
@@ -1749,9 +1709,11 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
             g_updateTimerRunning.store(true);
             g_updateTimerThread = new std::thread([intervalHours]() {
                 while (g_updateTimerRunning.load()) {
-                    // 等待指定的小时数（每分钟检查一次是否需要停止）
-                    for (int i = 0; i < intervalHours * 60 && g_updateTimerRunning.load(); ++i) {
-                        std::this_thread::sleep_for(std::chrono::minutes(1));
+                    // 等待指定的小时数；退出时被立即唤醒
+                    {
+                        std::unique_lock<std::mutex> lock(g_updateTimerMutex);
+                        g_updateTimerWake.wait_for(lock, std::chrono::hours(intervalHours),
+                                                   []() { return !g_updateTimerRunning.load(); });
                     }
                     
                     if (!g_updateTimerRunning.load()) break;
@@ -1813,7 +1775,11 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     
     // 停止定时检查更新线程
     if (g_updateTimerThread) {
-        g_updateTimerRunning.store(false);
+        {
+            std::lock_guard<std::mutex> lock(g_updateTimerMutex);
+            g_updateTimerRunning.store(false);
+        }
+        g_updateTimerWake.notify_all();
         if (g_updateTimerThread->joinable()) {
             g_updateTimerThread->join();
         }
@@ -1821,23 +1787,16 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         g_updateTimerThread = nullptr;
     }
     
-    // 清理
-    g_running = false;
-    
-    // 先关闭所有 SSE session（关闭 socket 让线程尽快退出）
-    SseSessionStore::getInstance().shutdownAllSessions();
+    // 清理：立即唤醒服务器排空（停止 accept，进行中的请求写完响应，SSE 流有序关闭）
+    StopHttpServer();
     
-    // 等待服务器线程结束
+    // 等待服务器线程结束（排空时限之外再留出 worker 收尾的时间）
     if (g_serverThread) {
-        WaitForSingleObject(g_serverThread, 5000);
+        int drainMs = g_configManager ? g_configManager->getHttpDrainTimeoutMs() : 5000;
+        WaitForSingleObject(g_serverThread, static_cast<DWORD>(drainMs + 3000));
         CloseHandle(g_serverThread);
     }
-    
-    // 等待 SSE 线程退出（最多 5 秒，每 100ms 检查一次）
-    for (int i = 0; i < 50; ++i) {
-        if (SseSessionStore::getInstance().sessionCount() == 0) break;
-        Sleep(100);
-    }
+    SseSessionStore::getInstance().shutdownAllSessions();
     
     Shell_NotifyIcon(NIM_DELETE, &nid);
     DestroyWindow(g_hwnd);
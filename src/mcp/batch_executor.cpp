@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "mcp/batch_executor.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+static std::atomic<WorkerPool*> g_mcpBatchPool{nullptr};
+
+void SetMcpBatchPool(WorkerPool* pool) {
+    g_mcpBatchPool.store(pool);
+}
+
+namespace {
+
+// 一个 batch 的共享状态：调用线程和池线程从 next 领取任务，领完即退出。
+// 池线程可能在 batch 结束后才开始执行（或被丢弃），因此由 shared_ptr 共同持有
+struct BatchRun {
+    std::vector<std::function<void()>> tasks;
+    std::atomic<size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t done = 0;
+
+    void work() {
+        size_t i;
+        while ((i = next.fetch_add(1)) < tasks.size()) {
+            tasks[i]();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++done == tasks.size()) cv.notify_all();
+        }
+    }
+};
+
+} // namespace
+
+void RunMcpBatchTasks(std::vector<std::function<void()>> tasks) {
+    if (tasks.empty()) return;
+    auto run = std::make_shared<BatchRun>();
+    run->tasks = std::move(tasks);
+
+    WorkerPool* pool = g_mcpBatchPool.load();
+    if (pool && run->tasks.size() > 1) {
+        size_t helpers = std::min(run->tasks.size() - 1, pool->stats().workers);
+        for (size_t i = 0; i < helpers; ++i) {
+            if (!pool->submit([run]() { run->work(); })) break;  // 池满：剩余任务由调用线程执行
+        }
+    }
+
+    run->work();
+    std::unique_lock<std::mutex> lock(run->mutex);
+    run->cv.wait(lock, [&run]() { return run->done == run->tasks.size(); });
+}
+
+nlohmann::json RunJsonRpcBatch(const nlohmann::json& batch,
+                               const std::function<nlohmann::json(const nlohmann::json&)>& handle) {
+    std::vector<nlohmann::json> responses(batch.size());
+    std::vector<std::function<void()>> tasks;
+    tasks.reserve(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        tasks.push_back([&batch, &handle, &responses, i]() {
+            const nlohmann::json& item = batch[i];
+            std::string error;
+            try {
+                responses[i] = handle(item);
+                return;
+            } catch (const std::exception& e) {
+                error = std::string("Internal error: ") + e.what();
+            } catch (...) {
+                error = "Internal error";
+            }
+            nlohmann::json id = item.is_object() ? item.value("id", nlohmann::json(nullptr)) : nlohmann::json(nullptr);
+            responses[i] = {{"jsonrpc", "2.0"}, {"id", id}, {"error", {{"code", -32603}, {"message", error}}}};
+        });
+    }
+    RunMcpBatchTasks(std::move(tasks));
+
+    nlohmann::json out = nlohmann::json::array();
+    for (nlohmann::json& response : responses) {
+        if (!response.is_null()) out.push_back(std::move(response));
+    }
+    return out;
+}
@@ -0,0 +1,466 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "mcp/dispatcher.h"
+#include <atomic>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include "app_core.h"
+#include "mcp/tool_registry.h"
+#include "policy/policy_guard.h"
+#include "support/audit_logger.h"
+
+nlohmann::json MakeJsonRpcResult(const nlohmann::json& id, const nlohmann::json& result) {
+    return {{"jsonrpc", "2.0"}, {"id", id}, {"result", result}};
+}
+
+nlohmann::json MakeJsonRpcError(const nlohmann::json& id, int code, const std::string& message) {
+    return {{"jsonrpc", "2.0"}, {"id", id}, {"error", {{"code", code}, {"message", message}}}};
+}
+
+JsonRpcMessage ParseJsonRpcMessage(const nlohmann::json& msg) {
+    JsonRpcMessage out;
+    if (!msg.is_object()) {
+        out.error = MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Expected JSON object");
+        return out;
+    }
+
+    auto idIt = msg.find("id");
+    if (idIt != msg.end()) out.id = *idIt;
+
+    auto versionIt = msg.find("jsonrpc");
+    if (versionIt == msg.end() || *versionIt != "2.0") {
+        out.error = MakeJsonRpcError(out.id, kJsonRpcInvalidRequest,
+            "Missing or invalid 'jsonrpc' field, must be '2.0'");
+        return out;
+    }
+
+    auto methodIt = msg.find("method");
+    if (methodIt == msg.end() || !methodIt->is_string()) {
+        if (msg.contains("result") || msg.contains("error")) {
+            out.kind = JsonRpcMessage::Response;
+        } else {
+            out.error = MakeJsonRpcError(out.id, kJsonRpcInvalidRequest, "Missing 'method' field");
+        }
+        return out;
+    }
+
+    out.method = methodIt->get<std::string>();
+    out.kind = idIt != msg.end() ? JsonRpcMessage::Request : JsonRpcMessage::Notification;
+    auto paramsIt = msg.find("params");
+    out.params = paramsIt != msg.end() ? *paramsIt : nlohmann::json::object();
+    return out;
+}
+
+// ping 和 notifications/cancelled 的 body 只有几十到几百字节（取消可带 reason），
+// 先按长度和关键字过滤，避免为每个 /mcp 请求解析 JSON
+static const size_t kMaxPingBodySize = 256;
+static const size_t kMaxCancelBodySize = 1024;
+
+bool IsMcpFastLaneMessage(std::string_view body) {
+    const char* method;
+    if (body.size() <= kMaxPingBodySize && body.find("\"ping\"") != std::string_view::npos) {
+        method = "ping";
+    } else if (body.size() <= kMaxCancelBodySize &&
+               body.find("\"notifications/cancelled\"") != std::string_view::npos) {
+        method = "notifications/cancelled";
+    } else {
+        return false;
+    }
+    nlohmann::json msg = nlohmann::json::parse(body.begin(), body.end(), nullptr, false);
+    return msg.is_object() && msg.value("method", "") == method;
+}
+
+nlohmann::json MakeMcpInitializeResult() {
+    return {
+        {"protocolVersion", kMcpProtocolVersion},
+        {"capabilities", {{"tools", nlohmann::json::object()}}},
+        {"serverInfo", {
+            {"name", "WinBridgeAgent"},
+            {"version", CLAWDESK_VERSION}
+        }}
+    };
+}
+
+nlohmann::json MakeMcpToolsListResult() {
+    return nlohmann::json::parse(*ToolRegistry::getInstance().getToolsList()->json);
+}
+
+McpToolsListResponse MakeMcpToolsListResponse(const nlohmann::json& id, const char* source) {
+    std::shared_ptr<const ToolsListSnapshot> list = ToolRegistry::getInstance().getToolsList();
+    // 键顺序与 nlohmann::json 的 dump 一致（按字母序）
+    McpToolsListResponse out;
+    out.prefix = "{\"id\":" + id.dump() + ",\"jsonrpc\":\"2.0\",\"result\":";
+    out.result = list->json;
+    out.etag = list->etag;
+    LogActivity(ActivityKind::Success, source, "tools/list: " + std::to_string(list->toolCount) + " tools");
+    return out;
+}
+
+static McpToolCallResult ToolCallError(int code, std::string message) {
+    McpToolCallResult out;
+    out.errorCode = code;
+    out.errorMessage = std::move(message);
+    return out;
+}
+
+// tools/call 的前半段：校验 params、查找工具、策略检查、审计。失败时返回错误
+static McpToolCallResult PrepareToolCall(const nlohmann::json& params, ToolHandle& tool, nlohmann::json& args) {
+    auto nameIt = params.is_object() ? params.find("name") : params.end();
+    if (nameIt == params.end() || !nameIt->is_string()) {
+        return ToolCallError(kJsonRpcInvalidParams, "Missing or invalid 'name' in params");
+    }
+    const std::string& toolName = nameIt->get_ref<const std::string&>();
+    auto argsIt = params.find("arguments");
+    args = argsIt != params.end() ? *argsIt : nlohmann::json::object();
+
+    // 只查找一次：之后的审计和执行都用同一个句柄
+    tool = ToolRegistry::getInstance().findTool(toolName);
+    if (!tool) {
+        return ToolCallError(kJsonRpcMethodNotFound, "Unknown tool: " + toolName);
+    }
+
+    // PolicyGuard 检查
+    if (g_policyGuard) {
+        auto decision = g_policyGuard->evaluateToolCall(toolName, args);
+        if (!decision.allowed) {
+            return ToolCallError(kJsonRpcServerError, "Policy denied: " + decision.reason);
+        }
+    }
+
+    // 审计日志
+    if (g_auditLogger) {
+        clawdesk::AuditLogEntry entry;
+        entry.time = g_auditLogger->getCurrentTimestamp();
+        entry.tool = toolName;
+        entry.risk = tool->riskLevel;
+        entry.details = args;
+        entry.result = "executing";
+        g_auditLogger->logToolCall(entry);
+    }
+    return McpToolCallResult();
+}
+
+namespace {
+
+// 执行中的 tools/call，按 session 和请求 id 索引，供 notifications/cancelled 查找。
+// 同一 session 重复使用的 id 以最后一次为准；按 key 的哈希分片，减少 worker 之间的锁竞争
+class InFlightToolCalls {
+public:
+    static InFlightToolCalls& instance() {
+        static InFlightToolCalls calls;
+        return calls;
+    }
+
+    static std::string key(const std::string& sessionId, const nlohmann::json& requestId) {
+        return sessionId + "\n" + requestId.dump();
+    }
+
+    uint64_t add(const std::string& key, const CancellationToken& token) {
+        uint64_t serial = nextSerial_.fetch_add(1);
+        Shard& s = shard(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.calls[key] = Entry{serial, token};
+        return serial;
+    }
+
+    void remove(const std::string& key, uint64_t serial) {
+        Shard& s = shard(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.calls.find(key);
+        if (it != s.calls.end() && it->second.serial == serial) s.calls.erase(it);
+    }
+
+    bool cancel(const std::string& key) {
+        CancellationToken token;
+        {
+            Shard& s = shard(key);
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto it = s.calls.find(key);
+            if (it == s.calls.end()) return false;
+            token = it->second.token;
+        }
+        token.cancel();  // 锁外执行：回调可能关闭连接等
+        return true;
+    }
+
+private:
+    struct Entry {
+        uint64_t serial;
+        CancellationToken token;
+    };
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, Entry> calls;
+    };
+    static const size_t kShards = 16;
+
+    Shard& shard(const std::string& key) { return shards_[std::hash<std::string>()(key) % kShards]; }
+
+    Shard shards_[kShards];
+    std::atomic<uint64_t> nextSerial_{1};
+};
+
+// InFlightToolCalls 中的一项，析构或 release() 时移除
+class InFlightCall {
+public:
+    InFlightCall() = default;
+    InFlightCall(const std::string& sessionId, const nlohmann::json& requestId, const CancellationToken& token) {
+        if (sessionId.empty() || requestId.is_null()) return;  // REST 调用和无 session 的请求不可取消
+        key_ = InFlightToolCalls::key(sessionId, requestId);
+        serial_ = InFlightToolCalls::instance().add(key_, token);
+    }
+    ~InFlightCall() { release(); }
+
+    InFlightCall(const InFlightCall&) = delete;
+    InFlightCall& operator=(const InFlightCall&) = delete;
+
+    void release() {
+        if (serial_ == 0) return;
+        InFlightToolCalls::instance().remove(key_, serial_);
+        serial_ = 0;
+    }
+
+private:
+    std::string key_;
+    uint64_t serial_ = 0;
+};
+
+// 一次 tools/call：进度转为 notifications/progress，complete / fail 只生效一次。
+// 取消令牌在客户端断开（channel->closed()）或收到 notifications/cancelled 时取消
+class McpToolCallContext : public ToolCallContext {
+public:
+    McpToolCallContext(nlohmann::json id, nlohmann::json progressToken, std::string toolName,
+                       const char* source, std::shared_ptr<McpResponseChannel> channel,
+                       CancellationToken token, const std::string& sessionId)
+        : id_(std::move(id)), progressToken_(std::move(progressToken)), toolName_(std::move(toolName)),
+          source_(source), channel_(std::move(channel)), token_(std::move(token)),
+          inFlight_(sessionId, id_, token_) {}
+
+    ~McpToolCallContext() override {
+        if (!done_.load()) {
+            LogActivity(ActivityKind::Error, source_, "tools/call error: " + toolName_ + " - no result");
+            channel_->respond(MakeJsonRpcError(id_, kJsonRpcInternalError,
+                                               "Tool finished without a result: " + toolName_));
+        }
+    }
+
+    void reportProgress(double progress, double total, const std::string& message) override {
+        if (progressToken_.is_null() || done_.load()) return;
+        nlohmann::json params = {{"progressToken", progressToken_}, {"progress", progress}};
+        if (total > 0) params["total"] = total;
+        if (!message.empty()) params["message"] = message;
+        // 串行发送，保证通知按上报顺序到达，且不会排在最终响应之后
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (done_.load()) return;
+        channel_->notify({{"jsonrpc", "2.0"}, {"method", "notifications/progress"}, {"params", params}});
+    }
+
+    CancellationToken cancellation() const override { return token_; }
+
+    void complete(nlohmann::json result) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (done_.exchange(true)) return;
+        inFlight_.release();
+        LogActivity(ActivityKind::Success, source_, "tools/call OK: " + toolName_);
+        channel_->respond(MakeJsonRpcResult(id_, result));
+    }
+
+    void fail(const std::string& message) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (done_.exchange(true)) return;
+        inFlight_.release();
+        LogActivity(ActivityKind::Error, source_, "tools/call error: " + toolName_ + " - " + message);
+        channel_->respond(MakeJsonRpcError(id_, kJsonRpcServerError, "Tool execution error: " + message));
+    }
+
+private:
+    nlohmann::json id_;
+    nlohmann::json progressToken_;
+    std::string toolName_;
+    const char* source_;
+    std::shared_ptr<McpResponseChannel> channel_;
+    CancellationToken token_;
+    InFlightCall inFlight_;
+    std::mutex mutex_;
+    std::atomic_bool done_{false};
+};
+
+// CallMcpTool 在调用线程中执行同步 handler：respond 在 RunSyncToolHandler 返回前完成
+class InlineChannel : public McpResponseChannel {
+public:
+    bool notify(const nlohmann::json&) override { return true; }
+    void respond(const nlohmann::json& response) override { response_ = response; }
+    bool closed() const override { return false; }
+
+    nlohmann::json& response() { return response_; }
+
+private:
+    nlohmann::json response_;
+};
+
+// CallMcpTool 等待只有 asyncHandler 的工具：响应交给调用线程
+class BlockingChannel : public McpResponseChannel {
+public:
+    bool notify(const nlohmann::json&) override { return true; }
+    void respond(const nlohmann::json& response) override { promise_.set_value(response); }
+    bool closed() const override { return false; }
+
+    std::future<nlohmann::json> future() { return promise_.get_future(); }
+
+private:
+    std::promise<nlohmann::json> promise_;
+};
+
+} // namespace
+
+static void RunAsyncToolHandler(const AsyncToolHandler& handler, const nlohmann::json& args,
+                                const std::shared_ptr<ToolCallContext>& context) {
+    try {
+        handler(args, context);
+    } catch (const std::exception& e) {
+        context->fail(e.what());
+    } catch (...) {
+        context->fail("unknown exception");
+    }
+}
+
+// JSON-RPC 响应转为 McpToolCallResult
+static McpToolCallResult ToolCallResultFromRpc(nlohmann::json& rpc) {
+    McpToolCallResult out;
+    if (rpc.contains("error")) {
+        out.errorCode = rpc["error"].value("code", kJsonRpcInternalError);
+        out.errorMessage = rpc["error"].value("message", "");
+    } else {
+        out.result = std::move(rpc["result"]);
+    }
+    return out;
+}
+
+McpToolCallResult CallMcpTool(const nlohmann::json& params, const char* source,
+                              const std::string& sessionId, const nlohmann::json& requestId) {
+    ToolHandle tool;
+    nlohmann::json args;
+    McpToolCallResult prepared = PrepareToolCall(params, tool, args);
+    if (!prepared.ok()) return prepared;
+
+    // 只有可以被 notifications/cancelled 找到的调用才需要取消状态
+    bool cancellable = !sessionId.empty() && !requestId.is_null();
+    CancellationToken token = cancellable ? CancellationToken::Create() : CancellationToken();
+    LogActivity(ActivityKind::Processing, source, "tools/call: " + tool->name);
+
+    if (!tool->handler) {
+        auto channel = std::make_shared<BlockingChannel>();
+        std::future<nlohmann::json> response = channel->future();
+        RunAsyncToolHandler(tool->asyncHandler, args,
+                            std::make_shared<McpToolCallContext>(requestId, nullptr, tool->name, source,
+                                                                 channel, token, sessionId));
+        nlohmann::json rpc = response.get();
+        return ToolCallResultFromRpc(rpc);
+    }
+
+    auto channel = std::make_shared<InlineChannel>();
+    RunSyncToolHandler(tool->handler, args,
+                       std::make_shared<McpToolCallContext>(requestId, nullptr, tool->name, source,
+                                                            channel, token, sessionId));
+    return ToolCallResultFromRpc(channel->response());
+}
+
+// params._meta.progressToken（字符串或整数），没有时为 null
+static nlohmann::json ProgressToken(const nlohmann::json& params) {
+    if (!params.is_object()) return nullptr;
+    auto metaIt = params.find("_meta");
+    if (metaIt == params.end() || !metaIt->is_object()) return nullptr;
+    auto tokenIt = metaIt->find("progressToken");
+    if (tokenIt == metaIt->end() || !(tokenIt->is_string() || tokenIt->is_number_integer())) return nullptr;
+    return *tokenIt;
+}
+
+bool IsAsyncMcpToolCall(const nlohmann::json& params) {
+    if (!ProgressToken(params).is_null()) return true;
+    auto nameIt = params.is_object() ? params.find("name") : params.end();
+    if (nameIt == params.end() || !nameIt->is_string()) return false;
+    ToolHandle tool = ToolRegistry::getInstance().findTool(nameIt->get<std::string>());
+    return tool && tool->asyncHandler;
+}
+
+void StartMcpToolCall(const JsonRpcMessage& request, const char* source,
+                      std::shared_ptr<McpResponseChannel> channel, const std::string& sessionId) {
+    ToolHandle tool;
+    nlohmann::json args;
+    McpToolCallResult prepared = PrepareToolCall(request.params, tool, args);
+    if (!prepared.ok()) {
+        channel->respond(MakeJsonRpcError(request.id, prepared.errorCode, prepared.errorMessage));
+        return;
+    }
+
+    LogActivity(ActivityKind::Processing, source, "tools/call: " + tool->name);
+    // 令牌的副本可能比 context 活得久：channel 已释放也视为已断开
+    std::weak_ptr<McpResponseChannel> weakChannel = channel;
+    CancellationToken token = CancellationToken::Create([weakChannel]() {
+        std::shared_ptr<McpResponseChannel> ch = weakChannel.lock();
+        return !ch || ch->closed();
+    });
+    auto context = std::make_shared<McpToolCallContext>(request.id, ProgressToken(request.params),
+                                                        tool->name, source, std::move(channel),
+                                                        std::move(token), sessionId);
+    RunAsyncToolHandler(tool->asyncHandler ? tool->asyncHandler : RunOnToolPool(tool->handler), args, context);
+}
+
+bool CancelMcpRequest(const nlohmann::json& params, const std::string& sessionId, const char* source) {
+    auto idIt = params.is_object() ? params.find("requestId") : params.end();
+    if (sessionId.empty() || idIt == params.end() || !(idIt->is_string() || idIt->is_number_integer())) {
+        return false;
+    }
+    if (!InFlightToolCalls::instance().cancel(InFlightToolCalls::key(sessionId, *idIt))) {
+        return false;  // 已完成或 id 未知：按规范忽略
+    }
+    auto reasonIt = params.find("reason");
+    std::string reason = reasonIt != params.end() && reasonIt->is_string() ? " (" + reasonIt->get<std::string>() + ")" : "";
+    LogActivity(ActivityKind::Processing, source, "tools/call cancelled: id=" + idIt->dump() + reason);
+    return true;
+}
+
+nlohmann::json DispatchMcpRequest(const JsonRpcMessage& request, const char* source, const std::string& sessionId) {
+    // ── ping ──
+    if (request.method == "ping") {
+        return MakeJsonRpcResult(request.id, nlohmann::json::object());
+    }
+
+    // ── tools/list ──（单条请求由各传输用 MakeMcpToolsListResponse 直接发送缓存的字节）
+    if (request.method == "tools/list") {
+        nlohmann::json result = MakeMcpToolsListResult();
+        LogActivity(ActivityKind::Success, source,
+                    "tools/list: " + std::to_string(result["tools"].size()) + " tools");
+        return MakeJsonRpcResult(request.id, result);
+    }
+
+    // ── tools/call ──
+    if (request.method == "tools/call") {
+        McpToolCallResult call = CallMcpTool(request.params, source, sessionId, request.id);
+        if (!call.ok()) {
+            return MakeJsonRpcError(request.id, call.errorCode, call.errorMessage);
+        }
+        return MakeJsonRpcResult(request.id, call.result);
+    }
+
+    // ── 未知方法 ──
+    return MakeJsonRpcError(request.id, kJsonRpcMethodNotFound, "Method not found: " + request.method);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "mcp/event_log.h"
+#include <cstdlib>
+#include "app_core.h"
+
+McpEventLog::McpEventLog(size_t maxEvents, size_t maxBytes) : maxEvents_(maxEvents), maxBytes_(maxBytes) {}
+
+uint64_t McpEventLog::openStream() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nextStream_++;
+}
+
+std::string McpEventLog::publish(uint64_t stream, const std::string& data, bool primaryOpen) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t seq = nextSeq_++;
+    std::string frame = "id: " + std::to_string(stream) + "-" + std::to_string(seq) +
+                        "\nevent: message\ndata: " + data + "\n\n";
+    events_.push_back(Event{stream, seq, frame});
+    bytes_ += frame.size();
+    while (!events_.empty() && (events_.size() > maxEvents_ || bytes_ > maxBytes_)) {
+        evictedSeq_ = events_.front().seq;
+        bytes_ -= events_.front().frame.size();
+        events_.pop_front();
+    }
+    if (!primaryOpen) write(stream, frame);
+    return frame;
+}
+
+void McpEventLog::write(uint64_t stream, const std::string& frame) {
+    auto it = writers_.find(stream);
+    if (it == writers_.end()) return;
+    if (!it->second->write(frame)) {
+        writers_.erase(it);  // GET 连接已断开，之后的事件等客户端续传
+    }
+}
+
+bool McpEventLog::attach(std::shared_ptr<SseStreamWriter> writer, const std::string& lastEventId) {
+    uint64_t stream = 0;
+    uint64_t seq = 0;
+    if (!lastEventId.empty() && !ParseEventId(lastEventId, stream, seq)) return false;
+
+    std::shared_ptr<SseStreamWriter> replaced;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            replaced = std::move(writer);
+        } else {
+            if (!lastEventId.empty()) {  // 新连接不重放
+                if (seq < evictedSeq_) {
+                    AppendHttpServerLogA("[MCP] Last-Event-ID " + lastEventId +
+                                         " is older than the replay buffer, some events are lost");
+                }
+                for (const Event& event : events_) {
+                    if (event.stream == stream && event.seq > seq) writer->write(event.frame);
+                }
+            }
+            std::shared_ptr<SseStreamWriter>& slot = writers_[stream];
+            replaced = std::move(slot);
+            slot = std::move(writer);
+        }
+    }
+    if (replaced) replaced->close();  // 同一个流只保留最新的连接
+    return true;
+}
+
+void McpEventLog::close() {
+    std::map<uint64_t, std::shared_ptr<SseStreamWriter>> writers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        writers.swap(writers_);
+        events_.clear();
+        bytes_ = 0;
+    }
+    for (auto& entry : writers) {
+        entry.second->close();
+    }
+}
+
+bool McpEventLog::hasListeners() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !writers_.empty();
+}
+
+bool McpEventLog::closed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+}
+
+bool McpEventLog::ParseEventId(const std::string& id, uint64_t& stream, uint64_t& seq) {
+    size_t dash = id.find('-');
+    if (dash == std::string::npos || dash == 0 || dash + 1 == id.size() || id.size() > 41) return false;
+    for (size_t i = 0; i < id.size(); ++i) {
+        if (i != dash && (id[i] < '0' || id[i] > '9')) return false;
+    }
+    stream = std::strtoull(id.c_str(), nullptr, 10);
+    seq = std::strtoull(id.c_str() + dash + 1, nullptr, 10);
+    return true;
+}
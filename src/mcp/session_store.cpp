@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "mcp/session_store.h"
+#include <functional>
+#include <random>
+#include "app_core.h"
+#include "utils/monotonic_clock.h"
+
+McpSessionStore& McpSessionStore::getInstance() {
+    static McpSessionStore instance;
+    return instance;
+}
+
+// 生成 32 字节随机十六进制字符串作为 session ID
+static std::string GenerateSessionId() {
+    static thread_local std::mt19937 rng(std::random_device{}());
+    std::uniform_int_distribution<int> dist(0, 15);
+    const char hex[] = "0123456789abcdef";
+    std::string id;
+    id.reserve(32);
+    for (int i = 0; i < 32; ++i) {
+        id += hex[dist(rng)];
+    }
+    return id;
+}
+
+static void CloseEventLogs(const std::vector<std::shared_ptr<McpEventLog>>& logs) {
+    for (const auto& events : logs) {
+        if (events) events->close();
+    }
+}
+
+void McpSessionStore::configure(const Limits& limits) {
+    size_t maxSessions = limits.maxSessions > 0 ? limits.maxSessions : 1;
+    maxPerShard_.store((maxSessions + kShards - 1) / kShards);
+    idleTimeoutMs_.store(limits.idleTimeoutMs);
+    ttlMs_.store(limits.ttlMs);
+}
+
+McpSessionStore::Shard& McpSessionStore::shard(const std::string& sessionId) {
+    return shards_[std::hash<std::string>()(sessionId) % kShards];
+}
+
+bool McpSessionStore::isExpired(const McpSession& session, uint64_t now) const {
+    uint64_t ttl = ttlMs_.load(std::memory_order_relaxed);
+    if (ttl > 0 && now - session.createdMs >= ttl) return true;
+    uint64_t lastUsed = session.lastUsedMs.load(std::memory_order_relaxed);
+    if (now < lastUsed || now - lastUsed < idleTimeoutMs_.load(std::memory_order_relaxed)) return false;
+    // 客户端挂着 GET 事件流时只是没有发请求，不算空闲
+    return !(session.events && session.events->hasListeners());
+}
+
+void McpSessionStore::sweepLocked(Shard& s, uint64_t now, std::vector<std::shared_ptr<McpEventLog>>& closing) {
+    for (auto it = s.sessions.begin(); it != s.sessions.end();) {
+        if (isExpired(*it->second, now)) {
+            closing.push_back(it->second->events);
+            it = s.sessions.erase(it);
+            size_.fetch_sub(1);
+            expired_.fetch_add(1);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::string McpSessionStore::createSession(const std::string& protocolVersion) {
+    auto session = std::make_shared<McpSession>();
+    session->sessionId = GenerateSessionId();
+    session->protocolVersion = protocolVersion;
+    session->createdAt = std::time(nullptr);
+    session->createdMs = MonotonicMillis();
+    session->lastUsedMs.store(session->createdMs);
+    session->events = std::make_shared<McpEventLog>();
+    std::string id = session->sessionId;
+
+    std::vector<std::shared_ptr<McpEventLog>> closing;
+    std::string evictedId;
+    {
+        Shard& s = shard(id);
+        std::unique_lock<std::shared_mutex> lock(s.mutex);
+        sweepLocked(s, session->createdMs, closing);
+        if (s.sessions.size() >= maxPerShard_.load()) {
+            // 分片已满：淘汰最久未使用的（分片很小，线性扫描即可）
+            auto lru = s.sessions.begin();
+            for (auto it = s.sessions.begin(); it != s.sessions.end(); ++it) {
+                if (it->second->lastUsedMs.load() < lru->second->lastUsedMs.load()) lru = it;
+            }
+            evictedId = lru->first;
+            closing.push_back(lru->second->events);
+            s.sessions.erase(lru);
+            size_.fetch_sub(1);
+            evicted_.fetch_add(1);
+        }
+        s.sessions.emplace(id, std::move(session));
+        size_.fetch_add(1);
+        created_.fetch_add(1);
+    }
+    CloseEventLogs(closing);
+    if (!evictedId.empty()) {
+        AppendHttpServerLogA("[MCP] Session limit reached, evicted least recently used session: " + evictedId);
+    }
+    return id;
+}
+
+McpSessionHandle McpSessionStore::findSession(const std::string& sessionId) {
+    Shard& s = shard(sessionId);
+    uint64_t now = MonotonicMillis();
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+        auto it = s.sessions.find(sessionId);
+        if (it == s.sessions.end()) return nullptr;
+        if (!isExpired(*it->second, now)) {
+            it->second->lastUsedMs.store(now, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    // 已过期：换写锁移除（期间可能已被其他线程移除）
+    std::shared_ptr<McpEventLog> events;
+    {
+        std::unique_lock<std::shared_mutex> lock(s.mutex);
+        auto it = s.sessions.find(sessionId);
+        if (it == s.sessions.end()) return nullptr;
+        if (!isExpired(*it->second, now)) {
+            it->second->lastUsedMs.store(now, std::memory_order_relaxed);
+            return it->second;
+        }
+        events = it->second->events;
+        s.sessions.erase(it);
+        size_.fetch_sub(1);
+        expired_.fetch_add(1);
+    }
+    if (events) events->close();
+    return nullptr;
+}
+
+std::shared_ptr<McpEventLog> McpSessionStore::eventLog(const std::string& sessionId) {
+    McpSessionHandle session = findSession(sessionId);
+    return session ? session->events : nullptr;
+}
+
+bool McpSessionStore::markInitialized(const std::string& sessionId) {
+    McpSessionHandle session = findSession(sessionId);
+    if (!session) return false;
+    session->initialized.store(true);
+    return true;
+}
+
+void McpSessionStore::removeSession(const std::string& sessionId) {
+    std::shared_ptr<McpEventLog> events;
+    {
+        Shard& s = shard(sessionId);
+        std::unique_lock<std::shared_mutex> lock(s.mutex);
+        auto it = s.sessions.find(sessionId);
+        if (it == s.sessions.end()) return;
+        events = it->second->events;
+        s.sessions.erase(it);
+        size_.fetch_sub(1);
+    }
+    if (events) events->close();
+}
+
+void McpSessionStore::clear() {
+    std::vector<std::shared_ptr<McpEventLog>> closing;
+    for (Shard& s : shards_) {
+        std::unique_lock<std::shared_mutex> lock(s.mutex);
+        for (auto& entry : s.sessions) {
+            closing.push_back(entry.second->events);
+        }
+        size_.fetch_sub(s.sessions.size());
+        s.sessions.clear();
+    }
+    CloseEventLogs(closing);
+}
+
+McpSessionStore::Stats McpSessionStore::stats() const {
+    Stats out;
+    out.sessions = size_.load();
+    out.created = created_.load();
+    out.expired = expired_.load();
+    out.evicted = evicted_.load();
+    return out;
+}
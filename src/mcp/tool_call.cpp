@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "mcp/tool_call.h"
+#include <atomic>
+#include <exception>
+
+static std::atomic<WorkerPool*> g_mcpToolPool{nullptr};
+static thread_local ToolCallContext* t_currentCall = nullptr;
+
+void SetMcpToolPool(WorkerPool* pool) {
+    g_mcpToolPool.store(pool);
+}
+
+ToolCallScope::ToolCallScope(ToolCallContext* context) : previous_(t_currentCall) {
+    t_currentCall = context;
+}
+
+ToolCallScope::~ToolCallScope() {
+    t_currentCall = previous_;
+}
+
+void ReportToolProgress(double progress, double total, const std::string& message) {
+    if (t_currentCall) t_currentCall->reportProgress(progress, total, message);
+}
+
+bool IsToolCallCancelled() {
+    return t_currentCall && t_currentCall->cancelled();
+}
+
+CancellationToken CurrentCancellationToken() {
+    return t_currentCall ? t_currentCall->cancellation() : CancellationToken();
+}
+
+void RunSyncToolHandler(const std::function<nlohmann::json(const nlohmann::json&)>& handler,
+                        const nlohmann::json& args, const std::shared_ptr<ToolCallContext>& context) {
+    ToolCallScope scope(context.get());
+    try {
+        context->complete(handler(args));
+    } catch (const std::exception& e) {
+        context->fail(e.what());
+    } catch (...) {
+        context->fail("unknown exception");
+    }
+}
+
+AsyncToolHandler RunOnToolPool(std::function<nlohmann::json(const nlohmann::json&)> handler) {
+    return [handler](const nlohmann::json& args, std::shared_ptr<ToolCallContext> context) {
+        WorkerPool* pool = g_mcpToolPool.load();
+        if (pool && pool->submit([handler, args, context]() { RunSyncToolHandler(handler, args, context); })) {
+            return;
+        }
+        RunSyncToolHandler(handler, args, context);  // 池未设置或已满
+    };
+}
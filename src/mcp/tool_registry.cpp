@@ -17,6 +17,7 @@
  * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
  */
 #include "mcp/tool_registry.h"
+#include <cstdio>
 #include <stdexcept>
 
 ToolRegistry& ToolRegistry::getInstance() {
@@ -26,23 +27,30 @@ ToolRegistry& ToolRegistry::getInstance() {
 
 void ToolRegistry::registerTool(const std::string& name, const ToolMetadata& metadata) {
     std::lock_guard<std::mutex> lock(registryMutex_);
-    tools_[name] = metadata;
+    tools_[name] = std::make_shared<const ToolMetadata>(metadata);
+    ++generation_;
 }
 
-ToolMetadata ToolRegistry::getTool(const std::string& name) const {
+ToolHandle ToolRegistry::findTool(const std::string& name) const {
     std::lock_guard<std::mutex> lock(registryMutex_);
     auto it = tools_.find(name);
-    if (it == tools_.end()) {
+    return it == tools_.end() ? nullptr : it->second;
+}
+
+ToolMetadata ToolRegistry::getTool(const std::string& name) const {
+    ToolHandle tool = findTool(name);
+    if (!tool) {
         throw std::runtime_error("Tool not found: " + name);
     }
-    return it->second;
+    return *tool;
 }
 
 std::vector<ToolDefinition> ToolRegistry::getAllTools() const {
     std::lock_guard<std::mutex> lock(registryMutex_);
     std::vector<ToolDefinition> defs;
+    defs.reserve(tools_.size());
     for (const auto& kv : tools_) {
-        defs.push_back({kv.second.name, kv.second.description, kv.second.inputSchema});
+        defs.push_back({kv.second->name, kv.second->description, kv.second->inputSchema});
     }
     return defs;
 }
@@ -51,3 +59,42 @@ bool ToolRegistry::hasTool(const std::string& name) const {
     std::lock_guard<std::mutex> lock(registryMutex_);
     return tools_.find(name) != tools_.end();
 }
+
+uint64_t ToolRegistry::generation() const {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    return generation_;
+}
+
+// FNV-1a 64 位，作为 ETag
+static std::string ContentETag(const std::string& data) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : data) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    char buf[24];
+    snprintf(buf, sizeof(buf), "\"%016llx\"", static_cast<unsigned long long>(hash));
+    return buf;
+}
+
+std::shared_ptr<const ToolsListSnapshot> ToolRegistry::getToolsList() const {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    if (toolsList_ && toolsList_->generation == generation_) {
+        return toolsList_;
+    }
+
+    nlohmann::json toolsArray = nlohmann::json::array();
+    for (const auto& kv : tools_) {
+        toolsArray.push_back({
+            {"name", kv.second->name},
+            {"description", kv.second->description},
+            {"inputSchema", kv.second->inputSchema}
+        });
+    }
+    auto snapshot = std::make_shared<ToolsListSnapshot>();
+    snapshot->generation = generation_;
+    snapshot->toolCount = tools_.size();
+    snapshot->json = std::make_shared<const std::string>(nlohmann::json{{"tools", std::move(toolsArray)}}.dump());
+    snapshot->etag = ContentETag(*snapshot->json);
+    toolsList_ = std::move(snapshot);
+    return toolsList_;
+}
@@ -41,18 +41,6 @@
 
 // ToolRegistry 在全局 namespace
 
-nlohmann::json MakeTextContent(const std::string& text, bool isError) {
-    nlohmann::json response;
-    response["content"] = nlohmann::json::array();
-    response["content"].push_back({{"type", "text"}, {"text", text}});
-    response["isError"] = isError;
-    return response;
-}
-
-std::string DumpMcpResponse(const nlohmann::json& response) {
-    return response.dump();
-}
-
 void RegisterMcpTools() {
     auto& registry = ToolRegistry::getInstance();
 
@@ -114,15 +102,7 @@ void RegisterMcpTools() {
             std::string lineEndings = args.value("line_endings", "auto");
 
             // If writing a batch file, default to CRLF for best compatibility.
-            std::string lowerPath = path;
-            std::transform(lowerPath.begin(), lowerPath.end(), lowerPath.begin(),
-                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-            if (lineEndings == "auto" &&
-                (lowerPath.size() >= 4 &&
-                 (lowerPath.rfind(".bat") == lowerPath.size() - 4 ||
-                  lowerPath.rfind(".cmd") == lowerPath.size() - 4))) {
-                lineEndings = "crlf";
-            }
+            lineEndings = FileService::resolveLineEndings(path, lineEndings);
 
             try {
                 g_fileService->writeTextFile(path, content, overwrite, lineEndings);
@@ -243,11 +223,21 @@ void RegisterMcpTools() {
             DWORD exitCode = 0;
             bool waited = false;
             bool timedOut = false;
+            bool cancelled = false;
             if (waitMs > 0) {
                 waited = true;
-                DWORD wr = WaitForSingleObject(pi.hProcess, (DWORD)waitMs);
+                // 分段等待：取消请求后不再等待（脚本继续运行）
+                CancellationToken cancel = CurrentCancellationToken();
+                DWORD wr = WAIT_TIMEOUT;
+                for (int elapsed = 0; elapsed < waitMs && wr == WAIT_TIMEOUT; elapsed += 50) {
+                    if (cancel.cancelled()) {
+                        cancelled = true;
+                        break;
+                    }
+                    wr = WaitForSingleObject(pi.hProcess, (DWORD)std::min<int>(50, waitMs - elapsed));
+                }
                 if (wr == WAIT_TIMEOUT) {
-                    timedOut = true;
+                    timedOut = !cancelled;
                 } else {
                     GetExitCodeProcess(pi.hProcess, &exitCode);
                 }
@@ -258,7 +248,8 @@ void RegisterMcpTools() {
                 {"pid", (uint32_t)pi.dwProcessId},
                 {"waited", waited},
                 {"timed_out", timedOut},
-                {"exit_code", waited && !timedOut ? (int)exitCode : -1},
+                {"cancelled", cancelled},
+                {"exit_code", waited && !timedOut && !cancelled ? (int)exitCode : -1},
                 {"path", fullPath}
             };
 
@@ -307,6 +298,94 @@ void RegisterMcpTools() {
         }
     });
 
+    // 递归搜索和内容匹配可能很慢：异步执行，按已检查的文件数上报进度，客户端断开或取消请求后
+    // 提前结束（遍历目录时也检查）
+    auto searchFiles = [](const nlohmann::json& args) {
+        if (!g_fileService) {
+            return MakeTextContent("Error: FileService not initialized", true);
+        }
+        FindFilesParams params{};
+        params.cancel = CurrentCancellationToken();
+        params.query = args.value("name_query", "");
+        params.days = args.value("days", 0);
+        params.max = args.value("max", 100);
+        if (params.max <= 0) {
+            params.max = 100;
+        }
+        if (args.contains("exts") && args["exts"].is_array()) {
+            for (const auto& ext : args["exts"]) {
+                if (ext.is_string()) {
+                    params.exts.push_back(ext.get<std::string>());
+                }
+            }
+        }
+        std::string path = args.value("path", "");
+        std::vector<FileInfo> files;
+        if (!path.empty()) {
+            files = g_fileService->findFilesInPath(path, params);
+        } else {
+            files = g_fileService->findFiles(params);
+        }
+        if (params.cancel.cancelled()) {
+            return MakeTextContent("Error: search cancelled", true);
+        }
+
+        int64_t minSize = args.value("min_size", static_cast<int64_t>(-1));
+        int64_t maxSize = args.value("max_size", static_cast<int64_t>(-1));
+        std::string contentQuery = args.value("content_query", "");
+
+        nlohmann::json payload = nlohmann::json::array();
+        size_t checked = 0;
+        for (const auto& file : files) {
+            if (params.cancel.cancelled()) {
+                return MakeTextContent("Error: search cancelled", true);
+            }
+            if (++checked % 64 == 0) {
+                ReportToolProgress(static_cast<double>(checked), static_cast<double>(files.size()));
+            }
+            if (minSize >= 0 && file.size < minSize) {
+                continue;
+            }
+            if (maxSize >= 0 && file.size > maxSize) {
+                continue;
+            }
+
+            nlohmann::json entry;
+            entry["path"] = file.path;
+            entry["size"] = file.size;
+            entry["modified"] = file.modified;
+            entry["extension"] = file.extension;
+
+            if (!contentQuery.empty()) {
+                try {
+                    auto matches = g_fileService->searchTextInFile(file.path, contentQuery);
+                    if (matches.empty()) {
+                        continue;
+                    }
+                    nlohmann::json matchList = nlohmann::json::array();
+                    size_t limit = std::min<size_t>(matches.size(), 5);
+                    for (size_t i = 0; i < limit; ++i) {
+                        matchList.push_back({
+                            {"line", matches[i].line},
+                            {"text", matches[i].text}
+                        });
+                    }
+                    entry["content_match_count"] = matches.size();
+                    entry["content_matches"] = matchList;
+                } catch (const std::exception&) {
+                    continue;
+                }
+            }
+
+            payload.push_back(entry);
+            if (params.max > 0 && static_cast<int>(payload.size()) >= params.max) {
+                break;
+            }
+        }
+
+        if (g_policyGuard) g_policyGuard->incrementUsageCount("search_files");
+        return MakeTextContent(payload.dump(), false);
+    };
     registry.registerTool("search_files", {
         "search_files",
         "Search files by name, metadata, and optional content",
@@ -325,81 +404,8 @@ void RegisterMcpTools() {
                 {"max", {{"type", "number"}}}
             }}
         },
-        [](const nlohmann::json& args) {
-            if (!g_fileService) {
-                return MakeTextContent("Error: FileService not initialized", true);
-            }
-            FindFilesParams params{};
-            params.query = args.value("name_query", "");
-            params.days = args.value("days", 0);
-            params.max = args.value("max", 100);
-            if (params.max <= 0) {
-                params.max = 100;
-            }
-            if (args.contains("exts") && args["exts"].is_array()) {
-                for (const auto& ext : args["exts"]) {
-                    if (ext.is_string()) {
-                        params.exts.push_back(ext.get<std::string>());
-                    }
-                }
-            }
-            std::string path = args.value("path", "");
-            std::vector<FileInfo> files;
-            if (!path.empty()) {
-                files = g_fileService->findFilesInPath(path, params);
-            } else {
-                files = g_fileService->findFiles(params);
-            }
-
-            int64_t minSize = args.value("min_size", static_cast<int64_t>(-1));
-            int64_t maxSize = args.value("max_size", static_cast<int64_t>(-1));
-            std::string contentQuery = args.value("content_query", "");
-
-            nlohmann::json payload = nlohmann::json::array();
-            for (const auto& file : files) {
-                if (minSize >= 0 && file.size < minSize) {
-                    continue;
-                }
-                if (maxSize >= 0 && file.size > maxSize) {
-                    continue;
-                }
-
-                nlohmann::json entry;
-                entry["path"] = file.path;
-                entry["size"] = file.size;
-                entry["modified"] = file.modified;
-                entry["extension"] = file.extension;
-
-                if (!contentQuery.empty()) {
-                    try {
-                        auto matches = g_fileService->searchTextInFile(file.path, contentQuery);
-                        if (matches.empty()) {
-                            continue;
-                        }
-                        nlohmann::json matchList = nlohmann::json::array();
-                        size_t limit = std::min<size_t>(matches.size(), 5);
-                        for (size_t i = 0; i < limit; ++i) {
-                            matchList.push_back({
-                                {"line", matches[i].line},
-                                {"text", matches[i].text}
-                            });
-                        }
-                        entry["content_match_count"] = matches.size();
-                        entry["content_matches"] = matchList;
-                    } catch (const std::exception&) {
-                        continue;
-                    }
-                }
-
-                payload.push_back(entry);
-                if (params.max > 0 && static_cast<int>(payload.size()) >= params.max) {
-                    break;
-                }
-            }
-
-            if (g_policyGuard) g_policyGuard->incrementUsageCount("search_files");
-            return MakeTextContent(payload.dump(), false);
-        }
+        searchFiles,
+        RunOnToolPool(searchFiles)
     });
 
     registry.registerTool("list_directory", {
@@ -796,6 +802,42 @@ void RegisterMcpTools() {
         }
     });
 
+    // 命令可能长时间运行：异步执行，不占用请求线程；客户端断开或取消请求时结束进程树
+    auto executeCommand = [](const nlohmann::json& args) {
+        if (!g_commandService) {
+            return MakeTextContent("Error: CommandService not initialized", true);
+        }
+        if (!args.contains("command")) {
+            return MakeTextContent("Error: Command is required", true);
+        }
+        try {
+            std::string command = args["command"].get<std::string>();
+            std::string trimmed = command;
+            trimmed.erase(trimmed.begin(),
+                          std::find_if(trimmed.begin(), trimmed.end(),
+                                       [](unsigned char c) { return !std::isspace(c); }));
+            trimmed.erase(std::find_if(trimmed.rbegin(), trimmed.rend(),
+                                       [](unsigned char c) { return !std::isspace(c); }).base(),
+                          trimmed.end());
+            std::string lower = trimmed;
+            std::transform(lower.begin(), lower.end(), lower.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (lower.empty() || lower == "/" || lower == "help") {
+                return MakeTextContent(BuildHelpJson(), false);
+            }
+            auto cmdResult = g_commandService->executeCommand(command, {}, 30000, CurrentCancellationToken());
+            nlohmann::json payload;
+            payload["stdout"] = cmdResult.stdoutText;
+            payload["stderr"] = cmdResult.stderrText;
+            payload["exit_code"] = cmdResult.exitCode;
+            payload["timed_out"] = cmdResult.timedOut;
+            payload["cancelled"] = cmdResult.cancelled;
+            if (g_policyGuard) g_policyGuard->incrementUsageCount("execute_command");
+            return MakeTextContent(payload.dump(), false);
+        } catch (const std::exception& e) {
+            return MakeTextContent(std::string("Error: ") + e.what(), true);
+        }
+    };
     registry.registerTool("execute_command", {
         "execute_command",
         "Execute command",
@@ -806,40 +848,8 @@ void RegisterMcpTools() {
             {"properties", {{"command", {{"type", "string"}}}}},
             {"required", {"command"}}
         },
-        [](const nlohmann::json& args) {
-            if (!g_commandService) {
-                return MakeTextContent("Error: CommandService not initialized", true);
-            }
-            if (!args.contains("command")) {
-                return MakeTextContent("Error: Command is required", true);
-            }
-            try {
-                std::string command = args["command"].get<std::string>();
-                std::string trimmed = command;
-                trimmed.erase(trimmed.begin(),
-                              std::find_if(trimmed.begin(), trimmed.end(),
-                                           [](unsigned char c) { return !std::isspace(c); }));
-                trimmed.erase(std::find_if(trimmed.rbegin(), trimmed.rend(),
-                                           [](unsigned char c) { return !std::isspace(c); }).base(),
-                              trimmed.end());
-                std::string lower = trimmed;
-                std::transform(lower.begin(), lower.end(), lower.begin(),
-                               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-                if (lower.empty() || lower == "/" || lower == "help") {
-                    return MakeTextContent(BuildHelpJson(), false);
-                }
-                auto cmdResult = g_commandService->executeCommand(command, {});
-                nlohmann::json payload;
-                payload["stdout"] = cmdResult.stdoutText;
-                payload["stderr"] = cmdResult.stderrText;
-                payload["exit_code"] = cmdResult.exitCode;
-                payload["timed_out"] = cmdResult.timedOut;
-                if (g_policyGuard) g_policyGuard->incrementUsageCount("execute_command");
-                return MakeTextContent(payload.dump(), false);
-            } catch (const std::exception& e) {
-                return MakeTextContent(std::string("Error: ") + e.what(), true);
-            }
-        }
+        executeCommand,
+        RunOnToolPool(executeCommand)
     });
 
     registry.registerTool("kill_process", {
@@ -1142,7 +1152,7 @@ void RegisterMcpTools() {
                     if (it.is_string()) additional.push_back(it.get<std::string>());
                 }
             }
-            auto result = g_browserService->launch(appPathOrName, headless, userDataDir, additional);
+            auto result = g_browserService->launch(appPathOrName, headless, userDataDir, additional, CurrentCancellationToken());
             if (!result.success) {
                 return MakeTextContent(std::string("Error: ") + result.error, true);
             }
@@ -1175,7 +1185,7 @@ void RegisterMcpTools() {
             if (sessionId.empty()) {
                 return MakeTextContent("Error: session_id is required", true);
             }
-            auto tab = g_browserService->newTab(sessionId);
+            auto tab = g_browserService->newTab(sessionId, CurrentCancellationToken());
             if (!tab.success) {
                 return MakeTextContent(std::string("Error: ") + tab.error, true);
             }
@@ -1214,7 +1224,7 @@ void RegisterMcpTools() {
                 return MakeTextContent("Error: session_id, target_id, url are required", true);
             }
             std::string err;
-            bool ok = g_browserService->navigate(sessionId, targetId, url, &err);
+            bool ok = g_browserService->navigate(sessionId, targetId, url, &err, CurrentCancellationToken());
             if (!ok) {
                 return MakeTextContent(std::string("Error: ") + err, true);
             }
@@ -1249,7 +1259,7 @@ void RegisterMcpTools() {
             if (sessionId.empty() || targetId.empty() || expr.empty()) {
                 return MakeTextContent("Error: session_id, target_id, expression are required", true);
             }
-            auto res = g_browserService->eval(sessionId, targetId, expr, awaitPromise);
+            auto res = g_browserService->eval(sessionId, targetId, expr, awaitPromise, CurrentCancellationToken());
             if (!res.success) {
                 return MakeTextContent(std::string("Error: ") + res.error, true);
             }
@@ -1284,7 +1294,7 @@ void RegisterMcpTools() {
             if (sessionId.empty() || targetId.empty()) {
                 return MakeTextContent("Error: session_id and target_id are required", true);
             }
-            auto shot = g_browserService->screenshotPngToFile(sessionId, targetId);
+            auto shot = g_browserService->screenshotPngToFile(sessionId, targetId, CurrentCancellationToken());
             if (!shot.success) {
                 return MakeTextContent(std::string("Error: ") + shot.error, true);
             }
@@ -1357,7 +1367,7 @@ void RegisterMcpTools() {
                 return MakeTextContent("Error: App not allowed", true);
             }
 
-            auto result = g_browserService->openUrl(url, app, headless, sessionId);
+            auto result = g_browserService->openUrl(url, app, headless, sessionId, CurrentCancellationToken());
             if (!result.success) {
                 return MakeTextContent(std::string("Error: ") + result.error, true);
             }
@@ -1415,13 +1425,14 @@ void RegisterMcpTools() {
                 return MakeTextContent("Error: App not allowed", true);
             }
 
-            auto opened = g_browserService->openUrl(url, app, headless, sessionId);
+            CancellationToken cancel = CurrentCancellationToken();
+            auto opened = g_browserService->openUrl(url, app, headless, sessionId, cancel);
             if (!opened.success) {
                 return MakeTextContent(std::string("Error: ") + opened.error, true);
             }
 
-            if (waitMs > 0) {
-                Sleep((DWORD)waitMs);
+            if (waitMs > 0 && cancel.waitFor(waitMs)) {
+                return MakeTextContent("Error: Cancelled", true);
             }
 
             // Poll a bit to allow dynamic pages to render.
@@ -1451,7 +1462,7 @@ void RegisterMcpTools() {
                 "  return { ok: false, url: location.href, title: document.title || '', text: String(text || '').slice(0, maxChars) };"
                 "})()";
 
-            auto ev = g_browserService->eval(opened.session_id, opened.target_id, js, true);
+            auto ev = g_browserService->eval(opened.session_id, opened.target_id, js, true, cancel);
             if (!ev.success) {
                 return MakeTextContent(std::string("Error: ") + ev.error, true);
             }
@@ -1541,66 +1552,3 @@ void RegisterMcpTools() {
         }
     });
 }
-// MCP 协议：初始化
-std::string HandleMCPInitialize(const std::string& body) {
-    std::string response = "{"
-        "\"protocolVersion\":\"2024-11-05\","
-        "\"capabilities\":{\"tools\":{}},"
-        "\"serverInfo\":{"
-            "\"name\":\"WinBridgeAgent\","
-            "\"version\":\"" CLAWDESK_VERSION "\""
-        "}"
-    "}";
-    return response;
-}
-
-// MCP 协议：列出工具
-std::string HandleMCPToolsList() {
-    auto tools = ToolRegistry::getInstance().getAllTools();
-    nlohmann::json response;
-    response["tools"] = nlohmann::json::array();
-    for (const auto& tool : tools) {
-        response["tools"].push_back({
-            {"name", tool.name},
-            {"description", tool.description},
-            {"inputSchema", tool.inputSchema}
-        });
-    }
-    return response.dump();
-}
-
-// MCP 协议：调用工具
-std::string HandleMCPToolsCall(const std::string& body) {
-    nlohmann::json payload;
-    try {
-        payload = nlohmann::json::parse(body);
-    } catch (const std::exception& e) {
-        return DumpMcpResponse(MakeTextContent(std::string("Error: Invalid JSON: ") + e.what(), true));
-    }
-
-    if (!payload.contains("name")) {
-        return DumpMcpResponse(MakeTextContent("Error: Missing tool name", true));
-    }
-
-    std::string toolName = payload["name"].get<std::string>();
-    nlohmann::json args = payload.value("arguments", nlohmann::json::object());
-
-    if (!ToolRegistry::getInstance().hasTool(toolName)) {
-        return DumpMcpResponse(MakeTextContent("Error: Unknown tool", true));
-    }
-
-    if (g_policyGuard) {
-        auto decision = g_policyGuard->evaluateToolCall(toolName, args);
-        if (!decision.allowed) {
-            return DumpMcpResponse(MakeTextContent("Error: " + decision.reason, true));
-        }
-    }
-
-    try {
-        auto tool = ToolRegistry::getInstance().getTool(toolName);
-        auto response = tool.handler(args);
-        return DumpMcpResponse(response);
-    } catch (const std::exception& e) {
-        return DumpMcpResponse(MakeTextContent(std::string("Error: ") + e.what(), true));
-    }
-}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "mcp_handlers.h"
+#include "app_core.h"
+#include <nlohmann/json.hpp>
+#include "mcp/dispatcher.h"
+#include "mcp/tool_registry.h"
+
+// MCP 协议层（与平台无关）：工具结果封装和 REST 形式的 initialize / tools/list / tools/call，
+// 后者是 mcp/dispatcher 的薄适配层。具体工具在 mcp_handlers.cpp 的 RegisterMcpTools 中注册
+
+nlohmann::json MakeTextContent(const std::string& text, bool isError) {
+    nlohmann::json response;
+    response["content"] = nlohmann::json::array();
+    response["content"].push_back({{"type", "text"}, {"text", text}});
+    response["isError"] = isError;
+    return response;
+}
+
+std::string DumpMcpResponse(const nlohmann::json& response) {
+    return response.dump();
+}
+
+// MCP 协议：初始化
+std::string HandleMCPInitialize(const std::string& /*body*/) {
+    return MakeMcpInitializeResult().dump();
+}
+
+// MCP 协议：列出工具（HTTP 路由直接发送注册表缓存的字节，见 http_routes.cpp）
+std::string HandleMCPToolsList() {
+    return *ToolRegistry::getInstance().getToolsList()->json;
+}
+
+// MCP 协议：调用工具（REST 形式直接返回工具结果，错误封装为 isError 的文本内容）
+std::string HandleMCPToolsCall(const std::string& body) {
+    nlohmann::json payload;
+    try {
+        payload = nlohmann::json::parse(body);
+    } catch (const std::exception& e) {
+        return DumpMcpResponse(MakeTextContent(std::string("Error: Invalid JSON: ") + e.what(), true));
+    }
+
+    McpToolCallResult call = CallMcpTool(payload, "MCP-REST");
+    if (!call.ok()) {
+        return DumpMcpResponse(MakeTextContent("Error: " + call.errorMessage, true));
+    }
+    return DumpMcpResponse(call.result);
+}
@@ -17,19 +17,15 @@
  * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
  */
 #include "mcp_sse.h"
-#include "http_server.h"
-#include "app_globals.h"
+#include "app_core.h"
 #include "mcp_handlers.h"
 #include <nlohmann/json.hpp>
 #include <random>
 #include <sstream>
-#include <algorithm>
-#include <cctype>
-#include "mcp/tool_registry.h"
-#include "policy/policy_guard.h"
+#include "mcp/batch_executor.h"
+#include "mcp/dispatcher.h"
 #include "support/config_manager.h"
-#include "support/audit_logger.h"
-#include "support/dashboard_window.h"
+#include "utils/monotonic_clock.h"
 
 // ── 生成 32 字节随机十六进制 session ID ────────────────────
 static std::string GenerateSseSessionId() {
@@ -51,27 +47,28 @@ SseSessionStore& SseSessionStore::getInstance() {
     return instance;
 }
 
-static const size_t kMaxSseSessions = 16;       // 最多同时 16 个 SSE 连接
-static const DWORD  kSseSessionTtlMs = 3600000;  // 1 小时 TTL
-
-static void CloseSessionSocket(const std::shared_ptr<SseSession>& session) {
+static void CloseSessionStream(const std::shared_ptr<SseSession>& session) {
     if (!session) return;
-    std::lock_guard<std::mutex> lock(session->writeMutex);
-    if (session->socket != INVALID_SOCKET) {
-        closesocket(session->socket);
-        session->socket = INVALID_SOCKET;
+    session->alive.store(false);
+    if (session->writer) {
+        session->writer->close();
     }
 }
 
-std::shared_ptr<SseSession> SseSessionStore::createSession(SOCKET socket) {
+void SseSessionStore::configure(size_t maxSessions, uint64_t ttlMs) {
+    maxSessions_.store(maxSessions > 0 ? maxSessions : 1);
+    ttlMs_.store(ttlMs);
+}
+
+std::shared_ptr<SseSession> SseSessionStore::createSession(std::shared_ptr<SseStreamWriter> writer) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    // 清理过期 session
-    DWORD now = GetTickCount();
+    // 清理过期 session（正常情况下已由连接的 TTL 定时器和断开处理移除，这里兜底）
+    uint64_t now = MonotonicMillis();
+    uint64_t ttlMs = ttlMs_.load();
     for (auto it = sessions_.begin(); it != sessions_.end(); ) {
-        if ((now - it->second->createdAt) > kSseSessionTtlMs || !it->second->alive.load()) {
-            it->second->alive.store(false);
-            CloseSessionSocket(it->second);
+        if ((now - it->second->createdAt) > ttlMs || !it->second->alive.load()) {
+            CloseSessionStream(it->second);
             it = sessions_.erase(it);
         } else {
             ++it;
@@ -79,16 +76,16 @@ std::shared_ptr<SseSession> SseSessionStore::createSession(SOCKET socket) {
     }
 
     // 拒绝超上限
-    if (sessions_.size() >= kMaxSseSessions) {
+    if (sessions_.size() >= maxSessions_.load()) {
         return nullptr;
     }
 
     auto session = std::make_shared<SseSession>();
     session->sessionId = GenerateSseSessionId();
-    session->socket = socket;
+    session->writer = std::move(writer);
     session->alive.store(true);
-    session->initialized = false;
-    session->createdAt = GetTickCount();
+    session->initialized.store(false);
+    session->createdAt = MonotonicMillis();
     sessions_[session->sessionId] = session;
     return session;
 }
@@ -108,10 +105,7 @@ void SseSessionStore::removeSession(const std::string& sessionId) {
 void SseSessionStore::shutdownAllSessions() {
     std::lock_guard<std::mutex> lock(mutex_);
     for (auto& pair : sessions_) {
-        auto& session = pair.second;
-        session->alive.store(false);
-        // 关闭 socket 会让阻塞在 Sleep/send 的线程尽快收到错误并退出
-        CloseSessionSocket(session);
+        CloseSessionStream(pair.second);
     }
     sessions_.clear();
 }
@@ -136,213 +130,105 @@ bool SseSessionStore::sendSseEvent(const std::string& sessionId,
     // 但 JSON 通常是单行
     frame += "data: " + data + "\n\n";
 
-    std::lock_guard<std::mutex> lock(session->writeMutex);
-    if (session->socket == INVALID_SOCKET) {
-        session->alive.store(false);
-        return false;
-    }
-    if (!SendAll(session->socket, frame)) {
+    if (!session->writer || !session->writer->write(frame)) {
         session->alive.store(false);
-        closesocket(session->socket);
-        session->socket = INVALID_SOCKET;
         return false;
     }
     return true;
 }
 
-// ── 辅助函数 ──────────────────────────────────────────────
-
-// 从 request 中提取 query parameter
-static std::string GetSseQueryParam(const std::string& request, const std::string& paramName) {
-    // 解析请求行中的 URL
-    size_t firstSpace = request.find(' ');
-    if (firstSpace == std::string::npos) return "";
-    size_t secondSpace = request.find(' ', firstSpace + 1);
-    if (secondSpace == std::string::npos) return "";
-    std::string url = request.substr(firstSpace + 1, secondSpace - firstSpace - 1);
-
-    size_t qmark = url.find('?');
-    if (qmark == std::string::npos) return "";
-    std::string query = url.substr(qmark + 1);
-
-    std::string key = paramName + "=";
-    size_t pos = query.find(key);
-    if (pos == std::string::npos) return "";
-    size_t valStart = pos + key.size();
-    size_t valEnd = query.find('&', valStart);
-    if (valEnd == std::string::npos) valEnd = query.size();
-    return query.substr(valStart, valEnd - valStart);
-}
-
-// 从 HTTP 请求中提取 body
-static std::string ExtractSseBody(const std::string& request) {
-    size_t pos = request.find("\r\n\r\n");
-    if (pos == std::string::npos) return "";
-    return request.substr(pos + 4);
-}
-
-// 从 HTTP 请求中提取 header（不区分大小写）
-static std::string ExtractSseHeader(const std::string& request, const std::string& headerNameLower) {
-    std::string searchKey = "\r\n" + headerNameLower + ":";
-    std::string lowerReq = request;
-    std::transform(lowerReq.begin(), lowerReq.end(), lowerReq.begin(),
-                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    size_t pos = lowerReq.find(searchKey);
-    if (pos == std::string::npos) return "";
-    size_t valStart = pos + searchKey.size();
-    while (valStart < request.size() && request[valStart] == ' ') ++valStart;
-    size_t valEnd = request.find("\r\n", valStart);
-    if (valEnd == std::string::npos) valEnd = request.size();
-    return request.substr(valStart, valEnd - valStart);
-}
-
-// JSON-RPC 错误码
-static const int kParseError     = -32700;
-static const int kInvalidRequest = -32600;
-static const int kMethodNotFound = -32601;
-static const int kInvalidParams  = -32602;
-static const int kServerError    = -32000;
-
-static const char* kSupportedProtocolVersion = "2024-11-05";
-
-// 构建 JSON-RPC 成功响应
-static nlohmann::json MakeRpcResult(const nlohmann::json& id, const nlohmann::json& result) {
-    return {{"jsonrpc", "2.0"}, {"id", id}, {"result", result}};
-}
-
-// 构建 JSON-RPC 错误响应
-static nlohmann::json MakeRpcError(const nlohmann::json& id, int code, const std::string& message) {
-    return {{"jsonrpc", "2.0"}, {"id", id}, {"error", {{"code", code}, {"message", message}}}};
-}
-
 // ── 检测 SSE 请求 ─────────────────────────────────────────
 
-bool IsSseRequest(const std::string& request) {
-    // 匹配 "GET /sse " 或 "GET /sse?"
-    if (request.size() < 9) return false;
-    if (request.substr(0, 9) == "GET /sse " || request.substr(0, 9) == "GET /sse?") return true;
-    if (request.size() >= 10 && request.substr(0, 10) == "GET /sse H") return true;
-    return false;
+bool IsSseRequest(const HttpRequest& request) {
+    return request.method == "GET" && request.path == "/sse";
 }
 
-// ── SSE 连接线程 ──────────────────────────────────────────
+// ── 打开 SSE 流 ──────────────────────────────────────────
 
-DWORD WINAPI SseConnectionThread(LPVOID lpParam) {
-    SseThreadParams* params = static_cast<SseThreadParams*>(lpParam);
-    SOCKET sock = params->socket;
-    std::string request = std::move(params->request);
-    delete params;
+std::string MakeSseResponseHead(const SseStreamWriter& writer) {
+    std::string head =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: keep-alive\r\n"
+        "Access-Control-Allow-Origin: *\r\n";
+    if (const char* encoding = writer.contentEncoding()) {
+        head += std::string("Content-Encoding: ") + encoding + "\r\nVary: Accept-Encoding\r\n";
+    }
+    head += "\r\n";
+    return head;
+}
 
+bool OpenSseStream(const HttpRequest& request,
+                   std::shared_ptr<SseStreamWriter> writer,
+                   std::string& sessionId,
+                   HttpResponse& error) {
     AppendHttpServerLogA("[SSE] New SSE connection");
-    if (g_dashboard) g_dashboard->logRequest("SSE", "GET /sse - new connection");
-
-    // 设置 SSE socket 发送超时（5 秒），防止阻塞
-    int sndTimeout = 5000;
-    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (const char*)&sndTimeout, sizeof(sndTimeout));
+    LogActivity(ActivityKind::Request, "SSE", "GET /sse - new connection");
 
     // 授权检查
     if (!IsAuthorizedRequest(request)) {
-        std::string resp = MakeUnauthorizedResponse();
-        SendAll(sock, resp);
-        closesocket(sock);
         AppendHttpServerLogA("[SSE] Unauthorized, closing");
-        return 0;
+        error = MakeUnauthorizedResponse();
+        return false;
     }
 
     // 创建 session（可能因上限被拒绝）
-    auto session = SseSessionStore::getInstance().createSession(sock);
+    auto session = SseSessionStore::getInstance().createSession(writer);
     if (!session) {
-        std::string body503 = "{\"error\":\"Too many SSE sessions, try later\"}";
-        std::string resp = "HTTP/1.1 503 Service Unavailable\r\n"
-                           "Content-Type: application/json\r\n"
-                           "Access-Control-Allow-Origin: *\r\n"
-                           "Content-Length: " + std::to_string(body503.size()) + "\r\n"
-                           "\r\n" + body503;
-        SendAll(sock, resp);
-        closesocket(sock);
         AppendHttpServerLogA("[SSE] Session limit reached, rejecting");
-        if (g_dashboard) g_dashboard->logError("SSE", "Session limit reached");
-        return 0;
+        LogActivity(ActivityKind::Error, "SSE", "Session limit reached");
+        error = MakeJsonResponse(503, "{\"error\":\"Too many SSE sessions, try later\"}");
+        return false;
     }
-    std::string sessionId = session->sessionId;
+    sessionId = session->sessionId;
     AppendHttpServerLogA("[SSE] Session created: " + sessionId);
-    if (g_dashboard) g_dashboard->logSuccess("SSE", "Session created: " + sessionId);
+    LogActivity(ActivityKind::Success, "SSE", "Session created: " + sessionId);
 
-    // 发送 SSE 响应头
-    std::string sseHeaders =
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: text/event-stream\r\n"
-        "Cache-Control: no-cache\r\n"
-        "Connection: keep-alive\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "\r\n";
-
-    {
-        bool headerOk = false;
-        {
-            std::lock_guard<std::mutex> lock(session->writeMutex);
-            headerOk = SendAll(sock, sseHeaders);
-        }
-        if (!headerOk) {
-            AppendHttpServerLogA("[SSE] Failed to send headers, closing");
-            SseSessionStore::getInstance().removeSession(sessionId);
-            CloseSessionSocket(session);
-            return 0;
-        }
+    // 发送 SSE 响应头（此后连接上只有事件流，心跳由 HTTP 服务器定时写出）
+    if (!writer->writeHead(MakeSseResponseHead(*writer))) {
+        AppendHttpServerLogA("[SSE] Failed to send headers, closing");
+        SseSessionStore::getInstance().removeSession(sessionId);
+        CloseSessionStream(session);
+        return true;
     }
 
-    // 发送 endpoint 事件，告诉客户端 POST 地址（使用绝对 URL）
-    std::string host = ExtractSseHeader(request, "host");
+    // 发送 endpoint 事件，告诉客户端 POST 地址（使用绝对 URL，HTTPS 连接上用 https）
+    std::string host(request.header("host"));
+    std::string scheme = request.secure ? "https://" : "http://";
     std::string endpointData;
     if (!host.empty()) {
-        endpointData = "http://" + host + "/messages?sessionId=" + sessionId;
+        endpointData = scheme + host + "/messages?sessionId=" + sessionId;
     } else {
         // fallback: 用配置的监听地址和端口
-        int port = g_configManager ? g_configManager->getServerPort() : 35182;
-        endpointData = "http://127.0.0.1:" + std::to_string(port) + "/messages?sessionId=" + sessionId;
+        int port;
+        if (request.secure) {
+            port = g_configManager ? g_configManager->getHttpTlsPort() : 0;
+        } else {
+            port = g_configManager ? g_configManager->getServerPort() : 35182;
+        }
+        endpointData = scheme + "127.0.0.1:" + std::to_string(port) + "/messages?sessionId=" + sessionId;
     }
     if (!SseSessionStore::getInstance().sendSseEvent(sessionId, "endpoint", endpointData)) {
         AppendHttpServerLogA("[SSE] Failed to send endpoint event, closing");
         SseSessionStore::getInstance().removeSession(sessionId);
-        CloseSessionSocket(session);
-        return 0;
+        CloseSessionStream(session);
+        return true;
     }
 
     AppendHttpServerLogA("[SSE] Endpoint event sent: " + endpointData);
+    return true;
+}
 
-    // Keep-alive 循环：定期发送 SSE comment 以检测断连
-    // 用短间隔 Sleep 代替一次 15 秒长等待，加速退出响应
-    while (g_running && session->alive.load()) {
-        for (int i = 0; i < 15 && g_running && session->alive.load(); ++i) {
-            Sleep(1000);
-        }
-
-        if (!g_running || !session->alive.load()) break;
-
-        // SSE comment（以 ":" 开头）不会被客户端当作事件
-        std::string ping = ": ping\n\n";
-        {
-            std::lock_guard<std::mutex> lock(session->writeMutex);
-            SOCKET s = session->socket;
-            if (s == INVALID_SOCKET || !SendAll(s, ping)) {
-                AppendHttpServerLogA("[SSE] Ping failed, client disconnected");
-                if (g_dashboard) g_dashboard->logError("SSE", "Client disconnected: " + sessionId);
-                session->alive.store(false);
-                if (session->socket != INVALID_SOCKET) {
-                    closesocket(session->socket);
-                    session->socket = INVALID_SOCKET;
-                }
-                break;
-            }
-        }
+// 连接断开时由 HTTP 服务器调用
+void CloseSseStream(const std::string& sessionId) {
+    auto session = SseSessionStore::getInstance().findSession(sessionId);
+    if (session) {
+        session->alive.store(false);
     }
-
-    // 清理（socket 可能已被 shutdownAllSessions 关闭）
-    AppendHttpServerLogA("[SSE] Session closing: " + sessionId);
-    if (g_dashboard) g_dashboard->logProcessing("SSE", "Session closing: " + sessionId);
     SseSessionStore::getInstance().removeSession(sessionId);
-    CloseSessionSocket(session);
-    return 0;
+    AppendHttpServerLogA("[SSE] Session closing: " + sessionId);
+    LogActivity(ActivityKind::Processing, "SSE", "Session closing: " + sessionId);
 }
 
 // ── 处理 POST /messages ──────────────────────────────────
@@ -358,203 +244,129 @@ static bool IsValidSessionId(const std::string& id) {
     return true;
 }
 
-std::string HandleSseMessage(const std::string& request) {
+// 异步 tools/call 的响应与进度通知作为 message 事件发到 session 的事件流
+class SseToolCallChannel : public McpResponseChannel {
+public:
+    explicit SseToolCallChannel(std::shared_ptr<SseSession> session) : session_(std::move(session)) {}
+
+    bool notify(const nlohmann::json& notification) override {
+        return SseSessionStore::getInstance().sendSseEvent(session_->sessionId, "message", notification.dump());
+    }
+
+    void respond(const nlohmann::json& response) override {
+        SseSessionStore::getInstance().sendSseEvent(session_->sessionId, "message", response.dump());
+    }
+
+    bool closed() const override { return !session_->alive.load(); }
+
+private:
+    std::shared_ptr<SseSession> session_;
+};
+
+// 一条 JSON-RPC 消息：校验后分发，返回应通过 SSE 发回的响应；通知、客户端发来的 response
+// 和已直接发出的响应返回 null。batch 元素（inBatch）中不允许 initialize
+static nlohmann::json HandleSseRpc(const nlohmann::json& item, const std::shared_ptr<SseSession>& session,
+                                   bool inBatch) {
+    JsonRpcMessage msg = ParseJsonRpcMessage(item);
+    switch (msg.kind) {
+    case JsonRpcMessage::Invalid:
+        return msg.error;
+    case JsonRpcMessage::Response:
+        return nullptr;
+    case JsonRpcMessage::Notification:
+        // 不通过 SSE 发送响应
+        if (msg.method == "notifications/initialized") {
+            session->initialized.store(true);
+            AppendHttpServerLogA("[SSE] Session initialized: " + session->sessionId);
+        } else if (msg.method == "notifications/cancelled") {
+            CancelMcpRequest(msg.params, session->sessionId, "SSE");
+        }
+        return nullptr;
+    case JsonRpcMessage::Request:
+        break;
+    }
+
+    AppendHttpServerLogA("[SSE] RPC request: " + msg.method + (inBatch ? " (batch)" : ""));
+    LogActivity(ActivityKind::Request, "SSE", msg.method);
+
+    // ── initialize ──
+    if (msg.method == "initialize") {
+        if (inBatch) {
+            return MakeJsonRpcError(msg.id, kJsonRpcInvalidRequest, "initialize must not be part of a batch");
+        }
+        session->protocolVersion = kMcpProtocolVersion;
+        LogActivity(ActivityKind::Success, "SSE", "initialize OK, version=" + std::string(kMcpProtocolVersion));
+        return MakeJsonRpcResult(msg.id, MakeMcpInitializeResult());
+    }
+
+    // tools/list：直接发送注册表缓存的字节，不构造响应对象
+    if (msg.method == "tools/list" && !inBatch) {
+        McpToolsListResponse list = MakeMcpToolsListResponse(msg.id, "SSE");
+        SseSessionStore::getInstance().sendSseEvent(session->sessionId, "message", list.join());
+        return nullptr;
+    }
+
+    // 异步工具 / 带 progressToken 的调用：POST 立即返回 202，进度通知和响应稍后经事件流发出
+    if (msg.method == "tools/call" && !inBatch && IsAsyncMcpToolCall(msg.params)) {
+        StartMcpToolCall(msg, "SSE", std::make_shared<SseToolCallChannel>(session), session->sessionId);
+        return nullptr;
+    }
+
+    return DispatchMcpRequest(msg, "SSE", session->sessionId);
+}
+
+HttpResponse HandleSseMessage(const HttpRequest& request) {
     // 提取并校验 sessionId
-    std::string sessionId = GetSseQueryParam(request, "sessionId");
+    std::string sessionId = request.queryParam("sessionId");
     if (sessionId.empty() || !IsValidSessionId(sessionId)) {
-        nlohmann::json err = MakeRpcError(nullptr, kInvalidRequest, "Missing sessionId query parameter");
-        std::string body = err.dump();
-        return "HTTP/1.1 400 Bad Request\r\n"
-               "Content-Type: application/json\r\n"
-               "Access-Control-Allow-Origin: *\r\n"
-               "Content-Length: " + std::to_string(body.size()) + "\r\n"
-               "\r\n" + body;
+        nlohmann::json err = MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Missing sessionId query parameter");
+        return MakeJsonResponse(400, err.dump());
     }
 
     // 查找 session
     auto session = SseSessionStore::getInstance().findSession(sessionId);
     if (!session || !session->alive.load()) {
-        nlohmann::json err = MakeRpcError(nullptr, kInvalidRequest,
+        nlohmann::json err = MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest,
             "Unknown or expired session. Connect to GET /sse first.");
-        std::string body = err.dump();
-        return "HTTP/1.1 404 Not Found\r\n"
-               "Content-Type: application/json\r\n"
-               "Access-Control-Allow-Origin: *\r\n"
-               "Content-Length: " + std::to_string(body.size()) + "\r\n"
-               "\r\n" + body;
+        return MakeJsonResponse(404, err.dump());
     }
 
     // 解析 body
-    std::string rawBody = ExtractSseBody(request);
     nlohmann::json msg;
     try {
-        msg = nlohmann::json::parse(rawBody);
+        msg = nlohmann::json::parse(request.body.begin(), request.body.end());
     } catch (const std::exception& e) {
-        nlohmann::json err = MakeRpcError(nullptr, kParseError,
+        nlohmann::json err = MakeJsonRpcError(nullptr, kJsonRpcParseError,
             std::string("Parse error: ") + e.what());
         std::string body = err.dump();
         SseSessionStore::getInstance().sendSseEvent(sessionId, "message", body);
-        return "HTTP/1.1 202 Accepted\r\n"
-               "Access-Control-Allow-Origin: *\r\n"
-               "Content-Length: 0\r\n"
-               "\r\n";
-    }
-
-    if (!msg.is_object()) {
-        nlohmann::json err = MakeRpcError(nullptr, kInvalidRequest, "Expected JSON object");
-        std::string body = err.dump();
-        SseSessionStore::getInstance().sendSseEvent(sessionId, "message", body);
-        return "HTTP/1.1 202 Accepted\r\n"
-               "Access-Control-Allow-Origin: *\r\n"
-               "Content-Length: 0\r\n"
-               "\r\n";
+        return AcceptedResponse();
     }
 
-    // 校验 jsonrpc
-    if (!msg.contains("jsonrpc") || msg["jsonrpc"] != "2.0") {
-        nlohmann::json err = MakeRpcError(nullptr, kInvalidRequest,
-            "Missing or invalid 'jsonrpc' field, must be '2.0'");
-        std::string body = err.dump();
-        SseSessionStore::getInstance().sendSseEvent(sessionId, "message", body);
-        return "HTTP/1.1 202 Accepted\r\n"
-               "Access-Control-Allow-Origin: *\r\n"
-               "Content-Length: 0\r\n"
-               "\r\n";
-    }
-
-    bool hasMethod = msg.contains("method") && msg["method"].is_string();
-    bool hasId     = msg.contains("id");
-
-    // Notification（有 method 无 id）
-    if (hasMethod && !hasId) {
-        std::string methodName = msg["method"].get<std::string>();
-        if (methodName == "notifications/initialized") {
-            session->initialized = true;
-            AppendHttpServerLogA("[SSE] Session initialized: " + sessionId);
-        }
-        // notification 返回 202，不通过 SSE 发送响应
-        return "HTTP/1.1 202 Accepted\r\n"
-               "Access-Control-Allow-Origin: *\r\n"
-               "Content-Length: 0\r\n"
-               "\r\n";
-    }
-
-    if (!hasMethod) {
-        nlohmann::json err = MakeRpcError(msg.value("id", nlohmann::json(nullptr)),
-            kInvalidRequest, "Missing 'method' field");
-        std::string body = err.dump();
-        SseSessionStore::getInstance().sendSseEvent(sessionId, "message", body);
-        return "HTTP/1.1 202 Accepted\r\n"
-               "Access-Control-Allow-Origin: *\r\n"
-               "Content-Length: 0\r\n"
-               "\r\n";
-    }
-
-    // ── Request（有 method 和 id）──
-    std::string methodName = msg["method"].get<std::string>();
-    nlohmann::json rpcId = msg["id"];
-    nlohmann::json params = msg.value("params", nlohmann::json::object());
-
-    AppendHttpServerLogA("[SSE] RPC request: " + methodName);
-    if (g_dashboard) g_dashboard->logRequest("SSE", methodName);
-
     nlohmann::json rpcResponse;
-
-    // ── initialize ──
-    if (methodName == "initialize") {
-        session->protocolVersion = kSupportedProtocolVersion;
-        nlohmann::json result = {
-            {"protocolVersion", kSupportedProtocolVersion},
-            {"capabilities", {{"tools", nlohmann::json::object()}}},
-            {"serverInfo", {
-                {"name", "WinBridgeAgent"},
-                {"version", CLAWDESK_VERSION}
-            }}
-        };
-        rpcResponse = MakeRpcResult(rpcId, result);
-        if (g_dashboard) g_dashboard->logSuccess("SSE", "initialize OK, version=" + std::string(kSupportedProtocolVersion));
-    }
-    // ── ping ──
-    else if (methodName == "ping") {
-        rpcResponse = MakeRpcResult(rpcId, nlohmann::json::object());
-    }
-    // ── tools/list ──
-    else if (methodName == "tools/list") {
-        auto tools = ToolRegistry::getInstance().getAllTools();
-        nlohmann::json toolsArray = nlohmann::json::array();
-        for (const auto& tool : tools) {
-            toolsArray.push_back({
-                {"name", tool.name},
-                {"description", tool.description},
-                {"inputSchema", tool.inputSchema}
-            });
-        }
-        rpcResponse = MakeRpcResult(rpcId, {{"tools", toolsArray}});
-        if (g_dashboard) g_dashboard->logSuccess("SSE", "tools/list: " + std::to_string(tools.size()) + " tools");
-    }
-    // ── tools/call ──
-    else if (methodName == "tools/call") {
-        if (!params.contains("name") || !params["name"].is_string()) {
-            rpcResponse = MakeRpcError(rpcId, kInvalidParams,
-                "Missing or invalid 'name' in params");
+    if (msg.is_array()) {
+        // batch：各元素并发处理，响应按原顺序放在一个数组中，作为一个 SSE 事件发回
+        if (msg.empty()) {
+            rpcResponse = MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Empty batch");
+        } else if (msg.size() > kMaxJsonRpcBatchSize) {
+            rpcResponse = MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest,
+                "Batch too large (max " + std::to_string(kMaxJsonRpcBatchSize) + " messages)");
         } else {
-            std::string toolName = params["name"].get<std::string>();
-            nlohmann::json args = params.value("arguments", nlohmann::json::object());
-
-            if (!ToolRegistry::getInstance().hasTool(toolName)) {
-                rpcResponse = MakeRpcError(rpcId, kMethodNotFound,
-                    "Unknown tool: " + toolName);
-            } else {
-                // PolicyGuard 检查
-                if (g_policyGuard) {
-                    auto decision = g_policyGuard->evaluateToolCall(toolName, args);
-                    if (!decision.allowed) {
-                        rpcResponse = MakeRpcError(rpcId, kServerError,
-                            "Policy denied: " + decision.reason);
-                    }
-                }
-
-                // 如果还没被 policy 拒绝
-                if (rpcResponse.is_null()) {
-                    // 审计日志
-                    if (g_auditLogger) {
-                        clawdesk::AuditLogEntry entry;
-                        entry.time = g_auditLogger->getCurrentTimestamp();
-                        entry.tool = toolName;
-                        entry.risk = ToolRegistry::getInstance().getTool(toolName).riskLevel;
-                        entry.details = args;
-                        entry.result = "executing";
-                        g_auditLogger->logToolCall(entry);
-                    }
-
-                    try {
-                        if (g_dashboard) g_dashboard->logProcessing("SSE", "tools/call: " + toolName);
-                        auto tool = ToolRegistry::getInstance().getTool(toolName);
-                        nlohmann::json toolResult = tool.handler(args);
-                        rpcResponse = MakeRpcResult(rpcId, toolResult);
-                        if (g_dashboard) g_dashboard->logSuccess("SSE", "tools/call OK: " + toolName);
-                    } catch (const std::exception& e) {
-                        rpcResponse = MakeRpcError(rpcId, kServerError,
-                            std::string("Tool execution error: ") + e.what());
-                        if (g_dashboard) g_dashboard->logError("SSE", "tools/call error: " + toolName + " - " + e.what());
-                    }
-                }
-            }
+            AppendHttpServerLogA("[SSE] batch: " + std::to_string(msg.size()) + " messages");
+            rpcResponse = RunJsonRpcBatch(msg, [&session](const nlohmann::json& item) {
+                return HandleSseRpc(item, session, true);
+            });
+            if (rpcResponse.empty()) rpcResponse = nullptr;
         }
-    }
-    // ── 未知方法 ──
-    else {
-        rpcResponse = MakeRpcError(rpcId, kMethodNotFound,
-            "Method not found: " + methodName);
+    } else {
+        rpcResponse = HandleSseRpc(msg, session, false);
     }
 
-    // 通过 SSE 发送 JSON-RPC 响应
-    std::string responseData = rpcResponse.dump();
-    SseSessionStore::getInstance().sendSseEvent(sessionId, "message", responseData);
+    // 通过 SSE 发送 JSON-RPC 响应（通知无响应）
+    if (!rpcResponse.is_null()) {
+        SseSessionStore::getInstance().sendSseEvent(sessionId, "message", rpcResponse.dump());
+    }
 
     // POST 返回 202 Accepted
-    return "HTTP/1.1 202 Accepted\r\n"
-           "Access-Control-Allow-Origin: *\r\n"
-           "Content-Length: 0\r\n"
-           "\r\n";
+    return AcceptedResponse();
 }
@@ -17,429 +17,380 @@
  * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
  */
 #include "mcp_streamable.h"
-#include "app_globals.h"
+#include "app_core.h"
 #include "mcp_handlers.h"
 #include <nlohmann/json.hpp>
-#include <random>
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
-#include <cctype>
 #include <vector>
-#include <windows.h>
-#include "mcp/tool_registry.h"
-#include "policy/policy_guard.h"
-#include "support/config_manager.h"
-#include "support/audit_logger.h"
-#include "support/dashboard_window.h"
-
-// ── McpSessionStore ────────────────────────────────────────
-
-McpSessionStore& McpSessionStore::getInstance() {
-    static McpSessionStore instance;
-    return instance;
-}
+#include "mcp/batch_executor.h"
+#include "mcp/dispatcher.h"
 
-// 生成 32 字节随机十六进制字符串作为 session ID
-static std::string GenerateSessionId() {
-    static std::mt19937 rng(std::random_device{}());
-    std::uniform_int_distribution<int> dist(0, 15);
-    const char hex[] = "0123456789abcdef";
-    std::string id;
-    id.reserve(32);
-    for (int i = 0; i < 32; ++i) {
-        id += hex[dist(rng)];
-    }
-    return id;
-}
+// ── HTTP 辅助 ──────────────────────────────────────────────
 
-std::string McpSessionStore::createSession(const std::string& protocolVersion) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    McpSession session;
-    session.sessionId = GenerateSessionId();
-    session.protocolVersion = protocolVersion;
-    session.initialized = false;
-    session.createdAt = std::time(nullptr);
-    std::string id = session.sessionId;
-    sessions_[id] = std::move(session);
-    return id;
+// 构建 200 OK + JSON body 响应
+static HttpResponse MakeHttpJsonResponse(std::string body) {
+    return MakeJsonResponse(200, std::move(body));
 }
 
-const McpSession* McpSessionStore::findSession(const std::string& sessionId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = sessions_.find(sessionId);
-    if (it == sessions_.end()) return nullptr;
-    return &it->second;
+static HttpResponse MakeHttpErrorResponse(int httpStatus, std::string body) {
+    return MakeJsonResponse(httpStatus, std::move(body));
 }
 
-bool McpSessionStore::markInitialized(const std::string& sessionId) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = sessions_.find(sessionId);
-    if (it == sessions_.end()) return false;
-    it->second.initialized = true;
-    return true;
+static HttpResponse MakeHttp405() {
+    static const HttpResponse methodNotAllowed = [] {
+        HttpResponse r = MakeJsonResponse(405, "{\"error\":\"Method Not Allowed\"}");
+        r.addHeader("Allow", "GET, POST, DELETE, OPTIONS");
+        r.freeze();
+        return r;
+    }();
+    return methodNotAllowed;
 }
 
-void McpSessionStore::removeSession(const std::string& sessionId) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    sessions_.erase(sessionId);
+// ── 协议支持的版本 ─────────────────────────────────────────
+static const std::vector<std::string> kAcceptedProtocolVersions = {
+    "2024-11-05", "2025-03-26"
+};
+
+static bool IsAcceptedProtocolVersion(const std::string& version) {
+    for (const auto& v : kAcceptedProtocolVersions) {
+        if (v == version) return true;
+    }
+    return false;
 }
 
-// ── HTTP 辅助 ──────────────────────────────────────────────
+// ── batch ──────────────────────────────────────────────────
 
-// 构建 JSON-RPC 2.0 成功响应
-static nlohmann::json MakeJsonRpcResult(const nlohmann::json& id, const nlohmann::json& result) {
-    return {
-        {"jsonrpc", "2.0"},
-        {"id", id},
-        {"result", result}
-    };
+static bool IsRpcRequest(const nlohmann::json& msg) {
+    return msg.is_object() && msg.contains("method") && msg["method"].is_string() && msg.contains("id");
 }
 
-// 构建 JSON-RPC 2.0 错误响应
-static nlohmann::json MakeJsonRpcError(const nlohmann::json& id, int code, const std::string& message) {
-    return {
-        {"jsonrpc", "2.0"},
-        {"id", id},
-        {"error", {{"code", code}, {"message", message}}}
-    };
+// batch 中的一条消息：校验后分发。通知和客户端发来的 response 返回 null。
+// initialize 不能出现在 batch 中（需要单独的响应头返回 session）
+static nlohmann::json HandleBatchItem(const nlohmann::json& item, const std::string& sessionId) {
+    JsonRpcMessage msg = ParseJsonRpcMessage(item);
+    switch (msg.kind) {
+    case JsonRpcMessage::Invalid:
+        return msg.error;
+    case JsonRpcMessage::Response:
+        return nullptr;
+    case JsonRpcMessage::Notification:
+        if (msg.method == "notifications/initialized") {
+            McpSessionStore::getInstance().markInitialized(sessionId);
+        } else if (msg.method == "notifications/cancelled") {
+            CancelMcpRequest(msg.params, sessionId, "MCP");
+        }
+        return nullptr;
+    case JsonRpcMessage::Request:
+        break;
+    }
+    if (msg.method == "initialize") {
+        return MakeJsonRpcError(msg.id, kJsonRpcInvalidRequest, "initialize must not be part of a batch");
+    }
+
+    AppendHttpServerLogA("[MCP] RPC request: " + msg.method + " (batch)");
+    LogActivity(ActivityKind::Request, "MCP", msg.method);
+    return DispatchMcpRequest(msg, "MCP", sessionId);
 }
 
-// 构建完整 HTTP 响应（200 OK + JSON body）
-static std::string MakeHttpJsonResponse(const std::string& body,
-                                         const std::string& extraHeaders = "") {
-    std::ostringstream oss;
-    oss << "HTTP/1.1 200 OK\r\n"
-        << "Content-Type: application/json\r\n"
-        << "Access-Control-Allow-Origin: *\r\n";
-    if (!extraHeaders.empty()) {
-        oss << extraHeaders;
+// POST /mcp 的 JSON 数组：各元素并发处理，响应按原顺序放在一个数组中返回；
+// 全部是通知时回 202
+static HttpResponse HandleMcpBatch(const HttpRequest& request, const nlohmann::json& batch) {
+    if (batch.empty()) {
+        return MakeHttpJsonResponse(MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Empty batch").dump());
+    }
+    if (batch.size() > kMaxJsonRpcBatchSize) {
+        return MakeHttpJsonResponse(
+            MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest,
+                "Batch too large (max " + std::to_string(kMaxJsonRpcBatchSize) + " messages)").dump());
     }
-    oss << "Content-Length: " << body.size() << "\r\n"
-        << "\r\n"
-        << body;
-    return oss.str();
-}
 
-static std::string MakeHttpErrorResponse(int httpStatus, const std::string& statusText,
-                                          const std::string& body) {
-    std::ostringstream oss;
-    oss << "HTTP/1.1 " << httpStatus << " " << statusText << "\r\n"
-        << "Content-Type: application/json\r\n"
-        << "Access-Control-Allow-Origin: *\r\n"
-        << "Content-Length: " << body.size() << "\r\n"
-        << "\r\n"
-        << body;
-    return oss.str();
-}
+    // 含 Request 时需要有效 session（与单条请求相同）
+    std::string sessionId(request.header("mcp-session-id"));
+    if (std::any_of(batch.begin(), batch.end(), IsRpcRequest)) {
+        if (sessionId.empty()) {
+            return MakeHttpErrorResponse(400,
+                MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Missing MCP-Session-Id header").dump());
+        }
+        if (!McpSessionStore::getInstance().findSession(sessionId)) {
+            return MakeHttpErrorResponse(404,
+                MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Unknown or expired session. Please re-initialize.").dump());
+        }
+    }
 
-static std::string MakeHttp202() {
-    return "HTTP/1.1 202 Accepted\r\n"
-           "Access-Control-Allow-Origin: *\r\n"
-           "Content-Length: 0\r\n"
-           "\r\n";
+    AppendHttpServerLogA("[MCP] batch: " + std::to_string(batch.size()) + " messages");
+    nlohmann::json responses = RunJsonRpcBatch(batch, [&sessionId](const nlohmann::json& item) {
+        return HandleBatchItem(item, sessionId);
+    });
+    if (responses.empty()) {
+        return AcceptedResponse();
+    }
+    return MakeHttpJsonResponse(responses.dump());
 }
 
-static std::string MakeHttp405() {
-    std::string body = "{\"error\":\"Method Not Allowed\"}";
-    std::ostringstream oss;
-    oss << "HTTP/1.1 405 Method Not Allowed\r\n"
-        << "Content-Type: application/json\r\n"
-        << "Access-Control-Allow-Origin: *\r\n"
-        << "Allow: POST, OPTIONS\r\n"
-        << "Content-Length: " << body.size() << "\r\n"
-        << "\r\n"
-        << body;
-    return oss.str();
+// Origin 检查（严格 host 匹配）：没有 Origin 或来自 localhost / 127.0.0.1 时允许
+static bool IsAllowedOrigin(const HttpRequest& request) {
+    std::string origin(request.header("origin"));
+    if (origin.empty()) return true;
+    // 从 origin 中提取 host 部分（scheme://host[:port]）
+    size_t schemeEnd = origin.find("://");
+    if (schemeEnd == std::string::npos) return false;
+    std::string hostPort = origin.substr(schemeEnd + 3);
+    // 去掉 port（如果有）
+    size_t colonPos = hostPort.find(':');
+    std::string host = (colonPos != std::string::npos) ? hostPort.substr(0, colonPos) : hostPort;
+    // 去掉尾部 path（如果有）
+    size_t slashPos = host.find('/');
+    if (slashPos != std::string::npos) host = host.substr(0, slashPos);
+    // TODO: 未来可添加 ConfigManager 的 allowed_origins 配置支持
+    return host == "localhost" || host == "127.0.0.1";
 }
 
-// 从 HTTP 请求中提取指定 header（不区分大小写）
-static std::string ExtractHeader(const std::string& request, const std::string& headerNameLower) {
-    std::string searchKey = "\r\n" + headerNameLower + ":";
-    // 转为小写进行查找
-    std::string lowerReq = request;
-    std::transform(lowerReq.begin(), lowerReq.end(), lowerReq.begin(),
-                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    size_t pos = lowerReq.find(searchKey);
-    if (pos == std::string::npos) return "";
-    size_t valStart = pos + searchKey.size();
-    // 跳过前导空格
-    while (valStart < request.size() && request[valStart] == ' ') ++valStart;
-    size_t valEnd = request.find("\r\n", valStart);
-    if (valEnd == std::string::npos) valEnd = request.size();
-    return request.substr(valStart, valEnd - valStart);
+static bool AcceptsEventStream(const HttpRequest& request) {
+    return request.header("accept").find("text/event-stream") != std::string_view::npos;
 }
 
-// 提取 HTTP body
-static std::string ExtractBody(const std::string& request) {
-    size_t pos = request.find("\r\n\r\n");
-    if (pos == std::string::npos) return "";
-    return request.substr(pos + 4);
+// ── GET 事件流 ─────────────────────────────────────────────
+
+bool IsMcpEventStreamRequest(const HttpRequest& request) {
+    return request.method == "GET" && request.path == "/mcp" && AcceptsEventStream(request);
 }
 
-// 提取 HTTP method
-static std::string ExtractMethod(const std::string& request) {
-    size_t sp = request.find(' ');
-    if (sp == std::string::npos) return "";
-    return request.substr(0, sp);
+bool OpenMcpEventStream(const HttpRequest& request,
+                        std::shared_ptr<SseStreamWriter> writer,
+                        std::string& sessionId,
+                        HttpResponse& error) {
+    if (!IsAuthorizedRequest(request)) {
+        error = MakeUnauthorizedResponse();
+        return false;
+    }
+    if (!IsAllowedOrigin(request)) {
+        error = MakeHttpErrorResponse(403, MakeJsonRpcError(nullptr, kJsonRpcServerError, "Origin not allowed").dump());
+        return false;
+    }
+    sessionId = std::string(request.header("mcp-session-id"));
+    if (sessionId.empty()) {
+        error = MakeHttpErrorResponse(400,
+            MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Missing MCP-Session-Id header").dump());
+        return false;
+    }
+    std::shared_ptr<McpEventLog> events = McpSessionStore::getInstance().eventLog(sessionId);
+    if (!events) {
+        error = MakeHttpErrorResponse(404,
+            MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Unknown or expired session. Please re-initialize.").dump());
+        return false;
+    }
+    std::string lastEventId(request.header("last-event-id"));
+    uint64_t stream = 0;
+    uint64_t seq = 0;
+    if (!lastEventId.empty() && !McpEventLog::ParseEventId(lastEventId, stream, seq)) {
+        error = MakeHttpErrorResponse(400,
+            MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Invalid Last-Event-ID: " + lastEventId).dump());
+        return false;
+    }
+
+    // 此后连接上只有事件流，心跳由 HTTP 服务器定时写出
+    if (!writer->writeHead(MakeSseResponseHead(*writer))) {
+        return true;
+    }
+    events->attach(writer, lastEventId);
+    AppendHttpServerLogA("[MCP] Event stream opened: " + sessionId +
+                         (lastEventId.empty() ? "" : " (resume after " + lastEventId + ")"));
+    LogActivity(ActivityKind::Success, "MCP", "GET event stream: " + sessionId);
+    return true;
 }
 
-// ── JSON-RPC 错误码 ────────────────────────────────────────
-static const int kParseError      = -32700;
-static const int kInvalidRequest  = -32600;
-static const int kMethodNotFound  = -32601;
-static const int kInvalidParams   = -32602;
-static const int kServerError     = -32000;
+// ── 异步 tools/call ────────────────────────────────────────
 
-// ── 协议支持的版本 ─────────────────────────────────────────
-static const char* kSupportedProtocolVersion = "2024-11-05";
-static const std::vector<std::string> kAcceptedProtocolVersions = {
-    "2024-11-05", "2025-03-26"
+// tools/call 的流式响应。events 非空时每条消息作为 session 事件日志中的一个事件写出（进度通知在前，
+// 响应最后）：POST 连接断开后工具继续执行，之后的事件留给客户端用 Last-Event-ID 续传；session 结束
+// 才视为取消。events 为空时 body 只有最终的 JSON-RPC 响应，连接断开即取消
+class StreamedToolCallChannel : public McpResponseChannel {
+public:
+    StreamedToolCallChannel(std::shared_ptr<HttpAsyncBodySink> sink, std::shared_ptr<McpEventLog> events)
+        : sink_(std::move(sink)), events_(std::move(events)), stream_(events_ ? events_->openStream() : 0) {}
+
+    bool notify(const nlohmann::json& notification) override {
+        if (!events_) return !sink_->cancelled();
+        publish(notification);
+        return !events_->closed();
+    }
+
+    void respond(const nlohmann::json& response) override {
+        if (events_) {
+            publish(response);
+        } else {
+            sink_->write(response.dump());
+        }
+        sink_->finish();
+    }
+
+    bool closed() const override { return events_ ? events_->closed() : sink_->cancelled(); }
+
+private:
+    void publish(const nlohmann::json& msg) {
+        bool open = !sink_->cancelled();
+        std::string frame = events_->publish(stream_, msg.dump(), open);
+        if (open) sink_->write(std::move(frame));
+    }
+
+    std::shared_ptr<HttpAsyncBodySink> sink_;
+    std::shared_ptr<McpEventLog> events_;
+    uint64_t stream_;
 };
 
-static bool IsAcceptedProtocolVersion(const std::string& version) {
-    for (const auto& v : kAcceptedProtocolVersions) {
-        if (v == version) return true;
+// 异步执行 tools/call，不占用 worker。客户端带 progressToken 且接受 text/event-stream 时以 SSE
+// 流回复（可续传），进度通知随执行陆续发出；否则等工具完成后以 application/json 回复
+static HttpResponse HandleAsyncToolCall(const HttpRequest& request, const JsonRpcMessage& rpc,
+                                        const std::string& sessionId) {
+    const nlohmann::json* meta = rpc.params.is_object() && rpc.params.contains("_meta") ? &rpc.params["_meta"] : nullptr;
+    std::shared_ptr<McpEventLog> events;
+    if (meta && meta->is_object() && meta->contains("progressToken") && AcceptsEventStream(request)) {
+        events = McpSessionStore::getInstance().eventLog(sessionId);
     }
-    return false;
+
+    HttpResponse response(200);
+    response.addHeader("Content-Type", events ? "text/event-stream" : "application/json");
+    if (events) response.addHeader("Cache-Control", "no-cache");
+    response.addHeader("Access-Control-Allow-Origin", "*");
+    response.setAsyncBody([rpc, events, sessionId](std::shared_ptr<HttpAsyncBodySink> sink) {
+        StartMcpToolCall(rpc, "MCP", std::make_shared<StreamedToolCallChannel>(std::move(sink), events), sessionId);
+    });
+    return response;
 }
 
 // ── 核心分发 ───────────────────────────────────────────────
 
-std::string HandleMcpStreamableHttp(const std::string& request) {
-    std::string method = ExtractMethod(request);
-
-    // GET /mcp 和 DELETE /mcp 返回 405
-    if (method != "POST") {
+HttpResponse HandleMcpStreamableHttp(const HttpRequest& request) {
+    // 事件流（GET + Accept: text/event-stream）由 HTTP 服务器经 OpenMcpEventStream 处理
+    if (request.method == "GET") {
+        return MakeHttpErrorResponse(406,
+            MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "GET /mcp requires Accept: text/event-stream").dump());
+    }
+    if (request.method != "POST" && request.method != "DELETE") {
         return MakeHttp405();
     }
 
     // ── Origin 检查（严格 host 匹配） ──
-    std::string origin = ExtractHeader(request, "origin");
-    if (!origin.empty()) {
-        // 从 origin 中提取 host 部分（scheme://host[:port]）
-        bool originAllowed = false;
-        size_t schemeEnd = origin.find("://");
-        if (schemeEnd != std::string::npos) {
-            std::string hostPort = origin.substr(schemeEnd + 3);
-            // 去掉 port（如果有）
-            size_t colonPos = hostPort.find(':');
-            std::string host = (colonPos != std::string::npos) ? hostPort.substr(0, colonPos) : hostPort;
-            // 去掉尾部 path（如果有）
-            size_t slashPos = host.find('/');
-            if (slashPos != std::string::npos) host = host.substr(0, slashPos);
-
-            originAllowed = (host == "localhost" || host == "127.0.0.1");
+    if (!IsAllowedOrigin(request)) {
+        return MakeHttpErrorResponse(403,
+            MakeJsonRpcError(nullptr, kJsonRpcServerError, "Origin not allowed").dump());
+    }
+
+    // ── DELETE：客户端结束 session，关闭其事件流 ──
+    if (request.method == "DELETE") {
+        std::string sessionId(request.header("mcp-session-id"));
+        if (sessionId.empty()) {
+            return MakeHttpErrorResponse(400,
+                MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Missing MCP-Session-Id header").dump());
         }
-        // TODO: 未来可添加 ConfigManager 的 allowed_origins 配置支持
-        if (!originAllowed) {
-            return MakeHttpErrorResponse(403, "Forbidden",
-                MakeJsonRpcError(nullptr, kServerError, "Origin not allowed").dump());
+        if (!McpSessionStore::getInstance().eventLog(sessionId)) {
+            return MakeHttpErrorResponse(404,
+                MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest, "Unknown or expired session").dump());
         }
+        McpSessionStore::getInstance().removeSession(sessionId);
+        LogActivity(ActivityKind::Success, "MCP", "session closed: " + sessionId);
+        return HttpResponse(204);
     }
 
     // ── MCP-Protocol-Version 检查（允许已知版本，始终以服务器支持的版本回复）──
-    std::string protoVersionHeader = ExtractHeader(request, "mcp-protocol-version");
+    std::string protoVersionHeader(request.header("mcp-protocol-version"));
     if (!protoVersionHeader.empty() && !IsAcceptedProtocolVersion(protoVersionHeader)) {
-        return MakeHttpErrorResponse(400, "Bad Request",
-            MakeJsonRpcError(nullptr, kInvalidRequest,
+        return MakeHttpErrorResponse(400,
+            MakeJsonRpcError(nullptr, kJsonRpcInvalidRequest,
                 "Unsupported MCP protocol version: " + protoVersionHeader +
                 ". Supported: 2024-11-05, 2025-03-26").dump());
     }
 
     // ── 解析 body ──
-    std::string body = ExtractBody(request);
     nlohmann::json msg;
     try {
-        msg = nlohmann::json::parse(body);
+        msg = nlohmann::json::parse(request.body.begin(), request.body.end());
     } catch (const std::exception& e) {
         return MakeHttpJsonResponse(
-            MakeJsonRpcError(nullptr, kParseError,
+            MakeJsonRpcError(nullptr, kJsonRpcParseError,
                 std::string("Parse error: ") + e.what()).dump());
     }
 
-    // 不支持 batch（数组）
+    // batch（数组）
     if (msg.is_array()) {
-        return MakeHttpJsonResponse(
-            MakeJsonRpcError(nullptr, kInvalidRequest,
-                "Batch requests are not supported").dump());
-    }
-
-    if (!msg.is_object()) {
-        return MakeHttpJsonResponse(
-            MakeJsonRpcError(nullptr, kInvalidRequest, "Expected JSON object").dump());
-    }
-
-    // ── 校验 jsonrpc 字段 ──
-    if (!msg.contains("jsonrpc") || msg["jsonrpc"] != "2.0") {
-        return MakeHttpJsonResponse(
-            MakeJsonRpcError(nullptr, kInvalidRequest,
-                "Missing or invalid 'jsonrpc' field, must be '2.0'").dump());
-    }
-
-    // ── 判定消息类型 ──
-    bool hasMethod = msg.contains("method") && msg["method"].is_string();
-    bool hasId     = msg.contains("id");
-    bool hasResult = msg.contains("result");
-    bool hasError  = msg.contains("error");
-
-    // Response（客户端发来的 response，忽略）
-    if (!hasMethod && (hasResult || hasError)) {
-        return MakeHttp202();
+        return HandleMcpBatch(request, msg);
     }
 
-    // Notification（有 method 无 id）
-    if (hasMethod && !hasId) {
-        std::string methodName = msg["method"].get<std::string>();
-
-        if (methodName == "notifications/initialized") {
-            std::string sid = ExtractHeader(request, "mcp-session-id");
-            if (!sid.empty()) {
+    JsonRpcMessage rpc = ParseJsonRpcMessage(msg);
+    switch (rpc.kind) {
+    case JsonRpcMessage::Invalid:
+        return MakeHttpJsonResponse(rpc.error.dump());
+    case JsonRpcMessage::Response:
+        // 客户端发来的 response，忽略
+        return AcceptedResponse();
+    case JsonRpcMessage::Notification:
+        {
+            std::string sid(request.header("mcp-session-id"));
+            if (sid.empty()) {
+                // 没有 session 的通知无从处理
+            } else if (rpc.method == "notifications/initialized") {
                 McpSessionStore::getInstance().markInitialized(sid);
+            } else if (rpc.method == "notifications/cancelled") {
+                CancelMcpRequest(rpc.params, sid, "MCP");
             }
         }
         // 所有 notification 返回 202
-        return MakeHttp202();
+        return AcceptedResponse();
+    case JsonRpcMessage::Request:
+        break;
     }
 
-    // 不是有效的 Request（无 method）
-    if (!hasMethod) {
-        return MakeHttpJsonResponse(
-            MakeJsonRpcError(msg.value("id", nlohmann::json(nullptr)),
-                kInvalidRequest, "Missing 'method' field").dump());
-    }
-
-    // ── Request（有 method 和 id）──
-    std::string methodName = msg["method"].get<std::string>();
-    nlohmann::json rpcId = msg["id"];
-    nlohmann::json params = msg.value("params", nlohmann::json::object());
-
-    AppendHttpServerLogA("[MCP] RPC request: " + methodName);
-    if (g_dashboard) g_dashboard->logRequest("MCP", methodName);
+    AppendHttpServerLogA("[MCP] RPC request: " + rpc.method);
+    LogActivity(ActivityKind::Request, "MCP", rpc.method);
 
     // ── initialize ──
-    if (methodName == "initialize") {
-        std::string clientProtoVersion = params.value("protocolVersion", std::string(""));
+    if (rpc.method == "initialize") {
+        std::string clientProtoVersion = rpc.params.value("protocolVersion", std::string(""));
         if (!clientProtoVersion.empty() && !IsAcceptedProtocolVersion(clientProtoVersion)) {
             return MakeHttpJsonResponse(
-                MakeJsonRpcError(rpcId, kInvalidRequest,
+                MakeJsonRpcError(rpc.id, kJsonRpcInvalidRequest,
                     "Unsupported client protocol version: " + clientProtoVersion +
                     ". Supported: 2024-11-05, 2025-03-26").dump());
         }
         AppendHttpServerLogA("[MCP] Client protocol version: " + (clientProtoVersion.empty() ? "(none)" : clientProtoVersion));
 
         // 创建 session（始终以服务器支持的版本回复）
-        std::string sessionId = McpSessionStore::getInstance().createSession(kSupportedProtocolVersion);
-
-        nlohmann::json result = {
-            {"protocolVersion", kSupportedProtocolVersion},
-            {"capabilities", {{"tools", nlohmann::json::object()}}},
-            {"serverInfo", {
-                {"name", "WinBridgeAgent"},
-                {"version", CLAWDESK_VERSION}
-            }}
-        };
-
-        nlohmann::json rpcResponse = MakeJsonRpcResult(rpcId, result);
-        std::string responseBody = rpcResponse.dump();
+        std::string sessionId = McpSessionStore::getInstance().createSession(kMcpProtocolVersion);
 
         // 在 header 中返回 MCP-Session-Id
-        std::string extraHeaders = "MCP-Session-Id: " + sessionId + "\r\n";
-        if (g_dashboard) g_dashboard->logSuccess("MCP", "initialize OK, session=" + sessionId);
-        return MakeHttpJsonResponse(responseBody, extraHeaders);
+        HttpResponse response = MakeHttpJsonResponse(MakeJsonRpcResult(rpc.id, MakeMcpInitializeResult()).dump());
+        response.addHeader("MCP-Session-Id", sessionId);
+        LogActivity(ActivityKind::Success, "MCP", "initialize OK, session=" + sessionId);
+        return response;
     }
 
     // ── 非 initialize 方法需要有效 session ──
-    std::string sessionId = ExtractHeader(request, "mcp-session-id");
+    std::string sessionId(request.header("mcp-session-id"));
     if (sessionId.empty()) {
-        return MakeHttpErrorResponse(400, "Bad Request",
-            MakeJsonRpcError(rpcId, kInvalidRequest,
+        return MakeHttpErrorResponse(400,
+            MakeJsonRpcError(rpc.id, kJsonRpcInvalidRequest,
                 "Missing MCP-Session-Id header").dump());
     }
 
-    const McpSession* session = McpSessionStore::getInstance().findSession(sessionId);
+    McpSessionHandle session = McpSessionStore::getInstance().findSession(sessionId);
     if (!session) {
-        return MakeHttpErrorResponse(404, "Not Found",
-            MakeJsonRpcError(rpcId, kInvalidRequest,
+        return MakeHttpErrorResponse(404,
+            MakeJsonRpcError(rpc.id, kJsonRpcInvalidRequest,
                 "Unknown or expired session. Please re-initialize.").dump());
     }
 
-    // ── ping ──
-    if (methodName == "ping") {
-        return MakeHttpJsonResponse(
-            MakeJsonRpcResult(rpcId, nlohmann::json::object()).dump());
-    }
-
-    // ── tools/list ──
-    if (methodName == "tools/list") {
-        auto tools = ToolRegistry::getInstance().getAllTools();
-        nlohmann::json toolsArray = nlohmann::json::array();
-        for (const auto& tool : tools) {
-            toolsArray.push_back({
-                {"name", tool.name},
-                {"description", tool.description},
-                {"inputSchema", tool.inputSchema}
-            });
-        }
-        nlohmann::json result = {{"tools", toolsArray}};
-        if (g_dashboard) g_dashboard->logSuccess("MCP", "tools/list: " + std::to_string(tools.size()) + " tools");
-        return MakeHttpJsonResponse(MakeJsonRpcResult(rpcId, result).dump());
+    // tools/list：直接发送注册表缓存的字节（前缀 + 共享的 result + 后缀，不拷贝）
+    if (rpc.method == "tools/list") {
+        McpToolsListResponse list = MakeMcpToolsListResponse(rpc.id, "MCP");
+        HttpResponse response = MakeHttpJsonResponse(std::move(list.prefix));
+        response.appendBody(list.result);
+        response.appendBody(std::string(McpToolsListResponse::suffix()));
+        return response;
     }
 
-    // ── tools/call ──
-    if (methodName == "tools/call") {
-        if (!params.contains("name") || !params["name"].is_string()) {
-            return MakeHttpJsonResponse(
-                MakeJsonRpcError(rpcId, kInvalidParams,
-                    "Missing or invalid 'name' in params").dump());
-        }
-
-        std::string toolName = params["name"].get<std::string>();
-        nlohmann::json args = params.value("arguments", nlohmann::json::object());
-
-        if (!ToolRegistry::getInstance().hasTool(toolName)) {
-            return MakeHttpJsonResponse(
-                MakeJsonRpcError(rpcId, kMethodNotFound,
-                    "Unknown tool: " + toolName).dump());
-        }
-
-        // PolicyGuard 检查
-        if (g_policyGuard) {
-            auto decision = g_policyGuard->evaluateToolCall(toolName, args);
-            if (!decision.allowed) {
-                return MakeHttpJsonResponse(
-                    MakeJsonRpcError(rpcId, kServerError,
-                        "Policy denied: " + decision.reason).dump());
-            }
-        }
-
-        // 审计日志
-        if (g_auditLogger) {
-            clawdesk::AuditLogEntry entry;
-            entry.time = g_auditLogger->getCurrentTimestamp();
-            entry.tool = toolName;
-            entry.risk = ToolRegistry::getInstance().getTool(toolName).riskLevel;
-            entry.details = args;
-            entry.result = "executing";
-            g_auditLogger->logToolCall(entry);
-        }
-
-        try {
-            if (g_dashboard) g_dashboard->logProcessing("MCP", "tools/call: " + toolName);
-            auto tool = ToolRegistry::getInstance().getTool(toolName);
-            nlohmann::json toolResult = tool.handler(args);
-            if (g_dashboard) g_dashboard->logSuccess("MCP", "tools/call OK: " + toolName);
-            return MakeHttpJsonResponse(MakeJsonRpcResult(rpcId, toolResult).dump());
-        } catch (const std::exception& e) {
-            if (g_dashboard) g_dashboard->logError("MCP", "tools/call error: " + toolName + " - " + e.what());
-            return MakeHttpJsonResponse(
-                MakeJsonRpcError(rpcId, kServerError,
-                    std::string("Tool execution error: ") + e.what()).dump());
-        }
+    if (rpc.method == "tools/call" && IsAsyncMcpToolCall(rpc.params)) {
+        return HandleAsyncToolCall(request, rpc, sessionId);
     }
 
-    // ── 未知方法 ──
-    return MakeHttpJsonResponse(
-        MakeJsonRpcError(rpcId, kMethodNotFound,
-            "Method not found: " + methodName).dump());
+    return MakeHttpJsonResponse(DispatchMcpRequest(rpc, "MCP", sessionId).dump());
 }
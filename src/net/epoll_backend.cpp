@@ -0,0 +1,378 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "net/io_backend.h"
+
+#ifdef __linux__
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+// ── epoll 后端 ─────────────────────────────────────────────
+//
+// epoll 只告诉我们"可读/可写"，这里在就绪时代替内核完成读写，
+// 把结果整理成与 IOCP 相同的完成语义交给上层。
+
+namespace {
+
+const size_t kRecvChunkSize = 16 * 1024;
+const int    kMaxAcceptPerWake = 64;  // 一次就绪最多 accept 的连接数，避免饿死其他 socket
+const int    kMaxIovPerSend = 64;     // 一次 sendmsg 最多携带的缓冲区数
+const size_t kMaxSendfileChunk = 0x7ffff000;  // Linux 单次 sendfile 的上限
+
+struct EpollChannel : IoChannel {
+    bool        listener = false;
+    bool        recvPending = false;
+    bool        sendPending = false;
+    uint32_t    events = 0;           // 当前注册到 epoll 的事件
+    IoSendCursor sendCursor;
+    int         sendFile = -1;        // startSendFile：head 写完后发送的文件区间
+    uint64_t    fileOffset = 0;
+    uint64_t    fileRemaining = 0;
+    uint64_t    fileSent = 0;
+    char        recvBuf[kRecvChunkSize];
+};
+
+class EpollBackend : public IoBackend {
+public:
+    EpollBackend() {
+        epfd_ = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epfd_ >= 0 && wakeFd_ >= 0) {
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.ptr = nullptr;  // nullptr 代表唤醒 fd
+            epoll_ctl(epfd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+        }
+    }
+
+    ~EpollBackend() override {
+        for (EpollChannel* ch : channels_) {
+            if (!ch->closed) {
+                ::close(ch->socket);
+            }
+            delete ch;
+        }
+        if (wakeFd_ >= 0) ::close(wakeFd_);
+        if (epfd_ >= 0) ::close(epfd_);
+    }
+
+    bool valid() const { return epfd_ >= 0 && wakeFd_ >= 0; }
+
+    const char* name() const override { return "epoll"; }
+
+    IoChannel* addListener(socket_t listener, void* context) override {
+        SetNonBlocking(listener);
+        EpollChannel* ch = newChannel(listener, context);
+        ch->listener = true;
+        if (!updateEvents(ch, EPOLLIN)) {
+            discard(ch);
+            return nullptr;
+        }
+        return ch;
+    }
+
+    IoChannel* addSocket(socket_t sock, void* context) override {
+        SetNonBlocking(sock);
+        int one = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        EpollChannel* ch = newChannel(sock, context);
+        epoll_event ev{};
+        ev.events = 0;
+        ev.data.ptr = ch;
+        if (epoll_ctl(epfd_, EPOLL_CTL_ADD, sock, &ev) != 0) {
+            discard(ch);
+            return nullptr;
+        }
+        return ch;
+    }
+
+    bool startRecv(IoChannel* channel) override {
+        EpollChannel* ch = static_cast<EpollChannel*>(channel);
+        if (ch->closed || ch->recvPending) return false;
+        ch->recvPending = true;
+        return updateEvents(ch, wantedEvents(ch));
+    }
+
+    bool startSend(IoChannel* channel, std::vector<IoBuffer> buffers) override {
+        EpollChannel* ch = static_cast<EpollChannel*>(channel);
+        if (ch->closed || ch->sendPending) return false;
+        ch->sendCursor.reset(std::move(buffers));
+        ch->sendPending = true;
+
+        // 乐观地直接写：大多数响应一次就能写完，省掉一轮 EPOLLOUT
+        if (flushSend(ch)) {
+            return true;
+        }
+        return updateEvents(ch, wantedEvents(ch));
+    }
+
+    bool startSendFile(IoChannel* channel, std::vector<IoBuffer> head,
+                       file_t file, uint64_t offset, uint64_t length) override {
+        EpollChannel* ch = static_cast<EpollChannel*>(channel);
+        if (ch->closed || ch->sendPending) return false;
+        ch->sendCursor.reset(std::move(head));
+        ch->sendFile = file;
+        ch->fileOffset = offset;
+        ch->fileRemaining = length;
+        ch->fileSent = 0;
+        ch->sendPending = true;
+
+        if (flushSend(ch)) {
+            return true;
+        }
+        return updateEvents(ch, wantedEvents(ch));
+    }
+
+    void close(IoChannel* channel) override {
+        EpollChannel* ch = static_cast<EpollChannel*>(channel);
+        if (ch->closed) return;
+        ch->closed = true;
+        epoll_ctl(epfd_, EPOLL_CTL_DEL, ch->socket, nullptr);
+        ::close(ch->socket);
+        ch->sendCursor.clear();
+        ch->sendFile = -1;
+
+        // 已排队但尚未交付的结果不再交付
+        ready_.erase(std::remove_if(ready_.begin(), ready_.end(),
+                                    [ch](const IoResult& r) { return r.channel == ch; }),
+                     ready_.end());
+        graveyard_.push_back(ch);
+    }
+
+    int wait(IoResult* out, int maxResults, int timeoutMs) override {
+        reap();
+
+        epoll_event events[64];
+        int n = epoll_wait(epfd_, events, 64, ready_.empty() ? timeoutMs : 0);
+        for (int i = 0; i < n; ++i) {
+            EpollChannel* ch = static_cast<EpollChannel*>(events[i].data.ptr);
+            if (!ch) {
+                uint64_t v;
+                while (read(wakeFd_, &v, sizeof(v)) > 0) {
+                }
+                IoResult r;
+                r.op = IoOp::Wakeup;
+                ready_.push_back(r);
+                continue;
+            }
+            if (ch->closed) continue;
+            if (ch->listener) {
+                acceptReady(ch);
+                continue;
+            }
+
+            uint32_t ev = events[i].events;
+            if (ch->sendPending && (ev & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+                flushSend(ch);
+            }
+            if (ch->recvPending && (ev & (EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP))) {
+                recvReady(ch);
+            }
+            updateEvents(ch, wantedEvents(ch));
+        }
+
+        int count = 0;
+        while (count < maxResults && !ready_.empty()) {
+            out[count++] = ready_.front();
+            ready_.pop_front();
+        }
+        return count;
+    }
+
+    void wakeup() override {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+        (void)ignored;
+    }
+
+private:
+    EpollChannel* newChannel(socket_t sock, void* context) {
+        EpollChannel* ch = new EpollChannel();
+        ch->socket = sock;
+        ch->context = context;
+        channels_.insert(ch);
+        return ch;
+    }
+
+    void discard(EpollChannel* ch) {
+        channels_.erase(ch);
+        delete ch;
+    }
+
+    // 上一轮 wait 返回后被关闭的 channel，在这里才真正释放
+    void reap() {
+        if (graveyard_.empty()) return;
+        for (EpollChannel* ch : graveyard_) {
+            channels_.erase(ch);
+            delete ch;
+        }
+        graveyard_.clear();
+    }
+
+    static uint32_t wantedEvents(const EpollChannel* ch) {
+        uint32_t ev = 0;
+        if (ch->recvPending) ev |= EPOLLIN | EPOLLRDHUP;
+        if (ch->sendPending) ev |= EPOLLOUT;
+        return ev;
+    }
+
+    bool updateEvents(EpollChannel* ch, uint32_t ev) {
+        if (ch->closed) return false;
+        if (ch->events == ev && !ch->listener) return true;
+        epoll_event e{};
+        e.events = ev;
+        e.data.ptr = ch;
+        int op = (ch->listener && ch->events == 0) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        if (epoll_ctl(epfd_, op, ch->socket, &e) != 0) {
+            return false;
+        }
+        ch->events = ev;
+        return true;
+    }
+
+    void acceptReady(EpollChannel* listener) {
+        for (int i = 0; i < kMaxAcceptPerWake; ++i) {
+            int s = accept4(listener->socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (s < 0) {
+                int err = errno;
+                if (IsWouldBlock(err) || err == EINTR) break;
+                IoResult r;
+                r.op = IoOp::Accept;
+                r.channel = listener;
+                r.error = err;
+                ready_.push_back(r);
+                break;
+            }
+            IoResult r;
+            r.op = IoOp::Accept;
+            r.channel = listener;
+            r.accepted = s;
+            ready_.push_back(r);
+        }
+    }
+
+    void recvReady(EpollChannel* ch) {
+        ssize_t n = ::recv(ch->socket, ch->recvBuf, sizeof(ch->recvBuf), 0);
+        if (n < 0 && (IsWouldBlock(errno) || errno == EINTR)) {
+            return;  // 虚假就绪，继续等
+        }
+        IoResult r;
+        r.op = IoOp::Recv;
+        r.channel = ch;
+        if (n < 0) {
+            r.error = errno;
+        } else {
+            r.data = ch->recvBuf;
+            r.bytes = static_cast<size_t>(n);
+        }
+        ch->recvPending = false;
+        ready_.push_back(r);
+    }
+
+    // 尽量写出：先用 sendmsg 写内存缓冲区（一次携带多个），再用 sendfile 写文件区间；
+    // 写完或出错时产生 Send 结果并返回 true
+    bool flushSend(EpollChannel* ch) {
+        IoSendCursor& cur = ch->sendCursor;
+        while (!cur.done()) {
+            iovec iov[kMaxIovPerSend];
+            int count = 0;
+            for (size_t i = cur.index; i < cur.buffers.size() && count < kMaxIovPerSend; ++i) {
+                const std::string& buf = *cur.buffers[i];
+                size_t start = (i == cur.index) ? cur.offset : 0;
+                if (start >= buf.size()) continue;
+                iov[count].iov_base = const_cast<char*>(buf.data() + start);
+                iov[count].iov_len = buf.size() - start;
+                ++count;
+            }
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = static_cast<size_t>(count);
+            // 后面紧跟文件内容时提示内核先别发出不满的包
+            int flags = MSG_NOSIGNAL | (ch->fileRemaining > 0 ? MSG_MORE : 0);
+            ssize_t n = ::sendmsg(ch->socket, &msg, flags);
+            if (n < 0) {
+                int err = errno;
+                if (err == EINTR) continue;
+                if (IsWouldBlock(err)) return false;
+                completeSend(ch, err);
+                return true;
+            }
+            cur.advance(static_cast<size_t>(n));
+        }
+        while (ch->fileRemaining > 0) {
+            off_t offset = static_cast<off_t>(ch->fileOffset);
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(ch->fileRemaining, kMaxSendfileChunk));
+            ssize_t n = ::sendfile(ch->socket, ch->sendFile, &offset, chunk);
+            if (n < 0) {
+                int err = errno;
+                if (err == EINTR) continue;
+                if (IsWouldBlock(err)) return false;
+                completeSend(ch, err);
+                return true;
+            }
+            if (n == 0) {
+                completeSend(ch, EIO);  // 文件在发送过程中被截短
+                return true;
+            }
+            ch->fileOffset += static_cast<uint64_t>(n);
+            ch->fileRemaining -= static_cast<uint64_t>(n);
+            ch->fileSent += static_cast<uint64_t>(n);
+        }
+        completeSend(ch, 0);
+        return true;
+    }
+
+    void completeSend(EpollChannel* ch, int error) {
+        IoResult r;
+        r.op = IoOp::Send;
+        r.channel = ch;
+        r.error = error;
+        r.bytes = ch->sendCursor.written + static_cast<size_t>(ch->fileSent);
+        ch->sendPending = false;
+        ch->sendCursor.clear();
+        ch->sendFile = -1;
+        ch->fileRemaining = 0;
+        ch->fileSent = 0;
+        ready_.push_back(r);
+    }
+
+    int epfd_ = -1;
+    int wakeFd_ = -1;
+    std::unordered_set<EpollChannel*> channels_;
+    std::vector<EpollChannel*> graveyard_;
+    std::deque<IoResult> ready_;
+};
+
+} // namespace
+
+std::unique_ptr<IoBackend> CreateEpollBackend() {
+    std::unique_ptr<EpollBackend> backend(new EpollBackend());
+    if (!backend->valid()) {
+        return nullptr;
+    }
+    return backend;
+}
+
+#endif // __linux__
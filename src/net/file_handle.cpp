@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "net/file_handle.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+// FILETIME（1601 年起的 100ns 计数）转 Unix 秒
+static int64_t FileTimeToUnixSeconds(const FILETIME& ft) {
+    ULARGE_INTEGER v;
+    v.LowPart = ft.dwLowDateTime;
+    v.HighPart = ft.dwHighDateTime;
+    return static_cast<int64_t>((v.QuadPart - 116444736000000000ULL) / 10000000ULL);
+}
+
+std::shared_ptr<FileHandle> FileHandle::open(const std::string& path) {
+    HANDLE h = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (h == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(h, &info) || (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        CloseHandle(h);
+        return nullptr;
+    }
+    ULARGE_INTEGER size;
+    size.LowPart = info.nFileSizeLow;
+    size.HighPart = info.nFileSizeHigh;
+    return std::shared_ptr<FileHandle>(
+        new FileHandle(h, path, size.QuadPart, FileTimeToUnixSeconds(info.ftLastWriteTime)));
+}
+
+FileHandle::~FileHandle() {
+    CloseHandle(file_);
+}
+
+long long FileHandle::readAt(uint64_t offset, void* buf, size_t size) const {
+    OVERLAPPED ov = {};
+    ov.Offset = static_cast<DWORD>(offset);
+    ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD n = 0;
+    DWORD want = static_cast<DWORD>(size > 0x7FFFFFFF ? 0x7FFFFFFF : size);
+    if (!ReadFile(file_, buf, want, &n, &ov)) {
+        return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+    }
+    return static_cast<long long>(n);
+}
+
+#else
+
+std::shared_ptr<FileHandle> FileHandle::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return nullptr;
+    }
+    return std::shared_ptr<FileHandle>(
+        new FileHandle(fd, path, static_cast<uint64_t>(st.st_size), static_cast<int64_t>(st.st_mtime)));
+}
+
+FileHandle::~FileHandle() {
+    ::close(file_);
+}
+
+long long FileHandle::readAt(uint64_t offset, void* buf, size_t size) const {
+    ssize_t n;
+    do {
+        n = ::pread(file_, buf, size, static_cast<off_t>(offset));
+    } while (n < 0 && errno == EINTR);
+    return static_cast<long long>(n);
+}
+
+#endif
@@ -0,0 +1,491 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "net/io_backend.h"
+
+#ifdef _WIN32
+
+#include <mswsock.h>
+#include <unordered_set>
+#include <vector>
+
+// ── IOCP 后端 ──────────────────────────────────────────────
+//
+// 每个 channel 内嵌 recv/send 的 OVERLAPPED（send 也用于 TransmitFile）；监听 channel
+// 额外持有若干个预投递的 AcceptEx。socket 关闭后内核仍会把被取消的操作投递回完成端口，
+// 因此 channel 必须等所有未完成操作都回来后才能释放（pendingOps 计数）。
+
+namespace {
+
+const size_t    kRecvChunkSize = 16 * 1024;
+const int       kAcceptBacklog = 16;   // 同时挂起的 AcceptEx 数量
+const ULONG_PTR kWakeKey = 1;
+const ULONG_PTR kIoKey = 2;
+const DWORD     kAcceptAddrLen = sizeof(sockaddr_storage) + 16;
+const int       kMaxBufsPerSend = 64;  // 一次 WSASend 最多携带的缓冲区数
+const uint64_t  kMaxTransmitChunk = 1ULL << 30;  // 单次 TransmitFile 的文件字节数（参数是 DWORD，0 又表示整个文件）
+
+struct IocpChannel;
+
+enum class IocpOpType { Accept, Recv, Send };
+
+struct IocpOp {
+    OVERLAPPED   ov;
+    IocpOpType   type;
+    IocpChannel* channel;
+    SOCKET       acceptSocket = INVALID_SOCKET;
+    char         acceptBuf[2 * kAcceptAddrLen];
+
+    IocpOp(IocpOpType t, IocpChannel* ch) : type(t), channel(ch) {
+        ZeroMemory(&ov, sizeof(ov));
+    }
+};
+
+struct IocpChannel : IoChannel {
+    bool                 listener = false;
+    int                  family = AF_INET;
+    int                  pendingOps = 0;
+    IocpOp               recvOp{IocpOpType::Recv, nullptr};
+    IocpOp               sendOp{IocpOpType::Send, nullptr};
+    std::vector<IocpOp*> acceptOps;
+    IoSendCursor         sendCursor;
+    // startSendFile 状态
+    HANDLE               sendFile = INVALID_HANDLE_VALUE;
+    uint64_t             fileOffset = 0;
+    uint64_t             fileRemaining = 0;
+    uint64_t             fileSent = 0;         // 已写出（含 head）
+    DWORD                fileChunk = 0;        // 本次 TransmitFile 的文件字节数
+    std::string          fileHead;             // TransmitFile 只接受一块 head，多个缓冲区拼在一起
+    TRANSMIT_FILE_BUFFERS fileBuffers;
+    char                 recvBuf[kRecvChunkSize];
+
+    IocpChannel() {
+        recvOp.channel = this;
+        sendOp.channel = this;
+    }
+    ~IocpChannel() override {
+        for (IocpOp* op : acceptOps) {
+            if (op->acceptSocket != INVALID_SOCKET) {
+                closesocket(op->acceptSocket);
+            }
+            delete op;
+        }
+    }
+};
+
+class IocpBackend : public IoBackend {
+public:
+    IocpBackend() {
+        port_ = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+    }
+
+    ~IocpBackend() override {
+        for (IocpChannel* ch : channels_) {
+            if (!ch->closed) {
+                closesocket(ch->socket);
+            }
+        }
+        // socket 全部关闭后，把被取消的操作收回来再释放内存
+        drainCancelled(500);
+        for (IocpChannel* ch : channels_) {
+            delete ch;
+        }
+        if (port_) CloseHandle(port_);
+    }
+
+    bool valid() const { return port_ != NULL; }
+
+    const char* name() const override { return "iocp"; }
+
+    IoChannel* addListener(socket_t listener, void* context) override {
+        if (!acceptEx_ && !loadAcceptEx(listener)) {
+            return nullptr;
+        }
+        IocpChannel* ch = newChannel(listener, context);
+        ch->listener = true;
+
+        sockaddr_storage addr{};
+        int len = sizeof(addr);
+        if (getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) == 0) {
+            ch->family = addr.ss_family;
+        }
+        if (!associate(ch)) {
+            discard(ch);
+            return nullptr;
+        }
+        for (int i = 0; i < kAcceptBacklog; ++i) {
+            IocpOp* op = new IocpOp(IocpOpType::Accept, ch);
+            ch->acceptOps.push_back(op);
+            postAccept(op);
+        }
+        return ch;
+    }
+
+    IoChannel* addSocket(socket_t sock, void* context) override {
+        int one = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+        IocpChannel* ch = newChannel(sock, context);
+        if (!associate(ch)) {
+            discard(ch);
+            return nullptr;
+        }
+        return ch;
+    }
+
+    bool startRecv(IoChannel* channel) override {
+        IocpChannel* ch = static_cast<IocpChannel*>(channel);
+        if (ch->closed) return false;
+        ZeroMemory(&ch->recvOp.ov, sizeof(ch->recvOp.ov));
+        WSABUF buf;
+        buf.buf = ch->recvBuf;
+        buf.len = static_cast<ULONG>(sizeof(ch->recvBuf));
+        DWORD flags = 0;
+        if (WSARecv(ch->socket, &buf, 1, NULL, &flags, &ch->recvOp.ov, NULL) == SOCKET_ERROR &&
+            WSAGetLastError() != WSA_IO_PENDING) {
+            return false;
+        }
+        ch->pendingOps++;
+        return true;
+    }
+
+    bool startSend(IoChannel* channel, std::vector<IoBuffer> buffers) override {
+        IocpChannel* ch = static_cast<IocpChannel*>(channel);
+        if (ch->closed) return false;
+        ch->sendCursor.reset(std::move(buffers));
+        if (ch->sendCursor.done()) {
+            // 没有数据可写：直接投递一个完成包，保持"每次 startSend 对应一个 Send 结果"
+            ZeroMemory(&ch->sendOp.ov, sizeof(ch->sendOp.ov));
+            if (!PostQueuedCompletionStatus(port_, 0, kIoKey, &ch->sendOp.ov)) return false;
+            ch->pendingOps++;
+            return true;
+        }
+        return postSend(ch);
+    }
+
+    // 注意：客户端版 Windows 上同一时刻最多两个 TransmitFile 在执行，其余排队（不会失败）
+    bool startSendFile(IoChannel* channel, std::vector<IoBuffer> head,
+                       file_t file, uint64_t offset, uint64_t length) override {
+        IocpChannel* ch = static_cast<IocpChannel*>(channel);
+        if (ch->closed) return false;
+        if (length == 0) {
+            return startSend(channel, std::move(head));  // TransmitFile 的 0 表示整个文件
+        }
+        if (!transmitFile_ && !loadTransmitFile(ch->socket)) {
+            return false;
+        }
+        ch->fileHead.clear();
+        for (const IoBuffer& buf : head) {
+            if (buf) ch->fileHead += *buf;  // 响应头很小，拼接代价可以忽略
+        }
+        ch->sendCursor.clear();
+        ch->sendFile = file;
+        ch->fileOffset = offset;
+        ch->fileRemaining = length;
+        ch->fileSent = 0;
+        if (!postTransmitFile(ch)) {
+            ch->sendFile = INVALID_HANDLE_VALUE;
+            return false;
+        }
+        return true;
+    }
+
+    void close(IoChannel* channel) override {
+        IocpChannel* ch = static_cast<IocpChannel*>(channel);
+        if (ch->closed) return;
+        ch->closed = true;
+        // closesocket 会取消挂起的 WSARecv/WSASend/AcceptEx，完成包稍后到达
+        closesocket(ch->socket);
+        graveyard_.push_back(ch);
+    }
+
+    int wait(IoResult* out, int maxResults, int timeoutMs) override {
+        reap();
+
+        OVERLAPPED_ENTRY entries[64];
+        ULONG count = 0;
+        ULONG maxEntries = static_cast<ULONG>(maxResults < 64 ? maxResults : 64);
+        DWORD timeout = timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs);
+        if (!GetQueuedCompletionStatusEx(port_, entries, maxEntries, &count, timeout, FALSE)) {
+            return 0;  // 超时
+        }
+
+        int produced = 0;
+        for (ULONG i = 0; i < count; ++i) {
+            if (entries[i].lpCompletionKey == kWakeKey) {
+                IoResult r;
+                r.op = IoOp::Wakeup;
+                out[produced++] = r;
+                continue;
+            }
+            IocpOp* op = reinterpret_cast<IocpOp*>(entries[i].lpOverlapped);
+            IocpChannel* ch = op->channel;
+            ch->pendingOps--;
+            DWORD bytes = entries[i].dwNumberOfBytesTransferred;
+
+            if (ch->closed) {
+                continue;  // 被取消的操作，等 reap 释放
+            }
+
+            int error = 0;
+            DWORD transferred = 0;
+            DWORD flags = 0;
+            if (!WSAGetOverlappedResult(ch->socket, &op->ov, &transferred, FALSE, &flags)) {
+                error = WSAGetLastError();
+            }
+
+            switch (op->type) {
+            case IocpOpType::Accept:
+                produced += completeAccept(ch, op, error, out + produced);
+                break;
+            case IocpOpType::Recv: {
+                IoResult r;
+                r.op = IoOp::Recv;
+                r.channel = ch;
+                r.error = error;
+                r.data = ch->recvBuf;
+                r.bytes = error ? 0 : bytes;
+                out[produced++] = r;
+                break;
+            }
+            case IocpOpType::Send: {
+                if (ch->sendFile != INVALID_HANDLE_VALUE) {
+                    produced += completeTransmitFile(ch, error, bytes, out + produced);
+                    break;
+                }
+                if (!error) {
+                    ch->sendCursor.advance(bytes);
+                    // 缓冲区超过一次 WSASend 的上限，或部分写出（内存压力下可能发生），继续写剩余部分
+                    if (!ch->sendCursor.done()) {
+                        if (postSend(ch)) break;
+                        error = WSAGetLastError();
+                    }
+                }
+                IoResult r;
+                r.op = IoOp::Send;
+                r.channel = ch;
+                r.error = error;
+                r.bytes = ch->sendCursor.written;
+                ch->sendCursor.clear();
+                out[produced++] = r;
+                break;
+            }
+            }
+        }
+        return produced;
+    }
+
+    void wakeup() override {
+        PostQueuedCompletionStatus(port_, 0, kWakeKey, NULL);
+    }
+
+private:
+    bool loadAcceptEx(SOCKET listener) {
+        GUID guid = WSAID_ACCEPTEX;
+        DWORD bytes = 0;
+        return WSAIoctl(listener, SIO_GET_EXTENSION_FUNCTION_POINTER, &guid, sizeof(guid), &acceptEx_,
+                        sizeof(acceptEx_), &bytes, NULL, NULL) == 0 &&
+               acceptEx_ != nullptr;
+    }
+
+    bool loadTransmitFile(SOCKET sock) {
+        GUID guid = WSAID_TRANSMITFILE;
+        DWORD bytes = 0;
+        return WSAIoctl(sock, SIO_GET_EXTENSION_FUNCTION_POINTER, &guid, sizeof(guid), &transmitFile_,
+                        sizeof(transmitFile_), &bytes, NULL, NULL) == 0 &&
+               transmitFile_ != nullptr;
+    }
+
+    IocpChannel* newChannel(socket_t sock, void* context) {
+        IocpChannel* ch = new IocpChannel();
+        ch->socket = sock;
+        ch->context = context;
+        channels_.insert(ch);
+        return ch;
+    }
+
+    void discard(IocpChannel* ch) {
+        channels_.erase(ch);
+        delete ch;
+    }
+
+    bool associate(IocpChannel* ch) {
+        return CreateIoCompletionPort(reinterpret_cast<HANDLE>(ch->socket), port_, kIoKey, 0) == port_;
+    }
+
+    // 只释放已关闭且没有未完成操作的 channel，其余的留到下次
+    void reap() {
+        for (size_t i = 0; i < graveyard_.size();) {
+            IocpChannel* ch = graveyard_[i];
+            if (ch->pendingOps == 0) {
+                channels_.erase(ch);
+                delete ch;
+                graveyard_[i] = graveyard_.back();
+                graveyard_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    void drainCancelled(DWORD timeoutMs) {
+        DWORD deadline = GetTickCount() + timeoutMs;
+        for (;;) {
+            bool pending = false;
+            for (IocpChannel* ch : channels_) {
+                if (ch->pendingOps > 0) {
+                    pending = true;
+                    break;
+                }
+            }
+            if (!pending || static_cast<LONG>(deadline - GetTickCount()) <= 0) return;
+
+            OVERLAPPED_ENTRY entries[64];
+            ULONG count = 0;
+            if (!GetQueuedCompletionStatusEx(port_, entries, 64, &count, 50, FALSE)) continue;
+            for (ULONG i = 0; i < count; ++i) {
+                if (entries[i].lpCompletionKey == kWakeKey) continue;
+                reinterpret_cast<IocpOp*>(entries[i].lpOverlapped)->channel->pendingOps--;
+            }
+        }
+    }
+
+    void postAccept(IocpOp* op) {
+        IocpChannel* ch = op->channel;
+        op->acceptSocket = WSASocketW(ch->family, SOCK_STREAM, IPPROTO_TCP, NULL, 0, WSA_FLAG_OVERLAPPED);
+        if (op->acceptSocket == INVALID_SOCKET) {
+            return;  // 该槽位失效，其余 AcceptEx 仍在工作
+        }
+        ZeroMemory(&op->ov, sizeof(op->ov));
+        DWORD bytes = 0;
+        if (!acceptEx_(ch->socket, op->acceptSocket, op->acceptBuf, 0, kAcceptAddrLen, kAcceptAddrLen, &bytes,
+                       &op->ov) &&
+            WSAGetLastError() != ERROR_IO_PENDING) {
+            closesocket(op->acceptSocket);
+            op->acceptSocket = INVALID_SOCKET;
+            return;
+        }
+        ch->pendingOps++;
+    }
+
+    int completeAccept(IocpChannel* listener, IocpOp* op, int error, IoResult* out) {
+        SOCKET accepted = op->acceptSocket;
+        op->acceptSocket = INVALID_SOCKET;
+
+        IoResult r;
+        r.op = IoOp::Accept;
+        r.channel = listener;
+        if (error) {
+            closesocket(accepted);
+            r.error = error;
+        } else {
+            // 让 getpeername/shutdown 等在 AcceptEx 得到的 socket 上可用
+            setsockopt(accepted, SOL_SOCKET, SO_UPDATE_ACCEPT_CONTEXT,
+                       reinterpret_cast<const char*>(&listener->socket), sizeof(listener->socket));
+            r.accepted = accepted;
+        }
+        postAccept(op);
+        *out = r;
+        return 1;
+    }
+
+    // WSASend 在返回前会复制 WSABUF 数组，栈上数组即可；缓冲区本身由 send 游标持有
+    bool postSend(IocpChannel* ch) {
+        ZeroMemory(&ch->sendOp.ov, sizeof(ch->sendOp.ov));
+        const IoSendCursor& cur = ch->sendCursor;
+        WSABUF bufs[kMaxBufsPerSend];
+        DWORD count = 0;
+        for (size_t i = cur.index; i < cur.buffers.size() && count < kMaxBufsPerSend; ++i) {
+            const std::string& buf = *cur.buffers[i];
+            size_t start = (i == cur.index) ? cur.offset : 0;
+            if (start >= buf.size()) continue;
+            bufs[count].buf = const_cast<char*>(buf.data() + start);
+            bufs[count].len = static_cast<ULONG>(buf.size() - start);
+            ++count;
+        }
+        if (WSASend(ch->socket, bufs, count, NULL, 0, &ch->sendOp.ov, NULL) == SOCKET_ERROR &&
+            WSAGetLastError() != WSA_IO_PENDING) {
+            return false;
+        }
+        ch->pendingOps++;
+        return true;
+    }
+
+    // 发送文件的下一段（首段带上 head），文件偏移通过 OVERLAPPED 传入
+    bool postTransmitFile(IocpChannel* ch) {
+        ZeroMemory(&ch->sendOp.ov, sizeof(ch->sendOp.ov));
+        ch->sendOp.ov.Offset = static_cast<DWORD>(ch->fileOffset & 0xFFFFFFFFULL);
+        ch->sendOp.ov.OffsetHigh = static_cast<DWORD>(ch->fileOffset >> 32);
+        ch->fileChunk = static_cast<DWORD>(ch->fileRemaining < kMaxTransmitChunk ? ch->fileRemaining : kMaxTransmitChunk);
+
+        TRANSMIT_FILE_BUFFERS* buffers = nullptr;
+        if (!ch->fileHead.empty()) {
+            ZeroMemory(&ch->fileBuffers, sizeof(ch->fileBuffers));
+            ch->fileBuffers.Head = &ch->fileHead[0];
+            ch->fileBuffers.HeadLength = static_cast<DWORD>(ch->fileHead.size());
+            buffers = &ch->fileBuffers;
+        }
+        if (!transmitFile_(ch->socket, ch->sendFile, ch->fileChunk, 0, &ch->sendOp.ov, buffers, 0) &&
+            WSAGetLastError() != WSA_IO_PENDING) {
+            return false;
+        }
+        ch->pendingOps++;
+        return true;
+    }
+
+    // TransmitFile 成功完成时已写出 head 和整段文件；还有剩余则继续，返回产生的结果数
+    int completeTransmitFile(IocpChannel* ch, int error, DWORD bytes, IoResult* out) {
+        if (!error) {
+            ch->fileSent += bytes;
+            ch->fileOffset += ch->fileChunk;
+            ch->fileRemaining -= ch->fileChunk;
+            ch->fileHead.clear();
+            if (ch->fileRemaining > 0) {
+                if (postTransmitFile(ch)) return 0;
+                error = WSAGetLastError();
+            }
+        }
+        IoResult r;
+        r.op = IoOp::Send;
+        r.channel = ch;
+        r.error = error;
+        r.bytes = static_cast<size_t>(ch->fileSent);
+        ch->sendFile = INVALID_HANDLE_VALUE;
+        ch->fileRemaining = 0;
+        ch->fileHead.clear();
+        *out = r;
+        return 1;
+    }
+
+    HANDLE port_ = NULL;
+    LPFN_ACCEPTEX acceptEx_ = nullptr;
+    LPFN_TRANSMITFILE transmitFile_ = nullptr;
+    std::unordered_set<IocpChannel*> channels_;
+    std::vector<IocpChannel*> graveyard_;
+};
+
+} // namespace
+
+std::unique_ptr<IoBackend> CreateIocpBackend() {
+    std::unique_ptr<IocpBackend> backend(new IocpBackend());
+    if (!backend->valid()) {
+        return nullptr;
+    }
+    return backend;
+}
+
+#endif // _WIN32
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "net/listen_socket.h"
+#include <algorithm>
+
+std::string ListenEndpoint::describe(int port) const {
+    if (family == AF_INET6) {
+        return "[" + host + "]:" + std::to_string(port);
+    }
+    return host + ":" + std::to_string(port);
+}
+
+static std::string Trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string::npos) return std::string();
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+// 把文本地址解析为 endpoint（host 规范化为 inet_ntop 的输出）
+static bool ParseEndpoint(std::string text, ListenEndpoint& out) {
+    if (text == "*") text = "::";
+    if (text.size() >= 2 && text.front() == '[' && text.back() == ']') {
+        text = text.substr(1, text.size() - 2);
+    }
+
+    char buf[INET6_ADDRSTRLEN] = {};
+    in_addr v4{};
+    if (inet_pton(AF_INET, text.c_str(), &v4) == 1) {
+        inet_ntop(AF_INET, &v4, buf, sizeof(buf));
+        out.host = buf;
+        out.family = AF_INET;
+        out.dualStack = false;
+        return true;
+    }
+    in6_addr v6{};
+    if (inet_pton(AF_INET6, text.c_str(), &v6) == 1) {
+        inet_ntop(AF_INET6, &v6, buf, sizeof(buf));
+        out.host = buf;
+        out.family = AF_INET6;
+        out.dualStack = out.host == "::";
+        return true;
+    }
+    return false;
+}
+
+std::vector<ListenEndpoint> ParseListenAddresses(const std::string& spec, std::vector<std::string>* invalid) {
+    std::vector<ListenEndpoint> endpoints;
+    size_t pos = 0;
+    while (pos <= spec.size()) {
+        size_t comma = spec.find(',', pos);
+        if (comma == std::string::npos) comma = spec.size();
+        std::string item = Trim(spec.substr(pos, comma - pos));
+        pos = comma + 1;
+        if (item.empty()) continue;
+
+        ListenEndpoint ep;
+        if (!ParseEndpoint(item, ep)) {
+            if (invalid) invalid->push_back(item);
+            continue;
+        }
+        bool duplicate = std::any_of(endpoints.begin(), endpoints.end(), [&ep](const ListenEndpoint& e) {
+            return e.family == ep.family && e.host == ep.host;
+        });
+        if (!duplicate) endpoints.push_back(ep);
+    }
+
+    // 双栈任意地址已经覆盖 IPv4 任意地址，同时绑定两者会端口冲突
+    bool hasDualStack = std::any_of(endpoints.begin(), endpoints.end(),
+                                    [](const ListenEndpoint& e) { return e.dualStack; });
+    if (hasDualStack) {
+        endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(),
+                                       [](const ListenEndpoint& e) {
+                                           return e.family == AF_INET && e.host == "0.0.0.0";
+                                       }),
+                        endpoints.end());
+    }
+
+    if (endpoints.empty()) {
+        ListenEndpoint any;
+        any.host = "0.0.0.0";
+        endpoints.push_back(any);
+    }
+    return endpoints;
+}
+
+bool SupportsReusePort() {
+#if defined(__linux__) && defined(SO_REUSEPORT)
+    return true;
+#else
+    return false;
+#endif
+}
+
+socket_t OpenListenSocket(const ListenEndpoint& endpoint, int port, const ListenOptions& options, int& error) {
+    error = 0;
+    socket_t s = socket(endpoint.family, SOCK_STREAM, IPPROTO_TCP);
+    if (s == kInvalidSocket) {
+        error = LastSocketError();
+        return kInvalidSocket;
+    }
+
+    int on = 1;
+#ifdef _WIN32
+    // Windows 上监听 socket 使用 SO_REUSEADDR 不安全（其他进程可以抢占端口），改为独占绑定
+    setsockopt(s, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, reinterpret_cast<const char*>(&on), sizeof(on));
+#else
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#if defined(SO_REUSEPORT)
+    if (options.reusePort && SupportsReusePort()) {
+        if (setsockopt(s, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) {
+            error = LastSocketError();
+            CloseSocket(s);
+            return kInvalidSocket;
+        }
+    }
+#endif
+#endif
+
+    sockaddr_storage addr{};
+    socklen_t addrLen = 0;
+    if (endpoint.family == AF_INET6) {
+        int v6only = endpoint.dualStack ? 0 : 1;
+        setsockopt(s, IPPROTO_IPV6, IPV6_V6ONLY, reinterpret_cast<const char*>(&v6only), sizeof(v6only));
+        auto* sin6 = reinterpret_cast<sockaddr_in6*>(&addr);
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons(static_cast<unsigned short>(port));
+        inet_pton(AF_INET6, endpoint.host.c_str(), &sin6->sin6_addr);
+        addrLen = sizeof(sockaddr_in6);
+    } else {
+        auto* sin = reinterpret_cast<sockaddr_in*>(&addr);
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(static_cast<unsigned short>(port));
+        inet_pton(AF_INET, endpoint.host.c_str(), &sin->sin_addr);
+        addrLen = sizeof(sockaddr_in);
+    }
+
+    if (bind(s, reinterpret_cast<sockaddr*>(&addr), addrLen) != 0 || listen(s, options.backlog) != 0) {
+        error = LastSocketError();
+        CloseSocket(s);
+        return kInvalidSocket;
+    }
+    return s;
+}
+
+int GetLocalPort(socket_t s) {
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (getsockname(s, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        return -1;
+    }
+    if (addr.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+    }
+    return ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+}
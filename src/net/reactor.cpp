@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "net/reactor.h"
+
+static const int kMaxResultsPerWait = 64;
+
+Reactor::Reactor(std::unique_ptr<IoBackend> backend) : backend_(std::move(backend)) {}
+
+Reactor::~Reactor() = default;
+
+void Reactor::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(postMutex_);
+        posted_.push_back(std::move(task));
+    }
+    // 已有未处理的唤醒时不重复唤醒
+    if (!wakePending_.exchange(true)) {
+        backend_->wakeup();
+    }
+}
+
+void Reactor::setTick(int intervalMs, std::function<void()> tick) {
+    tickIntervalMs_ = intervalMs;
+    tick_ = std::move(tick);
+}
+
+Reactor::TimerId Reactor::addTimer(int delayMs, std::function<void()> callback) {
+    return timers_.schedule(TimerQueue::Clock::now() + std::chrono::milliseconds(delayMs),
+                            std::move(callback));
+}
+
+void Reactor::cancelTimer(TimerId id) {
+    if (id != 0) timers_.cancel(id);
+}
+
+void Reactor::stop() {
+    stopping_.store(true);
+    backend_->wakeup();
+}
+
+void Reactor::runPosted() {
+    wakePending_.store(false);
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(postMutex_);
+        tasks.swap(posted_);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+}
+
+void Reactor::run() {
+    using Clock = std::chrono::steady_clock;
+    threadId_ = std::this_thread::get_id();
+
+    IoResult results[kMaxResultsPerWait];
+    Clock::time_point nextTick = Clock::now() + std::chrono::milliseconds(tickIntervalMs_);
+
+    while (!stopping_.load()) {
+        int timeoutMs = timers_.msUntilNext(Clock::now());
+        if (tick_) {
+            auto untilTick = std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - Clock::now()).count();
+            int tickMs = untilTick > 0 ? static_cast<int>(untilTick) : 0;
+            if (timeoutMs < 0 || tickMs < timeoutMs) timeoutMs = tickMs;
+        }
+
+        int n = backend_->wait(results, kMaxResultsPerWait, timeoutMs);
+        for (int i = 0; i < n; ++i) {
+            const IoResult& r = results[i];
+            if (r.op == IoOp::Wakeup) {
+                runPosted();
+                continue;
+            }
+            // 同一批结果中，前面的处理可能已经关闭了这个 channel
+            if (r.channel->closed) {
+                if (r.op == IoOp::Accept && r.accepted != kInvalidSocket) {
+                    CloseSocket(r.accepted);
+                }
+                continue;
+            }
+            static_cast<IoHandler*>(r.channel->context)->onIoComplete(r);
+        }
+
+        timers_.runExpired(Clock::now());
+
+        if (tick_ && Clock::now() >= nextTick) {
+            nextTick = Clock::now() + std::chrono::milliseconds(tickIntervalMs_);
+            tick_();
+        }
+    }
+
+    runPosted();
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "net/timer_queue.h"
+#include <algorithm>
+
+// 失效条目超过有效条目的两倍（且不少于此数）时重建堆
+static const size_t kMinCompactGarbage = 64;
+
+TimerQueue::TimerId TimerQueue::schedule(Clock::time_point when, std::function<void()> callback) {
+    TimerId id = nextId_++;
+    callbacks_.emplace(id, std::move(callback));
+    heap_.push_back({when, id});
+    std::push_heap(heap_.begin(), heap_.end(), Later());
+    return id;
+}
+
+bool TimerQueue::cancel(TimerId id) {
+    if (callbacks_.erase(id) == 0) return false;
+    size_t garbage = heap_.size() - callbacks_.size();
+    if (garbage >= kMinCompactGarbage && garbage > callbacks_.size() * 2) {
+        compact();
+    }
+    return true;
+}
+
+void TimerQueue::compact() {
+    heap_.erase(std::remove_if(heap_.begin(), heap_.end(),
+                               [this](const Entry& e) { return callbacks_.count(e.id) == 0; }),
+                heap_.end());
+    std::make_heap(heap_.begin(), heap_.end(), Later());
+}
+
+void TimerQueue::dropCancelledTop() {
+    while (!heap_.empty() && callbacks_.count(heap_.front().id) == 0) {
+        std::pop_heap(heap_.begin(), heap_.end(), Later());
+        heap_.pop_back();
+    }
+}
+
+size_t TimerQueue::runExpired(Clock::time_point now) {
+    size_t fired = 0;
+    for (;;) {
+        dropCancelledTop();
+        if (heap_.empty() || heap_.front().when > now) break;
+        TimerId id = heap_.front().id;
+        std::pop_heap(heap_.begin(), heap_.end(), Later());
+        heap_.pop_back();
+
+        auto it = callbacks_.find(id);
+        std::function<void()> callback = std::move(it->second);
+        callbacks_.erase(it);
+        callback();
+        fired++;
+    }
+    return fired;
+}
+
+int TimerQueue::msUntilNext(Clock::time_point now) {
+    dropCancelledTop();
+    if (heap_.empty()) return -1;
+    if (heap_.front().when <= now) return 0;
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(heap_.front().when - now).count();
+    long long ms = (us + 999) / 1000;
+    return ms > 0x7FFFFFFF ? 0x7FFFFFFF : static_cast<int>(ms);
+}
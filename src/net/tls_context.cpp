@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "net/tls_context.h"
+#include <algorithm>
+#include <chrono>
+
+#ifdef CLAWDESK_OPENSSL_ENABLED
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#endif
+
+static int64_t NowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TlsContext::recordHandshake(bool resumed, uint64_t micros) {
+    if (resumed) {
+        resumed_.fetch_add(1, std::memory_order_relaxed);
+        resumedUs_.fetch_add(micros, std::memory_order_relaxed);
+    } else {
+        full_.fetch_add(1, std::memory_order_relaxed);
+        fullUs_.fetch_add(micros, std::memory_order_relaxed);
+    }
+    uint64_t prev = maxUs_.load(std::memory_order_relaxed);
+    while (micros > prev && !maxUs_.compare_exchange_weak(prev, micros, std::memory_order_relaxed)) {
+    }
+}
+
+TlsContext::Stats TlsContext::stats() const {
+    Stats s;
+    s.fullHandshakes = full_.load(std::memory_order_relaxed);
+    s.resumedHandshakes = resumed_.load(std::memory_order_relaxed);
+    s.failedHandshakes = failed_.load(std::memory_order_relaxed);
+    s.fullHandshakeUs = fullUs_.load(std::memory_order_relaxed);
+    s.resumedHandshakeUs = resumedUs_.load(std::memory_order_relaxed);
+    s.maxHandshakeUs = maxUs_.load(std::memory_order_relaxed);
+    s.requests = requests_.load(std::memory_order_relaxed);
+    return s;
+}
+
+#ifdef CLAWDESK_OPENSSL_ENABLED
+
+static std::string LastSslError() {
+    unsigned long code = ERR_get_error();
+    ERR_clear_error();
+    if (code == 0) return "unknown error";
+    char buf[256];
+    ERR_error_string_n(code, buf, sizeof(buf));
+    return buf;
+}
+
+// ALPN：只说 HTTP/1.1，提供 h2 的客户端据此回落
+static int SelectAlpn(SSL*, const unsigned char** out, unsigned char* outlen, const unsigned char* in,
+                      unsigned int inlen, void*) {
+    static const unsigned char kHttp11[] = {8, 'h', 't', 't', 'p', '/', '1', '.', '1'};
+    unsigned char* selected = nullptr;
+    if (SSL_select_next_proto(&selected, outlen, kHttp11, sizeof(kHttp11), in, inlen) != OPENSSL_NPN_NEGOTIATED) {
+        return SSL_TLSEXT_ERR_NOACK;
+    }
+    *out = selected;
+    return SSL_TLSEXT_ERR_OK;
+}
+
+bool TlsContext::available() {
+    return true;
+}
+
+std::shared_ptr<TlsContext> TlsContext::create(const TlsOptions& options, std::string& error) {
+    if (options.certFile.empty() || options.keyFile.empty()) {
+        error = "certificate and private key files are required";
+        return nullptr;
+    }
+    SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+    if (!ctx) {
+        error = "SSL_CTX_new: " + LastSslError();
+        return nullptr;
+    }
+    std::shared_ptr<TlsContext> context(new TlsContext(ctx));
+
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_options(ctx, SSL_OP_NO_RENEGOTIATION | SSL_OP_CIPHER_SERVER_PREFERENCE);
+    // 写缓冲区地址会随连接的发送队列变化；允许部分写入以便逐条记录输出
+    SSL_CTX_set_mode(ctx, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_ENABLE_PARTIAL_WRITE |
+                              SSL_MODE_RELEASE_BUFFERS);
+
+    if (SSL_CTX_use_certificate_chain_file(ctx, options.certFile.c_str()) != 1) {
+        error = "load certificate " + options.certFile + ": " + LastSslError();
+        return nullptr;
+    }
+    if (SSL_CTX_use_PrivateKey_file(ctx, options.keyFile.c_str(), SSL_FILETYPE_PEM) != 1) {
+        error = "load private key " + options.keyFile + ": " + LastSslError();
+        return nullptr;
+    }
+    if (SSL_CTX_check_private_key(ctx) != 1) {
+        error = "private key does not match certificate: " + LastSslError();
+        return nullptr;
+    }
+
+    // 会话恢复：TLS 1.2 的 session id 查服务端缓存，TLS 1.2/1.3 的 session ticket 由客户端保存、
+    // 用本 context 的 ticket 密钥解密。两者都省去证书交换和密钥协商的大部分开销
+    static const unsigned char kSessionIdContext[] = "clawdesk-http";
+    SSL_CTX_set_session_id_context(ctx, kSessionIdContext, sizeof(kSessionIdContext) - 1);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(ctx, options.sessionCacheSize);
+    SSL_CTX_set_timeout(ctx, options.sessionTimeoutSeconds);
+    SSL_CTX_set_alpn_select_cb(ctx, SelectAlpn, nullptr);
+    return context;
+}
+
+TlsContext::~TlsContext() {
+    SSL_CTX_free(ctx_);
+}
+
+std::unique_ptr<TlsSession> TlsContext::newSession() {
+    SSL* ssl = SSL_new(ctx_);
+    if (!ssl) return nullptr;
+    BIO* in = BIO_new(BIO_s_mem());
+    BIO* out = BIO_new(BIO_s_mem());
+    if (!in || !out) {
+        BIO_free(in);
+        BIO_free(out);
+        SSL_free(ssl);
+        return nullptr;
+    }
+    // 读空时返回"稍后重试"而不是 EOF
+    BIO_set_mem_eof_return(in, -1);
+    BIO_set_mem_eof_return(out, -1);
+    SSL_set_bio(ssl, in, out);  // 所有权交给 ssl
+    SSL_set_accept_state(ssl);
+    return std::unique_ptr<TlsSession>(new TlsSession(shared_from_this(), ssl, in, out));
+}
+
+TlsSession::~TlsSession() {
+    if (!handshakeDone_ && handshakeStartUs_ != 0 && !failed_) {
+        context_->recordFailure();  // 握手途中断开
+    }
+    if (handshakeDone_ && !failed_) {
+        // 连接正常结束（包括不发 close_notify 直接断开的 keep-alive 连接）：标记为已关闭，
+        // 否则 SSL_free 会把会话从缓存中移除，客户端重连无法恢复
+        SSL_set_shutdown(ssl_, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+    }
+    SSL_free(ssl_);
+}
+
+bool TlsSession::finishHandshake() {
+    int rc = SSL_do_handshake(ssl_);
+    if (rc == 1) {
+        handshakeDone_ = true;
+        resumed_ = SSL_session_reused(ssl_) == 1;
+        context_->recordHandshake(resumed_, static_cast<uint64_t>(NowMicros() - handshakeStartUs_));
+        return true;
+    }
+    int err = SSL_get_error(ssl_, rc);
+    if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+        return true;
+    }
+    ERR_clear_error();
+    failed_ = true;
+    context_->recordFailure();
+    return false;
+}
+
+bool TlsSession::decrypt(const char* data, size_t size, std::string& plain) {
+    if (failed_) return false;
+    if (handshakeStartUs_ == 0) handshakeStartUs_ = NowMicros();
+    if (BIO_write(in_, data, static_cast<int>(size)) != static_cast<int>(size)) {
+        failed_ = true;
+        return false;
+    }
+    if (!handshakeDone_ && (!finishHandshake() || !handshakeDone_)) {
+        return !failed_;
+    }
+
+    // 一次收到的密文可能含多条记录，读到需要更多输入为止
+    char buf[16 * 1024];
+    for (;;) {
+        int n = SSL_read(ssl_, buf, sizeof(buf));
+        if (n > 0) {
+            plain.append(buf, static_cast<size_t>(n));
+            continue;
+        }
+        int err = SSL_get_error(ssl_, n);
+        if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+            return true;
+        }
+        ERR_clear_error();
+        failed_ = err != SSL_ERROR_ZERO_RETURN;
+        return false;
+    }
+}
+
+bool TlsSession::encrypt(const char* data, size_t size) {
+    while (size > 0) {
+        int n = SSL_write(ssl_, data, static_cast<int>(std::min<size_t>(size, 1u << 30)));
+        if (n <= 0) {
+            ERR_clear_error();
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string TlsSession::takeOutput() {
+    std::string out;
+    size_t pending = BIO_ctrl_pending(out_);
+    if (pending == 0) return out;
+    out.resize(pending);
+    int n = BIO_read(out_, &out[0], static_cast<int>(pending));
+    out.resize(n > 0 ? static_cast<size_t>(n) : 0);
+    return out;
+}
+
+bool TlsSession::hasOutput() const {
+    return BIO_ctrl_pending(out_) > 0;
+}
+
+#else  // !CLAWDESK_OPENSSL_ENABLED
+
+bool TlsContext::available() {
+    return false;
+}
+
+std::shared_ptr<TlsContext> TlsContext::create(const TlsOptions&, std::string& error) {
+    error = "built without OpenSSL (CLAWDESK_ENABLE_OPENSSL=OFF)";
+    return nullptr;
+}
+
+TlsContext::~TlsContext() {}
+
+std::unique_ptr<TlsSession> TlsContext::newSession() {
+    return nullptr;
+}
+
+TlsSession::~TlsSession() {}
+
+bool TlsSession::finishHandshake() { return false; }
+bool TlsSession::decrypt(const char*, size_t, std::string&) { return false; }
+bool TlsSession::encrypt(const char*, size_t) { return false; }
+std::string TlsSession::takeOutput() { return std::string(); }
+bool TlsSession::hasOutput() const { return false; }
+
+#endif
@@ -27,6 +27,7 @@
 #include <objbase.h>
 #include <wincrypt.h>
 
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <sstream>
@@ -373,10 +374,27 @@ static WebSocketConn OpenWebSocket(const WsUrlParts& urlParts) {
 
 static nlohmann::json SendCdpCommand(const std::string& wsUrl,
                                      const std::string& method,
-                                     const nlohmann::json& params) {
+                                     const nlohmann::json& params,
+                                     const CancellationToken& cancel) {
+    if (cancel.cancelled()) {
+        throw std::runtime_error("Cancelled");
+    }
     WsUrlParts parts = ParseWsUrl(wsUrl);
     WebSocketConn conn = OpenWebSocket(parts);
+
+    // On cancellation close the WebSocket handle from the cancelling thread: a blocked
+    // WinHttpWebSocketSend / WinHttpWebSocketReceive then fails immediately.
+    std::atomic_bool aborted{false};
+    HINTERNET wsHandle = conn.ws;
+    CancellationRegistration abortOnCancel = cancel.onCancel([wsHandle, &aborted]() {
+        aborted.store(true);
+        WinHttpCloseHandle(wsHandle);
+    });
     auto closeConn = [&]() {
+        abortOnCancel.reset();  // waits for a running abort callback
+        if (aborted.load()) {
+            conn.ws = NULL;
+        }
         if (conn.ws) {
             WinHttpWebSocketClose(conn.ws, WINHTTP_WEB_SOCKET_SUCCESS_CLOSE_STATUS, NULL, 0);
             WinHttpCloseHandle(conn.ws);
@@ -406,7 +424,7 @@ static nlohmann::json SendCdpCommand(const std::string& wsUrl,
                                     (DWORD)payload.size());
     if (res != NO_ERROR) {
         closeConn();
-        throw std::runtime_error("WinHttpWebSocketSend failed");
+        throw std::runtime_error(aborted.load() ? "Cancelled" : "WinHttpWebSocketSend failed");
     }
 
     std::string message;
@@ -414,13 +432,17 @@ static nlohmann::json SendCdpCommand(const std::string& wsUrl,
 
     auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
     while (std::chrono::steady_clock::now() < deadline) {
+        if (cancel.cancelled()) {
+            closeConn();
+            throw std::runtime_error("Cancelled");
+        }
         BYTE buffer[64 * 1024];
         DWORD bytesRead = 0;
         WINHTTP_WEB_SOCKET_BUFFER_TYPE type = WINHTTP_WEB_SOCKET_UTF8_MESSAGE_BUFFER_TYPE;
         res = WinHttpWebSocketReceive(conn.ws, buffer, sizeof(buffer), &bytesRead, &type);
         if (res != NO_ERROR) {
             closeConn();
-            throw std::runtime_error("WinHttpWebSocketReceive failed");
+            throw std::runtime_error(aborted.load() ? "Cancelled" : "WinHttpWebSocketReceive failed");
         }
         if (type == WINHTTP_WEB_SOCKET_CLOSE_BUFFER_TYPE) {
             break;
@@ -607,7 +629,8 @@ int BrowserService::pickFreePort() {
 BrowserService::LaunchResult BrowserService::launch(const std::string& app,
                                                     bool headless,
                                                     const std::string& user_data_dir,
-                                                    const std::vector<std::string>& additional_args) {
+                                                    const std::vector<std::string>& additional_args,
+                                                    const CancellationToken& cancel) {
     LaunchResult out;
     out.session_id = generateSessionId();
     out.port = pickFreePort();
@@ -678,6 +701,7 @@ BrowserService::LaunchResult BrowserService::launch(const std::string& app,
 
     // Poll until DevTools HTTP endpoint is ready.
     bool ready = false;
+    bool cancelled = false;
     auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
     while (std::chrono::steady_clock::now() < deadline) {
         try {
@@ -685,7 +709,10 @@ BrowserService::LaunchResult BrowserService::launch(const std::string& app,
             ready = true;
             break;
         } catch (...) {
-            Sleep(200);
+            if (cancel.waitFor(200)) {
+                cancelled = true;
+                break;
+            }
         }
     }
 
@@ -693,7 +720,7 @@ BrowserService::LaunchResult BrowserService::launch(const std::string& app,
         TerminateProcess(sei.hProcess, 0);
         CloseHandle(sei.hProcess);
         out.success = false;
-        out.error = "DevTools endpoint not ready";
+        out.error = cancelled ? "Cancelled" : "DevTools endpoint not ready";
         return out;
     }
 
@@ -733,7 +760,8 @@ bool BrowserService::close(const std::string& session_id) {
     return true;
 }
 
-BrowserService::NewTabResult BrowserService::newTab(const std::string& session_id) {
+BrowserService::NewTabResult BrowserService::newTab(const std::string& session_id,
+                                                    const CancellationToken& cancel) {
     NewTabResult out;
     Session s;
     {
@@ -766,7 +794,7 @@ BrowserService::NewTabResult BrowserService::newTab(const std::string& session_i
         std::string browserWs = ResolveBrowserWebSocketUrl(s.port);
         nlohmann::json params;
         params["url"] = "about:blank";
-        auto resp = SendCdpCommand(browserWs, "Target.createTarget", params);
+        auto resp = SendCdpCommand(browserWs, "Target.createTarget", params, cancel);
         std::string targetId;
         if (resp.contains("result") && resp["result"].is_object()) {
             targetId = resp["result"].value("targetId", "");
@@ -784,12 +812,14 @@ BrowserService::NewTabResult BrowserService::newTab(const std::string& session_i
                 wsUrl = ResolveTargetWebSocketUrl(s.port, targetId);
                 break;
             } catch (...) {
-                Sleep(100);
+                if (cancel.waitFor(100)) {
+                    break;
+                }
             }
         }
         if (wsUrl.empty()) {
             out.success = false;
-            out.error = "Failed to resolve websocket url for new tab";
+            out.error = cancel.cancelled() ? "Cancelled" : "Failed to resolve websocket url for new tab";
             return out;
         }
 
@@ -807,7 +837,8 @@ BrowserService::NewTabResult BrowserService::newTab(const std::string& session_i
 bool BrowserService::navigate(const std::string& session_id,
                               const std::string& target_id,
                               const std::string& url,
-                              std::string* outError) {
+                              std::string* outError,
+                              const CancellationToken& cancel) {
     Session s;
     {
         std::lock_guard<std::mutex> lock(mu_);
@@ -821,10 +852,10 @@ bool BrowserService::navigate(const std::string& session_id,
 
     try {
         std::string wsUrl = ResolveTargetWebSocketUrl(s.port, target_id);
-        (void)SendCdpCommand(wsUrl, "Page.enable", nlohmann::json::object());
+        (void)SendCdpCommand(wsUrl, "Page.enable", nlohmann::json::object(), cancel);
         nlohmann::json params;
         params["url"] = url;
-        (void)SendCdpCommand(wsUrl, "Page.navigate", params);
+        (void)SendCdpCommand(wsUrl, "Page.navigate", params, cancel);
         return true;
     } catch (const std::exception& e) {
         if (outError) *outError = e.what();
@@ -835,7 +866,8 @@ bool BrowserService::navigate(const std::string& session_id,
 BrowserService::EvalResult BrowserService::eval(const std::string& session_id,
                                                 const std::string& target_id,
                                                 const std::string& expression,
-                                                bool awaitPromise) {
+                                                bool awaitPromise,
+                                                const CancellationToken& cancel) {
     EvalResult out;
     Session s;
     {
@@ -851,12 +883,12 @@ BrowserService::EvalResult BrowserService::eval(const std::string& session_id,
 
     try {
         std::string wsUrl = ResolveTargetWebSocketUrl(s.port, target_id);
-        (void)SendCdpCommand(wsUrl, "Runtime.enable", nlohmann::json::object());
+        (void)SendCdpCommand(wsUrl, "Runtime.enable", nlohmann::json::object(), cancel);
         nlohmann::json params;
         params["expression"] = expression;
         params["returnByValue"] = true;
         params["awaitPromise"] = awaitPromise;
-        auto resp = SendCdpCommand(wsUrl, "Runtime.evaluate", params);
+        auto resp = SendCdpCommand(wsUrl, "Runtime.evaluate", params, cancel);
         if (resp.contains("error")) {
             out.success = false;
             out.error = resp["error"].dump();
@@ -873,7 +905,8 @@ BrowserService::EvalResult BrowserService::eval(const std::string& session_id,
 }
 
 BrowserService::ScreenshotResult BrowserService::screenshotPngToFile(const std::string& session_id,
-                                                                     const std::string& target_id) {
+                                                                     const std::string& target_id,
+                                                                     const CancellationToken& cancel) {
     ScreenshotResult out;
     Session s;
     {
@@ -889,11 +922,11 @@ BrowserService::ScreenshotResult BrowserService::screenshotPngToFile(const std::
 
     try {
         std::string wsUrl = ResolveTargetWebSocketUrl(s.port, target_id);
-        (void)SendCdpCommand(wsUrl, "Page.enable", nlohmann::json::object());
+        (void)SendCdpCommand(wsUrl, "Page.enable", nlohmann::json::object(), cancel);
 
         nlohmann::json params;
         params["format"] = "png";
-        auto resp = SendCdpCommand(wsUrl, "Page.captureScreenshot", params);
+        auto resp = SendCdpCommand(wsUrl, "Page.captureScreenshot", params, cancel);
         if (!resp.contains("result") || !resp["result"].is_object()) {
             out.success = false;
             out.error = "Invalid captureScreenshot response";
@@ -931,7 +964,8 @@ BrowserService::ScreenshotResult BrowserService::screenshotPngToFile(const std::
 BrowserService::OpenUrlResult BrowserService::openUrl(const std::string& url,
                                                        const std::string& app,
                                                        bool headless,
-                                                       const std::string& session_id) {
+                                                       const std::string& session_id,
+                                                       const CancellationToken& cancel) {
     OpenUrlResult out;
 
     if (url.empty()) {
@@ -957,7 +991,7 @@ BrowserService::OpenUrlResult BrowserService::openUrl(const std::string& url,
             launchApp = "chrome";
         }
 
-        auto launchResult = launch(launchApp, headless, "", {});
+        auto launchResult = launch(launchApp, headless, "", {}, cancel);
         if (!launchResult.success) {
             out.success = false;
             out.error = "Failed to launch browser: " + launchResult.error;
@@ -980,7 +1014,7 @@ BrowserService::OpenUrlResult BrowserService::openUrl(const std::string& url,
     }
 
     // Create new tab
-    auto tabResult = newTab(useSessionId);
+    auto tabResult = newTab(useSessionId, cancel);
     if (!tabResult.success) {
         out.success = false;
         out.error = "Failed to create new tab: " + tabResult.error;
@@ -991,7 +1025,7 @@ BrowserService::OpenUrlResult BrowserService::openUrl(const std::string& url,
 
     // Navigate to URL
     std::string navError;
-    bool navSuccess = navigate(useSessionId, tabResult.target_id, url, &navError);
+    bool navSuccess = navigate(useSessionId, tabResult.target_id, url, &navError, cancel);
     if (!navSuccess) {
         out.success = false;
         out.error = "Failed to navigate: " + navError;
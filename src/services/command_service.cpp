@@ -23,13 +23,24 @@
 #include <sstream>
 #include <stdexcept>
 
+// 等待子进程时检查取消的间隔
+static const DWORD kCancelPollMs = 50;
+
+// 收纳 cmd.exe 及其子进程的 Job：超时或取消时用 TerminateJobObject 结束整棵进程树。
+// 不设 KILL_ON_JOB_CLOSE，正常结束时关闭 Job 不影响命令在后台启动的进程（start 等）。
+// 创建失败时返回 NULL，退化为只结束 cmd.exe
+static HANDLE CreateProcessTreeJob() {
+    return CreateJobObjectA(NULL, NULL);
+}
+
 CommandService::CommandService(ConfigManager* configManager, PolicyGuard* policyGuard)
     : configManager_(configManager), policyGuard_(policyGuard) {
 }
 
 CommandResult CommandService::executeCommand(const std::string& command,
                                              const std::vector<std::string>& args,
-                                             int timeoutMs) {
+                                             int timeoutMs,
+                                             const CancellationToken& cancel) {
     if (!validateCommand(command)) {
         throw std::runtime_error("Command not allowed");
     }
@@ -71,13 +82,15 @@ CommandResult CommandService::executeCommand(const std::string& command,
     std::string cmdLineStr = cmdLine.str();
     char* cmdBuffer = _strdup(cmdLineStr.c_str());
 
+    // 先挂起创建，加入 Job 后再运行，避免子进程在加入前逃出
+    HANDLE job = CreateProcessTreeJob();
     BOOL success = CreateProcessA(
         NULL,
         cmdBuffer,
         NULL,
         NULL,
         TRUE,
-        CREATE_NO_WINDOW,
+        CREATE_NO_WINDOW | CREATE_SUSPENDED,
         NULL,
         NULL,
         &si,
@@ -91,18 +104,46 @@ CommandResult CommandService::executeCommand(const std::string& command,
     if (!success) {
         CloseHandle(hOutRead);
         CloseHandle(hErrRead);
+        if (job) CloseHandle(job);
         throw std::runtime_error("Failed to create process");
     }
+    if (job && !AssignProcessToJobObject(job, pi.hProcess)) {
+        CloseHandle(job);
+        job = NULL;
+    }
+    ResumeThread(pi.hThread);
 
     std::string outText;
     std::string errText;
     char buffer[4096];
     DWORD bytesRead = 0;
 
-    DWORD waitResult = WaitForSingleObject(pi.hProcess, timeoutMs);
-    bool timedOut = (waitResult == WAIT_TIMEOUT);
-    if (timedOut) {
-        TerminateProcess(pi.hProcess, 1);
+    // 分段等待，每段检查一次取消
+    ULONGLONG deadline = GetTickCount64() + static_cast<ULONGLONG>(timeoutMs > 0 ? timeoutMs : 0);
+    bool timedOut = true;
+    bool cancelled = false;
+    for (;;) {
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline) {
+            timedOut = WaitForSingleObject(pi.hProcess, 0) == WAIT_TIMEOUT;
+            break;
+        }
+        ULONGLONG remaining = deadline - now;
+        DWORD slice = remaining < kCancelPollMs ? static_cast<DWORD>(remaining) : kCancelPollMs;
+        if (WaitForSingleObject(pi.hProcess, slice) != WAIT_TIMEOUT) {
+            timedOut = false;
+            break;
+        }
+        if (cancel.cancelled()) {
+            timedOut = false;
+            cancelled = true;
+            break;
+        }
+    }
+    if (timedOut || cancelled) {
+        if (!job || !TerminateJobObject(job, 1)) {
+            TerminateProcess(pi.hProcess, 1);
+        }
     }
 
     while (ReadFile(hOutRead, buffer, sizeof(buffer) - 1, &bytesRead, NULL) && bytesRead > 0) {
@@ -121,12 +162,14 @@ CommandResult CommandService::executeCommand(const std::string& command,
     CloseHandle(hErrRead);
     CloseHandle(pi.hProcess);
     CloseHandle(pi.hThread);
+    if (job) CloseHandle(job);
 
     CommandResult result{};
     result.stdoutText = sanitizeOutput(outText, 1024 * 1024);
     result.stderrText = sanitizeOutput(errText, 1024 * 1024);
     result.exitCode = static_cast<int>(exitCode);
     result.timedOut = timedOut;
+    result.cancelled = cancelled;
     return result;
 }
 
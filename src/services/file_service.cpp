@@ -23,6 +23,7 @@
 #include <shlobj.h>
 #include <shlwapi.h>
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstring>
 #include <fstream>
@@ -59,49 +60,10 @@ static std::string getDirNameA(const std::string& path) {
     return std::string(buf);
 }
 
-static std::string normalizeLineEndings(const std::string& input, const std::string& mode) {
-    std::string m = toLower(mode);
-    if (m.empty() || m == "auto") {
-        // Keep as-is.
-        return input;
-    }
-    if (m == "lf") {
-        std::string out;
-        out.reserve(input.size());
-        for (size_t i = 0; i < input.size(); ++i) {
-            char c = input[i];
-            if (c == '\r') {
-                // Drop CR, preserve LF if present.
-                continue;
-            }
-            out.push_back(c);
-        }
-        return out;
-    }
-    if (m == "crlf") {
-        std::string out;
-        out.reserve(input.size() + input.size() / 20);
-        for (size_t i = 0; i < input.size(); ++i) {
-            char c = input[i];
-            if (c == '\r') {
-                // If already CRLF, keep CR and let next LF through.
-                out.push_back('\r');
-                continue;
-            }
-            if (c == '\n') {
-                // If previous wasn't CR, add CR.
-                if (i == 0 || input[i - 1] != '\r') {
-                    out.push_back('\r');
-                }
-                out.push_back('\n');
-                continue;
-            }
-            out.push_back(c);
-        }
-        return out;
-    }
-    // Unknown mode: keep as-is.
-    return input;
+// 临时文件名：同目录，进程内唯一
+static std::string makeTempPathA(const std::string& path) {
+    static std::atomic<unsigned> seq{0};
+    return path + ".~" + std::to_string(GetCurrentProcessId()) + "-" + std::to_string(++seq) + ".tmp";
 }
 } // namespace
 
@@ -120,6 +82,9 @@ std::vector<FileInfo> FileService::findFiles(const FindFilesParams& params) {
         if (params.max > 0 && static_cast<int>(results.size()) >= params.max) {
             break;
         }
+        if (params.cancel.cancelled()) {
+            break;
+        }
         searchDirectory(dir, params, results);
     }
 
@@ -163,10 +128,90 @@ std::string FileService::readTextFile(const std::string& path) {
     return buffer.str();
 }
 
-void FileService::writeTextFile(const std::string& path,
-                                const std::string& content,
-                                bool overwrite,
-                                const std::string& lineEndings) {
+// ── TextFileWriter ────────────────────────────────────────
+
+TextFileWriter::TextFileWriter(std::string path, std::string tempPath, HANDLE file, LineEndings mode, bool overwrite)
+    : path_(std::move(path)), tempPath_(std::move(tempPath)), file_(file), mode_(mode), overwrite_(overwrite) {
+}
+
+TextFileWriter::~TextFileWriter() {
+    if (file_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_);
+        DeleteFileA(tempPath_.c_str());
+    }
+}
+
+void TextFileWriter::writeRaw(const char* data, size_t size) {
+    while (size > 0) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+        DWORD written = 0;
+        if (!WriteFile(file_, data, chunk, &written, NULL) || written == 0) {
+            throw std::runtime_error("Failed to write file");
+        }
+        data += written;
+        size -= written;
+        bytesWritten_ += written;
+    }
+}
+
+void TextFileWriter::write(const char* data, size_t size) {
+    if (file_ == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("File already committed");
+    }
+    if (size == 0) return;
+    if (mode_ == LineEndings::Keep) {
+        writeRaw(data, size);
+        return;
+    }
+
+    scratch_.clear();
+    scratch_.reserve(size + size / 20);
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        if (mode_ == LineEndings::Lf) {
+            // Drop CR, preserve LF if present.
+            if (c != '\r') scratch_.push_back(c);
+            continue;
+        }
+        // CRLF: add CR before a bare LF; existing CRLF (possibly split across chunks) is kept.
+        if (c == '\n' && !lastWasCr_) {
+            scratch_.push_back('\r');
+        }
+        scratch_.push_back(c);
+        lastWasCr_ = (c == '\r');
+    }
+    writeRaw(scratch_.data(), scratch_.size());
+}
+
+void TextFileWriter::commit() {
+    if (file_ == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("File already committed");
+    }
+    bool flushed = FlushFileBuffers(file_) != 0;
+    CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+    if (!flushed) {
+        DeleteFileA(tempPath_.c_str());
+        throw std::runtime_error("Failed to write file");
+    }
+
+    // 不覆盖时不带 REPLACE_EXISTING：期间目标被别人创建也不会被替换
+    DWORD flags = MOVEFILE_COPY_ALLOWED | (overwrite_ ? MOVEFILE_REPLACE_EXISTING : 0);
+    if (!MoveFileExA(tempPath_.c_str(), path_.c_str(), flags)) {
+        DWORD err = GetLastError();
+        DeleteFileA(tempPath_.c_str());
+        if (err == ERROR_ALREADY_EXISTS || err == ERROR_FILE_EXISTS) {
+            throw std::runtime_error("File already exists");
+        }
+        throw std::runtime_error("Failed to write file");
+    }
+}
+
+// ── 写文件 ────────────────────────────────────────────────
+
+std::unique_ptr<TextFileWriter> FileService::openTextFileWriter(const std::string& path,
+                                                                bool overwrite,
+                                                                const std::string& lineEndings) {
     if (path.empty()) {
         throw std::runtime_error("Path required");
     }
@@ -184,17 +229,42 @@ void FileService::writeTextFile(const std::string& path,
         SHCreateDirectoryExA(NULL, dir.c_str(), NULL);
     }
 
-    std::string normalized = normalizeLineEndings(content, lineEndings);
+    // Unknown mode: keep as-is.
+    std::string m = toLower(lineEndings);
+    TextFileWriter::LineEndings mode = TextFileWriter::LineEndings::Keep;
+    if (m == "lf") {
+        mode = TextFileWriter::LineEndings::Lf;
+    } else if (m == "crlf") {
+        mode = TextFileWriter::LineEndings::Crlf;
+    }
 
-    std::ofstream out(path, std::ios::binary | std::ios::trunc);
-    if (!out.is_open()) {
+    std::string tempPath = makeTempPathA(path);
+    HANDLE file = CreateFileA(tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_NEW,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
         throw std::runtime_error("Failed to open file for write");
     }
-    out.write(normalized.data(), (std::streamsize)normalized.size());
-    out.close();
-    if (!out.good()) {
-        throw std::runtime_error("Failed to write file");
+    return std::unique_ptr<TextFileWriter>(new TextFileWriter(path, std::move(tempPath), file, mode, overwrite));
+}
+
+std::string FileService::resolveLineEndings(const std::string& path, const std::string& lineEndings) {
+    std::string lowerPath = toLower(path);
+    if (lineEndings == "auto" &&
+        (lowerPath.size() >= 4 &&
+         (lowerPath.rfind(".bat") == lowerPath.size() - 4 ||
+          lowerPath.rfind(".cmd") == lowerPath.size() - 4))) {
+        return "crlf";
     }
+    return lineEndings;
+}
+
+void FileService::writeTextFile(const std::string& path,
+                                const std::string& content,
+                                bool overwrite,
+                                const std::string& lineEndings) {
+    std::unique_ptr<TextFileWriter> writer = openTextFileWriter(path, overwrite, lineEndings);
+    writer->write(content);
+    writer->commit();
 }
 
 std::vector<SearchMatch> FileService::searchTextInFile(const std::string& path,
@@ -347,6 +417,9 @@ void FileService::searchDirectory(const std::string& dir,
     const uint64_t dayTicks = 24ULL * 60ULL * 60ULL * 10000000ULL;
 
     do {
+        if (params.cancel.cancelled()) {
+            break;
+        }
         std::string name = findData.cFileName;
         if (name == "." || name == "..") {
             continue;
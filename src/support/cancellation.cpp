@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "support/cancellation.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// probe 的最长检查间隔：waitFor 在条件变量上分段等待，每段结束检查一次 probe
+static const int kProbeIntervalMs = 50;
+
+struct CancellationState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic_bool cancelled{false};
+    std::function<bool()> probe;
+    uint64_t nextCallbackId = 1;
+    std::map<uint64_t, std::function<void()>> callbacks;
+};
+
+CancellationToken CancellationToken::Create(std::function<bool()> probe) {
+    CancellationToken token;
+    token.state_ = std::make_shared<CancellationState>();
+    token.state_->probe = std::move(probe);
+    return token;
+}
+
+void CancellationToken::cancel() const {
+    if (!state_) return;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->cancelled.exchange(true)) return;
+        // 持锁执行：注册对象析构时能等到回调结束
+        for (auto& entry : state_->callbacks) {
+            entry.second();
+        }
+        state_->callbacks.clear();
+    }
+    state_->cv.notify_all();
+}
+
+bool CancellationToken::cancelled() const {
+    if (!state_) return false;
+    if (state_->cancelled.load()) return true;
+    if (state_->probe && state_->probe()) {
+        cancel();
+        return true;
+    }
+    return false;
+}
+
+bool CancellationToken::waitFor(int ms) const {
+    if (!state_) {
+        if (ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return false;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(ms, 0));
+    while (!cancelled()) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) return false;
+        auto slice = std::min<std::chrono::steady_clock::duration>(
+            deadline - now, std::chrono::milliseconds(kProbeIntervalMs));
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->cv.wait_for(lock, slice, [this]() { return state_->cancelled.load(); });
+    }
+    return true;
+}
+
+CancellationRegistration CancellationToken::onCancel(std::function<void()> callback) const {
+    CancellationRegistration registration;
+    if (!state_) return registration;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->cancelled.load()) {
+            registration.state_ = state_;
+            registration.id_ = state_->nextCallbackId++;
+            state_->callbacks.emplace(registration.id_, std::move(callback));
+            return registration;
+        }
+    }
+    callback();
+    return registration;
+}
+
+CancellationRegistration::~CancellationRegistration() {
+    reset();
+}
+
+CancellationRegistration::CancellationRegistration(CancellationRegistration&& other) noexcept
+    : state_(std::move(other.state_)), id_(other.id_) {
+    other.id_ = 0;
+}
+
+CancellationRegistration& CancellationRegistration::operator=(CancellationRegistration&& other) noexcept {
+    if (this != &other) {
+        reset();
+        state_ = std::move(other.state_);
+        id_ = other.id_;
+        other.id_ = 0;
+    }
+    return *this;
+}
+
+void CancellationRegistration::reset() {
+    if (!state_) return;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->callbacks.erase(id_);
+    }
+    state_.reset();
+    id_ = 0;
+}
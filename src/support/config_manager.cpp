@@ -24,7 +24,11 @@
 #include <iomanip>
 #include <stdexcept>
 #include <iostream>
+#include <cstdio>
+#include <thread>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 using json = nlohmann::json;
 
@@ -62,7 +66,33 @@ void ConfigManager::load() {
         j["server"] = {
             {"port", config_.server_port},
             {"auto_port", config_.auto_port},
-            {"listen_address", config_.listen_address}
+            {"listen_address", config_.listen_address},
+            {"worker_threads", config_.http_worker_threads},
+            {"queue_capacity", config_.http_queue_capacity},
+            {"keep_alive_timeout_seconds", config_.http_keep_alive_timeout_seconds},
+            {"keep_alive_max_requests", config_.http_keep_alive_max_requests},
+            {"rate_limit_per_minute", config_.http_rate_limit_per_minute},
+            {"queue_timeout_ms", config_.http_queue_timeout_ms},
+            {"fast_lane_workers", config_.http_fast_lane_workers},
+            {"header_timeout_ms", config_.http_header_timeout_ms},
+            {"body_timeout_ms", config_.http_body_timeout_ms},
+            {"min_body_rate", config_.http_min_body_rate},
+            {"accept_shards", config_.http_accept_shards},
+            {"compression", config_.http_compression},
+            {"compression_min_bytes", config_.http_compression_min_bytes},
+            {"compression_level", config_.http_compression_level},
+            {"tls_port", config_.http_tls_port},
+            {"tls_cert_file", config_.http_tls_cert_file},
+            {"tls_key_file", config_.http_tls_key_file},
+            {"tls_session_timeout_seconds", config_.http_tls_session_timeout_seconds},
+            {"drain_timeout_ms", config_.http_drain_timeout_ms},
+            {"batch_workers", config_.http_batch_workers},
+            {"tool_workers", config_.http_tool_workers},
+            {"mcp_max_sessions", config_.mcp_max_sessions},
+            {"mcp_session_idle_timeout_seconds", config_.mcp_session_idle_timeout_seconds},
+            {"mcp_session_ttl_seconds", config_.mcp_session_ttl_seconds},
+            {"sse_max_sessions", config_.sse_max_sessions},
+            {"sse_session_ttl_seconds", config_.sse_session_ttl_seconds}
         };
         j["appearance"] = {
             {"dashboard_auto_show", config_.dashboard_auto_show},
@@ -104,6 +134,32 @@ void ConfigManager::load() {
         config_.log_retention_days = j.value("log_retention_days", 30);
         config_.daemon_enabled = j.value("daemon_enabled", true);
         config_.command_timeout_seconds = j.value("command_timeout_seconds", 30);
+        config_.http_worker_threads = 0;
+        config_.http_queue_capacity = 128;
+        config_.http_keep_alive_timeout_seconds = 15;
+        config_.http_keep_alive_max_requests = 100;
+        config_.http_rate_limit_per_minute = 120;
+        config_.http_queue_timeout_ms = 5000;
+        config_.http_fast_lane_workers = 1;
+        config_.http_header_timeout_ms = 10000;
+        config_.http_body_timeout_ms = 30000;
+        config_.http_min_body_rate = 1024;
+        config_.http_accept_shards = 1;
+        config_.http_compression = true;
+        config_.http_compression_min_bytes = 1024;
+        config_.http_compression_level = 6;
+        config_.http_tls_port = 0;
+        config_.http_tls_cert_file = "";
+        config_.http_tls_key_file = "";
+        config_.http_tls_session_timeout_seconds = 3600;
+        config_.http_drain_timeout_ms = 5000;
+        config_.http_batch_workers = 4;
+        config_.http_tool_workers = 4;
+        config_.mcp_max_sessions = 1024;
+        config_.mcp_session_idle_timeout_seconds = 1800;
+        config_.mcp_session_ttl_seconds = 86400;
+        config_.sse_max_sessions = 256;
+        config_.sse_session_ttl_seconds = 3600;
 
         config_.auto_update_enabled = j.value("auto_update_enabled", true);
         config_.update_check_interval_hours = j.value("update_check_interval_hours", 6);
@@ -129,6 +185,37 @@ void ConfigManager::load() {
             config_.server_port = server.value("port", config_.server_port);
             config_.auto_port = server.value("auto_port", config_.auto_port);
             config_.listen_address = server.value("listen_address", config_.listen_address);
+            config_.http_worker_threads = server.value("worker_threads", config_.http_worker_threads);
+            config_.http_queue_capacity = server.value("queue_capacity", config_.http_queue_capacity);
+            config_.http_keep_alive_timeout_seconds =
+                server.value("keep_alive_timeout_seconds", config_.http_keep_alive_timeout_seconds);
+            config_.http_keep_alive_max_requests =
+                server.value("keep_alive_max_requests", config_.http_keep_alive_max_requests);
+            config_.http_rate_limit_per_minute =
+                server.value("rate_limit_per_minute", config_.http_rate_limit_per_minute);
+            config_.http_queue_timeout_ms = server.value("queue_timeout_ms", config_.http_queue_timeout_ms);
+            config_.http_fast_lane_workers = server.value("fast_lane_workers", config_.http_fast_lane_workers);
+            config_.http_header_timeout_ms = server.value("header_timeout_ms", config_.http_header_timeout_ms);
+            config_.http_body_timeout_ms = server.value("body_timeout_ms", config_.http_body_timeout_ms);
+            config_.http_min_body_rate = server.value("min_body_rate", config_.http_min_body_rate);
+            config_.http_accept_shards = server.value("accept_shards", config_.http_accept_shards);
+            config_.http_compression = server.value("compression", config_.http_compression);
+            config_.http_compression_min_bytes = server.value("compression_min_bytes", config_.http_compression_min_bytes);
+            config_.http_compression_level = server.value("compression_level", config_.http_compression_level);
+            config_.http_tls_port = server.value("tls_port", config_.http_tls_port);
+            config_.http_tls_cert_file = server.value("tls_cert_file", config_.http_tls_cert_file);
+            config_.http_tls_key_file = server.value("tls_key_file", config_.http_tls_key_file);
+            config_.http_tls_session_timeout_seconds =
+                server.value("tls_session_timeout_seconds", config_.http_tls_session_timeout_seconds);
+            config_.http_drain_timeout_ms = server.value("drain_timeout_ms", config_.http_drain_timeout_ms);
+            config_.http_batch_workers = server.value("batch_workers", config_.http_batch_workers);
+            config_.http_tool_workers = server.value("tool_workers", config_.http_tool_workers);
+            config_.mcp_max_sessions = server.value("mcp_max_sessions", config_.mcp_max_sessions);
+            config_.mcp_session_idle_timeout_seconds =
+                server.value("mcp_session_idle_timeout_seconds", config_.mcp_session_idle_timeout_seconds);
+            config_.mcp_session_ttl_seconds = server.value("mcp_session_ttl_seconds", config_.mcp_session_ttl_seconds);
+            config_.sse_max_sessions = server.value("sse_max_sessions", config_.sse_max_sessions);
+            config_.sse_session_ttl_seconds = server.value("sse_session_ttl_seconds", config_.sse_session_ttl_seconds);
         }
 
         if (j.contains("appearance") && j["appearance"].is_object()) {
@@ -175,7 +262,33 @@ void ConfigManager::save() {
     j["server"] = {
         {"port", config_.server_port},
         {"auto_port", config_.auto_port},
-        {"listen_address", config_.listen_address}
+        {"listen_address", config_.listen_address},
+        {"worker_threads", config_.http_worker_threads},
+        {"queue_capacity", config_.http_queue_capacity},
+        {"keep_alive_timeout_seconds", config_.http_keep_alive_timeout_seconds},
+        {"keep_alive_max_requests", config_.http_keep_alive_max_requests},
+        {"rate_limit_per_minute", config_.http_rate_limit_per_minute},
+        {"queue_timeout_ms", config_.http_queue_timeout_ms},
+        {"fast_lane_workers", config_.http_fast_lane_workers},
+        {"header_timeout_ms", config_.http_header_timeout_ms},
+        {"body_timeout_ms", config_.http_body_timeout_ms},
+        {"min_body_rate", config_.http_min_body_rate},
+        {"accept_shards", config_.http_accept_shards},
+        {"compression", config_.http_compression},
+        {"compression_min_bytes", config_.http_compression_min_bytes},
+        {"compression_level", config_.http_compression_level},
+        {"tls_port", config_.http_tls_port},
+        {"tls_cert_file", config_.http_tls_cert_file},
+        {"tls_key_file", config_.http_tls_key_file},
+        {"tls_session_timeout_seconds", config_.http_tls_session_timeout_seconds},
+        {"drain_timeout_ms", config_.http_drain_timeout_ms},
+        {"batch_workers", config_.http_batch_workers},
+        {"tool_workers", config_.http_tool_workers},
+        {"mcp_max_sessions", config_.mcp_max_sessions},
+        {"mcp_session_idle_timeout_seconds", config_.mcp_session_idle_timeout_seconds},
+        {"mcp_session_ttl_seconds", config_.mcp_session_ttl_seconds},
+        {"sse_max_sessions", config_.sse_max_sessions},
+        {"sse_session_ttl_seconds", config_.sse_session_ttl_seconds}
     };
     j["appearance"] = {
         {"dashboard_auto_show", config_.dashboard_auto_show},
@@ -196,7 +309,13 @@ void ConfigManager::save() {
     file << j.dump(4) << std::endl;
     file.close();
 
-    if (!MoveFileExA(tempPath.c_str(), configPath_.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+    // 写临时文件后原子替换（POSIX rename 本身覆盖目标）
+#ifdef _WIN32
+    bool replaced = MoveFileExA(tempPath.c_str(), configPath_.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    bool replaced = std::rename(tempPath.c_str(), configPath_.c_str()) == 0;
+#endif
+    if (!replaced) {
         std::remove(tempPath.c_str());
         throw std::runtime_error("无法替换配置文件: " + configPath_);
     }
@@ -241,6 +360,23 @@ std::string ConfigManager::getListenAddress() const {
     return config_.listen_address;
 }
 
+bool ConfigManager::isListenLoopbackOnly() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    // listen_address 是逗号分隔的地址列表，IPv6 可带方括号；空列表按 0.0.0.0 处理
+    std::stringstream ss(config_.listen_address);
+    std::string item;
+    bool any = false;
+    while (std::getline(ss, item, ',')) {
+        size_t begin = item.find_first_not_of(" \t[");
+        if (begin == std::string::npos) continue;
+        size_t end = item.find_last_not_of(" \t]");
+        item = item.substr(begin, end - begin + 1);
+        if (item != "::1" && item.compare(0, 4, "127.") != 0) return false;
+        any = true;
+    }
+    return any;
+}
+
 std::string ConfigManager::getLanguage() const {
     std::lock_guard<std::mutex> lock(configMutex_);
     return config_.language;
@@ -289,6 +425,187 @@ int ConfigManager::getCommandTimeoutSeconds() const {
     std::lock_guard<std::mutex> lock(configMutex_);
     return config_.command_timeout_seconds > 0 ? config_.command_timeout_seconds : 30;
 }
+
+int ConfigManager::getHttpWorkerThreads() const {
+    int configured;
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        configured = config_.http_worker_threads;
+    }
+    if (configured > 0) {
+        return configured > 64 ? 64 : configured;
+    }
+    // 自动：CPU 核数，至少 4 个（工具调用大多是阻塞 I/O，而非 CPU 密集）
+    unsigned hc = std::thread::hardware_concurrency();
+    int n = hc > 0 ? static_cast<int>(hc) : 4;
+    if (n < 4) n = 4;
+    if (n > 16) n = 16;
+    return n;
+}
+
+int ConfigManager::getHttpQueueCapacity() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return config_.http_queue_capacity > 0 ? config_.http_queue_capacity : 128;
+}
+
+int ConfigManager::getHttpKeepAliveTimeoutSeconds() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return config_.http_keep_alive_timeout_seconds >= 0 ? config_.http_keep_alive_timeout_seconds : 15;
+}
+
+int ConfigManager::getHttpKeepAliveMaxRequests() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return config_.http_keep_alive_max_requests > 0 ? config_.http_keep_alive_max_requests : 100;
+}
+
+int ConfigManager::getHttpRateLimitPerMinute() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int n = config_.http_rate_limit_per_minute;
+    if (n < 1) return 120;
+    return n > 1000000 ? 1000000 : n;
+}
+
+int ConfigManager::getHttpQueueTimeoutMs() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    if (config_.http_queue_timeout_ms <= 0) return 5000;
+    return config_.http_queue_timeout_ms < 100 ? 100 : config_.http_queue_timeout_ms;
+}
+
+int ConfigManager::getHttpFastLaneWorkers() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int n = config_.http_fast_lane_workers;
+    if (n < 0) return 1;
+    return n > 4 ? 4 : n;
+}
+
+int ConfigManager::getHttpHeaderTimeoutMs() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    if (config_.http_header_timeout_ms <= 0) return 10000;
+    return config_.http_header_timeout_ms < 1000 ? 1000 : config_.http_header_timeout_ms;
+}
+
+int ConfigManager::getHttpBodyTimeoutMs() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    if (config_.http_body_timeout_ms <= 0) return 30000;
+    return config_.http_body_timeout_ms < 1000 ? 1000 : config_.http_body_timeout_ms;
+}
+
+int ConfigManager::getHttpMinBodyRate() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return config_.http_min_body_rate > 0 ? config_.http_min_body_rate : 0;
+}
+
+int ConfigManager::getHttpAcceptShards() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int n = config_.http_accept_shards;
+    if (n < 1) return 1;
+    return n > 16 ? 16 : n;
+}
+
+int ConfigManager::getHttpDrainTimeoutMs() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int ms = config_.http_drain_timeout_ms;
+    if (ms < 0) return 5000;
+    return ms > 60000 ? 60000 : ms;
+}
+
+int ConfigManager::getHttpBatchWorkers() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int n = config_.http_batch_workers;
+    if (n < 0) return 0;
+    return n > 32 ? 32 : n;
+}
+
+int ConfigManager::getHttpToolWorkers() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int n = config_.http_tool_workers;
+    if (n < 0) return 0;
+    return n > 64 ? 64 : n;
+}
+
+int ConfigManager::getMcpMaxSessions() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int n = config_.mcp_max_sessions;
+    if (n < 16) return 16;
+    return n > 100000 ? 100000 : n;
+}
+
+int ConfigManager::getMcpSessionIdleTimeoutSeconds() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int s = config_.mcp_session_idle_timeout_seconds;
+    if (s < 60) return 60;
+    return s > 604800 ? 604800 : s;
+}
+
+int ConfigManager::getMcpSessionTtlSeconds() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int s = config_.mcp_session_ttl_seconds;
+    if (s <= 0) return 0;
+    return s > 2592000 ? 2592000 : s;
+}
+
+int ConfigManager::getSseMaxSessions() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int n = config_.sse_max_sessions;
+    if (n < 1) return 1;
+    return n > 10000 ? 10000 : n;
+}
+
+int ConfigManager::getSseSessionTtlSeconds() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int s = config_.sse_session_ttl_seconds;
+    if (s < 60) return 60;
+    return s > 86400 ? 86400 : s;
+}
+
+bool ConfigManager::isHttpCompressionEnabled() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return config_.http_compression;
+}
+
+int ConfigManager::getHttpCompressionMinBytes() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return config_.http_compression_min_bytes < 0 ? 0 : config_.http_compression_min_bytes;
+}
+
+int ConfigManager::getHttpCompressionLevel() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int level = config_.http_compression_level;
+    if (level < 1) return 1;
+    return level > 9 ? 9 : level;
+}
+
+int ConfigManager::getHttpTlsPort() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int port = config_.http_tls_port;
+    return (port < 0 || port > 65535) ? 0 : port;
+}
+
+// 相对路径按配置文件所在目录解析
+static std::string ResolveConfigRelativePath(const std::string& configPath, const std::string& path) {
+    if (path.empty() || path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':')) {
+        return path;
+    }
+    size_t slash = configPath.find_last_of("/\\");
+    return slash == std::string::npos ? path : configPath.substr(0, slash + 1) + path;
+}
+
+std::string ConfigManager::getHttpTlsCertFile() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return ResolveConfigRelativePath(configPath_, config_.http_tls_cert_file);
+}
+
+std::string ConfigManager::getHttpTlsKeyFile() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    return ResolveConfigRelativePath(configPath_, config_.http_tls_key_file);
+}
+
+int ConfigManager::getHttpTlsSessionTimeoutSeconds() const {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    int n = config_.http_tls_session_timeout_seconds;
+    if (n < 60) return 60;
+    return n > 86400 ? 86400 : n;
+}
 // ===== 配置项修改器 =====
 
 void ConfigManager::setLicenseKey(const std::string&) {}
@@ -447,6 +764,32 @@ ServerConfig ConfigManager::generateDefaultConfig() {
     config.log_retention_days = 30;
     config.daemon_enabled = true;
     config.command_timeout_seconds = 30;
+    config.http_worker_threads = 0;
+    config.http_queue_capacity = 128;
+    config.http_keep_alive_timeout_seconds = 15;
+    config.http_keep_alive_max_requests = 100;
+    config.http_rate_limit_per_minute = 120;
+    config.http_queue_timeout_ms = 5000;
+    config.http_fast_lane_workers = 1;
+    config.http_header_timeout_ms = 10000;
+    config.http_body_timeout_ms = 30000;
+    config.http_min_body_rate = 1024;
+    config.http_accept_shards = 1;
+    config.http_compression = true;
+    config.http_compression_min_bytes = 1024;
+    config.http_compression_level = 6;
+    config.http_tls_port = 0;
+    config.http_tls_cert_file = "";
+    config.http_tls_key_file = "";
+    config.http_tls_session_timeout_seconds = 3600;
+    config.http_drain_timeout_ms = 5000;
+    config.http_batch_workers = 4;
+    config.http_tool_workers = 4;
+    config.mcp_max_sessions = 1024;
+    config.mcp_session_idle_timeout_seconds = 1800;
+    config.mcp_session_ttl_seconds = 86400;
+    config.sse_max_sessions = 256;
+    config.sse_session_ttl_seconds = 3600;
     config.auto_update_enabled = true;
     config.update_check_interval_hours = 6;
     config.update_channel = "stable";
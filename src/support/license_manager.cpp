@@ -78,7 +78,11 @@ std::string LicenseManager::getCurrentDateString() {
     auto now = std::chrono::system_clock::now();
     std::time_t t = std::chrono::system_clock::to_time_t(now);
     std::tm tm{};
+#ifdef _WIN32
     gmtime_s(&tm, &t);
+#else
+    gmtime_r(&t, &tm);
+#endif
     std::ostringstream oss;
     oss << std::put_time(&tm, "%Y-%m-%d");
     return oss.str();
@@ -17,13 +17,14 @@
  * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
  */
 #include "support/rate_limiter.h"
+#include "utils/monotonic_clock.h"
 
-RateLimiter::RateLimiter(int maxRequests, DWORD windowMs)
+RateLimiter::RateLimiter(int maxRequests, uint64_t windowMs)
     : maxRequests_(maxRequests), windowMs_(windowMs) {}
 
 bool RateLimiter::allow(const std::string& clientIp) {
     std::lock_guard<std::mutex> lock(mutex_);
-    DWORD now = GetTickCount();
+    uint64_t now = MonotonicMillis();
     auto& q = requests_[clientIp];
 
     // 移除窗口外的旧条目
@@ -41,7 +42,7 @@ bool RateLimiter::allow(const std::string& clientIp) {
 
 void RateLimiter::cleanup() {
     std::lock_guard<std::mutex> lock(mutex_);
-    DWORD now = GetTickCount();
+    uint64_t now = MonotonicMillis();
     for (auto it = requests_.begin(); it != requests_.end(); ) {
         auto& q = it->second;
         while (!q.empty() && (now - q.front()) > windowMs_) {
@@ -2665,7 +2665,7 @@ void SettingsWindow::updateTabTitles() {
         SendMessageW(GetDlgItem(serverTab, IDC_SERVER_AUTOPORT), BM_SETCHECK,
                      currentSettings_.autoPortSelection ? BST_CHECKED : BST_UNCHECKED, 0);
         EnableWindow(GetDlgItem(serverTab, IDC_SERVER_PORT_INPUT), currentSettings_.autoPortSelection ? FALSE : TRUE);
-        bool listenAll = currentSettings_.listenAddress == "0.0.0.0";
+        bool listenAll = configManager_ && !configManager_->isListenLoopbackOnly();
         SendMessageW(GetDlgItem(serverTab, IDC_SERVER_LISTEN_ALL), BM_SETCHECK, listenAll ? BST_CHECKED : BST_UNCHECKED, 0);
         SendMessageW(GetDlgItem(serverTab, IDC_SERVER_LISTEN_LOCAL), BM_SETCHECK, listenAll ? BST_UNCHECKED : BST_CHECKED, 0);
         SetWindowTextW(GetDlgItem(serverTab, IDC_SERVER_STATUS_LABEL),
@@ -2830,11 +2830,10 @@ void SettingsWindow::syncControlsToSettings() {
                 (SendMessageW(autoPort, BM_GETCHECK, 0, 0) == BST_CHECKED);
         }
         HWND listenAll = GetDlgItem(serverTab, IDC_SERVER_LISTEN_ALL);
-        if (listenAll &&
-            SendMessageW(listenAll, BM_GETCHECK, 0, 0) == BST_CHECKED) {
-            currentSettings_.listenAddress = "0.0.0.0";
-        } else {
-            currentSettings_.listenAddress = "127.0.0.1";
+        bool wantAll = listenAll && SendMessageW(listenAll, BM_GETCHECK, 0, 0) == BST_CHECKED;
+        // 手动配置的地址列表（如 "127.0.0.1,::1"）在单选项未改动时保留
+        if (!configManager_ || wantAll == configManager_->isListenLoopbackOnly()) {
+            currentSettings_.listenAddress = wantAll ? "0.0.0.0" : "127.0.0.1";
         }
     }
 
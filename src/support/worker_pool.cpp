@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+#include "support/worker_pool.h"
+
+static const size_t kFastLaneCapacity = 64;
+
+WorkerPool::WorkerPool(size_t workers, size_t capacity, const std::string& name, size_t fastLaneWorkers)
+    : name_(name), queue_(capacity < 2 ? 2 : capacity), fastQueue_(kFastLaneCapacity) {
+    if (workers == 0) workers = 1;
+    workerCount_ = workers;
+    fastLaneCount_ = fastLaneWorkers;
+    threads_.reserve(workers + fastLaneWorkers);
+    for (size_t i = 0; i < workers; ++i) {
+        threads_.emplace_back([this]() { workerLoop(false); });
+    }
+    for (size_t i = 0; i < fastLaneWorkers; ++i) {
+        threads_.emplace_back([this]() { workerLoop(true); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+bool WorkerPool::enqueue(Item item) {
+    if (stopping_.load(std::memory_order_acquire) || !queue_.tryPush(std::move(item))) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+
+    size_t depth = queue_.sizeApprox();
+    size_t peak = peakDepth_.load(std::memory_order_relaxed);
+    while (depth > peak && !peakDepth_.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {
+    }
+    wake(false);
+    return true;
+}
+
+// 与 workerLoop 中 parked_++ 之后的 fence 配对：
+// 要么生产者看到 parked_ > 0 并唤醒，要么休眠方在检查队列时看到本次 push
+void WorkerPool::wake(bool fast) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (fast && fastParked_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(parkMutex_);
+        fastParkCv_.notify_one();
+        return;
+    }
+    if (parked_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(parkMutex_);
+        parkCv_.notify_one();
+    }
+}
+
+bool WorkerPool::submit(Task task) {
+    Item item;
+    item.task = std::move(task);
+    item.enqueuedAt = Clock::now();
+    return enqueue(std::move(item));
+}
+
+bool WorkerPool::submit(Task task, std::chrono::milliseconds maxWait, Task onExpired) {
+    // 所有线程都在忙时，按排在前面的任务数 × 平均执行时间估算等待；明显超时的不必排队
+    uint64_t avg = avgServiceUs_.load(std::memory_order_relaxed);
+    size_t ahead = queue_.sizeApprox();
+    uint64_t limitUs = static_cast<uint64_t>(maxWait.count()) * 1000;
+    if (avg > 0 && ahead > 0 && ahead * avg / workerCount_ > limitUs) {
+        shed_.fetch_add(1, std::memory_order_relaxed);
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Item item;
+    item.task = std::move(task);
+    item.onExpired = std::move(onExpired);
+    item.enqueuedAt = Clock::now();
+    item.deadline = item.enqueuedAt + maxWait;
+    return enqueue(std::move(item));
+}
+
+bool WorkerPool::submitFast(Task task) {
+    Item item;
+    item.task = std::move(task);
+    item.enqueuedAt = Clock::now();
+    if (stopping_.load(std::memory_order_acquire) || !fastQueue_.tryPush(std::move(item))) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    fastSubmitted_.fetch_add(1, std::memory_order_relaxed);
+    wake(true);
+    return true;
+}
+
+void WorkerPool::recordWait(uint64_t waitUs) {
+    totalWaitUs_.fetch_add(waitUs, std::memory_order_relaxed);
+    uint64_t prev = maxWaitUs_.load(std::memory_order_relaxed);
+    while (waitUs > prev && !maxWaitUs_.compare_exchange_weak(prev, waitUs, std::memory_order_relaxed)) {
+    }
+}
+
+// 滑动平均（权重 1/8），只用于估算排队时间，并发更新丢一次样本无妨
+void WorkerPool::recordService(uint64_t serviceUs) {
+    uint64_t avg = avgServiceUs_.load(std::memory_order_relaxed);
+    uint64_t next = avg == 0 ? serviceUs : avg - avg / 8 + serviceUs / 8;
+    avgServiceUs_.store(next, std::memory_order_relaxed);
+}
+
+void WorkerPool::run(Item& item, bool fast) {
+    Clock::time_point start = Clock::now();
+    recordWait(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(start - item.enqueuedAt).count()));
+
+    if (start > item.deadline) {
+        // 排队超时：客户端多半已经在等重试，执行只会让后面的请求更晚
+        expired_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            if (item.onExpired) item.onExpired();
+        } catch (...) {
+        }
+        return;
+    }
+
+    busy_.fetch_add(1, std::memory_order_relaxed);
+    try {
+        item.task();
+    } catch (...) {
+        // 任务自身负责错误处理；这里只保证线程不退出
+    }
+    busy_.fetch_sub(1, std::memory_order_relaxed);
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    if (!fast) {
+        recordService(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count()));
+    }
+}
+
+void WorkerPool::workerLoop(bool fastOnly) {
+    for (;;) {
+        Item item;
+        bool fast = fastQueue_.tryPop(item);
+        if (fast || (!fastOnly && queue_.tryPop(item))) {
+            if (stopping_.load(std::memory_order_acquire)) {
+                continue;  // 停止阶段丢弃排队任务
+            }
+            run(item, fast);
+            continue;
+        }
+
+        if (stopping_.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        std::atomic<int>& parked = fastOnly ? fastParked_ : parked_;
+        std::unique_lock<std::mutex> lock(parkMutex_);
+        parked.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        (fastOnly ? fastParkCv_ : parkCv_).wait(lock, [this, fastOnly]() {
+            return stopping_.load(std::memory_order_acquire) || fastQueue_.sizeApprox() > 0 ||
+                   (!fastOnly && queue_.sizeApprox() > 0);
+        });
+        parked.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void WorkerPool::shutdown() {
+    if (stopping_.exchange(true)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(parkMutex_);
+        parkCv_.notify_all();
+        fastParkCv_.notify_all();
+    }
+    for (auto& t : threads_) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    threads_.clear();
+
+    // 线程都已退出，清掉残留任务（让捕获的 socket 等资源按析构逻辑释放）
+    Item item;
+    while (queue_.tryPop(item) || fastQueue_.tryPop(item)) {
+        item = Item();
+    }
+}
+
+WorkerPool::Stats WorkerPool::stats() const {
+    Stats s;
+    s.workers = workerCount_;
+    s.busyWorkers = busy_.load(std::memory_order_relaxed);
+    s.queueCapacity = queue_.capacity();
+    s.queueDepth = queue_.sizeApprox();
+    s.peakQueueDepth = peakDepth_.load(std::memory_order_relaxed);
+    s.fastLaneWorkers = fastLaneCount_;
+    s.fastLaneDepth = fastQueue_.sizeApprox();
+    s.submitted = submitted_.load(std::memory_order_relaxed);
+    s.completed = completed_.load(std::memory_order_relaxed);
+    s.rejected = rejected_.load(std::memory_order_relaxed);
+    s.shed = shed_.load(std::memory_order_relaxed);
+    s.expired = expired_.load(std::memory_order_relaxed);
+    s.fastLaneSubmitted = fastSubmitted_.load(std::memory_order_relaxed);
+    s.totalQueueWaitUs = totalWaitUs_.load(std::memory_order_relaxed);
+    s.maxQueueWaitUs = maxWaitUs_.load(std::memory_order_relaxed);
+    s.avgServiceUs = avgServiceUs_.load(std::memory_order_relaxed);
+    return s;
+}
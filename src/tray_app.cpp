@@ -72,7 +72,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                     std::string localIP = GetLocalIPAddress();
                     
                     std::wstring listenLabel = Localize("tray.listen", L"Listen");
-                    if (listenAddr == "0.0.0.0") {
+                    if (!g_configManager->isListenLoopbackOnly()) {
                         std::wstring allLabel = Localize("tray.listen.all", L"All interfaces");
                         std::wstring listenAddrW = ToWide(listenAddr);
                         std::wstring localIPW = ToWide(localIP);
@@ -275,8 +275,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                 case ID_TRAY_TOGGLE_LISTEN:
                     // 切换监听地址
                     if (g_configManager) {
-                        std::string currentAddr = g_configManager->getListenAddress();
-                        std::string newAddr = (currentAddr == "0.0.0.0") ? "127.0.0.1" : "0.0.0.0";
+                        std::string newAddr = g_configManager->isListenLoopbackOnly() ? "0.0.0.0" : "127.0.0.1";
                         g_configManager->setListenAddress(newAddr);
                         g_configManager->save();
                         
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * JSON-RPC batch 并发执行单元测试
+ */
+#include "mcp/batch_executor.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+static nlohmann::json Request(int id, const std::string& method) {
+    return {{"jsonrpc", "2.0"}, {"id", id}, {"method", method}};
+}
+
+static nlohmann::json Echo(const nlohmann::json& msg) {
+    if (!msg.contains("id")) return nullptr;  // 通知
+    if (msg["method"] == "throw") throw std::runtime_error("boom");
+    return {{"jsonrpc", "2.0"}, {"id", msg["id"]}, {"result", msg["method"]}};
+}
+
+// 测试 1: 无线程池时顺序执行，响应顺序、通知省略、异常转 -32603
+void test_batch_sequential() {
+    std::cout << "\n[测试 1] 无线程池的 batch..." << std::endl;
+
+    SetMcpBatchPool(nullptr);
+    nlohmann::json batch = nlohmann::json::array({
+        Request(1, "a"),
+        {{"jsonrpc", "2.0"}, {"method", "notifications/initialized"}},
+        Request(2, "throw"),
+        Request(3, "c")
+    });
+    nlohmann::json out = RunJsonRpcBatch(batch, Echo);
+    assert(out.is_array() && out.size() == 3);
+    assert(out[0]["id"] == 1 && out[0]["result"] == "a");
+    assert(out[1]["id"] == 2 && out[1]["error"]["code"] == -32603);
+    assert(out[2]["id"] == 3 && out[2]["result"] == "c");
+    std::cout << "  ✓ 响应按原顺序，通知无响应，异常只影响所在元素" << std::endl;
+
+    nlohmann::json notifications = nlohmann::json::array({
+        {{"jsonrpc", "2.0"}, {"method", "x"}},
+        {{"jsonrpc", "2.0"}, {"method", "y"}}
+    });
+    assert(RunJsonRpcBatch(notifications, Echo).empty());
+    std::cout << "  ✓ 全部是通知时返回空数组" << std::endl;
+    std::cout << "[通过] 无线程池的 batch" << std::endl;
+}
+
+// 测试 2: 有线程池时各元素并发执行
+void test_batch_parallel() {
+    std::cout << "\n[测试 2] 并发执行..." << std::endl;
+
+    WorkerPool pool(3, 16, "test-batch");
+    SetMcpBatchPool(&pool);
+
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    nlohmann::json batch = nlohmann::json::array();
+    for (int i = 0; i < 8; ++i) batch.push_back(Request(i, "slow"));
+
+    auto start = std::chrono::steady_clock::now();
+    nlohmann::json out = RunJsonRpcBatch(batch, [&](const nlohmann::json& msg) -> nlohmann::json {
+        int now = running.fetch_add(1) + 1;
+        int prev = maxRunning.load();
+        while (now > prev && !maxRunning.compare_exchange_weak(prev, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        running.fetch_sub(1);
+        return {{"jsonrpc", "2.0"}, {"id", msg["id"]}, {"result", true}};
+    });
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    assert(out.size() == 8);
+    for (int i = 0; i < 8; ++i) assert(out[i]["id"] == i);
+    assert(maxRunning.load() > 1 && maxRunning.load() <= 4);  // 调用线程 + 3 个池线程
+    assert(elapsedMs < 8 * 50);
+    std::cout << "  ✓ 最大并发: " << maxRunning.load() << "，耗时 " << elapsedMs << "ms" << std::endl;
+
+    SetMcpBatchPool(nullptr);
+    pool.shutdown();
+    std::cout << "[通过] 并发执行" << std::endl;
+}
+
+// 测试 3: 线程池被占满时由调用线程完成全部任务
+void test_batch_pool_busy() {
+    std::cout << "\n[测试 3] 线程池被占满..." << std::endl;
+
+    WorkerPool pool(1, 1, "test-batch");
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    assert(pool.submit([&]() {
+        started.store(true);
+        while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }));
+    while (!started.load()) std::this_thread::yield();
+    assert(pool.submit([]() {}));  // 队列也占满
+    SetMcpBatchPool(&pool);
+
+    std::atomic<int> ran{0};
+    std::vector<std::function<void()>> tasks;
+    for (int i = 0; i < 5; ++i) tasks.push_back([&ran]() { ran.fetch_add(1); });
+    RunMcpBatchTasks(std::move(tasks));
+    assert(ran.load() == 5);
+    std::cout << "  ✓ 不等待线程池，全部任务在调用线程完成" << std::endl;
+
+    SetMcpBatchPool(nullptr);
+    release.store(true);
+    pool.shutdown();
+    std::cout << "[通过] 线程池被占满" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[BatchExecutor] 开始测试..." << std::endl;
+    test_batch_sequential();
+    test_batch_parallel();
+    test_batch_pool_busy();
+    std::cout << "\n[通过] BatchExecutor 全部测试" << std::endl;
+    return 0;
+}
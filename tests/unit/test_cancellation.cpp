@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * CancellationToken 单元测试
+ */
+#include "support/cancellation.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+static long long ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void testDefaultToken() {
+    std::cout << "\n[测试 1] 默认令牌永不取消..." << std::endl;
+    CancellationToken token;
+    token.cancel();
+    assert(!token.cancelled());
+    bool called = false;
+    CancellationRegistration reg = token.onCancel([&called]() { called = true; });
+    assert(!called);
+    auto start = std::chrono::steady_clock::now();
+    assert(!token.waitFor(20));
+    assert(ElapsedMs(start) >= 20);
+    std::cout << "  ✓ cancel 无效，waitFor 睡满" << std::endl;
+}
+
+static void testCancelSharedState() {
+    std::cout << "\n[测试 2] 副本共享取消状态，waitFor 提前返回..." << std::endl;
+    CancellationToken token = CancellationToken::Create();
+    CancellationToken copy = token;
+    assert(!copy.cancelled());
+
+    std::thread canceller([token]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        token.cancel();
+    });
+    auto start = std::chrono::steady_clock::now();
+    assert(copy.waitFor(5000));
+    assert(ElapsedMs(start) < 2000);
+    canceller.join();
+    assert(copy.cancelled());
+    copy.cancel();  // 幂等
+    std::cout << "  ✓ 取消后立即唤醒" << std::endl;
+}
+
+static void testProbe() {
+    std::cout << "\n[测试 3] probe 为真时视为取消并触发回调..." << std::endl;
+    std::atomic_bool closed{false};
+    CancellationToken token = CancellationToken::Create([&closed]() { return closed.load(); });
+    int calls = 0;
+    CancellationRegistration reg = token.onCancel([&calls]() { ++calls; });
+    assert(!token.cancelled() && calls == 0);
+
+    std::thread closer([&closed]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        closed.store(true);
+    });
+    auto start = std::chrono::steady_clock::now();
+    assert(token.waitFor(5000));
+    assert(ElapsedMs(start) < 2000);
+    closer.join();
+    assert(calls == 1);
+    assert(token.cancelled() && calls == 1);
+    std::cout << "  ✓ 分段检查 probe，回调只执行一次" << std::endl;
+}
+
+static void testCallbacks() {
+    std::cout << "\n[测试 4] 回调注册、注销与已取消时立即执行..." << std::endl;
+    CancellationToken token = CancellationToken::Create();
+    int a = 0, b = 0, c = 0;
+    CancellationRegistration regA = token.onCancel([&a]() { ++a; });
+    CancellationRegistration regB = token.onCancel([&b]() { ++b; });
+    regB.reset();
+    {
+        CancellationRegistration moved = token.onCancel([&c]() { ++c; });
+        CancellationRegistration target = std::move(moved);
+    }  // 析构即注销
+    token.cancel();
+    token.cancel();
+    assert(a == 1 && b == 0 && c == 0);
+
+    int late = 0;
+    CancellationRegistration regLate = token.onCancel([&late]() { ++late; });
+    assert(late == 1);
+    std::cout << "  ✓ 只执行仍注册的回调" << std::endl;
+}
+
+static void testRegistrationWaitsForCallback() {
+    std::cout << "\n[测试 5] 注销时等待正在执行的回调..." << std::endl;
+    CancellationToken token = CancellationToken::Create();
+    std::atomic_bool inCallback{false};
+    std::atomic_bool finished{false};
+    CancellationRegistration reg = token.onCancel([&inCallback, &finished]() {
+        inCallback.store(true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        finished.store(true);
+    });
+    std::thread canceller([token]() { token.cancel(); });
+    while (!inCallback.load()) std::this_thread::yield();
+    reg.reset();
+    assert(finished.load());
+    canceller.join();
+    std::cout << "  ✓ reset 返回时回调已结束" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[Cancellation] 开始测试..." << std::endl;
+
+    testDefaultToken();
+    testCancelSharedState();
+    testProbe();
+    testCallbacks();
+    testRegistrationWaitsForCallback();
+
+    std::cout << "\n[通过] Cancellation 测试全部通过" << std::endl;
+    return 0;
+}
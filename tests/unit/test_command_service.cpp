@@ -25,9 +25,11 @@
 #include "policy/policy_guard.h"
 #include <nlohmann/json.hpp>
 #include <cassert>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <thread>
 
 namespace fs = std::filesystem;
 
@@ -39,7 +41,7 @@ static void writeConfig(const std::string& path) {
     cfg["listen_address"] = "127.0.0.1";
     cfg["allowed_dirs"] = nlohmann::json::array();
     cfg["allowed_apps"] = nlohmann::json::object();
-    cfg["allowed_commands"] = nlohmann::json::array({"echo"});
+    cfg["allowed_commands"] = nlohmann::json::array({"echo", "ping"});
     cfg["license_key"] = "";
     std::ofstream out(path, std::ios::trunc);
     out << cfg.dump(2);
@@ -65,6 +67,32 @@ int main() {
     assert(result.stdoutText.find("hello") != std::string::npos);
     std::cout << "  ✓ executeCommand" << std::endl;
 
+    // 已取消：不等待超时，结束进程树并标记 cancelled
+    CancellationToken cancel = CancellationToken::Create();
+    cancel.cancel();
+    auto start = std::chrono::steady_clock::now();
+    auto cancelled = service.executeCommand("ping -n 20 127.0.0.1", {}, 30000, cancel);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    assert(cancelled.cancelled && !cancelled.timedOut);
+    assert(elapsed < std::chrono::seconds(5));
+    assert(!result.cancelled);
+    std::cout << "  ✓ executeCommand 取消" << std::endl;
+
+    // 正常结束：命令在后台启动的进程不随 Job 关闭而被结束
+    const std::string markerPath = "test_command_service_detached.txt";
+    fs::remove(markerPath);
+    auto detached = service.executeCommand(
+        "start \"\" /b cmd /c \"ping -n 3 127.0.0.1 >nul & echo done>" + markerPath + "\"", {}, 30000);
+    assert(!detached.timedOut && !detached.cancelled);
+    bool survived = false;
+    for (int i = 0; i < 100 && !survived; ++i) {
+        survived = fs::exists(markerPath);
+        if (!survived) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    assert(survived);
+    fs::remove(markerPath);
+    std::cout << "  ✓ executeCommand 后台进程保留" << std::endl;
+
     fs::remove(configPath);
     fs::remove(usagePath);
 
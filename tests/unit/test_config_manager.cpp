@@ -22,10 +22,11 @@
  * 测试覆盖：
  * - 默认配置生成
  * - 配置文件加载和保存
- * - Auth Token 生成和验证
+ * - 开源版忽略安全字段（auth_token、license_key、白名单）
  * - 配置项访问和修改
  * - 线程安全性
  * - 配置验证
+ * - server.* 配置的默认值和取值范围
  */
 
 #include "support/config_manager.h"
@@ -59,11 +60,9 @@ void test_default_config_generation() {
     assert(fileExists(testFile));
     std::cout << "  ✓ 配置文件已创建" << std::endl;
     
-    // 验证 Auth Token 已生成
-    std::string token = cm.getAuthToken();
-    assert(!token.empty());
-    assert(token.length() >= 32);
-    std::cout << "  ✓ Auth Token 已生成 (长度: " << token.length() << ")" << std::endl;
+    // 开源版不使用 Auth Token
+    assert(cm.getAuthToken().empty());
+    std::cout << "  ✓ Auth Token: 未使用" << std::endl;
     
     // 验证默认端口
     assert(cm.getServerPort() == 35182);
@@ -73,18 +72,11 @@ void test_default_config_generation() {
     assert(cm.isAutoPortEnabled() == true);
     std::cout << "  ✓ 自动端口: 启用" << std::endl;
     
-    // 验证默认白名单
-    auto dirs = cm.getAllowedDirs();
-    assert(!dirs.empty());
-    std::cout << "  ✓ 默认目录白名单: " << dirs.size() << " 个" << std::endl;
-    
-    auto apps = cm.getAllowedApps();
-    assert(!apps.empty());
-    std::cout << "  ✓ 默认应用白名单: " << apps.size() << " 个" << std::endl;
-    
-    auto cmds = cm.getAllowedCommands();
-    assert(!cmds.empty());
-    std::cout << "  ✓ 默认命令白名单: " << cmds.size() << " 个" << std::endl;
+    // 开源版没有白名单
+    assert(cm.getAllowedDirs().empty());
+    assert(cm.getAllowedApps().empty());
+    assert(cm.getAllowedCommands().empty());
+    std::cout << "  ✓ 白名单: 未使用" << std::endl;
     
     // 验证许可证为空
     assert(cm.getLicenseKey().empty());
@@ -104,8 +96,8 @@ void test_config_load_save() {
     // 创建并保存配置
     ConfigManager cm1(testFile);
     cm1.load();
-    std::string originalToken = cm1.getAuthToken();
-    cm1.setLicenseKey("test-license-key-12345");
+    cm1.setLanguage("zh");
+    cm1.setApiKey("test-api-key-12345");
     cm1.save();
     
     std::cout << "  ✓ 配置已保存" << std::endl;
@@ -115,11 +107,11 @@ void test_config_load_save() {
     cm2.load();
     
     // 验证配置一致性
-    assert(cm2.getAuthToken() == originalToken);
-    std::cout << "  ✓ Auth Token 一致" << std::endl;
+    assert(cm2.getLanguage() == "zh");
+    std::cout << "  ✓ Language 一致" << std::endl;
     
-    assert(cm2.getLicenseKey() == "test-license-key-12345");
-    std::cout << "  ✓ License Key 一致" << std::endl;
+    assert(cm2.getApiKey() == "test-api-key-12345");
+    std::cout << "  ✓ API Key 一致" << std::endl;
     
     assert(cm2.getServerPort() == cm1.getServerPort());
     std::cout << "  ✓ Server Port 一致" << std::endl;
@@ -128,9 +120,9 @@ void test_config_load_save() {
     std::cout << "[通过] 配置加载和保存测试" << std::endl;
 }
 
-// 测试 3: Auth Token 自动重新生成
-void test_auth_token_regeneration() {
-    std::cout << "\n[测试 3] Auth Token 自动重新生成..." << std::endl;
+// 测试 3: 旧配置中的安全字段被忽略
+void test_security_fields_ignored() {
+    std::cout << "\n[测试 3] 旧配置中的安全字段被忽略..." << std::endl;
     
     const std::string testFile = "test_config_3.json";
     deleteTestFile(testFile);
@@ -142,26 +134,29 @@ void test_auth_token_regeneration() {
             "auth_token": "short",
             "server_port": 35182,
             "auto_port": true,
-            "allowed_dirs": [],
-            "allowed_apps": {},
-            "allowed_commands": [],
-            "license_key": ""
+            "allowed_dirs": ["C:\\\\"],
+            "allowed_apps": {"notepad": "notepad.exe"},
+            "allowed_commands": ["dir"],
+            "license_key": "old-license-key"
         })" << std::endl;
     }
     
-    std::cout << "  ✓ 创建了无效 Token 的配置文件" << std::endl;
+    std::cout << "  ✓ 创建了带安全字段的旧配置文件" << std::endl;
     
-    // 加载配置，应该自动重新生成 Token
+    // 加载配置：安全字段不报错，也不生效
     ConfigManager cm(testFile);
     cm.load();
     
-    std::string newToken = cm.getAuthToken();
-    assert(newToken != "short");
-    assert(newToken.length() >= 32);
-    std::cout << "  ✓ Token 已自动重新生成 (长度: " << newToken.length() << ")" << std::endl;
+    assert(cm.getAuthToken().empty());
+    assert(cm.getLicenseKey().empty());
+    assert(cm.getAllowedDirs().empty());
+    assert(cm.getAllowedApps().empty());
+    assert(cm.getAllowedCommands().empty());
+    assert(cm.getServerPort() == 35182);
+    std::cout << "  ✓ 安全字段已忽略" << std::endl;
     
     deleteTestFile(testFile);
-    std::cout << "[通过] Auth Token 重新生成测试" << std::endl;
+    std::cout << "[通过] 安全字段忽略测试" << std::endl;
 }
 
 // 测试 4: 配置项修改
@@ -174,10 +169,10 @@ void test_config_modification() {
     ConfigManager cm(testFile);
     cm.load();
     
-    // 修改许可证
-    cm.setLicenseKey("new-license-key");
-    assert(cm.getLicenseKey() == "new-license-key");
-    std::cout << "  ✓ License Key 修改成功" << std::endl;
+    // 修改语言
+    cm.setLanguage("zh");
+    assert(cm.getLanguage() == "zh");
+    std::cout << "  ✓ Language 修改成功" << std::endl;
     
     // 修改端口
     cm.setActualPort(12345);
@@ -189,7 +184,7 @@ void test_config_modification() {
     ConfigManager cm2(testFile);
     cm2.load();
     
-    assert(cm2.getLicenseKey() == "new-license-key");
+    assert(cm2.getLanguage() == "zh");
     assert(cm2.getServerPort() == 12345);
     std::cout << "  ✓ 修改已持久化" << std::endl;
     
@@ -219,13 +214,18 @@ void test_thread_safety() {
                 std::string token = cm.getAuthToken();
                 int port = cm.getServerPort();
                 bool autoPort = cm.isAutoPortEnabled();
+                (void)port;
+                (void)autoPort;
                 auto dirs = cm.getAllowedDirs();
                 auto apps = cm.getAllowedApps();
                 auto cmds = cm.getAllowedCommands();
                 std::string license = cm.getLicenseKey();
                 
+                int workers = cm.getHttpWorkerThreads();
+                (void)workers;
+                
                 // 写入操作
-                cm.setLicenseKey("thread-test-" + std::to_string(j));
+                cm.setApiKey("thread-test-" + std::to_string(j));
             }
         });
     }
@@ -275,6 +275,163 @@ void test_config_validation() {
     std::cout << "[通过] 配置验证测试" << std::endl;
 }
 
+// 写入只含 server 段的配置文件
+static void writeServerConfig(const std::string& path, const std::string& serverJson) {
+    std::ofstream file(path, std::ios::trunc);
+    file << "{\"server\": " << serverJson << "}" << std::endl;
+}
+
+// 测试 7: server.* 默认值
+void test_server_defaults() {
+    std::cout << "\n[测试 7] server.* 默认值..." << std::endl;
+    
+    const std::string testFile = "test_config_7.json";
+    writeServerConfig(testFile, "{}");
+    
+    ConfigManager cm(testFile);
+    cm.load();
+    
+    int workers = cm.getHttpWorkerThreads();
+    assert(workers >= 4 && workers <= 16);
+    assert(cm.getHttpQueueCapacity() == 128);
+    assert(cm.getHttpKeepAliveTimeoutSeconds() == 15);
+    assert(cm.getHttpKeepAliveMaxRequests() == 100);
+    assert(cm.getHttpRateLimitPerMinute() == 120);
+    std::cout << "  ✓ worker / keep-alive / 限流" << std::endl;
+    
+    assert(cm.getHttpQueueTimeoutMs() == 5000);
+    assert(cm.getHttpFastLaneWorkers() == 1);
+    assert(cm.getHttpHeaderTimeoutMs() == 10000);
+    assert(cm.getHttpBodyTimeoutMs() == 30000);
+    assert(cm.getHttpMinBodyRate() == 1024);
+    assert(cm.getHttpAcceptShards() == 1);
+    assert(cm.getHttpDrainTimeoutMs() == 5000);
+    std::cout << "  ✓ 排队 / 超时 / accept / drain" << std::endl;
+    
+    assert(cm.isHttpCompressionEnabled());
+    assert(cm.getHttpCompressionMinBytes() == 1024);
+    assert(cm.getHttpCompressionLevel() == 6);
+    assert(cm.getHttpTlsPort() == 0);
+    assert(cm.getHttpTlsCertFile().empty());
+    assert(cm.getHttpTlsKeyFile().empty());
+    assert(cm.getHttpTlsSessionTimeoutSeconds() == 3600);
+    std::cout << "  ✓ 压缩 / TLS" << std::endl;
+    
+    assert(cm.getHttpBatchWorkers() == 4);
+    assert(cm.getHttpToolWorkers() == 4);
+    assert(cm.getMcpMaxSessions() == 1024);
+    assert(cm.getMcpSessionIdleTimeoutSeconds() == 1800);
+    assert(cm.getMcpSessionTtlSeconds() == 86400);
+    assert(cm.getSseMaxSessions() == 256);
+    assert(cm.getSseSessionTtlSeconds() == 3600);
+    std::cout << "  ✓ 批处理 / 工具 / MCP session / SSE session" << std::endl;
+    
+    deleteTestFile(testFile);
+    std::cout << "[通过] server.* 默认值测试" << std::endl;
+}
+
+// 测试 8: server.* 取值范围
+void test_server_clamping() {
+    std::cout << "\n[测试 8] server.* 取值范围..." << std::endl;
+    
+    const std::string testFile = "test_config_8.json";
+    
+    // 过小或无效的值
+    writeServerConfig(testFile, R"({
+        "worker_threads": 0, "queue_capacity": 0, "keep_alive_timeout_seconds": -1,
+        "keep_alive_max_requests": 0, "rate_limit_per_minute": 0, "queue_timeout_ms": 10,
+        "fast_lane_workers": -1,
+        "header_timeout_ms": 10, "body_timeout_ms": 10, "min_body_rate": -5,
+        "accept_shards": 0, "compression_min_bytes": -1, "compression_level": 0,
+        "tls_port": -1, "tls_session_timeout_seconds": 1, "drain_timeout_ms": -1,
+        "batch_workers": -1, "tool_workers": -1, "mcp_max_sessions": 1,
+        "mcp_session_idle_timeout_seconds": 1, "mcp_session_ttl_seconds": -1,
+        "sse_max_sessions": 0, "sse_session_ttl_seconds": 1
+    })");
+    {
+        ConfigManager cm(testFile);
+        cm.load();
+        assert(cm.getHttpWorkerThreads() >= 4);
+        assert(cm.getHttpQueueCapacity() == 128);
+        assert(cm.getHttpKeepAliveTimeoutSeconds() == 15);
+        assert(cm.getHttpKeepAliveMaxRequests() == 100);
+        assert(cm.getHttpRateLimitPerMinute() == 120);
+        assert(cm.getHttpQueueTimeoutMs() == 100);
+        assert(cm.getHttpFastLaneWorkers() == 1);
+        assert(cm.getHttpHeaderTimeoutMs() == 1000);
+        assert(cm.getHttpBodyTimeoutMs() == 1000);
+        assert(cm.getHttpMinBodyRate() == 0);
+        assert(cm.getHttpAcceptShards() == 1);
+        assert(cm.getHttpCompressionMinBytes() == 0);
+        assert(cm.getHttpCompressionLevel() == 1);
+        assert(cm.getHttpTlsPort() == 0);
+        assert(cm.getHttpTlsSessionTimeoutSeconds() == 60);
+        assert(cm.getHttpDrainTimeoutMs() == 5000);
+        assert(cm.getHttpBatchWorkers() == 0);
+        assert(cm.getHttpToolWorkers() == 0);
+        assert(cm.getMcpMaxSessions() == 16);
+        assert(cm.getMcpSessionIdleTimeoutSeconds() == 60);
+        assert(cm.getMcpSessionTtlSeconds() == 0);
+        assert(cm.getSseMaxSessions() == 1);
+        assert(cm.getSseSessionTtlSeconds() == 60);
+    }
+    std::cout << "  ✓ 下限" << std::endl;
+    
+    // 过大的值
+    writeServerConfig(testFile, R"({
+        "worker_threads": 1000, "fast_lane_workers": 100, "accept_shards": 100, "rate_limit_per_minute": 10000000,
+        "compression_level": 42, "tls_port": 70000, "tls_session_timeout_seconds": 1000000,
+        "drain_timeout_ms": 1000000, "batch_workers": 1000, "tool_workers": 1000,
+        "mcp_max_sessions": 10000000, "mcp_session_idle_timeout_seconds": 10000000,
+        "mcp_session_ttl_seconds": 100000000, "sse_max_sessions": 1000000,
+        "sse_session_ttl_seconds": 1000000
+    })");
+    {
+        ConfigManager cm(testFile);
+        cm.load();
+        assert(cm.getHttpWorkerThreads() == 64);
+        assert(cm.getHttpRateLimitPerMinute() == 1000000);
+        assert(cm.getHttpFastLaneWorkers() == 4);
+        assert(cm.getHttpAcceptShards() == 16);
+        assert(cm.getHttpCompressionLevel() == 9);
+        assert(cm.getHttpTlsPort() == 0);
+        assert(cm.getHttpTlsSessionTimeoutSeconds() == 86400);
+        assert(cm.getHttpDrainTimeoutMs() == 60000);
+        assert(cm.getHttpBatchWorkers() == 32);
+        assert(cm.getHttpToolWorkers() == 64);
+        assert(cm.getMcpMaxSessions() == 100000);
+        assert(cm.getMcpSessionIdleTimeoutSeconds() == 604800);
+        assert(cm.getMcpSessionTtlSeconds() == 2592000);
+        assert(cm.getSseMaxSessions() == 10000);
+        assert(cm.getSseSessionTtlSeconds() == 86400);
+    }
+    std::cout << "  ✓ 上限" << std::endl;
+    
+    // 范围内的值原样返回；TLS 证书的相对路径按配置文件所在目录解析
+    writeServerConfig(testFile, R"({
+        "worker_threads": 8, "queue_timeout_ms": 250, "fast_lane_workers": 0,
+        "min_body_rate": 0, "drain_timeout_ms": 0, "mcp_session_ttl_seconds": 600,
+        "tls_port": 8443, "tls_cert_file": "certs/server.crt", "tls_key_file": "/etc/server.key"
+    })");
+    {
+        ConfigManager cm(testFile);
+        cm.load();
+        assert(cm.getHttpWorkerThreads() == 8);
+        assert(cm.getHttpQueueTimeoutMs() == 250);
+        assert(cm.getHttpFastLaneWorkers() == 0);
+        assert(cm.getHttpMinBodyRate() == 0);
+        assert(cm.getHttpDrainTimeoutMs() == 0);
+        assert(cm.getMcpSessionTtlSeconds() == 600);
+        assert(cm.getHttpTlsPort() == 8443);
+        assert(cm.getHttpTlsCertFile() == "certs/server.crt");
+        assert(cm.getHttpTlsKeyFile() == "/etc/server.key");
+    }
+    std::cout << "  ✓ 范围内的值" << std::endl;
+    
+    deleteTestFile(testFile);
+    std::cout << "[通过] server.* 取值范围测试" << std::endl;
+}
+
 // 主测试函数
 int main() {
     std::cout << "========================================" << std::endl;
@@ -284,10 +441,12 @@ int main() {
     try {
         test_default_config_generation();
         test_config_load_save();
-        test_auth_token_regeneration();
+        test_security_fields_ignored();
         test_config_modification();
         test_thread_safety();
         test_config_validation();
+        test_server_defaults();
+        test_server_clamping();
         
         std::cout << "\n========================================" << std::endl;
         std::cout << "所有测试通过! ✓" << std::endl;
@@ -0,0 +1,455 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * DEFLATE 压缩与 Content-Encoding 协商单元测试
+ */
+#include "http/content_encoding.h"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+// 最小的 DEFLATE 解码器（按 RFC 1951 逐位解码），只用于校验压缩结果
+class Inflater {
+public:
+    Inflater(const std::string& data, size_t begin, size_t end) : data_(data), pos_(begin), end_(end) {}
+
+    std::string run() {
+        int last;
+        do {
+            last = bits(1);
+            int type = bits(2);
+            if (type == 0) {
+                stored();
+            } else if (type == 1) {
+                fixed();
+            } else {
+                assert(type == 2);
+                dynamic();
+            }
+        } while (!last);
+        return out_;
+    }
+
+    size_t position() const { return pos_; }
+
+private:
+    struct Huffman {
+        short count[16];
+        short symbol[288];
+    };
+
+    int bits(int need) {
+        while (bitCount_ < need) {
+            assert(pos_ < end_);
+            bitBuffer_ |= static_cast<uint32_t>(static_cast<uint8_t>(data_[pos_++])) << bitCount_;
+            bitCount_ += 8;
+        }
+        int value = static_cast<int>(bitBuffer_ & ((1u << need) - 1));
+        bitBuffer_ >>= need;
+        bitCount_ -= need;
+        return value;
+    }
+
+    static void build(Huffman& h, const short* lengths, int n) {
+        std::memset(h.count, 0, sizeof(h.count));
+        for (int i = 0; i < n; ++i) h.count[lengths[i]]++;
+        short offs[16] = {};
+        for (int len = 1; len < 15; ++len) offs[len + 1] = static_cast<short>(offs[len] + h.count[len]);
+        for (int i = 0; i < n; ++i) {
+            if (lengths[i]) h.symbol[offs[lengths[i]]++] = static_cast<short>(i);
+        }
+    }
+
+    int decode(const Huffman& h) {
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len <= 15; ++len) {
+            code |= bits(1);
+            int count = h.count[len];
+            if (code - count < first) return h.symbol[index + (code - first)];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        assert(false && "invalid Huffman code");
+        return -1;
+    }
+
+    void stored() {
+        bitBuffer_ = 0;
+        bitCount_ = 0;
+        assert(pos_ + 4 <= end_);
+        unsigned len = static_cast<uint8_t>(data_[pos_]) | (static_cast<uint8_t>(data_[pos_ + 1]) << 8);
+        unsigned nlen = static_cast<uint8_t>(data_[pos_ + 2]) | (static_cast<uint8_t>(data_[pos_ + 3]) << 8);
+        assert(len == (~nlen & 0xFFFF));
+        pos_ += 4;
+        assert(pos_ + len <= end_);
+        out_.append(data_, pos_, len);
+        pos_ += len;
+    }
+
+    void codes(const Huffman& lencode, const Huffman& distcode) {
+        static const short lbase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const short lext[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                       3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const int dbase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+                                      193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+                                      6145, 8193, 12289, 16385, 24577};
+        static const short dext[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                       6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        for (;;) {
+            int symbol = decode(lencode);
+            if (symbol < 256) {
+                out_.push_back(static_cast<char>(symbol));
+            } else if (symbol == 256) {
+                return;
+            } else {
+                symbol -= 257;
+                assert(symbol < 29);
+                int len = lbase[symbol] + bits(lext[symbol]);
+                int d = decode(distcode);
+                assert(d < 30);
+                size_t dist = static_cast<size_t>(dbase[d] + bits(dext[d]));
+                assert(dist <= out_.size());
+                for (int i = 0; i < len; ++i) out_.push_back(out_[out_.size() - dist]);
+            }
+        }
+    }
+
+    void fixed() {
+        short lengths[288];
+        for (int i = 0; i < 288; ++i) lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+        Huffman lencode, distcode;
+        build(lencode, lengths, 288);
+        for (int i = 0; i < 30; ++i) lengths[i] = 5;
+        build(distcode, lengths, 30);
+        codes(lencode, distcode);
+    }
+
+    void dynamic() {
+        static const short order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        int nlen = bits(5) + 257;
+        int ndist = bits(5) + 1;
+        int ncode = bits(4) + 4;
+        short lengths[320] = {};
+        for (int i = 0; i < ncode; ++i) lengths[order[i]] = static_cast<short>(bits(3));
+        Huffman lencode, distcode;
+        build(lencode, lengths, 19);
+
+        int index = 0;
+        while (index < nlen + ndist) {
+            int symbol = decode(lencode);
+            if (symbol < 16) {
+                lengths[index++] = static_cast<short>(symbol);
+                continue;
+            }
+            short len = 0;
+            int repeat;
+            if (symbol == 16) {
+                assert(index > 0);
+                len = lengths[index - 1];
+                repeat = 3 + bits(2);
+            } else if (symbol == 17) {
+                repeat = 3 + bits(3);
+            } else {
+                repeat = 11 + bits(7);
+            }
+            assert(index + repeat <= nlen + ndist);
+            while (repeat--) lengths[index++] = len;
+        }
+        assert(lengths[256] > 0);
+        build(lencode, lengths, nlen);
+        build(distcode, lengths + nlen, ndist);
+        codes(lencode, distcode);
+    }
+
+    const std::string& data_;
+    size_t pos_;
+    size_t end_;
+    uint32_t bitBuffer_ = 0;
+    int bitCount_ = 0;
+    std::string out_;
+};
+
+static uint32_t ReadLE32(const std::string& s, size_t pos) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | static_cast<uint8_t>(s[pos + i]);
+    return v;
+}
+
+static std::string Gunzip(const std::string& gz) {
+    assert(gz.size() >= 18);
+    assert(static_cast<uint8_t>(gz[0]) == 0x1F && static_cast<uint8_t>(gz[1]) == 0x8B && gz[2] == 8);
+    Inflater inflater(gz, 10, gz.size() - 8);
+    std::string out = inflater.run();
+    assert(inflater.position() == gz.size() - 8);
+    assert(ReadLE32(gz, gz.size() - 8) == Crc32(0, out.data(), out.size()));
+    assert(ReadLE32(gz, gz.size() - 4) == static_cast<uint32_t>(out.size()));
+    return out;
+}
+
+static std::string ZlibInflate(const std::string& z) {
+    assert(z.size() >= 6);
+    assert(((static_cast<uint8_t>(z[0]) << 8) | static_cast<uint8_t>(z[1])) % 31 == 0);
+    Inflater inflater(z, 2, z.size() - 4);
+    std::string out = inflater.run();
+    uint32_t adler = 0;
+    for (size_t i = z.size() - 4; i < z.size(); ++i) adler = (adler << 8) | static_cast<uint8_t>(z[i]);
+    assert(adler == Adler32(1, out.data(), out.size()));
+    return out;
+}
+
+static std::string SampleJson(int items) {
+    std::string json = "[";
+    for (int i = 0; i < items; ++i) {
+        if (i) json += ",";
+        json += "{\"pid\":" + std::to_string(1000 + i * 7) + ",\"name\":\"process_" + std::to_string(i % 50) +
+                ".exe\",\"memory_kb\":" + std::to_string(4096 + i * 13) + ",\"title\":\"Window title " +
+                std::to_string(i) + "\"}";
+    }
+    return json + "]";
+}
+
+// 测试 1: 校验和与压缩往返
+void test_deflate_roundtrip() {
+    std::cout << "\n[测试 1] DEFLATE 压缩往返..." << std::endl;
+
+    assert(Crc32(0, "123456789", 9) == 0xCBF43926u);
+    assert(Adler32(1, "Wikipedia", 9) == 0x11E60398u);
+    std::cout << "  ✓ CRC-32 / Adler-32 标准向量" << std::endl;
+
+    std::mt19937 rng(42);
+    std::string random(100000, '\0');
+    for (char& c : random) c = static_cast<char>(rng());
+    std::string letters(200000, '\0');
+    for (char& c : letters) c = "abcdefgh "[rng() % 9];
+
+    const std::string samples[] = {std::string(), "a", "hello hello hello hello", SampleJson(3000),
+                                   std::string(300000, '\0'), random, letters};
+    for (const std::string& data : samples) {
+        for (int level : {1, 6, 9}) {
+            std::string gz = DeflateCompress(data, DeflateEncoder::Format::Gzip, level);
+            assert(Gunzip(gz) == data);
+            std::string z = DeflateCompress(data, DeflateEncoder::Format::Zlib, level);
+            assert(ZlibInflate(z) == data);
+        }
+    }
+    std::string json = SampleJson(3000);
+    std::string gz = DeflateCompress(json, DeflateEncoder::Format::Gzip, 6);
+    assert(gz.size() * 5 < json.size());
+    assert(DeflateCompress(random, DeflateEncoder::Format::Gzip, 6).size() < random.size() + 64);
+    std::cout << "  ✓ gzip / zlib 各级别往返一致，JSON " << json.size() << " -> " << gz.size()
+              << " 字节，随机数据按 stored 块输出" << std::endl;
+    std::cout << "[通过] DEFLATE 压缩往返" << std::endl;
+}
+
+// 测试 2: 分段写入与 sync flush
+void test_stream_flush() {
+    std::cout << "\n[测试 2] 分段压缩与 sync flush..." << std::endl;
+
+    StreamCompressor stream(ContentCoding::Gzip, 6);
+    std::string wire;
+    std::string plain;
+    for (int i = 0; i < 200; ++i) {
+        std::string event = "event: message\ndata: {\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(i) +
+                            ",\"result\":{\"content\":[{\"type\":\"text\",\"text\":\"ok\"}]}}\n\n";
+        plain += event;
+        std::string piece = stream.compress(event);
+        // 每段以 sync flush 结尾：已发送的字节足以解出到目前为止的全部事件
+        assert(piece.size() >= 4 && piece.compare(piece.size() - 4, 4, std::string("\x00\x00\xFF\xFF", 4)) == 0);
+        wire += piece;
+    }
+    wire += stream.finish();
+    assert(Gunzip(wire) == plain);
+    assert(wire.size() * 3 < plain.size());
+    std::cout << "  ✓ 200 个 SSE 事件 " << plain.size() << " -> " << wire.size() << " 字节" << std::endl;
+
+    // 大块数据跨越多个块与窗口平移
+    DeflateEncoder encoder(DeflateEncoder::Format::Zlib, 4);
+    std::string big = SampleJson(20000);
+    std::string out;
+    for (size_t i = 0; i < big.size(); i += 10000) {
+        encoder.write(std::string_view(big).substr(i, 10000), out, (i / 10000) % 7 == 0);
+    }
+    encoder.finish(out);
+    assert(ZlibInflate(out) == big);
+    std::cout << "  ✓ " << big.size() << " 字节分段写入（间隔 flush）往返一致" << std::endl;
+    std::cout << "[通过] 分段压缩与 sync flush" << std::endl;
+}
+
+// 测试 3: Accept-Encoding 协商
+void test_negotiate() {
+    std::cout << "\n[测试 3] Accept-Encoding 协商..." << std::endl;
+
+    assert(NegotiateContentCoding("") == ContentCoding::Identity);
+    assert(NegotiateContentCoding("gzip, deflate, br") == ContentCoding::Gzip);
+    assert(NegotiateContentCoding("deflate") == ContentCoding::Deflate);
+    assert(NegotiateContentCoding("GZIP") == ContentCoding::Gzip);
+    assert(NegotiateContentCoding("gzip;q=0.5, deflate") == ContentCoding::Deflate);
+    assert(NegotiateContentCoding("gzip;q=0, deflate;q=0") == ContentCoding::Identity);
+    assert(NegotiateContentCoding("*") == ContentCoding::Gzip);
+    assert(NegotiateContentCoding("*;q=0.1, gzip;q=0") == ContentCoding::Deflate);
+    assert(NegotiateContentCoding("br, identity") == ContentCoding::Identity);
+    assert(NegotiateContentCoding("gzip;q=abc") == ContentCoding::Identity);
+    std::cout << "  ✓ q 值、通配符、大小写与未知编码" << std::endl;
+
+    assert(IsCompressibleType("application/json"));
+    assert(IsCompressibleType("text/event-stream"));
+    assert(IsCompressibleType("text/plain; charset=utf-8"));
+    assert(IsCompressibleType("application/problem+json"));
+    assert(!IsCompressibleType("image/png"));
+    assert(!IsCompressibleType("application/octet-stream"));
+    assert(!IsCompressibleType(""));
+    std::cout << "  ✓ 可压缩类型识别" << std::endl;
+    std::cout << "[通过] Accept-Encoding 协商" << std::endl;
+}
+
+// 测试 4: 响应压缩与共享 body 缓存
+void test_compress_response() {
+    std::cout << "\n[测试 4] 响应压缩..." << std::endl;
+
+    auto gzipReq = ParseHttpRequest("GET /processes HTTP/1.1\r\nAccept-Encoding: gzip, deflate\r\n\r\n");
+    auto plainReq = ParseHttpRequest("GET /processes HTTP/1.1\r\n\r\n");
+    assert(gzipReq && plainReq);
+    CompressionOptions options;
+    std::string json = SampleJson(500);
+
+    HttpResponse r = MakeJsonResponse(200, json);
+    assert(CompressResponse(*gzipReq, r, options));
+    assert(r.header("content-encoding") == "gzip" && r.header("vary") == "Accept-Encoding");
+    assert(r.contentLength() < json.size() / 4);
+    assert(Gunzip(*r.body()[0].data) == json);
+    assert(r.toString().find("Content-Length: " + std::to_string(r.contentLength()) + "\r\n") != std::string::npos);
+    std::cout << "  ✓ gzip: " << json.size() << " -> " << r.contentLength() << " 字节" << std::endl;
+
+    r = MakeJsonResponse(200, json);
+    assert(!CompressResponse(*plainReq, r, options));
+    assert(r.header("content-encoding").empty() && r.header("vary") == "Accept-Encoding");
+    assert(r.contentLength() == json.size());
+
+    r = MakeJsonResponse(200, "{\"ok\":true}");
+    assert(!CompressResponse(*gzipReq, r, options) && r.header("vary").empty());
+
+    r = HttpResponse(200);
+    r.addHeader("Content-Type", "image/png");
+    r.setBody(json);
+    assert(!CompressResponse(*gzipReq, r, options));
+
+    options.enabled = false;
+    r = MakeJsonResponse(200, json);
+    assert(!CompressResponse(*gzipReq, r, options));
+    options.enabled = true;
+    std::cout << "  ✓ 不接受压缩、低于阈值、不可压缩类型、关闭时保持原样" << std::endl;
+
+    // static 常量响应：同一缓冲区只压缩一次
+    static const HttpResponse cached = MakeJsonResponse(200, json);
+    HttpResponse a = cached;
+    HttpResponse b = cached;
+    assert(CompressResponse(*gzipReq, a, options));
+    assert(CompressResponse(*gzipReq, b, options));
+    assert(a.body()[0].data == b.body()[0].data);
+    assert(Gunzip(*b.body()[0].data) == json);
+    HttpResponse fresh = MakeJsonResponse(200, json);
+    assert(CompressResponse(*gzipReq, fresh, options));
+    assert(fresh.body()[0].data != a.body()[0].data);
+    std::cout << "  ✓ 共享 body 的压缩结果被缓存复用" << std::endl;
+
+    // 流式响应只协商编码并写入 header，body 由连接层逐块压缩
+    HttpResponse stream = MakeJsonStreamResponse([](HttpBodySink&) {});
+    assert(ApplyStreamCoding(*gzipReq, stream, options) == ContentCoding::Gzip);
+    assert(stream.header("content-encoding") == "gzip" && stream.header("vary") == "Accept-Encoding");
+    stream = MakeJsonStreamResponse([](HttpBodySink&) {});
+    assert(ApplyStreamCoding(*plainReq, stream, options) == ContentCoding::Identity);
+    assert(stream.header("content-encoding").empty());
+    assert(ApplyStreamCoding(*gzipReq, fresh, options) == ContentCoding::Identity);
+    std::cout << "  ✓ 流式响应的编码协商" << std::endl;
+    std::cout << "[通过] 响应压缩" << std::endl;
+}
+
+// 测试 5: 压缩后的表示使用带编码后缀的 ETag
+void test_encoded_etag() {
+    std::cout << "\n[测试 5] 编码后的 ETag..." << std::endl;
+
+    assert(EncodedETag("\"abc\"", ContentCoding::Gzip) == "\"abc-gzip\"");
+    assert(EncodedETag("\"abc\"", ContentCoding::Deflate) == "\"abc-deflate\"");
+    assert(EncodedETag("\"abc\"", ContentCoding::Identity) == "\"abc\"");
+    assert(EncodedETag("W/\"abc\"", ContentCoding::Gzip) == "W/\"abc\"");
+    std::cout << "  ✓ 强 ETag 加编码后缀，弱 ETag 与 Identity 不变" << std::endl;
+
+    auto gzipReq = ParseHttpRequest("GET /mcp/tools/list HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n");
+    auto deflateReq = ParseHttpRequest("GET /mcp/tools/list HTTP/1.1\r\nAccept-Encoding: deflate\r\n\r\n");
+    auto plainReq = ParseHttpRequest("GET /mcp/tools/list HTTP/1.1\r\n\r\n");
+    assert(gzipReq && deflateReq && plainReq);
+    CompressionOptions options;
+    std::string json = SampleJson(500);
+
+    HttpResponse r = MakeJsonResponse(200, json);
+    r.addHeader("ETag", "\"abc\"");
+    assert(CompressResponse(*gzipReq, r, options));
+    assert(r.header("etag") == "\"abc-gzip\"" && r.header("vary") == "Accept-Encoding");
+
+    r = MakeJsonResponse(200, json);
+    r.addHeader("ETag", "\"abc\"");
+    assert(CompressResponse(*deflateReq, r, options));
+    assert(r.header("etag") == "\"abc-deflate\"");
+
+    r = MakeJsonResponse(200, json);
+    r.addHeader("ETag", "\"abc\"");
+    assert(!CompressResponse(*plainReq, r, options));
+    assert(r.header("etag") == "\"abc\"");
+
+    r = MakeJsonResponse(200, json);
+    r.addHeader("ETag", "W/\"abc\"");
+    assert(CompressResponse(*gzipReq, r, options));
+    assert(r.header("etag") == "W/\"abc\"");
+    std::cout << "  ✓ gzip/deflate/未压缩响应的 ETag 互不相同" << std::endl;
+
+    // 共享 body 走压缩缓存时同样改写，原响应不受影响
+    static const HttpResponse shared = [&] {
+        HttpResponse base = MakeJsonResponse(200, json);
+        base.addHeader("ETag", "\"shared\"");
+        return base;
+    }();
+    HttpResponse a = shared;
+    HttpResponse b = shared;
+    assert(CompressResponse(*gzipReq, a, options));
+    assert(CompressResponse(*gzipReq, b, options));
+    assert(a.body()[0].data == b.body()[0].data);
+    assert(b.header("etag") == "\"shared-gzip\"");
+    assert(shared.header("etag") == "\"shared\"");
+
+    HttpResponse stream = MakeJsonStreamResponse([](HttpBodySink&) {});
+    stream.addHeader("ETag", "\"abc\"");
+    assert(ApplyStreamCoding(*gzipReq, stream, options) == ContentCoding::Gzip);
+    assert(stream.header("etag") == "\"abc-gzip\"");
+    std::cout << "  ✓ 缓存命中与流式响应同样改写 ETag" << std::endl;
+    std::cout << "[通过] 编码后的 ETag" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[ContentEncoding] 开始测试..." << std::endl;
+    test_deflate_roundtrip();
+    test_stream_flush();
+    test_negotiate();
+    test_compress_response();
+    test_encoded_etag();
+    std::cout << "\n[通过] ContentEncoding 全部测试" << std::endl;
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * McpEventLog 单元测试（事件 ID、Last-Event-ID 续传、重放缓冲上限）
+ */
+#include "mcp/event_log.h"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+void AppendHttpServerLogA(const std::string&) {}
+
+// 记录写入的帧
+class RecordingWriter : public SseStreamWriter {
+public:
+    bool write(const std::string& data) override {
+        if (closed) return false;
+        frames.push_back(data);
+        return true;
+    }
+    void close() override { closed = true; }
+
+    std::vector<std::string> frames;
+    bool closed = false;
+};
+
+static std::string IdOf(const std::string& frame) {
+    return frame.substr(4, frame.find('\n') - 4);
+}
+
+static void testEventIds() {
+    std::cout << "\n[测试 1] 事件 ID 格式与解析..." << std::endl;
+    McpEventLog log;
+    uint64_t stream = log.openStream();
+    assert(stream == 1 && log.openStream() == 2);
+    std::string frame = log.publish(stream, "{\"a\":1}", true);
+    assert(frame == "id: 1-1\nevent: message\ndata: {\"a\":1}\n\n");
+
+    uint64_t s = 0, n = 0;
+    assert(McpEventLog::ParseEventId("3-42", s, n) && s == 3 && n == 42);
+    assert(!McpEventLog::ParseEventId("", s, n));
+    assert(!McpEventLog::ParseEventId("3", s, n));
+    assert(!McpEventLog::ParseEventId("-1", s, n));
+    assert(!McpEventLog::ParseEventId("1-", s, n));
+    assert(!McpEventLog::ParseEventId("1-x", s, n));
+    std::cout << "  ✓ <流号>-<序号>" << std::endl;
+}
+
+static void testResume() {
+    std::cout << "\n[测试 2] 连接断开后续传..." << std::endl;
+    McpEventLog log;
+    uint64_t stream = log.openStream();
+    std::string first = log.publish(stream, "1", true);
+    log.publish(stream, "2", true);   // 已写给 POST 连接，但客户端没收到
+    log.publish(0, "other", false);   // 其他流的事件不重放
+    log.publish(stream, "3", false);  // POST 连接已断开
+
+    auto resumed = std::make_shared<RecordingWriter>();
+    assert(log.attach(resumed, IdOf(first)));
+    assert(resumed->frames.size() == 2);
+    assert(IdOf(resumed->frames[0]) == "1-2" && IdOf(resumed->frames[1]) == "1-4");
+
+    // 之后该流的事件直接写到续传的连接
+    log.publish(stream, "4", false);
+    assert(resumed->frames.size() == 3);
+    std::cout << "  ✓ 只重放该流 Last-Event-ID 之后的事件" << std::endl;
+}
+
+static void testStandaloneStream() {
+    std::cout << "\n[测试 3] GET 流（流号 0）..." << std::endl;
+    McpEventLog log;
+    auto first = std::make_shared<RecordingWriter>();
+    auto second = std::make_shared<RecordingWriter>();
+    assert(log.attach(first, ""));
+    log.publish(0, "x");
+    assert(first->frames.size() == 1);
+    assert(log.attach(second, ""));
+    assert(first->closed && second->frames.empty());  // 新连接不重放，旧连接被关闭
+    log.publish(0, "y");
+    assert(second->frames.size() == 1 && first->frames.size() == 1);
+    assert(!log.attach(second, "bad"));
+    std::cout << "  ✓ 同一个流只保留最新的连接" << std::endl;
+}
+
+static void testBounds() {
+    std::cout << "\n[测试 4] 重放缓冲上限..." << std::endl;
+    McpEventLog log(4, 1024);
+    uint64_t stream = log.openStream();
+    std::string first = log.publish(stream, "0", true);
+    for (int i = 1; i < 10; ++i) log.publish(stream, std::to_string(i), true);
+    auto writer = std::make_shared<RecordingWriter>();
+    assert(log.attach(writer, IdOf(first)));
+    assert(writer->frames.size() == 4);  // 只剩最近 4 个
+    assert(IdOf(writer->frames.back()) == "1-10");
+
+    McpEventLog small(100, 128);
+    uint64_t s = small.openStream();
+    std::string big(40, 'x');
+    small.publish(s, big, true);
+    small.publish(s, big, true);
+    auto w = std::make_shared<RecordingWriter>();
+    small.attach(w, "1-0");
+    assert(w->frames.size() == 1);  // 按字节数淘汰
+    std::cout << "  ✓ 按事件数和字节数淘汰最早的事件" << std::endl;
+}
+
+static void testClose() {
+    std::cout << "\n[测试 5] session 结束..." << std::endl;
+    McpEventLog log;
+    auto writer = std::make_shared<RecordingWriter>();
+    log.attach(writer, "");
+    assert(!log.closed());
+    log.close();
+    assert(log.closed() && writer->closed);
+    auto late = std::make_shared<RecordingWriter>();
+    assert(log.attach(late, ""));
+    assert(late->closed);
+    std::cout << "  ✓ 关闭所有连接，之后的连接立即关闭" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[McpEventLog] 开始测试..." << std::endl;
+    testEventIds();
+    testResume();
+    testStandaloneStream();
+    testBounds();
+    testClose();
+    std::cout << "\n[通过] McpEventLog 测试全部通过" << std::endl;
+    return 0;
+}
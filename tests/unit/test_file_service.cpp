@@ -92,6 +92,36 @@ int main() {
     assert(!files.empty());
     std::cout << "  ✓ findFiles" << std::endl;
 
+    // 流式写入：行尾转换跨块保持正确，commit 前目标文件不出现
+    std::string upload = baseDir + "\\upload.txt";
+    assert(FileService::resolveLineEndings(baseDir + "\\run.BAT", "auto") == "crlf");
+    assert(FileService::resolveLineEndings(upload, "auto") == "auto");
+    {
+        auto writer = service.openTextFileWriter(upload, false, "crlf");
+        writer->write("echo a\r");
+        writer->write("\necho b\n");
+        assert(!fs::exists(upload));
+        writer->commit();
+        assert(writer->bytesWritten() == 16);
+    }
+    assert(service.readTextFile(upload) == "echo a\r\necho b\r\n");
+    {
+        auto writer = service.openTextFileWriter(upload, true, "lf");
+        writer->write("partial\r\n");
+        // 未 commit：临时文件删除，原文件不变
+    }
+    assert(service.readTextFile(upload) == "echo a\r\necho b\r\n");
+    bool rejected = false;
+    try {
+        service.openTextFileWriter(upload, false, "auto");
+    } catch (const std::exception&) {
+        rejected = true;
+    }
+    assert(rejected);
+    service.writeTextFile(upload, "x\ny\n", true, "lf");
+    assert(service.readTextFile(upload) == "x\ny\n");
+    std::cout << "  ✓ openTextFileWriter / writeTextFile" << std::endl;
+
     fs::remove(configPath);
     fs::remove(usagePath);
     fs::remove_all("test_files");
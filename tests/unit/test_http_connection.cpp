@@ -0,0 +1,1226 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * HttpConnectionManager 单元测试（回环 socket 上的真实连接）
+ *
+ * 测试程序充当宿主：提供 app_core.h 的全局变量和回调，并用自己的路由表实现 http_routes.h
+ * （链接时不会引入 http_routes.cpp），从而可以注册桌面版才有的流式请求体路由。
+ */
+#include "http_connection.h"
+#include "app_core.h"
+#include "http/http_router.h"
+#include "http_routes.h"
+#include "mcp/dispatcher.h"
+#include "mcp/tool_call.h"
+#include "mcp/tool_registry.h"
+#include "mcp_sse.h"
+#include "net/tls_context.h"
+#include "support/config_manager.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef CLAWDESK_OPENSSL_ENABLED
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#endif
+
+// ── 宿主：全局变量与回调 ──────────────────────────────────
+
+std::atomic<bool>      g_running(true);
+ConfigManager*         g_configManager = nullptr;
+clawdesk::AuditLogger* g_auditLogger = nullptr;
+PolicyGuard*           g_policyGuard = nullptr;
+uint64_t               g_startTickCount = 0;
+
+void AppendHttpServerLogA(const std::string&) {}
+void AppendExceptionLogA(const std::string&) {}
+void LogActivity(ActivityKind, const std::string&, const std::string&) {}
+
+// 测试可暂停授权检查，让 GET /sse 的握手停在 worker 中
+static std::atomic<bool> g_holdAuth{false};
+static std::atomic<int> g_authEntered{0};
+static std::mutex g_authMutex;
+static std::condition_variable g_authCv;
+
+bool IsAuthorizedRequest(const HttpRequest&) {
+    g_authEntered.fetch_add(1);
+    std::unique_lock<std::mutex> lock(g_authMutex);
+    g_authCv.wait(lock, []() { return !g_holdAuth.load(); });
+    return true;
+}
+
+static void HoldAuth(bool hold) {
+    {
+        std::lock_guard<std::mutex> lock(g_authMutex);
+        g_holdAuth.store(hold);
+    }
+    g_authCv.notify_all();
+}
+
+HttpResponse MakeUnauthorizedResponse() { return MakeJsonResponse(401, "{\"error\":\"Unauthorized\"}"); }
+std::string RedactAuthorizationHeader(const std::string& request) { return request; }
+
+// ── 宿主：路由表 ──────────────────────────────────────────
+
+static const uint64_t kEchoBodyLimit = 1024;
+static const uint64_t kUploadBodyLimit = 64 * 1024 * 1024;
+
+// 测试控制处理函数何时继续（例如流式路由何时开始读 body）
+class Gate {
+public:
+    void open() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            open_ = true;
+        }
+        cv_.notify_all();
+    }
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = false;
+    }
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return open_; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+static Gate g_uploadGate;
+
+// /wait 进入处理函数时计数，然后等 g_waitGate 打开（模拟排空时仍在处理的请求）
+static Gate g_waitGate;
+static std::atomic<int> g_waitEntered{0};
+
+// /flood 的 producer 在 write() 返回 false（连接被关闭）后记下已写出的字节数
+static const uint64_t kFloodLimit = 1024ull * 1024 * 1024;
+static std::atomic<bool> g_floodStopped{false};
+static std::atomic<uint64_t> g_floodBytes{0};
+
+static HttpResponse TextResponse(int status, std::string body) {
+    HttpResponse response(status);
+    response.setHeader("Content-Type", "text/plain");
+    response.setBody(std::move(body));
+    return response;
+}
+
+static std::unique_ptr<HttpRouter> BuildTestRoutes() {
+    auto router = std::make_unique<HttpRouter>(64 * 1024);
+    HttpRouter& r = *router;
+
+    r.add("GET", "/hello", [](const HttpRequest&) { return TextResponse(200, "hello"); });
+    r.add("POST", "/echo", [](const HttpRequest& request) {
+        return TextResponse(200, std::string(request.body));
+    }).setBody(kEchoBodyLimit, false);
+
+    // 流式请求体：带 X-Gate 时等 g_uploadGate 打开后再读，返回收到的字节数
+    r.add("PUT", "/upload", [](const HttpRequest& request) {
+        if (request.header("x-gate") == "1") g_uploadGate.wait();
+        HttpBodyReader* body = request.bodyReader();
+        uint64_t total = 0;
+        if (body) {
+            char buf[64 * 1024];
+            size_t n;
+            while ((n = body->read(buf, sizeof(buf))) > 0) total += n;
+        }
+        return TextResponse(200, std::to_string(total));
+    }).setBody(kUploadBodyLimit, true);
+
+    // 流式请求体：不读 body 直接拒绝
+    r.add("PUT", "/reject", [](const HttpRequest&) {
+        return TextResponse(403, "rejected");
+    }).setBody(kUploadBodyLimit, true);
+
+    r.add("GET", "/wait", [](const HttpRequest&) {
+        g_waitEntered.fetch_add(1);
+        g_waitGate.wait();
+        return TextResponse(200, "waited");
+    });
+
+    // MCP：tools/call 在 HTTP worker 中同步执行，notifications/cancelled 取消同一 session 的调用
+    r.add("POST", "/mcp", [](const HttpRequest& request) {
+        JsonRpcMessage msg = ParseJsonRpcMessage(nlohmann::json::parse(request.body, nullptr, false));
+        if (msg.method == "notifications/cancelled") {
+            CancelMcpRequest(msg.params, "test-session", "TEST");
+            return TextResponse(202, "");
+        }
+        McpToolCallResult call = CallMcpTool(msg.params, "TEST", "test-session", msg.id);
+        return TextResponse(call.ok() ? 200 : 500, call.ok() ? call.result["content"][0]["text"].get<std::string>()
+                                                             : call.errorMessage);
+    }).setBody(kEchoBodyLimit, false);
+
+    // 流式响应：不停写出直到客户端断开或被写超时关闭
+    r.add("GET", "/flood", [](const HttpRequest&) {
+        HttpResponse response(200);
+        response.setHeader("Content-Type", "application/octet-stream");
+        response.setStreamBody([](HttpBodySink& sink) {
+            std::string piece(16 * 1024, 'f');
+            uint64_t written = 0;
+            while (written < kFloodLimit && sink.write(piece)) written += piece.size();
+            g_floodBytes.store(written);
+            g_floodStopped.store(true);
+        });
+        return response;
+    });
+    return router;
+}
+
+static const HttpRouter& TestRoutes() {
+    static const std::unique_ptr<HttpRouter> router = BuildTestRoutes();
+    return *router;
+}
+
+HttpBodyPolicy GetRequestBodyPolicy(const HttpRequest& head) {
+    return TestRoutes().bodyPolicy(head);
+}
+
+// 与 http_routes.cpp 相同的 MCP 判定（ping、notifications/cancelled）
+bool IsFastLaneRequest(const HttpRequest& request) {
+    return request.method == "POST" && request.path == "/mcp" && IsMcpFastLaneMessage(request.body);
+}
+
+HttpResponse HandleHttpRequest(const HttpRequest& request) {
+    HttpRouteMatch match = TestRoutes().match(request.method, request.path);
+    if (!match.route) {
+        return TextResponse(404, "not found");
+    }
+    return match.route->handler(request);
+}
+
+// ── 服务器与客户端 ────────────────────────────────────────
+
+static std::unique_ptr<ConfigManager> g_testConfig;
+
+// 用只含 server 段的配置替换 g_configManager（HttpConnectionManager 构造时读取）
+static void UseServerConfig(const std::string& serverJson) {
+    const std::string path = "test_http_connection_config.json";
+    {
+        std::ofstream file(path, std::ios::trunc);
+        file << "{\"server\": " << serverJson << "}" << std::endl;
+    }
+    g_testConfig.reset(new ConfigManager(path));
+    g_testConfig->load();
+    g_configManager = g_testConfig.get();
+    std::remove(path.c_str());
+}
+
+static socket_t MakeListener(int& port) {
+    socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    assert(s != kInvalidSocket);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    assert(bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    assert(listen(s, SOMAXCONN) == 0);
+    socklen_t len = sizeof(addr);
+    getsockname(s, reinterpret_cast<sockaddr*>(&addr), &len);
+    port = ntohs(addr.sin_port);
+    return s;
+}
+
+// 一个 reactor 线程 + worker 池上的 HttpConnectionManager，监听 127.0.0.1 的随机端口
+class TestServer {
+public:
+    // tls 非空时监听器为 HTTPS；rateLimit 为每 IP 每分钟请求数
+    explicit TestServer(std::shared_ptr<TlsContext> tls = nullptr, int rateLimit = 100000)
+        : reactor_(CreateIoBackend()), pool_(4, 64, "test-http", 1), rateLimiter_(rateLimit, 60000),
+          connections_(reactor_, pool_, rateLimiter_) {
+        socket_t listener = MakeListener(port_);
+        assert(connections_.addListener(listener, std::move(tls)));
+        loop_ = std::thread([this]() { reactor_.run(); });
+    }
+
+    ~TestServer() {
+        reactor_.post([this]() {
+            connections_.closeAll();
+            reactor_.stop();
+        });
+        loop_.join();
+        pool_.shutdown();
+    }
+
+    int port() const { return port_; }
+
+    // 在 reactor 线程上开始排空；onDrained 也在 reactor 线程调用
+    void drain(int timeoutMs, std::function<void()> onDrained) {
+        reactor_.post([this, timeoutMs, onDrained]() { connections_.drain(timeoutMs, onDrained); });
+    }
+
+    size_t connectionCount() {
+        std::promise<size_t> count;
+        reactor_.post([this, &count]() { count.set_value(connections_.connectionCount()); });
+        return count.get_future().get();
+    }
+
+private:
+    Reactor reactor_;
+    WorkerPool pool_;
+    RateLimiter rateLimiter_;
+    HttpConnectionManager connections_;
+    int port_ = 0;
+    std::thread loop_;
+};
+
+struct ClientResponse {
+    int status = 0;
+    std::map<std::string, std::string> headers;  // 名称小写
+    std::string body;
+
+    std::string header(const std::string& name) const {
+        auto it = headers.find(name);
+        return it == headers.end() ? std::string() : it->second;
+    }
+};
+
+// 阻塞 socket 上的最小 HTTP/1.1 客户端：请求原样发送，响应按 Content-Length 读取
+class TestClient {
+public:
+    // recvBufferBytes > 0 时在连接前缩小接收缓冲区（模拟不读数据的慢客户端）
+    explicit TestClient(int port, int recvBufferBytes = 0) {
+        sock_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        assert(sock_ != kInvalidSocket);
+        if (recvBufferBytes > 0) {
+            setsockopt(sock_, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&recvBufferBytes),
+                       sizeof(recvBufferBytes));
+        }
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(static_cast<unsigned short>(port));
+        assert(connect(sock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    }
+
+    ~TestClient() { CloseSocket(sock_); }
+
+    TestClient(const TestClient&) = delete;
+    TestClient& operator=(const TestClient&) = delete;
+
+    // 写出全部数据；对端已关闭时返回 false
+    bool send(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            int n = ::send(sock_, data.data() + sent, static_cast<int>(data.size() - sent), kSendFlags);
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // 读出一个响应（1xx 临时响应只有 header）；超时或连接关闭时返回 false
+    bool readResponse(ClientResponse& out, int timeoutMs = 5000) {
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        size_t headEnd;
+        while ((headEnd = buf_.find("\r\n\r\n")) == std::string::npos) {
+            if (recvSome(deadline) <= 0) return false;
+        }
+        out = ClientResponse();
+        std::string head = buf_.substr(0, headEnd);
+        buf_.erase(0, headEnd + 4);
+
+        size_t lineEnd = head.find("\r\n");
+        std::string statusLine = head.substr(0, lineEnd);
+        out.status = std::atoi(statusLine.substr(statusLine.find(' ') + 1).c_str());
+        while (lineEnd != std::string::npos) {
+            size_t start = lineEnd + 2;
+            lineEnd = head.find("\r\n", start);
+            std::string line = head.substr(start, lineEnd == std::string::npos ? std::string::npos : lineEnd - start);
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string name = line.substr(0, colon);
+            for (char& c : name) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            size_t valueStart = line.find_first_not_of(' ', colon + 1);
+            out.headers[name] = valueStart == std::string::npos ? std::string() : line.substr(valueStart);
+        }
+        if (out.status < 200) return true;
+
+        size_t length = static_cast<size_t>(std::atoll(out.header("content-length").c_str()));
+        while (buf_.size() < length) {
+            if (recvSome(deadline) <= 0) return false;
+        }
+        out.body = buf_.substr(0, length);
+        buf_.erase(0, length);
+        return true;
+    }
+
+    // 读到 marker 为止，out 为 marker 及之前的数据；超时或连接关闭时返回 false
+    bool readUntil(const std::string& marker, std::string& out, int timeoutMs = 5000) {
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        size_t pos;
+        while ((pos = buf_.find(marker)) == std::string::npos) {
+            if (recvSome(deadline) <= 0) return false;
+        }
+        out = buf_.substr(0, pos + marker.size());
+        buf_.erase(0, pos + marker.size());
+        return true;
+    }
+
+    // 读到对端关闭为止，out 为剩余的全部数据；超时返回 false
+    bool readToEnd(std::string& out, int timeoutMs = 5000) {
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        int n;
+        while ((n = recvSome(deadline)) > 0) {
+        }
+        out.swap(buf_);
+        buf_.clear();
+        return n == 0;
+    }
+
+    // ms 内没有收到任何数据
+    bool silentFor(int ms) {
+        return buf_.empty() && recvSome(Clock::now() + std::chrono::milliseconds(ms)) < 0;
+    }
+
+    // timeoutMs 内对端关闭连接（读到 EOF 或连接被重置），之前到达的数据丢弃
+    bool closedWithin(int timeoutMs) {
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        for (;;) {
+            int n = recvSome(deadline);
+            if (n == 0) return true;
+            if (n < 0) return false;
+            buf_.clear();
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+#ifdef MSG_NOSIGNAL
+    static const int kSendFlags = MSG_NOSIGNAL;
+#else
+    static const int kSendFlags = 0;
+#endif
+
+    // 收到数据返回字节数，EOF 或连接错误返回 0，到期返回 -1
+    int recvSome(Clock::time_point deadline) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (remaining < 0) remaining = 0;
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(sock_, &readable);
+        timeval tv;
+        tv.tv_sec = static_cast<long>(remaining / 1000);
+        tv.tv_usec = static_cast<long>((remaining % 1000) * 1000);
+        int ready = select(static_cast<int>(sock_ + 1), &readable, nullptr, nullptr, &tv);
+        if (ready == 0) return -1;
+        if (ready < 0) return 0;
+        char chunk[16 * 1024];
+        int n = recv(sock_, chunk, static_cast<int>(sizeof(chunk)), 0);
+        if (n <= 0) return 0;
+        buf_.append(chunk, static_cast<size_t>(n));
+        return n;
+    }
+
+    socket_t sock_ = kInvalidSocket;
+    std::string buf_;  // 已收到、尚未作为响应取走的字节
+};
+
+static std::string Get(const std::string& path, const std::string& extraHeaders = "") {
+    return "GET " + path + " HTTP/1.1\r\nHost: test\r\n" + extraHeaders + "\r\n";
+}
+
+static std::string Post(const std::string& path, const std::string& body) {
+    return "POST " + path + " HTTP/1.1\r\nHost: test\r\nContent-Length: " + std::to_string(body.size()) +
+           "\r\n\r\n" + body;
+}
+
+static std::string Upload(const std::string& path, uint64_t length, const std::string& extraHeaders = "") {
+    return "PUT " + path + " HTTP/1.1\r\nHost: test\r\nContent-Length: " + std::to_string(length) + "\r\n" +
+           extraHeaders + "\r\n";
+}
+
+// 连接被接受（监听 socket 未关闭）
+static bool CanConnect(int port) {
+    socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<unsigned short>(port));
+    bool connected = connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    CloseSocket(s);
+    return connected;
+}
+
+// 最多等 timeoutMs 直到 done() 为真
+template <typename Predicate>
+static bool WaitFor(Predicate done, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+static long long ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ── keep-alive ────────────────────────────────────────────
+
+// 测试 1: 同一连接上连续请求，达到 keep_alive_max_requests 时回 Connection: close 并关闭
+void test_keep_alive_reuse() {
+    std::cout << "\n[测试 1] keep-alive 复用与请求数上限..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_max_requests": 3, "keep_alive_timeout_seconds": 5})");
+    TestServer server;
+    TestClient client(server.port());
+
+    ClientResponse response;
+    for (int i = 1; i <= 2; ++i) {
+        assert(client.send(Get("/hello")));
+        assert(client.readResponse(response));
+        assert(response.status == 200 && response.body == "hello");
+        assert(response.header("connection") == "keep-alive");
+        assert(response.header("keep-alive") == "timeout=5, max=" + std::to_string(3 - i));
+    }
+    assert(server.connectionCount() == 1);
+    std::cout << "  ✓ 前 2 个请求复用同一连接，Keep-Alive 头递减" << std::endl;
+
+    assert(client.send(Get("/hello")));
+    assert(client.readResponse(response));
+    assert(response.status == 200);
+    assert(response.header("connection") == "close");
+    assert(client.closedWithin(2000));
+    std::cout << "  ✓ 第 3 个请求回 Connection: close 后断开" << std::endl;
+
+    TestClient closing(server.port());
+    assert(closing.send(Get("/hello", "Connection: close\r\n")));
+    assert(closing.readResponse(response));
+    assert(response.header("connection") == "close");
+    assert(closing.closedWithin(2000));
+    std::cout << "  ✓ 客户端 Connection: close 时响应后断开" << std::endl;
+
+    std::cout << "[通过] keep-alive 复用与请求数上限" << std::endl;
+}
+
+// 测试 2: HTTP/1.0 默认不保持连接，显式 Connection: keep-alive 时保持
+void test_http10() {
+    std::cout << "\n[测试 2] HTTP/1.0 连接语义..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_max_requests": 100, "keep_alive_timeout_seconds": 5})");
+    TestServer server;
+    ClientResponse response;
+
+    TestClient plain(server.port());
+    assert(plain.send("GET /hello HTTP/1.0\r\n\r\n"));
+    assert(plain.readResponse(response));
+    assert(response.status == 200 && response.body == "hello");
+    assert(response.header("connection") == "close");
+    assert(plain.closedWithin(2000));
+    std::cout << "  ✓ 不带 Connection 头时响应后断开" << std::endl;
+
+    TestClient keepAlive(server.port());
+    for (int i = 0; i < 2; ++i) {
+        assert(keepAlive.send("GET /hello HTTP/1.0\r\nConnection: keep-alive\r\n\r\n"));
+        assert(keepAlive.readResponse(response));
+        assert(response.status == 200);
+        assert(response.header("connection") == "keep-alive");
+    }
+    std::cout << "  ✓ Connection: keep-alive 时保持连接" << std::endl;
+
+    std::cout << "[通过] HTTP/1.0 连接语义" << std::endl;
+}
+
+// 测试 3: 一次发出的多个请求（pipelining）依次处理，多出的字节留给下一个请求
+void test_pipelining() {
+    std::cout << "\n[测试 3] 请求流水线..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_max_requests": 100, "keep_alive_timeout_seconds": 5})");
+    TestServer server;
+    TestClient client(server.port());
+
+    assert(client.send(Get("/hello") + Post("/echo", "first body") + Post("/echo", "second") +
+                       Get("/hello", "Connection: close\r\n")));
+    ClientResponse response;
+    assert(client.readResponse(response) && response.status == 200 && response.body == "hello");
+    assert(client.readResponse(response) && response.status == 200 && response.body == "first body");
+    assert(client.readResponse(response) && response.status == 200 && response.body == "second");
+    assert(client.readResponse(response) && response.status == 200 && response.body == "hello");
+    assert(response.header("connection") == "close");
+    assert(client.closedWithin(2000));
+    std::cout << "  ✓ 4 个请求一次发出，按顺序得到 4 个响应" << std::endl;
+
+    std::cout << "[通过] 请求流水线" << std::endl;
+}
+
+// 测试 16: 限流按请求计，keep-alive 连接上的请求同样计入
+void test_rate_limit_per_request() {
+    std::cout << "\n[测试 16] 按请求限流..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_max_requests": 100, "keep_alive_timeout_seconds": 5})");
+    TestServer server(nullptr, 3);
+    TestClient client(server.port());
+
+    ClientResponse response;
+    for (int i = 0; i < 3; ++i) {
+        assert(client.send(Get("/hello")));
+        assert(client.readResponse(response) && response.status == 200);
+    }
+    assert(client.send(Get("/hello")));
+    assert(client.readResponse(response));
+    assert(response.status == 429 && response.header("retry-after") == "60");
+    assert(response.header("connection") == "close");
+    assert(client.closedWithin(2000));
+    std::cout << "  ✓ 同一连接上第 4 个请求回 429 并断开" << std::endl;
+
+    TestClient another(server.port());
+    assert(another.readResponse(response));
+    assert(response.status == 429);
+    std::cout << "  ✓ 额度用完后新连接直接回 429" << std::endl;
+
+    std::cout << "[通过] 按请求限流" << std::endl;
+}
+
+// ── 请求体 ────────────────────────────────────────────────
+
+// 测试 4: 普通路由收到 Expect: 100-continue 时立即回复，客户端再上传 body
+void test_expect_continue_buffered() {
+    std::cout << "\n[测试 4] 普通路由的 100 Continue..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 5})");
+    TestServer server;
+    TestClient client(server.port());
+
+    assert(client.send("POST /echo HTTP/1.1\r\nHost: test\r\nContent-Length: 5\r\nExpect: 100-continue\r\n\r\n"));
+    ClientResponse response;
+    assert(client.readResponse(response));
+    assert(response.status == 100);
+    std::cout << "  ✓ 上传 body 前收到 100 Continue" << std::endl;
+
+    assert(client.send("12345"));
+    assert(client.readResponse(response));
+    assert(response.status == 200 && response.body == "12345");
+    assert(response.header("connection") == "keep-alive");
+    std::cout << "  ✓ body 收齐后分发，连接保持" << std::endl;
+
+    std::cout << "[通过] 普通路由的 100 Continue" << std::endl;
+}
+
+// 测试 5: 流式路由等 handler 第一次 read() 时才回复 100 Continue
+void test_expect_continue_streaming() {
+    std::cout << "\n[测试 5] 流式路由的 100 Continue..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 5})");
+    TestServer server;
+    TestClient client(server.port());
+    g_uploadGate.reset();
+
+    assert(client.send(Upload("/upload", 1000, "Expect: 100-continue\r\nX-Gate: 1\r\n")));
+    assert(client.silentFor(300));
+    std::cout << "  ✓ handler 读 body 之前没有 100 Continue" << std::endl;
+
+    g_uploadGate.open();
+    ClientResponse response;
+    assert(client.readResponse(response));
+    assert(response.status == 100);
+    assert(client.send(std::string(1000, 'x')));
+    assert(client.readResponse(response));
+    assert(response.status == 200 && response.body == "1000");
+    std::cout << "  ✓ handler 开始读取后收到 100 Continue，body 完整" << std::endl;
+
+    // body 已读完，连接可以继续使用
+    assert(response.header("connection") == "keep-alive");
+    assert(client.send(Get("/hello")));
+    assert(client.readResponse(response) && response.body == "hello");
+    std::cout << "  ✓ body 读完后连接保持" << std::endl;
+
+    std::cout << "[通过] 流式路由的 100 Continue" << std::endl;
+}
+
+// 测试 6: 不认识的 Expect 回 417；HTTP/1.0 的 Expect 忽略
+void test_expect_unsupported() {
+    std::cout << "\n[测试 6] 不支持的 Expect..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 5})");
+    TestServer server;
+    ClientResponse response;
+
+    TestClient client(server.port());
+    assert(client.send("POST /echo HTTP/1.1\r\nHost: test\r\nContent-Length: 5\r\nExpect: 200-ok\r\n\r\n"));
+    assert(client.readResponse(response));
+    assert(response.status == 417);
+    assert(client.closedWithin(2000));
+    std::cout << "  ✓ Expect: 200-ok 回 417 并断开" << std::endl;
+
+    TestClient http10(server.port());
+    assert(http10.send("POST /echo HTTP/1.0\r\nContent-Length: 5\r\nExpect: 200-ok\r\n\r\nabcde"));
+    assert(http10.readResponse(response));
+    assert(response.status == 200 && response.body == "abcde");
+    std::cout << "  ✓ HTTP/1.0 的 Expect 被忽略" << std::endl;
+
+    std::cout << "[通过] 不支持的 Expect" << std::endl;
+}
+
+// 测试 7: Content-Length 超出路由上限时不等 body 直接 413
+void test_body_too_large() {
+    std::cout << "\n[测试 7] 请求体超出路由上限..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 5})");
+    TestServer server;
+    ClientResponse response;
+
+    TestClient expecting(server.port());
+    assert(expecting.send("POST /echo HTTP/1.1\r\nHost: test\r\nContent-Length: " +
+                          std::to_string(kEchoBodyLimit + 1) + "\r\nExpect: 100-continue\r\n\r\n"));
+    assert(expecting.readResponse(response));
+    assert(response.status == 413);
+    assert(expecting.closedWithin(2000));
+    std::cout << "  ✓ 带 100-continue 时回 413 而不是 100" << std::endl;
+
+    TestClient plain(server.port());
+    assert(plain.send("POST /echo HTTP/1.1\r\nHost: test\r\nContent-Length: 4096\r\n\r\n"));
+    assert(plain.readResponse(response, 2000));
+    assert(response.status == 413);
+    assert(plain.closedWithin(2000));
+    std::cout << "  ✓ 未上传任何 body 字节即回 413" << std::endl;
+
+    std::cout << "[通过] 请求体超出路由上限" << std::endl;
+}
+
+// 测试 8: handler 不读时积压到 256 KB 暂停接收，读走后恢复
+void test_body_backpressure() {
+    std::cout << "\n[测试 8] 流式请求体背压..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 5})");
+    TestServer server;
+    TestClient client(server.port());
+    g_uploadGate.reset();
+
+    const uint64_t kLength = 32 * 1024 * 1024;
+    assert(client.send(Upload("/upload", kLength, "X-Gate: 1\r\n")));
+    std::atomic<uint64_t> sent{0};
+    std::thread sender([&client, &sent, kLength]() {
+        std::string piece(64 * 1024, 'b');
+        while (sent.load() < kLength) {
+            if (!client.send(piece)) return;
+            sent.fetch_add(piece.size());
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    uint64_t sentWhilePaused = sent.load();
+    assert(sentWhilePaused < kLength);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(sent.load() == sentWhilePaused);
+    std::cout << "  ✓ handler 未读取时上传停在 " << sentWhilePaused / 1024 << " KB（内核缓冲 + 256 KB 积压）" << std::endl;
+
+    g_uploadGate.open();
+    sender.join();
+    assert(sent.load() == kLength);
+    ClientResponse response;
+    assert(client.readResponse(response, 10000));
+    assert(response.status == 200 && response.body == std::to_string(kLength));
+    std::cout << "  ✓ handler 开始读取后恢复接收，32 MB 完整到达" << std::endl;
+
+    std::cout << "[通过] 流式请求体背压" << std::endl;
+}
+
+// 测试 9: handler 没读完 body 就响应时不保持连接
+void test_unread_body_closes() {
+    std::cout << "\n[测试 9] 未读完的请求体..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 5})");
+    TestServer server;
+    TestClient client(server.port());
+
+    assert(client.send(Upload("/reject", 100000) + std::string(1000, 'r')));
+    ClientResponse response;
+    assert(client.readResponse(response));
+    assert(response.status == 403);
+    assert(response.header("connection") == "close");
+    assert(client.closedWithin(2000));
+    std::cout << "  ✓ 403 带 Connection: close，随后断开" << std::endl;
+
+    std::cout << "[通过] 未读完的请求体" << std::endl;
+}
+
+// ── 超时 ──────────────────────────────────────────────────
+
+// 测试 10: header / idle / body / write 超时与 min_body_rate（各场景并行跑在同一服务器上）
+void test_deadlines() {
+    std::cout << "\n[测试 10] 连接超时..." << std::endl;
+
+    UseServerConfig(R"({"header_timeout_ms": 1000, "body_timeout_ms": 1000, "keep_alive_timeout_seconds": 1,
+                        "min_body_rate": 1024})");
+    TestServer server;
+    const int port = server.port();
+    using Clock = std::chrono::steady_clock;
+
+    // 各场景返回服务器断开所用的毫秒数，超出上限仍未断开时返回 -1
+    auto partialHeader = std::async(std::launch::async, [port]() -> long long {
+        TestClient client(port);
+        auto start = Clock::now();
+        assert(client.send("GET /hello HTTP/1.1\r\nHost: te"));
+        return client.closedWithin(5000) ? ElapsedMs(start) : -1;
+    });
+    // header 每 200 ms 多一行：收到数据不会推迟 header 超时
+    auto slowloris = std::async(std::launch::async, [port]() -> long long {
+        TestClient client(port);
+        auto start = Clock::now();
+        assert(client.send("GET /hello HTTP/1.1\r\n"));
+        for (int i = 0; i < 25; ++i) {
+            if (!client.send("X-Slow-" + std::to_string(i) + ": 1\r\n") || client.closedWithin(200)) {
+                return ElapsedMs(start);
+            }
+        }
+        return -1;
+    });
+    auto idle = std::async(std::launch::async, [port]() -> long long {
+        TestClient client(port);
+        ClientResponse response;
+        assert(client.send(Get("/hello")));
+        assert(client.readResponse(response));
+        auto start = Clock::now();
+        return client.closedWithin(5000) ? ElapsedMs(start) : -1;
+    });
+    // header 完整但 body 一个字节都不来：第一次检查（5 s）时断开
+    auto bodyStall = std::async(std::launch::async, [port]() -> long long {
+        TestClient client(port);
+        auto start = Clock::now();
+        assert(client.send("POST /echo HTTP/1.1\r\nHost: test\r\nContent-Length: 1000\r\n\r\n"));
+        return client.closedWithin(10000) ? ElapsedMs(start) : -1;
+    });
+    // body 每 100 ms 一个字节（约 10 B/s）：有进展所以不算停顿，宽限期后速率检查（10 s）断开
+    auto bodyTrickle = std::async(std::launch::async, [port]() -> long long {
+        TestClient client(port);
+        auto start = Clock::now();
+        assert(client.send("POST /echo HTTP/1.1\r\nHost: test\r\nContent-Length: 1000\r\n\r\n"));
+        for (int i = 0; i < 200; ++i) {
+            if (!client.send("t") || client.closedWithin(100)) return ElapsedMs(start);
+        }
+        return -1;
+    });
+    // 客户端不读响应：发送停住后写超时（10 s + 每 64 KB 放宽 1 s）关闭连接，producer 的 write() 返回 false
+    g_floodStopped.store(false);
+    auto writeStall = std::async(std::launch::async, [port]() -> long long {
+        TestClient client(port, 4096);
+        auto start = Clock::now();
+        assert(client.send(Get("/flood")));
+        while (!g_floodStopped.load()) {
+            if (ElapsedMs(start) > 30000) return -1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        return ElapsedMs(start);
+    });
+
+    long long ms = partialHeader.get();
+    assert(ms >= 900 && ms < 3000);
+    std::cout << "  ✓ 不完整的 header 在 header_timeout_ms 后断开（" << ms << " ms）" << std::endl;
+
+    ms = slowloris.get();
+    assert(ms >= 900 && ms < 3000);
+    std::cout << "  ✓ 逐行慢发的 header 同样按 header_timeout_ms 断开（" << ms << " ms）" << std::endl;
+
+    ms = idle.get();
+    assert(ms >= 900 && ms < 3000);
+    std::cout << "  ✓ 空闲 keep-alive 连接在 keep_alive_timeout_seconds 后断开（" << ms << " ms）" << std::endl;
+
+    ms = bodyStall.get();
+    assert(ms >= 4500 && ms < 8000);
+    std::cout << "  ✓ body 停顿超过 body_timeout_ms 后在下一次检查时断开（" << ms << " ms）" << std::endl;
+
+    ms = bodyTrickle.get();
+    assert(ms >= 9500 && ms < 13000);
+    std::cout << "  ✓ body 速率低于 min_body_rate 在宽限期后断开（" << ms << " ms）" << std::endl;
+
+    ms = writeStall.get();
+    assert(ms >= 9500 && ms < 25000);
+    assert(g_floodBytes.load() < kFloodLimit);
+    std::cout << "  ✓ 客户端不读时写超时关闭连接，producer 停止（" << ms << " ms，写出 "
+              << g_floodBytes.load() / 1024 << " KB）" << std::endl;
+
+    std::cout << "[通过] 连接超时" << std::endl;
+}
+
+// ── 排空 ──────────────────────────────────────────────────
+
+// 测试 11: 空闲连接立即关闭、新连接被拒绝，进行中的请求写完响应后关闭
+void test_drain_idle_and_inflight() {
+    std::cout << "\n[测试 11] 排空空闲连接与进行中的请求..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 30})");
+    TestServer server;
+    ClientResponse response;
+    g_waitGate.reset();
+    g_waitEntered.store(0);
+
+    TestClient idle(server.port());
+    assert(idle.send(Get("/hello")));
+    assert(idle.readResponse(response) && response.header("connection") == "keep-alive");
+    TestClient busy(server.port());
+    assert(busy.send(Get("/wait")));
+    assert(WaitFor([]() { return g_waitEntered.load() == 1; }, 2000));
+
+    std::atomic<int> drained{0};
+    server.drain(10000, [&drained]() { drained.fetch_add(1); });
+    assert(idle.closedWithin(1000));
+    assert(!CanConnect(server.port()));
+    std::cout << "  ✓ 空闲 keep-alive 连接立即关闭，不再接受新连接" << std::endl;
+
+    assert(busy.silentFor(200));
+    assert(drained.load() == 0);
+    g_waitGate.open();
+    assert(busy.readResponse(response));
+    assert(response.status == 200 && response.body == "waited");
+    assert(busy.closedWithin(1000));
+    assert(WaitFor([&drained]() { return drained.load() == 1; }, 1000));
+    std::cout << "  ✓ 进行中的请求照常响应后关闭，随后 onDrained 被调用" << std::endl;
+
+    std::cout << "[通过] 排空空闲连接与进行中的请求" << std::endl;
+}
+
+// 测试 12: SSE 流写完已排队的事件后关闭，session 随之结束
+void test_drain_sse() {
+    std::cout << "\n[测试 12] 排空 SSE 流..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 30})");
+    TestServer server;
+    TestClient client(server.port());
+
+    assert(client.send(Get("/sse")));
+    ClientResponse response;
+    assert(client.readResponse(response));
+    assert(response.status == 200 && response.header("content-type") == "text/event-stream");
+    std::string endpoint;
+    assert(client.readUntil("\n\n", endpoint));
+    size_t idPos = endpoint.find("sessionId=");
+    assert(endpoint.find("event: endpoint") != std::string::npos && idPos != std::string::npos);
+    std::string sessionId = endpoint.substr(idPos + 10, endpoint.find_first_of("\r\n", idPos) - idPos - 10);
+
+    // 客户端还没读时排入一个大事件，紧接着排空：事件必须完整写出后才关闭
+    const std::string payload(512 * 1024, 'e');
+    assert(SseSessionStore::getInstance().sendSseEvent(sessionId, "message", payload));
+    std::atomic<int> drained{0};
+    server.drain(10000, [&drained]() { drained.fetch_add(1); });
+
+    std::string rest;
+    assert(client.readToEnd(rest));
+    assert(rest.find("event: message") != std::string::npos);
+    assert(rest.find(payload) != std::string::npos);
+    std::cout << "  ✓ 已排队的 " << payload.size() / 1024 << " KB 事件写完后连接关闭" << std::endl;
+
+    assert(WaitFor([&drained]() { return drained.load() == 1; }, 1000));
+    assert(!SseSessionStore::getInstance().findSession(sessionId));
+    std::cout << "  ✓ onDrained 被调用，SSE session 已移除" << std::endl;
+
+    // 握手还在 worker 中时开始排空：握手完成后写出首个事件即关闭，不等到排空超时
+    TestServer handshaking;
+    TestClient late(handshaking.port());
+    HoldAuth(true);
+    g_authEntered.store(0);
+    assert(late.send(Get("/sse")));
+    assert(WaitFor([]() { return g_authEntered.load() == 1; }, 2000));
+    std::atomic<int> lateDrained{0};
+    handshaking.drain(10000, [&lateDrained]() { lateDrained.fetch_add(1); });
+    HoldAuth(false);
+    assert(late.readResponse(response) && response.status == 200);
+    assert(late.readToEnd(rest, 2000));
+    assert(rest.find("event: endpoint") != std::string::npos);
+    assert(WaitFor([&lateDrained]() { return lateDrained.load() == 1; }, 1000));
+    std::cout << "  ✓ 排空时仍在握手的 SSE 流写出 endpoint 事件后立即关闭" << std::endl;
+
+    std::cout << "[通过] 排空 SSE 流" << std::endl;
+}
+
+// 测试 13: 超时后强制关闭剩余连接，onDrained 只调用一次，重复 drain 无效
+void test_drain_timeout() {
+    std::cout << "\n[测试 13] 排空超时..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 30})");
+    TestServer server;
+    g_waitGate.reset();
+    g_waitEntered.store(0);
+
+    TestClient busy(server.port());
+    assert(busy.send(Get("/wait")));
+    assert(WaitFor([]() { return g_waitEntered.load() == 1; }, 2000));
+
+    std::atomic<int> drained{0};
+    std::atomic<int> drainedAgain{0};
+    auto start = std::chrono::steady_clock::now();
+    server.drain(300, [&drained]() { drained.fetch_add(1); });
+    server.drain(300, [&drainedAgain]() { drainedAgain.fetch_add(1); });
+
+    assert(busy.closedWithin(2000));
+    long long ms = ElapsedMs(start);
+    assert(ms >= 250);
+    assert(WaitFor([&drained]() { return drained.load() == 1; }, 1000));
+    std::cout << "  ✓ 处理函数未返回，" << ms << " ms 后强制关闭并调用 onDrained" << std::endl;
+
+    // 处理函数之后返回：响应被丢弃，不会再次通知
+    g_waitGate.open();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(drained.load() == 1);
+    assert(drainedAgain.load() == 0);
+    assert(server.connectionCount() == 0);
+    std::cout << "  ✓ onDrained 只调用一次，第二次 drain 被忽略" << std::endl;
+
+    std::cout << "[通过] 排空超时" << std::endl;
+}
+
+// ── SSE endpoint ──────────────────────────────────────────
+
+// 取事件流里 endpoint 事件的 data 行
+static std::string EndpointUrl(const std::string& stream) {
+    size_t event = stream.find("event: endpoint");
+    assert(event != std::string::npos);
+    size_t data = stream.find("data: ", event);
+    assert(data != std::string::npos);
+    data += 6;
+    return stream.substr(data, stream.find_first_of("\r\n", data) - data);
+}
+
+#ifdef CLAWDESK_OPENSSL_ENABLED
+
+static const char* kCertFile = "test_http_connection_cert.pem";
+static const char* kKeyFile = "test_http_connection_key.pem";
+
+// 生成自签名 P-256 证书
+static void WriteSelfSignedCert() {
+    EVP_PKEY_CTX* kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    EVP_PKEY* key = nullptr;
+    assert(kctx && EVP_PKEY_keygen_init(kctx) == 1);
+    assert(EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1) == 1);
+    assert(EVP_PKEY_keygen(kctx, &key) == 1);
+    EVP_PKEY_CTX_free(kctx);
+
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1,
+                               0);
+    X509_set_issuer_name(cert, name);
+    assert(X509_sign(cert, key, EVP_sha256()) > 0);
+
+    FILE* f = fopen(kCertFile, "wb");
+    assert(f);
+    PEM_write_X509(f, cert);
+    fclose(f);
+    f = fopen(kKeyFile, "wb");
+    assert(f);
+    PEM_write_PrivateKey(f, key, nullptr, nullptr, 0, nullptr, nullptr);
+    fclose(f);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+}
+
+// 阻塞 socket 上的 TLS 客户端：发一个请求，读到 SSE endpoint 事件为止
+static std::string TlsReadEndpoint(int port, const std::string& request) {
+    socket_t sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<unsigned short>(port));
+    assert(connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
+    SSL* ssl = SSL_new(ctx);
+    SSL_set_fd(ssl, static_cast<int>(sock));
+    assert(SSL_connect(ssl) == 1);
+    assert(SSL_write(ssl, request.data(), static_cast<int>(request.size())) == static_cast<int>(request.size()));
+
+    std::string stream;
+    char buf[4096];
+    size_t event;
+    while ((event = stream.find("event: endpoint")) == std::string::npos ||
+           stream.find("\n\n", event) == std::string::npos) {
+        int n = SSL_read(ssl, buf, sizeof(buf));
+        assert(n > 0);
+        stream.append(buf, static_cast<size_t>(n));
+    }
+    assert(stream.compare(0, 15, "HTTP/1.1 200 OK") == 0 || stream.compare(0, 15, "HTTP/1.0 200 OK") == 0);
+
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    SSL_CTX_free(ctx);
+    CloseSocket(sock);
+    return EndpointUrl(stream);
+}
+
+#endif
+
+// 测试 14: SSE endpoint 事件的 URL 与连接的 scheme 一致（HTTPS 上不能宣告 http://）
+void test_sse_endpoint_scheme() {
+    std::cout << "\n[测试 14] SSE endpoint 的 scheme..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 30, "port": 35182, "tls_port": 38443})");
+    std::string stream;
+
+    TestServer server;
+    TestClient withHost(server.port());
+    assert(withHost.send(Get("/sse")));
+    ClientResponse response;
+    assert(withHost.readResponse(response) && response.status == 200);
+    assert(withHost.readUntil("\n\n", stream));
+    assert(EndpointUrl(stream).rfind("http://test/messages?sessionId=", 0) == 0);
+    TestClient noHost(server.port());
+    assert(noHost.send("GET /sse HTTP/1.0\r\n\r\n"));
+    assert(noHost.readResponse(response) && response.status == 200);
+    assert(noHost.readUntil("\n\n", stream));
+    assert(EndpointUrl(stream).rfind("http://127.0.0.1:35182/messages?sessionId=", 0) == 0);
+    std::cout << "  ✓ HTTP 连接上宣告 http://（Host 或配置的 port）" << std::endl;
+
+#ifdef CLAWDESK_OPENSSL_ENABLED
+    WriteSelfSignedCert();
+    TlsOptions options;
+    options.certFile = kCertFile;
+    options.keyFile = kKeyFile;
+    std::string error;
+    std::shared_ptr<TlsContext> context = TlsContext::create(options, error);
+    assert(context);
+    {
+        TestServer secure(context);
+        std::string url = TlsReadEndpoint(secure.port(), "GET /sse HTTP/1.1\r\nHost: test\r\n\r\n");
+        assert(url.rfind("https://test/messages?sessionId=", 0) == 0);
+        url = TlsReadEndpoint(secure.port(), "GET /sse HTTP/1.0\r\n\r\n");
+        assert(url.rfind("https://127.0.0.1:38443/messages?sessionId=", 0) == 0);
+    }
+    std::remove(kCertFile);
+    std::remove(kKeyFile);
+    std::cout << "  ✓ HTTPS 连接上宣告 https://（Host 或配置的 tls_port）" << std::endl;
+#else
+    std::cout << "  - 未启用 OpenSSL，跳过 HTTPS 部分" << std::endl;
+#endif
+
+    std::cout << "[通过] SSE endpoint 的 scheme" << std::endl;
+}
+
+// ── MCP 取消 ──────────────────────────────────────────────
+
+static std::atomic<int> g_waitToolEntered{0};
+
+// 同步工具：等到调用被取消（最多 10 s）
+static void RegisterWaitTool() {
+    ToolMetadata meta;
+    meta.name = "wait_cancel";
+    meta.description = "wait_cancel";
+    meta.riskLevel = clawdesk::RiskLevel::Low;
+    meta.requiresConfirmation = false;
+    meta.inputSchema = nlohmann::json::object();
+    meta.handler = [](const nlohmann::json&) {
+        CancellationToken cancel = CurrentCancellationToken();
+        g_waitToolEntered.fetch_add(1);
+        std::string text = cancel.waitFor(10000) ? "cancelled" : "timeout";
+        return nlohmann::json{{"content", nlohmann::json::array({{{"type", "text"}, {"text", text}}})}};
+    };
+    ToolRegistry::getInstance().registerTool(meta.name, meta);
+}
+
+static std::string McpCall(int id) {
+    return Post("/mcp", nlohmann::json{{"jsonrpc", "2.0"}, {"id", id}, {"method", "tools/call"},
+                                       {"params", {{"name", "wait_cancel"}, {"arguments", nlohmann::json::object()}}}}
+                            .dump());
+}
+
+static std::string McpCancel(int id) {
+    return Post("/mcp", nlohmann::json{{"jsonrpc", "2.0"}, {"method", "notifications/cancelled"},
+                                       {"params", {{"requestId", id}, {"reason", "user"}}}}
+                            .dump());
+}
+
+// 测试 15: 同步工具占满所有 worker 时，notifications/cancelled 经快速通道立即生效
+void test_cancel_with_busy_workers() {
+    std::cout << "\n[测试 15] worker 占满时取消 tools/call..." << std::endl;
+
+    UseServerConfig(R"({"keep_alive_timeout_seconds": 30, "queue_timeout_ms": 1000})");
+    RegisterWaitTool();
+    TestServer server;
+    g_waitToolEntered.store(0);
+
+    const int kWorkers = 4;  // TestServer 的普通 worker 数
+    std::vector<std::unique_ptr<TestClient>> calls;
+    for (int id = 1; id <= kWorkers; ++id) {
+        calls.emplace_back(new TestClient(server.port()));
+        assert(calls.back()->send(McpCall(id)));
+    }
+    assert(WaitFor([]() { return g_waitToolEntered.load() == kWorkers; }, 2000));
+
+    ClientResponse response;
+    TestClient canceller(server.port());
+    auto start = std::chrono::steady_clock::now();
+    assert(canceller.send(McpCancel(1)));
+    assert(canceller.readResponse(response, 2000));
+    assert(response.status == 202);
+    assert(calls[0]->readResponse(response, 2000));
+    assert(response.status == 200 && response.body == "cancelled");
+    long long ms = ElapsedMs(start);
+    assert(ms < 1000);
+    std::cout << "  ✓ 取消不排在被取消的调用之后，" << ms << " ms 内生效" << std::endl;
+
+    for (int id = 2; id <= kWorkers; ++id) {
+        assert(canceller.send(McpCancel(id)));
+        assert(canceller.readResponse(response) && response.status == 202);
+        assert(calls[id - 1]->readResponse(response) && response.body == "cancelled");
+    }
+    std::cout << "  ✓ 其余调用同样被取消" << std::endl;
+
+    std::cout << "[通过] worker 占满时取消 tools/call" << std::endl;
+}
+
+int main() {
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+    std::cout << "\n[HttpConnection] 开始测试..." << std::endl;
+    test_keep_alive_reuse();
+    test_http10();
+    test_pipelining();
+    test_expect_continue_buffered();
+    test_expect_continue_streaming();
+    test_expect_unsupported();
+    test_body_too_large();
+    test_body_backpressure();
+    test_unread_body_closes();
+    test_deadlines();
+    test_drain_idle_and_inflight();
+    test_drain_sse();
+    test_drain_timeout();
+    test_sse_endpoint_scheme();
+    test_cancel_with_busy_workers();
+    test_rate_limit_per_request();
+    std::cout << "\n[通过] HttpConnection 全部测试" << std::endl;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return 0;
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * HttpRequestParser 单元测试
+ */
+#include "http/http_request.h"
+#include <cassert>
+#include <iostream>
+
+using Status = HttpRequestParser::Status;
+
+// 测试 1: 请求行、header、body
+void test_basic_request() {
+    std::cout << "\n[测试 1] 解析完整请求..." << std::endl;
+
+    auto req = ParseHttpRequest(
+        "POST /mcp HTTP/1.1\r\n"
+        "Host: 127.0.0.1:35182\r\n"
+        "Content-Type:  application/json \r\n"
+        "Mcp-Session-Id: abc123\r\n"
+        "Content-Length: 14\r\n"
+        "\r\n"
+        "{\"id\":1,\"x\":2}");
+    assert(req);
+    assert(req->method == "POST");
+    assert(req->path == "/mcp");
+    assert(req->version == "HTTP/1.1");
+    assert(req->headers.size() == 4);
+    assert(req->header("content-type") == "application/json");
+    assert(req->header("MCP-SESSION-ID") == "abc123");
+    assert(req->header("authorization").empty());
+    assert(!req->hasHeader("authorization"));
+    assert(req->body == "{\"id\":1,\"x\":2}");
+    assert(req->head().size() + req->body.size() == req->raw().size());
+    std::cout << "  ✓ method/path/version/header/body 正确，header 查找不区分大小写" << std::endl;
+    std::cout << "[通过] 解析完整请求" << std::endl;
+}
+
+// 测试 2: query string 解码
+void test_query_decoding() {
+    std::cout << "\n[测试 2] query 参数解码..." << std::endl;
+
+    auto req = ParseHttpRequest(
+        "GET /list?path=C%3A%5CUsers%5Cme&name=a+b&flag&dup=1&dup=2&empty= HTTP/1.1\r\n"
+        "\r\n");
+    assert(req);
+    assert(req->path == "/list");
+    assert(req->target.find('?') != std::string_view::npos);
+    assert(req->queryParam("path") == "C:\\Users\\me");
+    assert(req->queryParam("name") == "a b");
+    assert(req->query.count("flag") == 1 && req->queryParam("flag").empty());
+    assert(req->queryParam("dup") == "1");
+    assert(req->query.count("empty") == 1);
+    assert(req->queryParam("missing").empty());
+    assert(DecodeUrlComponent("%E4%B8%AD") == "\xE4\xB8\xAD");
+    assert(DecodeUrlComponent("100%") == "100%");
+    assert(DecodeUrlComponent("%zz") == "%zz");
+    std::cout << "  ✓ %XX、'+'、无值参数、重复参数处理正确" << std::endl;
+    std::cout << "[通过] query 参数解码" << std::endl;
+}
+
+// 测试 3: 逐字节喂入，与一次性解析结果一致
+void test_incremental() {
+    std::cout << "\n[测试 3] 增量解析..." << std::endl;
+
+    const std::string raw =
+        "PUT /clipboard HTTP/1.1\r\n"
+        "content-length: 5\r\n"
+        "X-Test: yes\r\n"
+        "\r\n"
+        "hello";
+    HttpRequestParser parser(16 * 1024, 1024);
+    std::string buf;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        buf += raw[i];
+        Status s = parser.parse(buf);
+        if (i + 1 < raw.size()) {
+            assert(s == Status::NeedMore);
+        } else {
+            assert(s == Status::Complete);
+        }
+    }
+    auto req = parser.take(buf);
+    assert(req);
+    assert(buf.empty());
+    assert(req->method == "PUT");
+    assert(req->header("X-TEST") == "yes");
+    assert(req->body == "hello");
+    std::cout << "  ✓ 逐字节喂入后解析结果正确" << std::endl;
+    std::cout << "[通过] 增量解析" << std::endl;
+}
+
+// 测试 4: pipelining，剩余字节留在缓冲区
+void test_pipelining() {
+    std::cout << "\n[测试 4] pipelining..." << std::endl;
+
+    std::string buf =
+        "GET /health HTTP/1.1\r\n\r\n"
+        "POST /echo HTTP/1.1\r\nContent-Length: 2\r\n\r\nok"
+        "GET /part";
+    HttpRequestParser parser(16 * 1024, 1024);
+
+    assert(parser.parse(buf) == Status::Complete);
+    auto first = parser.take(buf);
+    assert(first->path == "/health" && first->body.empty());
+
+    assert(parser.parse(buf) == Status::Complete);
+    auto second = parser.take(buf);
+    assert(second->path == "/echo" && second->body == "ok");
+    assert(first->path == "/health");  // 前一个请求的 view 不受影响
+
+    assert(parser.parse(buf) == Status::NeedMore);
+    assert(buf == "GET /part");
+    std::cout << "  ✓ 连续请求逐个取出，不完整的请求保留" << std::endl;
+    std::cout << "[通过] pipelining" << std::endl;
+}
+
+// 测试 5: 错误与上限
+void test_errors() {
+    std::cout << "\n[测试 5] 错误请求..." << std::endl;
+
+    auto expect = [](const std::string& raw, int status, size_t maxHeader = 1024, size_t maxBody = 64) {
+        HttpRequestParser parser(maxHeader, maxBody);
+        std::string buf = raw;
+        assert(parser.parse(buf) == Status::Error);
+        assert(parser.errorStatus() == status);
+    };
+
+    expect("GARBAGE\r\n\r\n", 400);
+    expect("GET /x HTTP/2.0\r\n\r\n", 400);
+    expect("GET /x HTTP/1.1\r\nBad Header: 1\r\n\r\n", 400);
+    expect("GET /x HTTP/1.1\r\nNoColon\r\n\r\n", 400);
+    expect("POST /x HTTP/1.1\r\nContent-Length: 1a\r\n\r\n", 400);
+    expect("POST /x HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n", 400);
+    expect("POST /x HTTP/1.1\r\nContent-Length: 65\r\n\r\n", 413);
+    expect("POST /x HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", 501);
+    expect("GET /x HTTP/1.1\r\nX-Long: " + std::string(2000, 'a') + "\r\n\r\n", 431);
+    expect(std::string(2000, 'a'), 431);
+
+    // 重复但一致的 Content-Length 允许；请求行前的空行忽略
+    auto req = ParseHttpRequest("\r\nPOST /x HTTP/1.0\r\nContent-Length: 1\r\nContent-Length: 1\r\n\r\nz");
+    assert(req && req->version == "HTTP/1.0" && req->body == "z");
+
+    // LF 行尾也接受
+    req = ParseHttpRequest("GET /lf HTTP/1.1\nHost: a\n\n");
+    assert(req && req->path == "/lf" && req->header("host") == "a");
+    std::cout << "  ✓ 400/413/431/501 判定正确" << std::endl;
+    std::cout << "[通过] 错误请求" << std::endl;
+}
+
+// 测试 6: 只解析 header，body 由调用方接收
+void test_head_only() {
+    std::cout << "\n[测试 6] 只取 header..." << std::endl;
+
+    std::string buf =
+        "PUT /file?path=a.txt HTTP/1.1\r\n"
+        "Content-Length: 100000\r\n"
+        "Expect: 100-continue\r\n"
+        "\r\n"
+        "first";
+    HttpRequestParser parser(1024, 64);
+    assert(parser.parse(buf) == Status::Error && parser.errorStatus() == 413);  // parse() 仍按 body 上限拒绝
+
+    parser.reset();
+    assert(parser.parseHead(buf) == Status::Complete);  // parseHead() 不检查 body 上限
+    assert(parser.contentLength() == 100000);
+    auto head = parser.takeHead(buf);
+    assert(head && buf == "first");
+    assert(head->path == "/file" && head->queryParam("path") == "a.txt");
+    assert(head->header("expect") == "100-continue");
+    assert(head->body.empty() && head->bodyReader() == nullptr);
+
+    head->attachBody("0123456789");
+    assert(head->body == "0123456789");
+
+    // header 未完整时 NeedMore，错误与 parse() 一致
+    std::string partial = "GET /x HTTP/1.1\r\nHost: a\r\n";
+    assert(parser.parseHead(partial) == Status::NeedMore);
+    std::string chunked = "POST /x HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    parser.reset();
+    assert(parser.parseHead(chunked) == Status::Error && parser.errorStatus() == 501);
+    std::cout << "  ✓ header 取出后 body 留在缓冲区，body 上限交给调用方" << std::endl;
+    std::cout << "[通过] 只取 header" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[HttpRequest] 开始测试..." << std::endl;
+    test_basic_request();
+    test_query_decoding();
+    test_incremental();
+    test_pipelining();
+    test_errors();
+    test_head_only();
+    std::cout << "\n[通过] HttpRequest 全部测试" << std::endl;
+    return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * HttpResponse 单元测试
+ */
+#include "http/http_response.h"
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+
+// 测试 1: 状态行、header、Content-Length
+void test_basic_response() {
+    std::cout << "\n[测试 1] 序列化普通响应..." << std::endl;
+
+    HttpResponse r = MakeJsonResponse(404, "{\"error\":\"x\"}");
+    assert(r.status() == 404);
+    assert(r.contentLength() == 13);
+    assert(r.header("content-type") == "application/json");
+    assert(r.header("X-Missing").empty());
+    assert(r.toString() ==
+        "HTTP/1.1 404 Not Found\r\n"
+        "Content-Type: application/json\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Content-Length: 13\r\n"
+        "\r\n"
+        "{\"error\":\"x\"}");
+
+    r.setHeader("CONTENT-TYPE", "text/plain");
+    assert(r.header("Content-Type") == "text/plain");
+
+    HttpResponse empty(400);
+    assert(empty.toString() == "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n");
+    std::cout << "  ✓ 状态行、header 顺序与 Content-Length 正确" << std::endl;
+    std::cout << "[通过] 序列化普通响应" << std::endl;
+}
+
+// 测试 2: 多段 body，段直接引用，不拷贝
+void test_gather_parts() {
+    std::cout << "\n[测试 2] 多段 body..." << std::endl;
+
+    const char* path = "test_http_response_part.bin";
+    FILE* fp = fopen(path, "wb");
+    assert(fp);
+    fputs(std::string(200, 'x').c_str(), fp);
+    fclose(fp);
+    auto file = FileHandle::open(path);
+    assert(file && file->size() == 200);
+    char tail[16];
+    assert(file->readAt(195, tail, sizeof(tail)) == 5 && tail[0] == 'x');
+    assert(file->readAt(300, tail, sizeof(tail)) == 0);
+
+    auto shared = std::make_shared<const std::string>("world");
+    HttpResponse r(200);
+    r.appendBody("hello ");
+    r.appendBody(shared);
+    r.appendBody(std::string());
+    r.appendFile(file, 10, 100);
+    r.appendFile(file, 0, 0);
+    r.appendFile(nullptr, 0, 10);
+    assert(r.contentLength() == 111);
+
+    auto parts = r.serialize();
+    assert(parts.size() == 4);
+    assert(parts[0].data->find("Content-Length: 111\r\n\r\n") != std::string::npos);
+    assert(*parts[1].data == "hello ");
+    assert(parts[2].data.get() == shared.get());
+    assert(parts[3].isFile() && parts[3].fileOffset == 10 && parts[3].size() == 100);
+    assert(r.toString().find("hello world") != std::string::npos);
+    file.reset();
+    r = HttpResponse(304);
+    assert(r.toString() == "HTTP/1.1 304 Not Modified\r\n\r\n");  // 304 不带 Content-Length
+    remove(path);
+    std::cout << "  ✓ 内存块共享、空段跳过、文件区间计入长度，304 不写 Content-Length" << std::endl;
+    std::cout << "[通过] 多段 body" << std::endl;
+}
+
+// 测试 3: 冻结的固定响应
+void test_frozen() {
+    std::cout << "\n[测试 3] 预序列化响应..." << std::endl;
+
+    const HttpResponse& accepted = AcceptedResponse();
+    HttpResponse a = accepted;
+    HttpResponse b = accepted;
+    auto pa = a.serialize();
+    auto pb = b.serialize();
+    assert(pa[0].data.get() == pb[0].data.get());  // 共享同一份响应头
+    assert(a.toString() ==
+        "HTTP/1.1 202 Accepted\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n");
+
+    // 冻结后追加 header：单独写出，不影响共享部分
+    a.addHeader("Connection", "close");
+    assert(a.serialize()[0].data.get() == pb[0].data.get());
+    assert(a.toString() ==
+        "HTTP/1.1 202 Accepted\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Content-Length: 0\r\n"
+        "Connection: close\r\n"
+        "\r\n");
+    assert(b.header("Connection").empty());
+
+    // 修改已冻结的 header 或 body 会解除冻结
+    b.setHeader("Access-Control-Allow-Origin", "http://localhost");
+    b.setBody("ok");
+    assert(b.toString() ==
+        "HTTP/1.1 202 Accepted\r\n"
+        "Access-Control-Allow-Origin: http://localhost\r\n"
+        "Content-Length: 2\r\n"
+        "\r\n"
+        "ok");
+    assert(AcceptedResponse().header("Access-Control-Allow-Origin") == "*");
+    std::cout << "  ✓ 拷贝共享响应头，修改时自动解除冻结" << std::endl;
+    std::cout << "[通过] 预序列化响应" << std::endl;
+}
+
+// 测试 4: 流式响应
+void test_streaming() {
+    std::cout << "\n[测试 4] 流式响应..." << std::endl;
+
+    class StringSink : public HttpBodySink {
+    public:
+        bool write(std::string_view data) override {
+            out.append(data.data(), data.size());
+            return true;
+        }
+        std::string out;
+    };
+
+    HttpResponse r = MakeJsonStreamResponse([](HttpBodySink& sink) {
+        sink.write("[1,");
+        sink.write("2]");
+    });
+    assert(r.isStreaming());
+    assert(r.serialize().size() == 1);
+    assert(r.toString() ==
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/json\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n");
+
+    StringSink sink;
+    r.producer()(sink);
+    assert(sink.out == "[1,2]");
+
+    // setBody 取消流式，恢复 Content-Length
+    r.setBody(std::move(sink.out));
+    assert(!r.isStreaming());
+    assert(r.toString().find("Content-Length: 5\r\n") != std::string::npos);
+    assert(r.toString().find("Transfer-Encoding") == std::string::npos);
+    std::cout << "  ✓ chunked 响应头、producer 输出、回退为定长响应" << std::endl;
+    std::cout << "[通过] 流式响应" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[HttpResponse] 开始测试..." << std::endl;
+    test_basic_response();
+    test_gather_parts();
+    test_frozen();
+    test_streaming();
+    std::cout << "\n[通过] HttpResponse 全部测试" << std::endl;
+    return 0;
+}
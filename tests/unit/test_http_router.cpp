@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * HTTP 路由表单元测试
+ */
+#include "http/http_router.h"
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+static HttpResponse Reply(int status) {
+    return HttpResponse(status);
+}
+
+static int Dispatch(const HttpRouter& router, const char* method, const char* path) {
+    HttpRouteMatch m = router.match(method, path);
+    if (!m.route) return m.allow.empty() ? 404 : 405;
+    auto req = ParseHttpRequest(std::string(method) + " " + path + " HTTP/1.1\r\n\r\n");
+    assert(req);
+    return m.route->handler(*req).status();
+}
+
+static bool IsText(const HttpRequest& head) {
+    return head.header("content-type") == "text/plain";
+}
+
+// 测试 1: 精确路径与方法
+void test_exact() {
+    std::cout << "\n[测试 1] 精确路径与方法..." << std::endl;
+
+    HttpRouter router(1024);
+    router.add("", "/status", [](const HttpRequest&) { return Reply(200); });
+    router.add("GET", "/clipboard", [](const HttpRequest&) { return Reply(201); });
+    router.add("PUT", "/clipboard", [](const HttpRequest&) { return Reply(202); });
+    router.add("POST", "/execute", [](const HttpRequest&) { return Reply(203); });
+    router.add("", "/", [](const HttpRequest&) { return Reply(204); });
+    assert(router.size() == 5);
+
+    assert(Dispatch(router, "GET", "/status") == 200);
+    assert(Dispatch(router, "DELETE", "/status") == 200);
+    assert(Dispatch(router, "GET", "/clipboard") == 201);
+    assert(Dispatch(router, "PUT", "/clipboard") == 202);
+    assert(Dispatch(router, "POST", "/execute") == 203);
+    assert(Dispatch(router, "GET", "/") == 204);
+    assert(Dispatch(router, "GET", "/status/") == 404);
+    assert(Dispatch(router, "GET", "/nope") == 404);
+    std::cout << "  ✓ 任意方法、指定方法与根路径分别命中" << std::endl;
+
+    HttpRouteMatch m = router.match("GET", "/execute");
+    assert(!m.route && m.allow == "POST");
+    m = router.match("POST", "/clipboard");
+    assert(!m.route && m.allow == "GET, PUT");
+    std::cout << "  ✓ 方法不匹配返回 Allow: " << m.allow << std::endl;
+
+    bool threw = false;
+    try {
+        router.add("PUT", "/clipboard", [](const HttpRequest&) { return Reply(500); });
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "  ✓ 重复注册抛 logic_error" << std::endl;
+    std::cout << "[通过] 精确路径与方法" << std::endl;
+}
+
+// 测试 2: 前缀路径
+void test_prefix() {
+    std::cout << "\n[测试 2] 前缀路径..." << std::endl;
+
+    HttpRouter router(1024);
+    router.addPrefix("GET", "/clipboard/", [](const HttpRequest&) { return Reply(210); });
+    router.addPrefix("GET", "/clipboard/image/", [](const HttpRequest& r) {
+        return Reply(r.path.size() > 17 ? 211 : 400);
+    });
+    router.add("GET", "/clipboard/image/latest", [](const HttpRequest&) { return Reply(212); });
+
+    assert(Dispatch(router, "GET", "/clipboard/image/a.png") == 211);
+    assert(Dispatch(router, "GET", "/clipboard/image/") == 400);
+    assert(Dispatch(router, "GET", "/clipboard/file/b.txt") == 210);
+    assert(Dispatch(router, "GET", "/clipboard/image/sub/c.png") == 211);
+    assert(Dispatch(router, "GET", "/clipboard/image/latest") == 212);
+    assert(Dispatch(router, "GET", "/clipboard") == 404);
+    assert(Dispatch(router, "PUT", "/clipboard/image/a.png") == 405);
+    std::cout << "  ✓ 最长前缀优先，精确路径优先于前缀" << std::endl;
+
+    bool threw = false;
+    try {
+        router.addPrefix("GET", "/screenshot/file", [](const HttpRequest&) { return Reply(500); });
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "  ✓ 前缀必须以 '/' 结尾" << std::endl;
+    std::cout << "[通过] 前缀路径" << std::endl;
+}
+
+// 测试 3: 鉴权声明与请求体约定
+void test_policy() {
+    std::cout << "\n[测试 3] 鉴权与请求体约定..." << std::endl;
+
+    HttpRouter router(4096);
+    router.add("", "/health", [](const HttpRequest&) { return Reply(200); }).setPublic();
+    router.add("PUT", "/file", [](const HttpRequest&) { return Reply(200); }).setBody(1 << 30, true);
+    router.add("PUT", "/clipboard", [](const HttpRequest&) { return Reply(200); })
+        .setBody(1 << 20, false)
+        .setStreamBodyIf(IsText);
+    router.add("POST", "/mcp", [](const HttpRequest&) { return Reply(200); });
+
+    assert(router.match("GET", "/health").route->auth == RouteAuth::Public);
+    assert(router.match("POST", "/mcp").route->auth == RouteAuth::Token);
+
+    auto put = ParseHttpRequest("PUT /file?path=x HTTP/1.1\r\n\r\n");
+    HttpBodyPolicy policy = router.bodyPolicy(*put);
+    assert(policy.maxBytes == (1u << 30) && policy.streaming);
+
+    auto text = ParseHttpRequest("PUT /clipboard HTTP/1.1\r\nContent-Type: text/plain\r\n\r\n");
+    auto json = ParseHttpRequest("PUT /clipboard HTTP/1.1\r\nContent-Type: application/json\r\n\r\n");
+    policy = router.bodyPolicy(*text);
+    assert(policy.maxBytes == (1u << 20) && policy.streaming);
+    policy = router.bodyPolicy(*json);
+    assert(policy.maxBytes == (1u << 20) && !policy.streaming);
+
+    auto mcp = ParseHttpRequest("POST /mcp HTTP/1.1\r\n\r\n");
+    auto unknown = ParseHttpRequest("POST /unknown HTTP/1.1\r\n\r\n");
+    policy = router.bodyPolicy(*mcp);
+    assert(policy.maxBytes == 4096 && !policy.streaming);
+    policy = router.bodyPolicy(*unknown);
+    assert(policy.maxBytes == 4096 && !policy.streaming);
+    std::cout << "  ✓ 路由声明的上限与流式方式生效，其余使用默认上限" << std::endl;
+    std::cout << "[通过] 鉴权与请求体约定" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[HttpRouter] 开始测试..." << std::endl;
+    test_exact();
+    test_prefix();
+    test_policy();
+    std::cout << "\n[通过] HttpRouter 全部测试" << std::endl;
+    return 0;
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * 监听地址解析与监听 socket 单元测试
+ */
+#include "net/listen_socket.h"
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static socket_t ConnectTo(int family, const char* host, int port) {
+    socket_t s = socket(family, SOCK_STREAM, IPPROTO_TCP);
+    assert(s != kInvalidSocket);
+    sockaddr_storage addr{};
+    socklen_t len;
+    if (family == AF_INET6) {
+        auto* sin6 = reinterpret_cast<sockaddr_in6*>(&addr);
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons(static_cast<unsigned short>(port));
+        inet_pton(AF_INET6, host, &sin6->sin6_addr);
+        len = sizeof(sockaddr_in6);
+    } else {
+        auto* sin = reinterpret_cast<sockaddr_in*>(&addr);
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(static_cast<unsigned short>(port));
+        inet_pton(AF_INET, host, &sin->sin_addr);
+        len = sizeof(sockaddr_in);
+    }
+    if (connect(s, reinterpret_cast<sockaddr*>(&addr), len) != 0) {
+        CloseSocket(s);
+        return kInvalidSocket;
+    }
+    return s;
+}
+
+// 测试 1: 地址列表解析
+void test_parse() {
+    std::cout << "\n[测试 1] 解析 listen_address..." << std::endl;
+
+    std::vector<ListenEndpoint> eps = ParseListenAddresses("0.0.0.0");
+    assert(eps.size() == 1 && eps[0].family == AF_INET && eps[0].host == "0.0.0.0");
+
+    std::vector<std::string> invalid;
+    eps = ParseListenAddresses(" 127.0.0.1 , [::1], 192.168.1.10,127.0.0.1, localhost,", &invalid);
+    assert(eps.size() == 3);
+    assert(eps[0].host == "127.0.0.1" && eps[0].family == AF_INET);
+    assert(eps[1].host == "::1" && eps[1].family == AF_INET6 && !eps[1].dualStack);
+    assert(eps[2].host == "192.168.1.10");
+    assert(invalid.size() == 1 && invalid[0] == "localhost");
+    std::cout << "  ✓ 逗号分隔、去重、方括号 IPv6、无效条目单独返回" << std::endl;
+
+    // 双栈任意地址覆盖 0.0.0.0
+    eps = ParseListenAddresses("0.0.0.0,*,0:0::0");
+    assert(eps.size() == 1 && eps[0].host == "::" && eps[0].dualStack);
+    std::cout << "  ✓ \"*\" / \"::\" 为双栈，并吸收 0.0.0.0" << std::endl;
+
+    // 全部无效时回退 0.0.0.0
+    invalid.clear();
+    eps = ParseListenAddresses("not-an-ip", &invalid);
+    assert(eps.size() == 1 && eps[0].host == "0.0.0.0" && invalid.size() == 1);
+    eps = ParseListenAddresses("");
+    assert(eps.size() == 1 && eps[0].host == "0.0.0.0");
+    std::cout << "  ✓ 没有有效地址时回退 0.0.0.0" << std::endl;
+    std::cout << "[通过] 解析 listen_address" << std::endl;
+}
+
+// 测试 2: 监听回环地址并连接
+void test_open_and_connect() {
+    std::cout << "\n[测试 2] 打开监听 socket..." << std::endl;
+
+    ListenEndpoint ep = ParseListenAddresses("127.0.0.1")[0];
+    int err = 0;
+    socket_t listener = OpenListenSocket(ep, 0, ListenOptions(), err);
+    assert(listener != kInvalidSocket && err == 0);
+    int port = GetLocalPort(listener);
+    assert(port > 0);
+
+    socket_t client = ConnectTo(AF_INET, "127.0.0.1", port);
+    assert(client != kInvalidSocket);
+    socket_t accepted = accept(listener, nullptr, nullptr);
+    assert(accepted != kInvalidSocket);
+    assert(GetPeerAddress(accepted) == "127.0.0.1");
+    std::cout << "  ✓ " << ep.describe(port) << " 接受连接" << std::endl;
+
+    // 未开启 reusePort 时同一端口不能再绑定
+    socket_t second = OpenListenSocket(ep, port, ListenOptions(), err);
+    assert(second == kInvalidSocket && err != 0);
+    std::cout << "  ✓ 重复绑定失败 err=" << err << std::endl;
+
+    CloseSocket(accepted);
+    CloseSocket(client);
+    CloseSocket(listener);
+    std::cout << "[通过] 打开监听 socket" << std::endl;
+}
+
+// 测试 3: 双栈监听接受 IPv4 连接，对端地址按 IPv4 返回
+void test_dual_stack() {
+    std::cout << "\n[测试 3] IPv6 双栈..." << std::endl;
+
+    ListenEndpoint ep = ParseListenAddresses("::")[0];
+    int err = 0;
+    socket_t listener = OpenListenSocket(ep, 0, ListenOptions(), err);
+    if (listener == kInvalidSocket) {
+        std::cout << "  - 系统不支持 IPv6（err=" << err << "），跳过" << std::endl;
+        return;
+    }
+    int port = GetLocalPort(listener);
+
+    socket_t client = ConnectTo(AF_INET, "127.0.0.1", port);
+    assert(client != kInvalidSocket);
+    socket_t accepted = accept(listener, nullptr, nullptr);
+    assert(accepted != kInvalidSocket);
+    assert(GetPeerAddress(accepted) == "127.0.0.1");
+    CloseSocket(accepted);
+    CloseSocket(client);
+
+    socket_t client6 = ConnectTo(AF_INET6, "::1", port);
+    if (client6 != kInvalidSocket) {
+        accepted = accept(listener, nullptr, nullptr);
+        assert(accepted != kInvalidSocket);
+        assert(GetPeerAddress(accepted) == "::1");
+        CloseSocket(accepted);
+        CloseSocket(client6);
+    }
+    CloseSocket(listener);
+    std::cout << "  ✓ " << ep.describe(port) << " 同时接受 IPv4 和 IPv6 连接" << std::endl;
+    std::cout << "[通过] IPv6 双栈" << std::endl;
+}
+
+// 测试 4: SO_REUSEPORT 分片监听
+void test_reuse_port() {
+    std::cout << "\n[测试 4] SO_REUSEPORT..." << std::endl;
+    if (!SupportsReusePort()) {
+        std::cout << "  - 当前平台不支持，跳过" << std::endl;
+        return;
+    }
+
+    ListenEndpoint ep = ParseListenAddresses("127.0.0.1")[0];
+    ListenOptions options;
+    options.reusePort = true;
+    int err = 0;
+    socket_t a = OpenListenSocket(ep, 0, options, err);
+    assert(a != kInvalidSocket);
+    int port = GetLocalPort(a);
+    socket_t b = OpenListenSocket(ep, port, options, err);
+    assert(b != kInvalidSocket && GetLocalPort(b) == port);
+
+    // 内核按四元组哈希分摊，连接足够多时两个 socket 都会分到
+    SetNonBlocking(a);
+    SetNonBlocking(b);
+    std::vector<socket_t> clients;
+    for (int i = 0; i < 64; ++i) {
+        socket_t c = ConnectTo(AF_INET, "127.0.0.1", port);
+        assert(c != kInvalidSocket);
+        clients.push_back(c);
+    }
+    int acceptedA = 0, acceptedB = 0;
+    for (socket_t s; (s = accept(a, nullptr, nullptr)) != kInvalidSocket; ++acceptedA) CloseSocket(s);
+    for (socket_t s; (s = accept(b, nullptr, nullptr)) != kInvalidSocket; ++acceptedB) CloseSocket(s);
+    assert(acceptedA + acceptedB == 64);
+    assert(acceptedA > 0 && acceptedB > 0);
+    for (socket_t c : clients) CloseSocket(c);
+    CloseSocket(a);
+    CloseSocket(b);
+    std::cout << "  ✓ 64 个连接分到两个监听 socket: " << acceptedA << " / " << acceptedB << std::endl;
+    std::cout << "[通过] SO_REUSEPORT" << std::endl;
+}
+
+int main() {
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+    std::cout << "\n[ListenSocket] 开始测试..." << std::endl;
+    test_parse();
+    test_open_and_connect();
+    test_dual_stack();
+    test_reuse_port();
+    std::cout << "\n[通过] ListenSocket 全部测试" << std::endl;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return 0;
+}
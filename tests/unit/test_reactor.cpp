@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * Reactor / IoBackend 单元测试（Windows 上走 IOCP，Linux 上走 epoll）
+ */
+#include "net/reactor.h"
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// 回显服务器：每个连接读到什么就写回什么
+class EchoConnection : public IoHandler {
+public:
+    EchoConnection(Reactor& reactor, socket_t sock) : reactor_(reactor) {
+        channel_ = reactor_.backend().addSocket(sock, this);
+        assert(channel_);
+        reactor_.backend().startRecv(channel_);
+    }
+
+    void onIoComplete(const IoResult& r) override {
+        if (r.op == IoOp::Recv) {
+            if (r.error || r.bytes == 0) {
+                reactor_.backend().close(channel_);
+                return;
+            }
+            reactor_.backend().startSend(channel_, std::string(r.data, r.bytes));
+        } else if (r.op == IoOp::Send) {
+            if (r.error) {
+                reactor_.backend().close(channel_);
+                return;
+            }
+            reactor_.backend().startRecv(channel_);
+        }
+    }
+
+private:
+    Reactor& reactor_;
+    IoChannel* channel_ = nullptr;
+};
+
+class EchoListener : public IoHandler {
+public:
+    explicit EchoListener(Reactor& reactor) : reactor_(reactor) {}
+    void onIoComplete(const IoResult& r) override {
+        if (r.op == IoOp::Accept && !r.error) {
+            conns_.emplace_back(new EchoConnection(reactor_, r.accepted));
+            accepted++;
+        }
+    }
+    int accepted = 0;
+
+private:
+    Reactor& reactor_;
+    std::vector<std::unique_ptr<EchoConnection>> conns_;
+};
+
+static socket_t MakeListener(int& port) {
+    socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    assert(s != kInvalidSocket);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    assert(bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    assert(listen(s, SOMAXCONN) == 0);
+    socklen_t len = sizeof(addr);
+    getsockname(s, reinterpret_cast<sockaddr*>(&addr), &len);
+    port = ntohs(addr.sin_port);
+    return s;
+}
+
+static socket_t Connect(int port) {
+    socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<unsigned short>(port));
+    assert(connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    return s;
+}
+
+static std::string RecvExactly(socket_t s, size_t n) {
+    std::string out;
+    char buf[4096];
+    while (out.size() < n) {
+        int r = recv(s, buf, static_cast<int>(sizeof(buf)), 0);
+        if (r <= 0) break;
+        out.append(buf, r);
+    }
+    return out;
+}
+
+// 测试 1: 多个客户端并发回显（包括大于一次读缓冲的数据）
+void test_echo() {
+    std::cout << "\n[测试 1] 多连接回显..." << std::endl;
+
+    auto backend = CreateIoBackend();
+    assert(backend);
+    std::cout << "  后端: " << backend->name() << std::endl;
+
+    Reactor reactor(std::move(backend));
+    EchoListener listener(reactor);
+    int port = 0;
+    socket_t ls = MakeListener(port);
+    assert(reactor.backend().addListener(ls, &listener));
+
+    std::thread loop([&reactor]() { reactor.run(); });
+
+    const int kClients = 8;
+    std::vector<std::thread> clients;
+    std::atomic<int> ok{0};
+    for (int i = 0; i < kClients; ++i) {
+        clients.emplace_back([port, i, &ok]() {
+            socket_t s = Connect(port);
+            for (int round = 0; round < 5; ++round) {
+                std::string msg(100000 + i * 10 + round, static_cast<char>('a' + i));
+                size_t sent = 0;
+                while (sent < msg.size()) {
+                    int n = send(s, msg.data() + sent, static_cast<int>(msg.size() - sent), 0);
+                    assert(n > 0);
+                    sent += static_cast<size_t>(n);
+                }
+                std::string echoed = RecvExactly(s, msg.size());
+                assert(echoed == msg);
+            }
+            CloseSocket(s);
+            ok.fetch_add(1);
+        });
+    }
+    for (auto& t : clients) t.join();
+    assert(ok.load() == kClients);
+    std::cout << "  ✓ " << kClients << " 个客户端各 5 轮 100KB 回显正确" << std::endl;
+
+    reactor.stop();
+    loop.join();
+    std::cout << "[通过] 多连接回显" << std::endl;
+}
+
+// 测试 2: post() 跨线程投递与 tick
+void test_post_and_tick() {
+    std::cout << "\n[测试 2] 跨线程投递与周期 tick..." << std::endl;
+
+    Reactor reactor(CreateIoBackend());
+    std::atomic<int> ticks{0};
+    std::atomic<int> posted{0};
+    std::atomic<bool> onLoopThread{true};
+    reactor.setTick(10, [&]() { ticks.fetch_add(1); });
+
+    std::thread loop([&reactor]() { reactor.run(); });
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; ++p) {
+        producers.emplace_back([&]() {
+            for (int i = 0; i < 1000; ++i) {
+                reactor.post([&]() {
+                    if (!reactor.inReactorThread()) onLoopThread.store(false);
+                    posted.fetch_add(1);
+                });
+            }
+        });
+    }
+    for (auto& t : producers) t.join();
+
+    while (posted.load() < 4000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    reactor.stop();
+    loop.join();
+
+    assert(onLoopThread.load());
+    assert(ticks.load() >= 3);
+    std::cout << "  ✓ 4000 个任务全部在 reactor 线程执行，tick " << ticks.load() << " 次" << std::endl;
+    std::cout << "[通过] 跨线程投递与周期 tick" << std::endl;
+}
+
+// 测试 3: startSendFile（sendfile / TransmitFile）先写 head 再写文件区间
+class FileSender : public IoHandler {
+public:
+    FileSender(Reactor& reactor, std::shared_ptr<FileHandle> file) : reactor_(reactor), file_(std::move(file)) {}
+    void onIoComplete(const IoResult& r) override {
+        if (r.op == IoOp::Accept && !r.error) {
+            channel_ = reactor_.backend().addSocket(r.accepted, this);
+            std::vector<IoBuffer> head;
+            head.push_back(std::make_shared<const std::string>("HEAD:"));
+            head.push_back(std::make_shared<const std::string>("ok|"));
+            reactor_.backend().startSendFile(channel_, std::move(head), file_->native(), 1000, file_->size() - 1000);
+        } else if (r.op == IoOp::Send) {
+            sentBytes = r.bytes;
+            sendError = r.error;
+            reactor_.backend().close(channel_);
+        }
+    }
+    std::atomic<size_t> sentBytes{0};
+    std::atomic<int> sendError{-1};
+
+private:
+    Reactor& reactor_;
+    std::shared_ptr<FileHandle> file_;
+    IoChannel* channel_ = nullptr;
+};
+
+void test_send_file() {
+    std::cout << "\n[测试 3] 零拷贝发送文件区间..." << std::endl;
+
+    const char* path = "test_reactor_sendfile.bin";
+    std::string content;
+    for (int i = 0; i < 3 * 1024 * 1024; ++i) content += static_cast<char>('0' + i % 10);
+    FILE* fp = fopen(path, "wb");
+    assert(fp);
+    fwrite(content.data(), 1, content.size(), fp);
+    fclose(fp);
+
+    auto file = FileHandle::open(path);
+    assert(file && file->size() == content.size());
+
+    Reactor reactor(CreateIoBackend());
+    FileSender sender(reactor, file);
+    int port = 0;
+    socket_t ls = MakeListener(port);
+    assert(reactor.backend().addListener(ls, &sender));
+    std::thread loop([&reactor]() { reactor.run(); });
+
+    socket_t s = Connect(port);
+    std::string expected = "HEAD:ok|" + content.substr(1000);
+    std::string received = RecvExactly(s, expected.size());
+    CloseSocket(s);
+    assert(received == expected);
+    while (sender.sendError.load() < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    assert(sender.sendError.load() == 0);
+    assert(sender.sentBytes.load() == expected.size());
+
+    reactor.stop();
+    loop.join();
+    file.reset();
+    remove(path);
+    std::cout << "  ✓ head + 3MB 文件区间完整到达，完成字节数正确" << std::endl;
+    std::cout << "[通过] 零拷贝发送文件区间" << std::endl;
+}
+
+// 测试 4: 定时器按到期顺序触发，取消的不触发，不依赖 tick
+void test_timers() {
+    std::cout << "\n[测试 4] reactor 定时器..." << std::endl;
+
+    Reactor reactor(CreateIoBackend());
+    std::vector<int> order;
+    std::atomic<bool> done{false};
+    auto start = std::chrono::steady_clock::now();
+    long long elapsedMs = 0;
+
+    reactor.post([&]() {
+        reactor.addTimer(60, [&]() {
+            order.push_back(3);
+            elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            done.store(true);
+        });
+        reactor.addTimer(20, [&]() { order.push_back(1); });
+        Reactor::TimerId cancelled = reactor.addTimer(30, [&]() { order.push_back(99); });
+        reactor.addTimer(40, [&]() { order.push_back(2); });
+        reactor.cancelTimer(cancelled);
+        reactor.cancelTimer(0);
+    });
+
+    std::thread loop([&reactor]() { reactor.run(); });
+    while (!done.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    reactor.stop();
+    loop.join();
+
+    assert((order == std::vector<int>{1, 2, 3}));
+    assert(elapsedMs >= 60 && elapsedMs < 1000);
+    std::cout << "  ✓ 无 tick 时按定时器唤醒，" << elapsedMs << "ms 后最后一个触发" << std::endl;
+    std::cout << "[通过] reactor 定时器" << std::endl;
+}
+
+int main() {
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+    std::cout << "\n[Reactor] 开始测试..." << std::endl;
+    test_echo();
+    test_post_and_tick();
+    test_send_file();
+    test_timers();
+    std::cout << "\n[通过] Reactor 全部测试" << std::endl;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return 0;
+}
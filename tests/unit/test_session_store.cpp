@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * McpSessionStore 单元测试（句柄、LRU 淘汰、空闲超时、存活时间、并发）
+ */
+#include "mcp/session_store.h"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+void AppendHttpServerLogA(const std::string&) {}
+
+class RecordingWriter : public SseStreamWriter {
+public:
+    bool write(const std::string&) override { return !closed; }
+    void close() override { closed = true; }
+    bool closed = false;
+};
+
+static void SleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static void Reset(const McpSessionStore::Limits& limits = McpSessionStore::Limits()) {
+    McpSessionStore::getInstance().clear();
+    McpSessionStore::getInstance().configure(limits);
+}
+
+static void testHandles() {
+    std::cout << "\n[测试 1] 查找返回句柄，移除后句柄仍有效..." << std::endl;
+    Reset();
+    McpSessionStore& store = McpSessionStore::getInstance();
+    std::string id = store.createSession("2024-11-05");
+    assert(id.size() == 32);
+
+    McpSessionHandle session = store.findSession(id);
+    assert(session && session->sessionId == id && !session->initialized.load());
+    assert(store.markInitialized(id) && session->initialized.load());
+    assert(store.eventLog(id) == session->events);
+    assert(!store.findSession("missing") && !store.markInitialized("missing"));
+
+    store.removeSession(id);
+    assert(!store.findSession(id));
+    assert(session->protocolVersion == "2024-11-05");  // 句柄仍持有 session
+    assert(session->events->closed());
+    assert(store.stats().sessions == 0);
+    std::cout << "  ✓ 句柄持有 session，移除时关闭事件日志" << std::endl;
+}
+
+static void testLruEviction() {
+    std::cout << "\n[测试 2] 数量上限与 LRU 淘汰..." << std::endl;
+    McpSessionStore::Limits limits;
+    limits.maxSessions = 32;  // 每个分片 2 个
+    Reset(limits);
+    McpSessionStore& store = McpSessionStore::getInstance();
+    McpSessionStore::Stats before = store.stats();  // 计数是累计的
+
+    std::string hot = store.createSession("2024-11-05");
+    for (int i = 0; i < 100; ++i) {
+        SleepMs(2);
+        assert(store.findSession(hot));  // 一直在用的 session 不会被淘汰
+        store.createSession("2024-11-05");
+        assert(store.stats().sessions <= 32);
+    }
+    McpSessionStore::Stats stats = store.stats();
+    assert(store.findSession(hot));
+    uint64_t evicted = stats.evicted - before.evicted;
+    assert(stats.created - before.created == 101);
+    assert(evicted == 101 - stats.sessions);
+    assert(evicted >= 101 - 32);
+    std::cout << "  ✓ 淘汰 " << evicted << " 个，保留 " << stats.sessions << " 个" << std::endl;
+}
+
+static void testIdleTimeout() {
+    std::cout << "\n[测试 3] 空闲超时；有 GET 事件流的 session 不算空闲..." << std::endl;
+    McpSessionStore::Limits limits;
+    limits.idleTimeoutMs = 50;
+    Reset(limits);
+    McpSessionStore& store = McpSessionStore::getInstance();
+    uint64_t expiredBefore = store.stats().expired;
+
+    std::string idle = store.createSession("2024-11-05");
+    std::string listening = store.createSession("2024-11-05");
+    std::shared_ptr<McpEventLog> idleEvents = store.eventLog(idle);
+    auto writer = std::make_shared<RecordingWriter>();
+    assert(store.eventLog(listening)->attach(writer, ""));
+
+    SleepMs(80);
+    assert(!store.findSession(idle));
+    assert(idleEvents->closed());
+    assert(store.findSession(listening) && !writer->closed);
+    assert(store.stats().expired == expiredBefore + 1);
+
+    // 创建 session 时清理同一分片中过期的 session：最终数量不超过仍在使用的
+    for (int i = 0; i < 64; ++i) store.createSession("2024-11-05");
+    SleepMs(80);
+    for (int i = 0; i < 64; ++i) store.createSession("2024-11-05");
+    assert(store.stats().sessions <= 64 + 1 + 16);
+    std::cout << "  ✓ 空闲 session 移除，事件流保活" << std::endl;
+}
+
+static void testTtl() {
+    std::cout << "\n[测试 4] 最长存活时间..." << std::endl;
+    McpSessionStore::Limits limits;
+    limits.ttlMs = 60;
+    Reset(limits);
+    McpSessionStore& store = McpSessionStore::getInstance();
+
+    std::string id = store.createSession("2024-11-05");
+    for (int i = 0; i < 3; ++i) {
+        assert(store.findSession(id));
+        SleepMs(10);
+    }
+    SleepMs(60);
+    assert(!store.findSession(id));  // 一直在用也到期
+    std::cout << "  ✓ 到期后移除" << std::endl;
+}
+
+static void testConcurrentAccess() {
+    std::cout << "\n[测试 5] 并发创建 / 查找 / 移除..." << std::endl;
+    McpSessionStore::Limits limits;
+    limits.maxSessions = 64;
+    Reset(limits);
+    McpSessionStore& store = McpSessionStore::getInstance();
+    uint64_t createdBefore = store.stats().created;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&store, t]() {
+            std::vector<std::string> mine;
+            for (int i = 0; i < 500; ++i) {
+                mine.push_back(store.createSession("2024-11-05"));
+                McpSessionHandle session = store.findSession(mine[i / 2]);
+                if (session) session->initialized.store(true);
+                if (i % 3 == t % 3) store.removeSession(mine[i]);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    McpSessionStore::Stats stats = store.stats();
+    assert(stats.created - createdBefore == 8 * 500);
+    assert(stats.sessions <= 64);
+    store.clear();
+    assert(store.stats().sessions == 0);
+    std::cout << "  ✓ 数量不超过上限" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[McpSessionStore] 开始测试..." << std::endl;
+
+    testHandles();
+    testLruEviction();
+    testIdleTimeout();
+    testTtl();
+    testConcurrentAccess();
+
+    std::cout << "\n[通过] McpSessionStore 测试全部通过" << std::endl;
+    return 0;
+}
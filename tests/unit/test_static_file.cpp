@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * 静态文件（ETag / 304 / Range / MIME）单元测试
+ */
+#include "http/static_file.h"
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+
+static const char* kTestFile = "test_static_file.png";
+
+static HttpResponse Get(const std::string& extraHeaders) {
+    auto req = ParseHttpRequest("GET /screenshot/file/x HTTP/1.1\r\n" + extraHeaders + "\r\n");
+    assert(req);
+    return ServeFile(*req, kTestFile);
+}
+
+// 测试 1: MIME 与 HTTP 日期
+void test_mime_and_date() {
+    std::cout << "\n[测试 1] MIME 与 HTTP 日期..." << std::endl;
+
+    assert(std::string(GuessMimeType("a.PNG")) == "image/png");
+    assert(std::string(GuessMimeType("shot.jpeg")) == "image/jpeg");
+    assert(std::string(GuessMimeType("report.pdf")) == "application/pdf");
+    assert(std::string(GuessMimeType("noext")) == "application/octet-stream");
+    assert(std::string(GuessMimeType("archive.tar.unknown")) == "application/octet-stream");
+
+    assert(FormatHttpDate(784111777) == "Sun, 06 Nov 1994 08:49:37 GMT");
+    assert(FormatHttpDate(0) == "Thu, 01 Jan 1970 00:00:00 GMT");
+    assert(FormatHttpDate(1709251199) == "Thu, 29 Feb 2024 23:59:59 GMT");
+    int64_t t = 0;
+    assert(ParseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", t) && t == 784111777);
+    assert(ParseHttpDate(FormatHttpDate(1709251199), t) && t == 1709251199);
+    assert(!ParseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT", t));
+    assert(!ParseHttpDate("Sun, 06 Foo 1994 08:49:37 GMT", t));
+    std::cout << "  ✓ 扩展名识别、IMF-fixdate 格式化与解析正确" << std::endl;
+    std::cout << "[通过] MIME 与 HTTP 日期" << std::endl;
+}
+
+// 测试 2: Range 解析
+void test_byte_range() {
+    std::cout << "\n[测试 2] Range 解析..." << std::endl;
+
+    uint64_t off = 0, len = 0;
+    assert(ParseByteRange("bytes=0-99", 1000, off, len) == 1 && off == 0 && len == 100);
+    assert(ParseByteRange("bytes=900-", 1000, off, len) == 1 && off == 900 && len == 100);
+    assert(ParseByteRange("bytes=-10", 1000, off, len) == 1 && off == 990 && len == 10);
+    assert(ParseByteRange("bytes=-5000", 1000, off, len) == 1 && off == 0 && len == 1000);
+    assert(ParseByteRange("bytes=500-5000", 1000, off, len) == 1 && off == 500 && len == 500);
+    assert(ParseByteRange("bytes=1000-", 1000, off, len) == 0);
+    assert(ParseByteRange("bytes=-0", 1000, off, len) == 0);
+    assert(ParseByteRange("bytes=0-1,5-6", 1000, off, len) == -1);
+    assert(ParseByteRange("bytes=5-1", 1000, off, len) == -1);
+    assert(ParseByteRange("items=0-1", 1000, off, len) == -1);
+    assert(ParseByteRange("bytes=a-b", 1000, off, len) == -1);
+    std::cout << "  ✓ 普通/开放/后缀区间、416 与忽略的情况判定正确" << std::endl;
+    std::cout << "[通过] Range 解析" << std::endl;
+}
+
+// 测试 3: ServeFile 的 200 / 304 / 206 / 416 / 404
+void test_serve_file() {
+    std::cout << "\n[测试 3] ServeFile..." << std::endl;
+
+    FILE* fp = fopen(kTestFile, "wb");
+    assert(fp);
+    for (int i = 0; i < 1000; ++i) fputc('a' + i % 26, fp);
+    fclose(fp);
+
+    HttpResponse full = Get("");
+    assert(full.status() == 200);
+    assert(full.contentLength() == 1000);
+    assert(full.header("Content-Type") == "image/png");
+    assert(full.header("Accept-Ranges") == "bytes");
+    std::string etag(full.header("ETag"));
+    std::string lastModified(full.header("Last-Modified"));
+    assert(etag.size() > 2 && etag.front() == '"');
+    assert(full.body().size() == 1 && full.body()[0].isFile());
+
+    // 条件请求
+    HttpResponse notModified = Get("If-None-Match: \"other\", " + etag + "\r\n");
+    assert(notModified.status() == 304 && notModified.contentLength() == 0);
+    assert(notModified.header("ETag") == etag);
+    assert(Get("If-None-Match: W/" + etag + "\r\n").status() == 304);
+    assert(Get("If-None-Match: \"other\"\r\n").status() == 200);
+    assert(Get("If-Modified-Since: " + lastModified + "\r\n").status() == 304);
+    assert(Get("If-Modified-Since: Thu, 01 Jan 1970 00:00:00 GMT\r\n").status() == 200);
+    // If-None-Match 优先于 If-Modified-Since
+    assert(Get("If-None-Match: \"other\"\r\nIf-Modified-Since: " + lastModified + "\r\n").status() == 200);
+
+    // Range
+    HttpResponse partial = Get("Range: bytes=100-199\r\n");
+    assert(partial.status() == 206);
+    assert(partial.contentLength() == 100);
+    assert(partial.header("Content-Range") == "bytes 100-199/1000");
+    assert(partial.body()[0].fileOffset == 100);
+
+    HttpResponse unsatisfiable = Get("Range: bytes=5000-\r\n");
+    assert(unsatisfiable.status() == 416);
+    assert(unsatisfiable.header("Content-Range") == "bytes */1000");
+
+    assert(Get("Range: bytes=0-1,5-6\r\n").status() == 200);
+    assert(Get("Range: bytes=0-9\r\nIf-Range: " + etag + "\r\n").status() == 206);
+    assert(Get("Range: bytes=0-9\r\nIf-Range: \"stale\"\r\n").status() == 200);
+    assert(Get("Range: bytes=0-9\r\nIf-Range: " + lastModified + "\r\n").status() == 206);
+
+    auto req = ParseHttpRequest("GET /x HTTP/1.1\r\n\r\n");
+    assert(ServeFile(*req, "no_such_file.png").status() == 404);
+
+    full = HttpResponse();
+    partial = HttpResponse();
+    remove(kTestFile);
+    std::cout << "  ✓ ETag/Last-Modified、304、206、416、404 处理正确" << std::endl;
+    std::cout << "[通过] ServeFile" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[StaticFile] 开始测试..." << std::endl;
+    test_mime_and_date();
+    test_byte_range();
+    test_serve_file();
+    std::cout << "\n[通过] StaticFile 全部测试" << std::endl;
+    return 0;
+}
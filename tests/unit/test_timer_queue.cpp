@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * TimerQueue 单元测试
+ */
+#include "net/timer_queue.h"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using Clock = TimerQueue::Clock;
+using std::chrono::milliseconds;
+
+// 测试 1: 按到期时间顺序触发，同一时刻按添加顺序
+void test_ordering() {
+    std::cout << "\n[测试 1] 触发顺序..." << std::endl;
+
+    TimerQueue q;
+    Clock::time_point t0 = Clock::now();
+    std::vector<int> fired;
+    q.schedule(t0 + milliseconds(30), [&]() { fired.push_back(3); });
+    q.schedule(t0 + milliseconds(10), [&]() { fired.push_back(1); });
+    q.schedule(t0 + milliseconds(20), [&]() { fired.push_back(2); });
+    q.schedule(t0 + milliseconds(20), [&]() { fired.push_back(22); });
+    assert(q.size() == 4);
+
+    assert(q.runExpired(t0) == 0);
+    assert(q.runExpired(t0 + milliseconds(20)) == 3);
+    assert((fired == std::vector<int>{1, 2, 22}));
+    assert(q.runExpired(t0 + milliseconds(100)) == 1);
+    assert(fired.back() == 3 && q.empty());
+    std::cout << "  ✓ 未到期不触发，到期按时间和添加顺序触发" << std::endl;
+    std::cout << "[通过] 触发顺序" << std::endl;
+}
+
+// 测试 2: 取消与 msUntilNext
+void test_cancel() {
+    std::cout << "\n[测试 2] 取消定时器..." << std::endl;
+
+    TimerQueue q;
+    Clock::time_point t0 = Clock::now();
+    assert(q.msUntilNext(t0) == -1);
+
+    int fired = 0;
+    TimerQueue::TimerId a = q.schedule(t0 + milliseconds(5), [&]() { fired += 1; });
+    TimerQueue::TimerId b = q.schedule(t0 + milliseconds(50), [&]() { fired += 10; });
+    assert(a != 0 && b != 0 && a != b);
+    assert(q.msUntilNext(t0) == 5);
+
+    assert(q.cancel(a));
+    assert(!q.cancel(a));        // 重复取消
+    assert(!q.cancel(12345));    // 不存在
+    assert(q.msUntilNext(t0) == 50);  // 堆顶的已取消条目被跳过
+    assert(q.msUntilNext(t0 + milliseconds(60)) == 0);
+
+    assert(q.runExpired(t0 + milliseconds(60)) == 1);
+    assert(fired == 10);
+    assert(!q.cancel(b));        // 已触发
+    assert(q.msUntilNext(t0) == -1);
+
+    // 大量取消后重建堆，剩余定时器不受影响
+    std::vector<TimerQueue::TimerId> ids;
+    for (int i = 0; i < 1000; ++i) {
+        ids.push_back(q.schedule(t0 + milliseconds(1000 + i), [&]() { fired += 100; }));
+    }
+    for (int i = 0; i < 999; ++i) q.cancel(ids[i]);
+    assert(q.size() == 1);
+    assert(q.msUntilNext(t0) == 1999);
+    assert(q.runExpired(t0 + milliseconds(5000)) == 1 && fired == 110);
+    std::cout << "  ✓ 取消的定时器不触发，msUntilNext 跳过失效条目" << std::endl;
+    std::cout << "[通过] 取消定时器" << std::endl;
+}
+
+// 测试 3: 回调中重新调度、取消其他定时器
+void test_reentrant() {
+    std::cout << "\n[测试 3] 回调中操作队列..." << std::endl;
+
+    TimerQueue q;
+    Clock::time_point t0 = Clock::now();
+    int rounds = 0;
+    int victimFired = 0;
+    TimerQueue::TimerId victim = q.schedule(t0 + milliseconds(10), [&]() { victimFired++; });
+
+    std::function<void()> rearm = [&]() {
+        rounds++;
+        if (rounds < 3) q.schedule(t0 + milliseconds(rounds), rearm);  // 已到期，本轮继续触发
+    };
+    q.schedule(t0, [&]() {
+        q.cancel(victim);
+        rearm();
+    });
+
+    assert(q.runExpired(t0 + milliseconds(20)) == 3);
+    assert(rounds == 3 && victimFired == 0 && q.empty());
+    std::cout << "  ✓ 回调内添加的已到期定时器同轮触发，取消立即生效" << std::endl;
+    std::cout << "[通过] 回调中操作队列" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[TimerQueue] 开始测试..." << std::endl;
+    test_ordering();
+    test_cancel();
+    test_reentrant();
+    std::cout << "\n[通过] TimerQueue 全部测试" << std::endl;
+    return 0;
+}
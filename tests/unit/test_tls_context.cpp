@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * TLS 会话（内存 BIO）单元测试：握手、收发、会话恢复、握手统计
+ */
+#include "net/tls_context.h"
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#ifdef CLAWDESK_OPENSSL_ENABLED
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+static const char* kCertFile = "test_tls_cert.pem";
+static const char* kKeyFile = "test_tls_key.pem";
+
+// 生成自签名 P-256 证书
+static void WriteSelfSignedCert() {
+    EVP_PKEY_CTX* kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    EVP_PKEY* key = nullptr;
+    assert(kctx && EVP_PKEY_keygen_init(kctx) == 1);
+    assert(EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx, NID_X9_62_prime256v1) == 1);
+    assert(EVP_PKEY_keygen(kctx, &key) == 1);
+    EVP_PKEY_CTX_free(kctx);
+
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1,
+                               0);
+    X509_set_issuer_name(cert, name);
+    assert(X509_sign(cert, key, EVP_sha256()) > 0);
+
+    FILE* f = fopen(kCertFile, "wb");
+    assert(f);
+    PEM_write_X509(f, cert);
+    fclose(f);
+    f = fopen(kKeyFile, "wb");
+    assert(f);
+    PEM_write_PrivateKey(f, key, nullptr, nullptr, 0, nullptr, nullptr);
+    fclose(f);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+}
+
+// 测试用客户端：同样使用内存 BIO，与 TlsSession 直接交换字节
+struct Client {
+    SSL* ssl;
+    BIO* in;
+    BIO* out;
+
+    Client(SSL_CTX* ctx, SSL_SESSION* session = nullptr) {
+        ssl = SSL_new(ctx);
+        in = BIO_new(BIO_s_mem());
+        out = BIO_new(BIO_s_mem());
+        BIO_set_mem_eof_return(in, -1);
+        SSL_set_bio(ssl, in, out);
+        SSL_set_connect_state(ssl);
+        if (session) SSL_set_session(ssl, session);
+    }
+    ~Client() {
+        SSL_shutdown(ssl);  // 未关闭就释放的会话会被 OpenSSL 标记为不可恢复
+        SSL_free(ssl);
+    }
+
+    std::string takeOutput() {
+        std::string data(BIO_ctrl_pending(out), '\0');
+        if (!data.empty()) BIO_read(out, &data[0], static_cast<int>(data.size()));
+        return data;
+    }
+
+    void feed(const std::string& data) { BIO_write(in, data.data(), static_cast<int>(data.size())); }
+
+    std::string read() {
+        std::string plain;
+        char buf[4096];
+        int n;
+        while ((n = SSL_read(ssl, buf, sizeof(buf))) > 0) plain.append(buf, n);
+        return plain;
+    }
+};
+
+// 双向搬运字节直到双方握手完成；服务端发出的记录（含 session ticket）都交给客户端处理
+static void Pump(Client& client, TlsSession& server) {
+    for (int round = 0; round < 8; ++round) {
+        SSL_do_handshake(client.ssl);
+        std::string toServer = client.takeOutput();
+        if (!toServer.empty()) {
+            std::string plain;
+            assert(server.decrypt(toServer.data(), toServer.size(), plain));
+            assert(plain.empty());
+        }
+        std::string toClient = server.takeOutput();
+        if (!toClient.empty()) client.feed(toClient);
+        if (server.handshakeDone() && SSL_is_init_finished(client.ssl) && toServer.empty() && toClient.empty()) {
+            break;
+        }
+    }
+    client.read();  // 处理 TLS 1.3 握手后下发的 session ticket
+}
+
+static SSL_CTX* NewClientContext() {
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT);
+    return ctx;
+}
+
+static std::shared_ptr<TlsContext> NewServerContext() {
+    TlsOptions options;
+    options.certFile = kCertFile;
+    options.keyFile = kKeyFile;
+    std::string error;
+    std::shared_ptr<TlsContext> context = TlsContext::create(options, error);
+    if (!context) std::cerr << error << std::endl;
+    assert(context);
+    return context;
+}
+
+// 测试 1: 握手与双向收发
+void test_handshake_and_data() {
+    std::cout << "\n[测试 1] 握手与收发..." << std::endl;
+    std::shared_ptr<TlsContext> context = NewServerContext();
+    SSL_CTX* clientCtx = NewClientContext();
+
+    Client client(clientCtx);
+    std::unique_ptr<TlsSession> server = context->newSession();
+    assert(server);
+    Pump(client, *server);
+    assert(server->handshakeDone() && !server->resumed());
+    const unsigned char* alpn = nullptr;
+    unsigned int alpnLen = 0;
+    SSL_get0_alpn_selected(client.ssl, &alpn, &alpnLen);
+    assert(alpnLen == 0);  // 客户端没有提供 ALPN
+    std::cout << "  ✓ 握手完成（" << SSL_get_version(client.ssl) << "）" << std::endl;
+
+    // 客户端 → 服务端：一次输入里的多条记录全部解出
+    std::string request = "GET /health HTTP/1.1\r\nHost: x\r\n\r\n";
+    SSL_write(client.ssl, request.data(), static_cast<int>(request.size()));
+    SSL_write(client.ssl, request.data(), static_cast<int>(request.size()));
+    std::string cipher = client.takeOutput();
+    std::string plain;
+    assert(server->decrypt(cipher.data(), cipher.size(), plain));
+    assert(plain == request + request);
+
+    // 逐字节输入也能拼出完整记录
+    SSL_write(client.ssl, request.data(), static_cast<int>(request.size()));
+    cipher = client.takeOutput();
+    plain.clear();
+    for (char c : cipher) assert(server->decrypt(&c, 1, plain));
+    assert(plain == request);
+    std::cout << "  ✓ 多条记录 / 分段到达的记录都能解出" << std::endl;
+
+    // 服务端 → 客户端
+    std::string body(100 * 1024, 'x');
+    assert(server->encrypt(body.data(), body.size()));
+    assert(server->hasOutput());
+    client.feed(server->takeOutput());
+    assert(!server->hasOutput());
+    assert(client.read() == body);
+    std::cout << "  ✓ 100KB 响应加密后客户端完整解出" << std::endl;
+
+    // close_notify：返回 false 但不算握手失败
+    SSL_shutdown(client.ssl);
+    cipher = client.takeOutput();
+    plain.clear();
+    assert(!server->decrypt(cipher.data(), cipher.size(), plain));
+
+    SSL_CTX_free(clientCtx);
+    TlsContext::Stats stats = context->stats();
+    assert(stats.fullHandshakes == 1 && stats.resumedHandshakes == 0 && stats.failedHandshakes == 0);
+    std::cout << "[通过] 握手与收发" << std::endl;
+}
+
+// 测试 2: 会话恢复（TLS 1.3 session ticket 与 TLS 1.2 会话缓存）
+void test_resumption(int version) {
+    const char* label = version == TLS1_3_VERSION ? "TLS 1.3 ticket" : "TLS 1.2";
+    std::cout << "\n[测试 2] 会话恢复 " << label << "..." << std::endl;
+    std::shared_ptr<TlsContext> context = NewServerContext();
+    SSL_CTX* clientCtx = NewClientContext();
+    SSL_CTX_set_max_proto_version(clientCtx, version);
+
+    SSL_SESSION* saved = nullptr;
+    {
+        Client client(clientCtx);
+        std::unique_ptr<TlsSession> server = context->newSession();
+        Pump(client, *server);
+        assert(server->handshakeDone() && !server->resumed());
+        saved = SSL_get1_session(client.ssl);
+        assert(saved && SSL_SESSION_is_resumable(saved));
+    }
+
+    // 新连接（可能落到另一个分片）带上保存的会话
+    for (int i = 0; i < 3; ++i) {
+        Client client(clientCtx, saved);
+        std::unique_ptr<TlsSession> server = context->newSession();
+        Pump(client, *server);
+        assert(server->handshakeDone() && server->resumed());
+        assert(SSL_session_reused(client.ssl) == 1);
+        if (version == TLS1_3_VERSION) {
+            // TLS 1.3 ticket 一次性使用：换成本次连接下发的新 ticket
+            SSL_SESSION_free(saved);
+            saved = SSL_get1_session(client.ssl);
+        }
+    }
+    SSL_SESSION_free(saved);
+    SSL_CTX_free(clientCtx);
+
+    TlsContext::Stats stats = context->stats();
+    assert(stats.fullHandshakes == 1 && stats.resumedHandshakes == 3);
+    assert(stats.maxHandshakeUs > 0 || stats.fullHandshakeUs == 0);
+    std::cout << "  ✓ 1 次完整握手 + 3 次恢复；完整握手 " << stats.fullHandshakeUs << "us，恢复平均 "
+              << stats.resumedHandshakeUs / 3 << "us" << std::endl;
+    std::cout << "[通过] 会话恢复 " << label << std::endl;
+}
+
+// 测试 3: 非 TLS 输入与握手中断计为失败
+void test_failures() {
+    std::cout << "\n[测试 3] 握手失败..." << std::endl;
+    std::shared_ptr<TlsContext> context = NewServerContext();
+    {
+        std::unique_ptr<TlsSession> server = context->newSession();
+        std::string garbage = "GET / HTTP/1.1\r\nHost: x\r\n\r\n";
+        std::string plain;
+        assert(!server->decrypt(garbage.data(), garbage.size(), plain));
+        assert(!server->decrypt(garbage.data(), garbage.size(), plain));  // 失败后不再接受输入
+    }
+    {
+        // 发完 ClientHello 就断开
+        SSL_CTX* clientCtx = NewClientContext();
+        Client client(clientCtx);
+        std::unique_ptr<TlsSession> server = context->newSession();
+        SSL_do_handshake(client.ssl);
+        std::string hello = client.takeOutput();
+        std::string plain;
+        assert(server->decrypt(hello.data(), hello.size(), plain));
+        assert(!server->handshakeDone() && server->hasOutput());
+        server.reset();
+        SSL_CTX_free(clientCtx);
+    }
+    assert(context->stats().failedHandshakes == 2);
+    std::cout << "  ✓ 明文 HTTP 与半途断开的握手各计一次失败" << std::endl;
+
+    TlsOptions missing;
+    missing.certFile = "no-such-cert.pem";
+    missing.keyFile = "no-such-key.pem";
+    std::string error;
+    assert(!TlsContext::create(missing, error) && !error.empty());
+    std::cout << "  ✓ 证书不存在: " << error << std::endl;
+    std::cout << "[通过] 握手失败" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[TlsContext] 开始测试..." << std::endl;
+    assert(TlsContext::available());
+    WriteSelfSignedCert();
+    test_handshake_and_data();
+    test_resumption(TLS1_3_VERSION);
+    test_resumption(TLS1_2_VERSION);
+    test_failures();
+    std::remove(kCertFile);
+    std::remove(kKeyFile);
+    std::cout << "\n[通过] TlsContext 全部测试" << std::endl;
+    return 0;
+}
+
+#else
+
+int main() {
+    std::string error;
+    assert(!TlsContext::available());
+    assert(!TlsContext::create(TlsOptions(), error) && !error.empty());
+    std::cout << "[跳过] 未启用 OpenSSL，TlsContext::create 返回: " << error << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * 异步工具调用单元测试（ToolCallContext、RunOnToolPool、StartMcpToolCall）
+ */
+#include "mcp/tool_call.h"
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "app_core.h"
+#include "mcp/dispatcher.h"
+#include "mcp/tool_registry.h"
+
+// dispatcher 引用的全局变量（测试中不启用策略和审计）
+clawdesk::AuditLogger* g_auditLogger = nullptr;
+PolicyGuard*           g_policyGuard = nullptr;
+
+void LogActivity(ActivityKind, const std::string&, const std::string&) {}
+
+// 记录通知和响应，respond 后唤醒等待方
+class RecordingChannel : public McpResponseChannel {
+public:
+    bool notify(const nlohmann::json& notification) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        notifications.push_back(notification);
+        return !closedFlag.load();
+    }
+    void respond(const nlohmann::json& r) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        responses.push_back(r);
+        cv.notify_all();
+    }
+    bool closed() const override { return closedFlag.load(); }
+
+    nlohmann::json wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this]() { return !responses.empty(); });
+        return responses.front();
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<nlohmann::json> notifications;
+    std::vector<nlohmann::json> responses;
+    std::atomic_bool closedFlag{false};
+};
+
+static nlohmann::json TextContent(const std::string& text) {
+    return {{"content", nlohmann::json::array({{{"type", "text"}, {"text", text}}})}, {"isError", false}};
+}
+
+static JsonRpcMessage ToolCall(int id, const nlohmann::json& params) {
+    return ParseJsonRpcMessage({{"jsonrpc", "2.0"}, {"id", id}, {"method", "tools/call"}, {"params", params}});
+}
+
+static void RegisterTool(const std::string& name, std::function<nlohmann::json(const nlohmann::json&)> handler,
+                         AsyncToolHandler asyncHandler) {
+    ToolMetadata meta;
+    meta.name = name;
+    meta.description = name;
+    meta.riskLevel = clawdesk::RiskLevel::Low;
+    meta.requiresConfirmation = false;
+    meta.inputSchema = nlohmann::json::object();
+    meta.handler = std::move(handler);
+    meta.asyncHandler = std::move(asyncHandler);
+    ToolRegistry::getInstance().registerTool(name, meta);
+}
+
+// 同步工具：每步上报一次进度
+static nlohmann::json CountTool(const nlohmann::json& args) {
+    int steps = args.value("steps", 3);
+    for (int i = 1; i <= steps; ++i) {
+        if (IsToolCallCancelled()) return TextContent("cancelled");
+        ReportToolProgress(i, steps, "step " + std::to_string(i));
+    }
+    return TextContent("done");
+}
+
+static void testProgressAndResult() {
+    std::cout << "\n[测试 1] 进度通知与最终响应..." << std::endl;
+    WorkerPool pool(2, 16, "test-tools");
+    SetMcpToolPool(&pool);
+
+    auto channel = std::make_shared<RecordingChannel>();
+    StartMcpToolCall(ToolCall(1, {{"name", "count"}, {"arguments", {{"steps", 3}}},
+                                  {"_meta", {{"progressToken", "tok"}}}}), "TEST", channel);
+    nlohmann::json response = channel->wait();
+    assert(response["id"] == 1);
+    assert(response["result"]["content"][0]["text"] == "done");
+
+    std::lock_guard<std::mutex> lock(channel->mutex);
+    assert(channel->notifications.size() == 3);
+    for (size_t i = 0; i < 3; ++i) {
+        const nlohmann::json& n = channel->notifications[i];
+        assert(n["method"] == "notifications/progress");
+        assert(n["params"]["progressToken"] == "tok");
+        assert(n["params"]["progress"] == static_cast<double>(i + 1));
+        assert(n["params"]["total"] == 3.0);
+        assert(n["params"]["message"] == "step " + std::to_string(i + 1));
+    }
+    assert(channel->responses.size() == 1);
+
+    SetMcpToolPool(nullptr);
+    pool.shutdown();
+    std::cout << "  ✓ 进度按顺序发出，响应只有一条" << std::endl;
+}
+
+static void testNoProgressToken() {
+    std::cout << "\n[测试 2] 无 progressToken 时不发通知，无线程池时在调用线程执行..." << std::endl;
+    auto channel = std::make_shared<RecordingChannel>();
+    StartMcpToolCall(ToolCall(2, {{"name", "count"}}), "TEST", channel);
+    assert(channel->responses.size() == 1);  // 同步完成
+    assert(channel->notifications.empty());
+    assert(channel->responses[0]["result"]["content"][0]["text"] == "done");
+    std::cout << "  ✓ 只有最终响应" << std::endl;
+}
+
+static void testErrors() {
+    std::cout << "\n[测试 3] 错误响应..." << std::endl;
+    auto unknown = std::make_shared<RecordingChannel>();
+    StartMcpToolCall(ToolCall(3, {{"name", "missing_tool"}}), "TEST", unknown);
+    assert(unknown->responses.size() == 1);
+    assert(unknown->responses[0]["error"]["code"] == kJsonRpcMethodNotFound);
+
+    // 异步 handler 丢弃 context 而不完成：返回内部错误
+    RegisterTool("forgetful", nullptr, [](const nlohmann::json&, std::shared_ptr<ToolCallContext>) {});
+    auto forgotten = std::make_shared<RecordingChannel>();
+    StartMcpToolCall(ToolCall(4, {{"name", "forgetful"}}), "TEST", forgotten);
+    assert(forgotten->responses.size() == 1);
+    assert(forgotten->responses[0]["error"]["code"] == kJsonRpcInternalError);
+
+    // 抛出异常；之后再 complete 不再生效
+    RegisterTool("throwing", nullptr, [](const nlohmann::json&, std::shared_ptr<ToolCallContext> ctx) {
+        std::thread([ctx]() { ctx->complete(TextContent("late")); }).join();
+        throw std::runtime_error("boom");
+    });
+    auto thrown = std::make_shared<RecordingChannel>();
+    StartMcpToolCall(ToolCall(5, {{"name", "throwing"}}), "TEST", thrown);
+    assert(thrown->responses.size() == 1);
+    assert(thrown->responses[0]["result"]["content"][0]["text"] == "late");
+    std::cout << "  ✓ 未知工具、未完成、异常" << std::endl;
+}
+
+static void testCancellation() {
+    std::cout << "\n[测试 4] 客户端断开后 cancelled() 为真..." << std::endl;
+    std::shared_ptr<ToolCallContext> held;
+    RegisterTool("holding", nullptr, [&held](const nlohmann::json&, std::shared_ptr<ToolCallContext> ctx) {
+        held = ctx;
+    });
+    auto channel = std::make_shared<RecordingChannel>();
+    StartMcpToolCall(ToolCall(6, {{"name", "holding"}, {"_meta", {{"progressToken", 9}}}}), "TEST", channel);
+    assert(held && !held->cancelled() && channel->responses.empty());
+    channel->closedFlag.store(true);
+    assert(held->cancelled());
+    held->complete(TextContent("ok"));
+    held.reset();
+    assert(channel->responses.size() == 1 && channel->responses[0]["result"]["content"][0]["text"] == "ok");
+    std::cout << "  ✓ 完成后释放 context 不再发送错误" << std::endl;
+}
+
+static void testBlockingCall() {
+    std::cout << "\n[测试 5] CallMcpTool 等待只有异步 handler 的工具..." << std::endl;
+    RegisterTool("async_only", nullptr, [](const nlohmann::json& args, std::shared_ptr<ToolCallContext> ctx) {
+        std::thread([args, ctx]() { ctx->complete(TextContent(args.value("text", ""))); }).detach();
+    });
+    McpToolCallResult call = CallMcpTool({{"name", "async_only"}, {"arguments", {{"text", "hi"}}}}, "TEST");
+    assert(call.ok() && call.result["content"][0]["text"] == "hi");
+
+    assert(IsAsyncMcpToolCall({{"name", "async_only"}}));
+    assert(IsAsyncMcpToolCall({{"name", "echo_sync"}, {"_meta", {{"progressToken", "x"}}}}));
+    assert(!IsAsyncMcpToolCall({{"name", "echo_sync"}}));
+    std::cout << "  ✓ 阻塞调用与异步判定" << std::endl;
+}
+
+static void testCancelNotification() {
+    std::cout << "\n[测试 6] notifications/cancelled 按 session 和请求 id 取消..." << std::endl;
+    std::shared_ptr<ToolCallContext> held;
+    RegisterTool("holding", nullptr, [&held](const nlohmann::json&, std::shared_ptr<ToolCallContext> ctx) {
+        held = ctx;
+    });
+    auto channel = std::make_shared<RecordingChannel>();
+    StartMcpToolCall(ToolCall(7, {{"name", "holding"}}), "TEST", channel, "s1");
+    assert(held && !held->cancelled());
+
+    // 其他 session、其他 id、类型不符的 id 都不匹配
+    assert(!CancelMcpRequest({{"requestId", 7}}, "s2", "TEST"));
+    assert(!CancelMcpRequest({{"requestId", 8}}, "s1", "TEST"));
+    assert(!CancelMcpRequest({{"requestId", "7"}}, "s1", "TEST"));
+    assert(!held->cancelled());
+
+    CancellationToken token = held->cancellation();
+    assert(CancelMcpRequest({{"requestId", 7}, {"reason", "user"}}, "s1", "TEST"));
+    assert(held->cancelled() && token.cancelled());
+    held->complete(TextContent("stopped"));
+    held.reset();
+    // 已完成的调用不再登记
+    assert(!CancelMcpRequest({{"requestId", 7}}, "s1", "TEST"));
+    assert(channel->responses.size() == 1);
+
+    // 同步 handler 经 CurrentCancellationToken 看到取消
+    std::atomic_bool started{false};
+    RegisterTool("waiting", [&started](const nlohmann::json&) {
+        CancellationToken cancel = CurrentCancellationToken();
+        started.store(true);
+        return TextContent(cancel.waitFor(10000) ? "cancelled" : "timeout");
+    }, nullptr);
+    std::thread canceller([&started]() {
+        while (!started.load()) std::this_thread::yield();
+        while (!CancelMcpRequest({{"requestId", "w"}}, "s1", "TEST")) std::this_thread::yield();
+    });
+    McpToolCallResult call = CallMcpTool({{"name", "waiting"}}, "TEST", "s1", "w");
+    canceller.join();
+    assert(call.ok() && call.result["content"][0]["text"] == "cancelled");
+
+    // 没有 session 的调用不登记、不可取消
+    CancellationToken outside;
+    RegisterTool("peek", [&outside](const nlohmann::json&) {
+        outside = CurrentCancellationToken();
+        return TextContent("x");
+    }, nullptr);
+    assert(CallMcpTool({{"name", "peek"}}, "TEST").ok());
+    outside.cancel();
+    assert(!outside.cancelled());
+    std::cout << "  ✓ 只取消匹配的执行中调用" << std::endl;
+}
+
+static void testScopeOutsideCall() {
+    std::cout << "\n[测试 7] 不在调用中时 ReportToolProgress / IsToolCallCancelled 为空操作..." << std::endl;
+    ReportToolProgress(1, 2);
+    assert(!IsToolCallCancelled());
+    assert(!CurrentCancellationToken().cancelled());
+    std::cout << "  ✓ 空操作" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[ToolCall] 开始测试..." << std::endl;
+    RegisterTool("count", CountTool, nullptr);
+    RegisterTool("echo_sync", [](const nlohmann::json&) { return TextContent("x"); }, nullptr);
+
+    testProgressAndResult();
+    testNoProgressToken();
+    testErrors();
+    testCancellation();
+    testBlockingCall();
+    testCancelNotification();
+    testScopeOutsideCall();
+
+    std::cout << "\n[通过] ToolCall 测试全部通过" << std::endl;
+    return 0;
+}
@@ -44,6 +44,7 @@ int main() {
     assert(registry.hasTool("unit_test_tool"));
     auto loaded = registry.getTool("unit_test_tool");
     assert(loaded.name == "unit_test_tool");
+    assert(!registry.findTool("missing_tool"));
 
     auto tools = registry.getAllTools();
     bool found = false;
@@ -56,6 +57,30 @@ int main() {
     assert(found);
     std::cout << "  ✓ 注册与查询" << std::endl;
 
+    // 重新注册只替换表项，已取得的句柄仍指向旧元数据
+    ToolHandle handle = registry.findTool("unit_test_tool");
+    assert(handle && handle->description == "Unit test tool");
+    meta.description = "Replaced";
+    registry.registerTool(meta.name, meta);
+    assert(handle->description == "Unit test tool");
+    assert(handle->handler(nlohmann::json::object())["isError"] == false);
+    assert(registry.findTool("unit_test_tool")->description == "Replaced");
+    std::cout << "  ✓ 重新注册不影响已取得的句柄" << std::endl;
+
+    // tools/list 缓存：未变化时共享同一份字节，注册后重建，ETag 随内容变化
+    auto list = registry.getToolsList();
+    assert(list->generation == registry.generation());
+    assert(list == registry.getToolsList());
+    assert(nlohmann::json::parse(*list->json)["tools"].size() == list->toolCount);
+    assert(list->etag.size() > 2 && list->etag.front() == '"' && list->etag.back() == '"');
+    meta.name = "unit_test_tool_2";
+    registry.registerTool(meta.name, meta);
+    auto rebuilt = registry.getToolsList();
+    assert(rebuilt != list && rebuilt->generation == list->generation + 1);
+    assert(rebuilt->toolCount == list->toolCount + 1 && rebuilt->etag != list->etag);
+    assert(rebuilt->json->find("unit_test_tool_2") != std::string::npos);
+    std::cout << "  ✓ tools/list 预序列化缓存按版本重建" << std::endl;
+
     std::cout << "[通过] ToolRegistry 测试" << std::endl;
     return 0;
 }
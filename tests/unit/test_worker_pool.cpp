@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2026 Codyard
+ *
+ * This file is part of WinBridgeAgent.
+ *
+ * WinBridgeAgent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WinBridgeAgent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WinBridgeAgent. If not, see <https://www.gnu.org/licenses/\>.
+ */
+/**
+ * WorkerPool / BoundedMpmcQueue 单元测试
+ */
+#include "support/worker_pool.h"
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// 测试 1: 队列基本语义（FIFO、满/空）
+void test_queue_basic() {
+    std::cout << "\n[测试 1] 有界队列基本语义..." << std::endl;
+
+    BoundedMpmcQueue<int> q(3);  // 取整为 4
+    assert(q.capacity() == 4);
+    for (int i = 0; i < 4; ++i) {
+        int v = i;
+        assert(q.tryPush(std::move(v)));
+    }
+    int extra = 99;
+    assert(!q.tryPush(std::move(extra)));
+    std::cout << "  ✓ 满时 tryPush 返回 false" << std::endl;
+
+    for (int i = 0; i < 4; ++i) {
+        int out = -1;
+        assert(q.tryPop(out));
+        assert(out == i);
+    }
+    int out = -1;
+    assert(!q.tryPop(out));
+    std::cout << "  ✓ FIFO 顺序，空时 tryPop 返回 false" << std::endl;
+    std::cout << "[通过] 有界队列基本语义" << std::endl;
+}
+
+// 测试 2: 多生产者多消费者不丢不重
+void test_queue_concurrent() {
+    std::cout << "\n[测试 2] 多生产者/多消费者..." << std::endl;
+
+    BoundedMpmcQueue<int> q(64);
+    const int kProducers = 4;
+    const int kPerProducer = 20000;
+    std::atomic<long long> sum{0};
+    std::atomic<int> consumed{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&q, p]() {
+            for (int i = 1; i <= kPerProducer; ++i) {
+                int v = i;
+                while (!q.tryPush(std::move(v))) {
+                    v = i;
+                    std::this_thread::yield();
+                }
+            }
+            (void)p;
+        });
+    }
+    for (int c = 0; c < kProducers; ++c) {
+        threads.emplace_back([&]() {
+            while (consumed.load() < kProducers * kPerProducer) {
+                int v = 0;
+                if (q.tryPop(v)) {
+                    sum.fetch_add(v);
+                    consumed.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    long long expected = static_cast<long long>(kProducers) * kPerProducer * (kPerProducer + 1) / 2;
+    assert(sum.load() == expected);
+    std::cout << "  ✓ " << consumed.load() << " 个元素全部正确交接" << std::endl;
+    std::cout << "[通过] 多生产者/多消费者" << std::endl;
+}
+
+// 测试 3: 线程池并行执行与指标
+void test_pool_parallel() {
+    std::cout << "\n[测试 3] 线程池并行执行..." << std::endl;
+
+    WorkerPool pool(4, 16, "test");
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    std::atomic<int> done{0};
+
+    for (int i = 0; i < 8; ++i) {
+        bool ok = pool.submit([&]() {
+            int now = running.fetch_add(1) + 1;
+            int prev = maxRunning.load();
+            while (now > prev && !maxRunning.compare_exchange_weak(prev, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            running.fetch_sub(1);
+            done.fetch_add(1);
+        });
+        assert(ok);
+    }
+
+    while (done.load() < 8) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    assert(maxRunning.load() > 1);
+    std::cout << "  ✓ 最大并发: " << maxRunning.load() << std::endl;
+
+    auto s = pool.stats();
+    assert(s.workers == 4);
+    assert(s.submitted == 8);
+    assert(s.completed == 8);
+    assert(s.rejected == 0);
+    std::cout << "  ✓ 指标: submitted=" << s.submitted << " completed=" << s.completed
+              << " max_wait_us=" << s.maxQueueWaitUs << std::endl;
+    std::cout << "[通过] 线程池并行执行" << std::endl;
+}
+
+// 测试 4: 队列满时拒绝，shutdown 后拒绝
+void test_pool_reject() {
+    std::cout << "\n[测试 4] 队列满/停止后拒绝..." << std::endl;
+
+    WorkerPool pool(1, 2, "test");
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    assert(pool.submit([&]() {
+        started.store(true);
+        while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }));
+    while (!started.load()) std::this_thread::yield();
+
+    int accepted = 0;
+    for (int i = 0; i < 10; ++i) {
+        if (pool.submit([]() {})) accepted++;
+    }
+    assert(accepted == 2);
+    assert(pool.stats().rejected == 8);
+    std::cout << "  ✓ 容量 2 的队列只接受 2 个排队任务" << std::endl;
+
+    release.store(true);
+    pool.shutdown();
+    assert(!pool.submit([]() {}));
+    std::cout << "  ✓ shutdown 后 submit 返回 false" << std::endl;
+    std::cout << "[通过] 队列满/停止后拒绝" << std::endl;
+}
+
+// 测试 5: 排队时限、预估拒绝与快速通道
+void test_pool_admission() {
+    std::cout << "\n[测试 5] 准入控制..." << std::endl;
+
+    WorkerPool pool(1, 8, "test", 1);
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    auto blocker = [&]() {
+        started.store(true);
+        while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    };
+
+    // 先跑一个 30ms 的任务，让平均执行时间有样本
+    std::atomic<bool> warmed{false};
+    assert(pool.submit([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        warmed.store(true);
+    }));
+    while (!warmed.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    while (pool.stats().completed < 1) std::this_thread::yield();
+    assert(pool.stats().avgServiceUs >= 20000);
+
+    assert(pool.submit(blocker));
+    while (!started.load()) std::this_thread::yield();
+
+    // 排在后面的任务等待超过时限：不执行，改为回调
+    std::atomic<bool> ran{false};
+    std::atomic<bool> expired{false};
+    assert(pool.submit([&]() { ran.store(true); }, std::chrono::milliseconds(20), [&]() { expired.store(true); }));
+
+    // 已有 1 个任务排队、平均 30ms：10ms 时限预估赶不上，直接拒绝
+    assert(!pool.submit([]() {}, std::chrono::milliseconds(10), []() {}));
+    assert(pool.stats().shed == 1);
+    std::cout << "  ✓ 预估等待超过时限时提交即拒绝" << std::endl;
+
+    // 普通线程被占满时，快速通道由保留线程执行
+    std::atomic<bool> fastRan{false};
+    assert(pool.submitFast([&]() { fastRan.store(true); }));
+    for (int i = 0; i < 1000 && !fastRan.load(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(fastRan.load());
+    std::cout << "  ✓ 快速通道不受普通任务阻塞" << std::endl;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    release.store(true);
+    for (int i = 0; i < 1000 && !expired.load(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(expired.load() && !ran.load());
+    auto s = pool.stats();
+    assert(s.expired == 1 && s.fastLaneSubmitted == 1 && s.fastLaneWorkers == 1);
+    std::cout << "  ✓ 排队超时的任务只调用 onExpired" << std::endl;
+    std::cout << "[通过] 准入控制" << std::endl;
+}
+
+int main() {
+    std::cout << "\n[WorkerPool] 开始测试..." << std::endl;
+    test_queue_basic();
+    test_queue_concurrent();
+    test_pool_parallel();
+    test_pool_reject();
+    test_pool_admission();
+    std::cout << "\n[通过] WorkerPool 全部测试" << std::endl;
+    return 0;
+}
@@ -27,38 +27,47 @@ void Log(const std::string& message) {
     }
 }
 
-// 等待进程退出
+// 等待进程退出：找到进程后等待其进程句柄（退出即返回），打不开句柄时再退回短间隔轮询
 bool WaitForProcessExit(const std::string& processName, int timeoutSeconds) {
     Log("Waiting for process to exit: " + processName);
     
-    for (int i = 0; i < timeoutSeconds; ++i) {
+    ULONGLONG deadline = GetTickCount64() + static_cast<ULONGLONG>(timeoutSeconds) * 1000;
+    for (;;) {
         HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-        if (snapshot == INVALID_HANDLE_VALUE) {
-            continue;
-        }
-        
-        PROCESSENTRY32 pe32;
-        pe32.dwSize = sizeof(PROCESSENTRY32);
-        
+        DWORD pid = 0;
         bool found = false;
-        if (Process32First(snapshot, &pe32)) {
-            do {
-                std::string exeName = pe32.szExeFile;
-                if (exeName == processName) {
-                    found = true;
-                    break;
-                }
-            } while (Process32Next(snapshot, &pe32));
+        if (snapshot != INVALID_HANDLE_VALUE) {
+            PROCESSENTRY32 pe32;
+            pe32.dwSize = sizeof(PROCESSENTRY32);
+            if (Process32First(snapshot, &pe32)) {
+                do {
+                    std::string exeName = pe32.szExeFile;
+                    if (exeName == processName) {
+                        found = true;
+                        pid = pe32.th32ProcessID;
+                        break;
+                    }
+                } while (Process32Next(snapshot, &pe32));
+            }
+            CloseHandle(snapshot);
+            
+            if (!found) {
+                Log("Process exited: " + processName);
+                return true;
+            }
         }
         
-        CloseHandle(snapshot);
+        ULONGLONG now = GetTickCount64();
+        if (now >= deadline) break;
+        DWORD remaining = static_cast<DWORD>(deadline - now);
         
-        if (!found) {
-            Log("Process exited: " + processName);
-            return true;
+        HANDLE process = found ? OpenProcess(SYNCHRONIZE, FALSE, pid) : NULL;
+        if (process) {
+            WaitForSingleObject(process, remaining);
+            CloseHandle(process);
+        } else {
+            Sleep(remaining < 100 ? remaining : 100);
         }
-        
-        std::this_thread::sleep_for(std::chrono::seconds(1));
     }
     
     Log("Timeout waiting for process: " + processName);